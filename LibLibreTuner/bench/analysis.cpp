@@ -0,0 +1,88 @@
+// Table lookup and cell histograms over log samples
+
+#include <benchmark/benchmark.h>
+
+#include <lt/analysis/cellhistogram.h>
+#include <lt/analysis/lookup.h>
+
+#include <random>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+TableLookup makeLookup()
+{
+    std::vector<double> rpm, load;
+    for (int i = 0; i < 32; ++i)
+        rpm.push_back(500.0 + i * 250.0);
+    for (int i = 0; i < 32; ++i)
+        load.push_back(0.05 * i);
+    return TableLookup(Breakpoints(rpm), Breakpoints(load));
+}
+
+// Scattered operating points, so the search cannot be predicted
+void makeSamples(std::size_t count, std::vector<double> & x, std::vector<double> & y)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> rpm(0.0, 9000.0), load(0.0, 1.8);
+    x.resize(count);
+    y.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        x[i] = rpm(rng);
+        y[i] = load(rng);
+    }
+}
+} // namespace
+
+// Locates `range(0)` samples in a 32x32 table on one thread
+static void BM_TableLookup(benchmark::State & state)
+{
+    TableLookup lookup = makeLookup();
+    std::vector<double> x, y;
+    makeSamples(static_cast<std::size_t>(state.range(0)), x, y);
+    std::vector<CellLookup> cells(x.size());
+
+    for (auto _ : state)
+    {
+        lookup.locate(x.data(), y.data(), cells.data(), x.size());
+        benchmark::DoNotOptimize(cells.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TableLookup)->Arg(1 << 20);
+
+// Same as BM_TableLookup on every core
+static void BM_TableLookupParallel(benchmark::State & state)
+{
+    TableLookup lookup = makeLookup();
+    std::vector<double> x, y;
+    makeSamples(static_cast<std::size_t>(state.range(0)), x, y);
+    std::vector<CellLookup> cells(x.size());
+
+    for (auto _ : state)
+    {
+        lookup.locateParallel(x.data(), y.data(), cells.data(), x.size());
+        benchmark::DoNotOptimize(cells.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TableLookupParallel)->Arg(1 << 20)->UseRealTime();
+
+// Bins `range(0)` samples into a 32x32 histogram on every core
+static void BM_CellHistogram(benchmark::State & state)
+{
+    std::vector<double> x, y;
+    makeSamples(static_cast<std::size_t>(state.range(0)), x, y);
+
+    for (auto _ : state)
+    {
+        CellHistogram histogram(makeLookup());
+        histogram.addParallel(x.data(), y.data(), y.data(), x.size());
+        benchmark::DoNotOptimize(histogram.samples());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CellHistogram)->Arg(1 << 20)->UseRealTime();
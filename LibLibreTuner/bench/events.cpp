@@ -0,0 +1,142 @@
+// Event dispatch, data log insertion and tracing
+
+#include <benchmark/benchmark.h>
+
+#include <lt/datalog/datalog.h>
+#include <lt/support/event.h>
+#include <lt/support/trace.h>
+
+#include <atomic>
+#include <forward_list>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+// The event implementation before listener lists were copy-on-write, kept
+// for comparison. Each dispatch walks a linked list and locks every
+// listener's weak_ptr.
+class WeakListEvent
+{
+public:
+    using Connection = std::function<void(int)>;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    template <typename Func> ConnectionPtr connect(Func && func)
+    {
+        auto connection = std::make_shared<Connection>(std::forward<Func>(func));
+        connections_.emplace_front(connection);
+        return connection;
+    }
+
+    void operator()(int value) const
+    {
+        for (const std::weak_ptr<Connection> & weak : connections_)
+        {
+            if (auto connection = weak.lock())
+                (*connection)(value);
+        }
+    }
+
+private:
+    std::forward_list<std::weak_ptr<Connection>> connections_;
+};
+
+template <typename EventType> void dispatch(benchmark::State & state)
+{
+    // Shared by every benchmark thread
+    static EventType event;
+    static std::vector<typename EventType::ConnectionPtr> connections;
+    static std::atomic<int> sum{0};
+    if (state.thread_index() == 0)
+    {
+        for (int i = 0; i < state.range(0); ++i)
+            connections.emplace_back(event.connect([](int value) { sum.fetch_add(value, std::memory_order_relaxed); }));
+    }
+
+    for (auto _ : state)
+    {
+        event(1);
+    }
+
+    if (state.thread_index() == 0)
+        connections.clear();
+    state.SetItemsProcessed(state.iterations());
+}
+} // namespace
+
+// Dispatches to `range(0)` listeners
+static void BM_EventDispatch(benchmark::State & state) { dispatch<Event<int>>(state); }
+BENCHMARK(BM_EventDispatch)->Arg(0)->Arg(1)->Arg(8)->Arg(64)->ThreadRange(1, 4);
+
+// Same with the previous implementation
+static void BM_EventDispatchWeakList(benchmark::State & state) { dispatch<WeakListEvent>(state); }
+BENCHMARK(BM_EventDispatchWeakList)->Arg(0)->Arg(1)->Arg(8)->Arg(64)->ThreadRange(1, 4);
+
+// Connects and disconnects a listener with `range(0)` other listeners
+// connected, which publishes two lists
+static void BM_EventConnect(benchmark::State & state)
+{
+    Event<int> event;
+    std::vector<Event<int>::ConnectionPtr> connections;
+    for (int i = 0; i < state.range(0); ++i)
+        connections.emplace_back(event.connect([](int) {}));
+
+    for (auto _ : state)
+    {
+        auto connection = event.connect([](int) {});
+        connection->disconnect();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EventConnect)->Arg(0)->Arg(8)->Arg(64);
+
+// Adds entries with `range(0)` listeners connected to the add event
+static void BM_DataLogAdd(benchmark::State & state)
+{
+    DataLog log;
+    Pid pid{0x000C, "RPM", "", "", "rpm"};
+    log.addPid(pid);
+
+    std::vector<DataLog::AddConnectionPtr> connections;
+    double sum = 0;
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        connections.emplace_back(log.onAdd(
+            [&sum](const PidLog &, const PidLogEntry & entry) { sum += entry.value; }));
+    }
+
+    std::size_t time = 0;
+    for (auto _ : state)
+    {
+        log.add(pid, PidLogEntry{static_cast<double>(time % 7000), time});
+        ++time;
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataLogAdd)->Arg(0)->Arg(1);
+
+// Cost of recording a span. Buffers are cleared before they fill so every
+// span is recorded.
+static void BM_TraceSpan(benchmark::State & state)
+{
+    trace::clear();
+    std::size_t count = 0;
+    for (auto _ : state)
+    {
+        trace::Span span("bench.span");
+        if (++count == trace::ThreadBuffer::capacity)
+        {
+            state.PauseTiming();
+            trace::clear();
+            count = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TraceSpan);
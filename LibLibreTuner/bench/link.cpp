@@ -0,0 +1,175 @@
+// ISO-TP and UDS against the virtual ECU. Macro benchmarks run the
+// downloader, flasher and logging requests end to end over a loopback bus,
+// so they measure the transport stack without CAN hardware.
+
+#include <benchmark/benchmark.h>
+
+#include <lt/auth/udsauthenticator.h>
+#include <lt/download/rmadownloader.h>
+#include <lt/flash/mazdat1.h>
+#include <lt/network/can/loopbackcan.h>
+#include <lt/network/isotp/isotpcan.h>
+#include <lt/network/isotp/isotpdecoder.h>
+#include <lt/network/uds/isotpuds.h>
+#include <lt/sim/virtualecu.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+constexpr const char * key = "bench";
+
+std::vector<uint8_t> pattern(std::size_t size)
+{
+    std::vector<uint8_t> data(size);
+    std::iota(data.begin(), data.end(), uint8_t{0});
+    return data;
+}
+
+// Virtual ECU on a loopback bus
+struct Bench
+{
+    std::unique_ptr<sim::VirtualEcu> ecu;
+    network::UdsPtr uds;
+
+    explicit Bench(std::size_t imageSize)
+    {
+        sim::VirtualEcuOptions options;
+        options.auth.key = key;
+        options.image = pattern(imageSize);
+
+        auto [tester, ecuCan] = network::LoopbackCan::createPair();
+        ecu = std::make_unique<sim::VirtualEcu>(std::move(ecuCan), std::move(options));
+        ecu->start();
+        uds = std::make_unique<network::IsoTpUds>(std::make_unique<network::IsoTpCan>(std::move(tester)));
+    }
+};
+
+// Appends the frames of an ISO-TP transfer of `payload` from `id`, with flow
+// control from `peer`
+void segment(uint32_t id, uint32_t peer, const std::vector<uint8_t> & payload,
+             std::vector<network::CanLogEntry> & entries, std::chrono::microseconds & time)
+{
+    auto add = [&](uint32_t from, const uint8_t * data, uint8_t length) {
+        network::CanLogEntry entry;
+        entry.direction = from == id ? network::CanMessageDirection::Outbound : network::CanMessageDirection::Inbound;
+        entry.message.setMessage(from, data, length);
+        entry.time = time;
+        time += std::chrono::microseconds(250);
+        entries.push_back(entry);
+    };
+
+    uint8_t frame[8]{};
+    if (payload.size() <= 7)
+    {
+        frame[0] = static_cast<uint8_t>(payload.size());
+        std::copy(payload.begin(), payload.end(), frame + 1);
+        add(id, frame, 8);
+        return;
+    }
+
+    frame[0] = static_cast<uint8_t>(0x10 | (payload.size() >> 8));
+    frame[1] = static_cast<uint8_t>(payload.size() & 0xFF);
+    std::copy(payload.begin(), payload.begin() + 6, frame + 2);
+    add(id, frame, 8);
+
+    const uint8_t flowControl[8] = {0x30, 0x00, 0x00};
+    add(peer, flowControl, 8);
+
+    uint8_t sequence = 1;
+    for (std::size_t offset = 6; offset < payload.size(); offset += 7)
+    {
+        std::size_t length = std::min<std::size_t>(7, payload.size() - offset);
+        frame[0] = static_cast<uint8_t>(0x20 | (sequence++ & 0x0F));
+        std::copy(payload.begin() + offset, payload.begin() + offset + length, frame + 1);
+        add(id, frame, static_cast<uint8_t>(length + 1));
+    }
+}
+} // namespace
+
+// Passive reassembly of captured ReadMemoryByAddress exchanges
+static void BM_IsoTpDecode(benchmark::State & state)
+{
+    const auto size = static_cast<std::size_t>(state.range(0));
+    std::vector<network::CanLogEntry> entries;
+    std::chrono::microseconds time{0};
+
+    std::vector<uint8_t> response = pattern(size + 1);
+    response[0] = 0x63;
+    for (int i = 0; i < 16; ++i)
+    {
+        segment(0x7E0, 0x7E8, {0x23, 0x00, 0x00, 0x10, 0x00, 0x0F, 0xFE}, entries, time);
+        segment(0x7E8, 0x7E0, response, entries, time);
+    }
+
+    network::IsoTpDecoder decoder;
+    for (auto _ : state)
+    {
+        decoder.clear();
+        decoder.add(entries.data(), entries.size());
+        decoder.finish();
+        benchmark::DoNotOptimize(decoder);
+    }
+    state.SetBytesProcessed(state.iterations() * 16 * static_cast<int64_t>(size));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries.size()));
+}
+BENCHMARK(BM_IsoTpDecode)->Arg(64)->Arg(4094);
+
+// Segmentation by the ECU and reassembly by the tester
+static void BM_UdsReadMemory(benchmark::State & state)
+{
+    const auto size = static_cast<uint16_t>(state.range(0));
+    Bench bench(64 * 1024);
+    auth::UdsAuthenticator(*bench.uds, {key}).auth();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(bench.uds->requestReadMemoryAddress(0, size));
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_UdsReadMemory)->Arg(6)->Arg(256)->Arg(4094)->UseRealTime();
+
+// Live data request rate
+static void BM_UdsReadDataByIdentifier(benchmark::State & state)
+{
+    Bench bench(0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(bench.uds->readDataByIdentifier(0x000C));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UdsReadDataByIdentifier)->UseRealTime();
+
+static void BM_RMADownload(benchmark::State & state)
+{
+    const auto size = static_cast<std::size_t>(state.range(0));
+    Bench bench(size);
+    download::RMADownloader downloader(std::move(bench.uds), download::Options{{key}, size});
+    for (auto _ : state)
+    {
+        if (!downloader.download())
+            state.SkipWithError("download was canceled");
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(BM_RMADownload)->Arg(256 * 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_MazdaT1Flash(benchmark::State & state)
+{
+    const auto size = static_cast<std::size_t>(state.range(0));
+    Bench bench(size);
+    MazdaT1Flasher flasher(std::move(bench.uds), FlashOptions{{key}});
+    FlashMap flashMap(pattern(size), 0);
+    for (auto _ : state)
+    {
+        if (!flasher.flash(flashMap))
+            state.SkipWithError("flash was canceled");
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(BM_MazdaT1Flash)->Arg(256 * 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,5 @@
+#include <benchmark/benchmark.h>
+
+// Run with --benchmark_out=<file> --benchmark_out_format=json to keep
+// results for comparing builds. The `bench` target does this.
+BENCHMARK_MAIN();
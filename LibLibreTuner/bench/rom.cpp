@@ -0,0 +1,188 @@
+// ROM data access: views, tables, checksums, model identification and
+// project queries
+
+#include <benchmark/benchmark.h>
+
+#include <lt/buffer/memorybuffer.h>
+#include <lt/buffer/view.h>
+#include <lt/definition/checksum.h>
+#include <lt/definition/platform.h>
+#include <lt/project/project.h>
+#include <lt/rom/table.h>
+
+#include <filesystem>
+#include <numeric>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+constexpr int tableWidth = 32;
+constexpr int tableHeight = 32;
+
+MemoryBuffer makeBuffer(std::size_t size)
+{
+    std::vector<uint8_t> data(size);
+    std::iota(data.begin(), data.end(), uint8_t{0});
+    return MemoryBuffer(std::move(data));
+}
+
+Table makeTable(MemoryBuffer & buffer)
+{
+    View view = buffer.view(0, tableWidth * tableHeight * sizeof(float));
+    return Table::Builder()
+        .setSize(tableWidth, tableHeight)
+        .setBounds(-1e9, 1e9)
+        .setEntries(create_entries<double, Endianness::Big>(DataType::Float, view))
+        .build();
+}
+} // namespace
+
+template <typename T> static void BM_ViewGet(benchmark::State & state)
+{
+    MemoryBuffer buffer = makeBuffer(64 * 1024);
+    View view = buffer.view();
+    const int count = view.size() / static_cast<int>(sizeof(T));
+    for (auto _ : state)
+    {
+        for (int i = 0; i < count; ++i)
+            benchmark::DoNotOptimize(view.get<T, Endianness::Big>(i * sizeof(T)));
+    }
+    state.SetBytesProcessed(state.iterations() * view.size());
+}
+BENCHMARK_TEMPLATE(BM_ViewGet, uint8_t);
+BENCHMARK_TEMPLATE(BM_ViewGet, uint16_t);
+BENCHMARK_TEMPLATE(BM_ViewGet, float);
+
+template <typename T> static void BM_ViewSet(benchmark::State & state)
+{
+    MemoryBuffer buffer = makeBuffer(64 * 1024);
+    View view = buffer.view();
+    const int count = view.size() / static_cast<int>(sizeof(T));
+    for (auto _ : state)
+    {
+        for (int i = 0; i < count; ++i)
+            view.set<T, Endianness::Big>(static_cast<T>(i), i * sizeof(T));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * view.size());
+}
+BENCHMARK_TEMPLATE(BM_ViewSet, uint8_t);
+BENCHMARK_TEMPLATE(BM_ViewSet, uint16_t);
+BENCHMARK_TEMPLATE(BM_ViewSet, float);
+
+static void BM_TableGet(benchmark::State & state)
+{
+    MemoryBuffer buffer = makeBuffer(tableWidth * tableHeight * sizeof(float));
+    Table table = makeTable(buffer);
+    for (auto _ : state)
+    {
+        for (int row = 0; row < tableHeight; ++row)
+        {
+            for (int column = 0; column < tableWidth; ++column)
+                benchmark::DoNotOptimize(table.get(row, column));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * tableWidth * tableHeight);
+}
+BENCHMARK(BM_TableGet);
+
+static void BM_TableSet(benchmark::State & state)
+{
+    MemoryBuffer buffer = makeBuffer(tableWidth * tableHeight * sizeof(float));
+    Table table = makeTable(buffer);
+    for (auto _ : state)
+    {
+        for (int row = 0; row < tableHeight; ++row)
+        {
+            for (int column = 0; column < tableWidth; ++column)
+                table.set(row, column, row + column * 0.5);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * tableWidth * tableHeight);
+}
+BENCHMARK(BM_TableSet);
+
+static void BM_ChecksumBasicCompute(benchmark::State & state)
+{
+    const auto size = static_cast<int>(state.range(0));
+    MemoryBuffer buffer = makeBuffer(size);
+    ChecksumBasic checksum(0, size, 0);
+    for (auto _ : state)
+    {
+        bool ok;
+        benchmark::DoNotOptimize(checksum.compute(buffer.data(), buffer.size(), &ok));
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_ChecksumBasicCompute)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+// Identifies a ROM that matches the last of `range(0)` models
+static void BM_PlatformIdentify(benchmark::State & state)
+{
+    const auto models = static_cast<int>(state.range(0));
+    MemoryBuffer rom = makeBuffer(1024 * 1024);
+
+    auto platform = std::make_shared<Platform>();
+    for (int i = 0; i < models; ++i)
+    {
+        auto model = std::make_shared<Model>(platform);
+        model->id = "model" + std::to_string(i);
+        // Models share the first identifier and differ in the second, as
+        // models of one platform usually do
+        model->identifiers.emplace_back(0x100, rom.data() + 0x100, rom.data() + 0x110);
+        std::vector<uint8_t> id(rom.data() + 0x2000, rom.data() + 0x2008);
+        id[0] = static_cast<uint8_t>(id[0] + models - 1 - i);
+        model->identifiers.emplace_back(0x2000, id.begin(), id.end());
+        platform->models.emplace_back(std::move(model));
+    }
+
+    for (auto _ : state)
+    {
+        ModelPtr model = platform->identify(rom.data(), rom.size());
+        if (!model)
+            state.SkipWithError("failed to identify model");
+        benchmark::DoNotOptimize(model);
+    }
+}
+BENCHMARK(BM_PlatformIdentify)->Arg(1)->Arg(16)->Arg(64);
+
+// Reads the metadata of `range(0)` saved ROMs
+static void BM_ProjectQueryRoms(benchmark::State & state)
+{
+    const auto roms = static_cast<int>(state.range(0));
+    std::filesystem::path base = std::filesystem::temp_directory_path() / "lt_bench_project";
+    std::filesystem::remove_all(base);
+
+    auto platform = std::make_shared<Platform>();
+    platform->id = "bench";
+    auto model = std::make_shared<Model>(platform);
+    model->id = "model";
+
+    Platforms platforms;
+    {
+        Project project(base, platforms);
+        project.makeDirectories();
+        for (int i = 0; i < roms; ++i)
+        {
+            RomPtr rom = project.createRom("rom" + std::to_string(i), model);
+            rom->setData(makeBuffer(256 * 1024));
+            rom->save();
+        }
+    }
+
+    Project project(base, platforms);
+    for (auto _ : state)
+    {
+        std::vector<Rom::MetaData> metadata = project.queryRoms();
+        if (metadata.size() != static_cast<std::size_t>(roms))
+            state.SkipWithError("missing ROMs");
+        benchmark::DoNotOptimize(metadata);
+    }
+    state.SetItemsProcessed(state.iterations() * roms);
+
+    std::filesystem::remove_all(base);
+}
+BENCHMARK(BM_ProjectQueryRoms)->Arg(8)->Arg(64);
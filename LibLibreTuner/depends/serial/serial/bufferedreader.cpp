@@ -1,71 +1,111 @@
 #include "bufferedreader.h"
 
 #include <stdexcept>
-#include <array>
 #include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
 
 namespace serial {
 
+BufferedReader::BufferedReader(Device &device, std::size_t capacity)
+    : device_(device), buffer_(new char[capacity]), capacity_(capacity) {}
 
 void BufferedReader::readSome() {
-    int preSize = buffer_.size();
-    buffer_.resize(buffer_.size() + 1024);
-
-    int amountRead = device_.read(buffer_.data() + preSize, 1024);
-    buffer_.resize(preSize + amountRead);
+    if (tail_ == capacity_) {
+        if (head_ == 0) {
+            throw std::runtime_error("buffered reader is full");
+        }
+        // Move unread data to the front. Only happens once per capacity
+        // worth of data.
+        std::memmove(buffer_.get(), buffer_.get() + head_, tail_ - head_);
+        tail_ -= head_;
+        head_ = 0;
+    }
 
-    if (amountRead == 0) {
+    int amountRead = device_.read(buffer_.get() + tail_, static_cast<int>(capacity_ - tail_));
+    if (amountRead <= 0) {
         throw std::runtime_error("received 0 bytes from socket");
     }
+    tail_ += static_cast<std::size_t>(amountRead);
 }
 
-std::string BufferedReader::read(unsigned int amount) {
-    while (buffer_.size() < amount) {
+std::string_view BufferedReader::read(std::size_t amount) {
+    if (amount > capacity_) {
+        throw std::runtime_error("read is larger than the buffer");
+    }
+    while (size() < amount) {
         readSome();
     }
-    std::string res(buffer_.begin(), buffer_.begin() + amount);
-    buffer_.erase(buffer_.begin(), buffer_.begin() + amount);
+    std::string_view res(buffer_.get() + head_, amount);
+    head_ += amount;
     return res;
 }
 
-std::string BufferedReader::readLine(const std::string &stop) {
-    constexpr std::array<char, 2> terminators{'\r', '\n'};
+void BufferedReader::read(char *out, std::size_t amount) {
+    std::size_t buffered = std::min(amount, size());
+    std::memcpy(out, buffer_.get() + head_, buffered);
+    head_ += buffered;
+    out += buffered;
+    amount -= buffered;
 
+    while (amount != 0) {
+        auto chunk = std::min<std::size_t>(amount, std::numeric_limits<int>::max());
+        int amountRead = device_.read(out, static_cast<int>(chunk));
+        if (amountRead <= 0) {
+            throw std::runtime_error("received 0 bytes from socket");
+        }
+        out += amountRead;
+        amount -= static_cast<std::size_t>(amountRead);
+    }
+}
+
+std::string_view BufferedReader::readLine(std::string_view stop) {
     skipWhitespace();
 
-    auto pos = buffer_.end();
-    std::size_t lastPos{0};
+    // Offset from head_ searched so far
+    std::size_t searched = 0;
     while (true) {
-        // Start searching from where we left off
-        pos = std::find_first_of(buffer_.begin() + lastPos, buffer_.end(), terminators.begin(), terminators.end());
+        const char *begin = buffer_.get() + head_;
+        std::size_t available = size();
+
         // Check for stop
-        if (!stop.empty() && buffer_.size() >= stop.size()) {
-            if (std::equal(stop.begin(), stop.end(), buffer_.begin())) {
-                // stop was found
-                pos = buffer_.begin() + stop.size();
-                break;
-            }
+        if (!stop.empty() && available >= stop.size() &&
+            std::memcmp(begin, stop.data(), stop.size()) == 0) {
+            head_ += stop.size();
+            return {begin, stop.size()};
         }
 
-        if (pos != buffer_.end()) {
-            break;
+        // Start searching from where we left off
+        const char *end = begin + available;
+        const void *cr = std::memchr(begin + searched, '\r', available - searched);
+        const char *pos = cr != nullptr ? static_cast<const char *>(cr) : end;
+        if (const void *lf = std::memchr(begin + searched, '\n', pos - (begin + searched))) {
+            pos = static_cast<const char *>(lf);
         }
 
-        lastPos = buffer_.size();
+        if (pos != end) {
+            std::size_t length = pos - begin;
+            head_ += length;
+            return {begin, length};
+        }
+
+        searched = available;
         readSome();
-        skipWhitespace();
+        if (searched == 0) {
+            // Only whitespace may have been read
+            skipWhitespace();
+        }
     }
-
-    std::string line(buffer_.begin(), pos);
-    //std::advance(pos, 1);
-    buffer_.erase(buffer_.begin(), pos);
-
-    return line;
 }
 
 void BufferedReader::skipWhitespace() {
-    buffer_.erase(buffer_.begin(), std::find_if_not(buffer_.begin(), buffer_.end(), [](char c) {
-        return std::isspace(static_cast<unsigned char>(c));
-    }));
+    while (head_ != tail_ && std::isspace(static_cast<unsigned char>(buffer_[head_]))) {
+        ++head_;
+    }
+    if (head_ == tail_) {
+        // Restart at the front so reads get the whole buffer
+        clear();
+    }
 }
 }
@@ -2,30 +2,54 @@
 #define SERIAL_BUFFEREDREADER_H
 
 #include "device.h"
-#include <vector>
+#include <cstddef>
+#include <memory>
+#include <string_view>
 
 namespace serial {
+// Reads from a device through a fixed-capacity buffer. Unread data is
+// moved to the front of the buffer only when the end is reached, so lines
+// and reads can be returned as views into the buffer. Views are valid
+// until the next call to the reader.
 class BufferedReader {
 public:
-    explicit BufferedReader(Device &device) : device_(device) {}
+    static constexpr std::size_t defaultCapacity = 16384;
 
-    // Reads exactly `amount` bytes
-    std::string read(unsigned int amount);
+    explicit BufferedReader(Device &device, std::size_t capacity = defaultCapacity);
+
+    // Reads exactly `amount` bytes. `amount` must not exceed the capacity.
+    std::string_view read(std::size_t amount);
+
+    // Reads exactly `amount` bytes into `out`. Any amount can be read;
+    // data past the buffered bytes is read directly into `out`.
+    void read(char *out, std::size_t amount);
 
     // Reads a single line terminating in CR or LF
-    // or if `stop` is read at the beginning of the line
-    std::string readLine(const std::string &stop = "");
+    // or if `stop` is read at the beginning of the line.
+    // The terminator is left in the buffer.
+    std::string_view readLine(std::string_view stop = {});
 
     // Clears buffer
-    inline void clear() noexcept { buffer_.clear(); }
+    inline void clear() noexcept { head_ = tail_ = 0; }
 
     // Clears whitespace at the beginning of the buffer
     void skipWhitespace();
 
+    inline std::size_t capacity() const noexcept { return capacity_; }
+
+    // Amount of buffered bytes
+    inline std::size_t size() const noexcept { return tail_ - head_; }
+
 private:
-    std::vector<char> buffer_;
     Device &device_;
-
+    std::unique_ptr<char[]> buffer_;
+    std::size_t capacity_;
+    // Unread data is [head_, tail_)
+    std::size_t head_{0};
+    std::size_t tail_{0};
+
+    // Reads at least one byte from the device. Throws if the buffer is full
+    // or the read times out.
     void readSome();
 };
 }
@@ -5,6 +5,7 @@
 #include <asm/termbits.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -133,9 +134,10 @@ void Device::updateSettings() {
     // termSettings.c_oflag = 0;
     termSettings.c_oflag &= ~OPOST; /*No Output Processing*/
 
-    // Set blocking
+    // Non-blocking reads. read() waits for readiness itself so the
+    // timeout is not limited to tenths of a second.
     termSettings.c_cc[VMIN] = 0;
-    termSettings.c_cc[VTIME] = 5; // 0.5s timeout
+    termSettings.c_cc[VTIME] = 0;
 
     // Disable hardware flow control
     termSettings.c_cflag &= ~CRTSCTS;
@@ -195,6 +197,29 @@ int Device::read(char *buffer, int amount) {
         throw std::runtime_error("attempt to read from closed socket");
     }
 
+    pollfd pfd{};
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(settings_.readTimeout);
+    timespec timeout{};
+    timeout.tv_sec = static_cast<time_t>(seconds.count());
+    timeout.tv_nsec = static_cast<long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(settings_.readTimeout - seconds).count());
+
+    int ready;
+    do {
+        ready = ::ppoll(&pfd, 1, &timeout, nullptr);
+    } while (ready == -1 && errno == EINTR);
+    if (ready == -1) {
+        throw std::runtime_error(
+            std::string("error while waiting for serial: ") + strerror(errno));
+    }
+    if (ready == 0) {
+        // Timed out
+        return 0;
+    }
+
     int res = ::read(fd_, buffer, amount);
     if (res == -1) {
         throw std::runtime_error(
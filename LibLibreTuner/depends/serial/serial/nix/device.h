@@ -40,7 +40,8 @@ public:
     // Writes data to device
     void write(const std::string &data);
 
-    // Reads up to `amount` bytes. Returns amount of bytes read.
+    // Reads up to `amount` bytes. Waits up to the read timeout for data.
+    // Returns amount of bytes read, or 0 if the timeout expired.
     int read(char *buffer, int amount);
 
     ~Device();
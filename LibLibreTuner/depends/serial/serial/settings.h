@@ -1,6 +1,7 @@
 #ifndef SERIAL_SETTINGS_H
 #define SERIAL_SETTINGS_H
 
+#include <chrono>
 #include <cstdint>
 
 namespace serial {
@@ -57,6 +58,8 @@ struct Settings {
     StopBits stopBits{StopBits::One};
     Mode mode{Mode::ReadWrite};
     DataBits dataBits{DataBits::DB8};
+    // Longest time read() waits for data
+    std::chrono::microseconds readTimeout{std::chrono::milliseconds(500)};
 };
 
 }
@@ -42,7 +42,8 @@ void Device::open() {
     // Set timeouts
     COMMTIMEOUTS timeouts{};
     timeouts.ReadIntervalTimeout = MAXDWORD;
-    timeouts.ReadTotalTimeoutConstant = 500;
+    timeouts.ReadTotalTimeoutConstant = static_cast<DWORD>(
+        std::chrono::ceil<std::chrono::milliseconds>(settings_.readTimeout).count());
     timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
     timeouts.WriteTotalTimeoutMultiplier = 10;
     timeouts.WriteTotalTimeoutConstant = 500;
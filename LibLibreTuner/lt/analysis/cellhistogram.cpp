@@ -0,0 +1,301 @@
+#include "cellhistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace lt
+{
+
+namespace
+{
+// Interpolates `entries` at `time` like alignSamples(). Returns false if
+// no entry is at or after `time` yet. Sets `value` to NaN if `time` is
+// before the first entry.
+bool interpolate(const std::deque<PidLogEntry> & entries, std::size_t time, double & value)
+{
+    auto next = std::lower_bound(entries.begin(), entries.end(), time,
+                                 [](const PidLogEntry & entry, std::size_t target) { return entry.time < target; });
+    if (next == entries.end())
+        return false;
+
+    if (next->time == time)
+    {
+        value = next->value;
+    }
+    else if (next == entries.begin())
+    {
+        value = std::numeric_limits<double>::quiet_NaN();
+    }
+    else
+    {
+        const PidLogEntry & previous = *(next - 1);
+        double t = static_cast<double>(time - previous.time) / static_cast<double>(next->time - previous.time);
+        value = previous.value + (next->value - previous.value) * t;
+    }
+    return true;
+}
+
+// Drops the entries before the last one at or before `time`
+void dropBefore(std::deque<PidLogEntry> & entries, std::size_t time)
+{
+    while (entries.size() > 1 && entries[1].time <= time)
+        entries.pop_front();
+}
+} // namespace
+
+void CellStats::add(double value) noexcept
+{
+    // Welford's online update
+    ++count;
+    double delta = value - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (value - mean);
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+void CellStats::merge(const CellStats & other) noexcept
+{
+    if (other.count != 0)
+    {
+        // Chan et al. pairwise combination
+        uint64_t total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * static_cast<double>(other.count) / static_cast<double>(total);
+        m2 += other.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) /
+                             static_cast<double>(total);
+        count = total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    weight += other.weight;
+    weightedSum += other.weightedSum;
+}
+
+CellHistogram::CellHistogram(TableLookup lookup)
+    : lookup_(std::move(lookup)), cells_(static_cast<std::size_t>(lookup_.width()) * lookup_.height())
+{
+}
+
+CellHistogram CellHistogram::fromLog(const DataLog & log, TableLookup lookup, uint16_t x, uint16_t y, uint16_t value,
+                                     JobPool & pool)
+{
+    std::vector<PidLog> logs;
+    if (!log.copyEntries({value, x, y}, logs))
+        throw std::runtime_error("the log does not contain the PIDs of the histogram");
+
+    AlignedSamples samples = alignSamples({&logs[0], &logs[1], &logs[2]});
+    CellHistogram histogram(std::move(lookup));
+    histogram.addParallel(samples.channels[1].data(), samples.channels[2].data(), samples.channels[0].data(),
+                          samples.size(), pool);
+    return histogram;
+}
+
+void CellHistogram::add(double x, double y, double value) noexcept
+{
+    if (std::isnan(value))
+        return;
+
+    const CellLookup cell = lookup_.locate(x, y);
+    const int width = lookup_.width();
+    cells_[cell.nearestRow() * width + cell.nearestColumn()].add(value);
+
+    const int nextRow = std::min(cell.row + 1, lookup_.height() - 1);
+    const int nextColumn = std::min(cell.column + 1, width - 1);
+    const double wx = cell.columnWeight;
+    const double wy = cell.rowWeight;
+    auto spread = [&](int row, int column, double weight) {
+        CellStats & stats = cells_[row * width + column];
+        stats.weight += weight;
+        stats.weightedSum += weight * value;
+    };
+    spread(cell.row, cell.column, (1.0 - wy) * (1.0 - wx));
+    spread(cell.row, nextColumn, (1.0 - wy) * wx);
+    spread(nextRow, cell.column, wy * (1.0 - wx));
+    spread(nextRow, nextColumn, wy * wx);
+    ++samples_;
+}
+
+void CellHistogram::add(const double * x, const double * y, const double * values, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+        add(x[i], y[i], values[i]);
+}
+
+void CellHistogram::addParallel(const double * x, const double * y, const double * values, std::size_t count,
+                                JobPool & pool)
+{
+    // Each part bins a contiguous range into its own histogram. A few parts
+    // per thread balance the load without many histograms to merge.
+    constexpr std::size_t minPartSize = 16384;
+    std::size_t parts = std::min<std::size_t>((count + minPartSize - 1) / minPartSize,
+                                              static_cast<std::size_t>(std::max(pool.threads(), 1u)) * 4);
+    if (parts <= 1)
+    {
+        add(x, y, values, count);
+        return;
+    }
+
+    std::vector<CellHistogram> partial(parts, CellHistogram(lookup_));
+    const std::size_t partSize = (count + parts - 1) / parts;
+    pool.parallelFor(parts, [&](std::size_t part) {
+        std::size_t begin = part * partSize;
+        std::size_t end = std::min(begin + partSize, count);
+        if (begin < end)
+            partial[part].add(x + begin, y + begin, values + begin, end - begin);
+    });
+
+    for (const CellHistogram & histogram : partial)
+        merge(histogram);
+}
+
+void CellHistogram::merge(const CellHistogram & other)
+{
+    if (other.width() != width() || other.height() != height())
+        throw std::runtime_error("attempt to merge cell histograms of different sizes");
+
+    for (std::size_t i = 0; i < cells_.size(); ++i)
+        cells_[i].merge(other.cells_[i]);
+    samples_ += other.samples_;
+}
+
+void CellHistogram::clear() noexcept
+{
+    std::fill(cells_.begin(), cells_.end(), CellStats{});
+    samples_ = 0;
+}
+
+std::vector<double> CellHistogram::suggest(const std::vector<double> & current, Correction mode,
+                                           double minWeight) const
+{
+    if (current.size() != cells_.size())
+        throw std::runtime_error("table size does not match the cell histogram");
+
+    std::vector<double> suggested(current);
+    for (std::size_t i = 0; i < cells_.size(); ++i)
+    {
+        const CellStats & stats = cells_[i];
+        if (stats.weight < minWeight || stats.weight <= 0.0)
+            continue;
+
+        double correction = stats.weightedMean();
+        if (mode == Correction::Multiplicative)
+            suggested[i] *= 1.0 + correction;
+        else
+            suggested[i] += correction;
+    }
+    return suggested;
+}
+
+LiveCellHistogram::LiveCellHistogram(DataLog & log, TableLookup lookup, uint16_t x, uint16_t y, uint16_t value,
+                                     JobPool & pool)
+    : xCode_(x), yCode_(y), valueCode_(value), histogram_(lookup)
+{
+    std::vector<PidLog> logs;
+    {
+        // Entries added while the log is copied wait for the lock and are
+        // skipped if the copy already has them
+        std::lock_guard lock(mutex_);
+        connection_ = log.onAdd([this](const PidLog & pidLog, const PidLogEntry & entry) { added(pidLog, entry); });
+
+        if (log.copyEntries({value, x, y}, logs))
+        {
+            const std::vector<PidLogEntry> & values = logs[0].entries;
+            xEntries_.assign(logs[1].entries.begin(), logs[1].entries.end());
+            yEntries_.assign(logs[2].entries.begin(), logs[2].entries.end());
+            if (!values.empty())
+            {
+                valueTime_ = values.back().time;
+                hasValues_ = true;
+            }
+
+            // alignSamples() bins the values up to the last time both
+            // operating point PIDs were logged. Later values wait for them.
+            auto first = values.begin();
+            if (!xEntries_.empty() && !yEntries_.empty())
+            {
+                std::size_t end = std::min(xEntries_.back().time, yEntries_.back().time);
+                first = std::upper_bound(values.begin(), values.end(), end,
+                                         [](std::size_t time, const PidLogEntry & entry) { return time < entry.time; });
+            }
+            pending_.assign(first, values.end());
+            binPending();
+        }
+    }
+
+    if (logs.empty())
+        return;
+
+    // Binning a long log takes a while, so new entries are binned meanwhile
+    AlignedSamples samples = alignSamples({&logs[0], &logs[1], &logs[2]});
+    CellHistogram copied(std::move(lookup));
+    copied.addParallel(samples.channels[1].data(), samples.channels[2].data(), samples.channels[0].data(),
+                       samples.size(), pool);
+    {
+        std::lock_guard lock(mutex_);
+        histogram_.merge(copied);
+    }
+    updateEvent_();
+}
+
+CellHistogram LiveCellHistogram::snapshot() const
+{
+    std::lock_guard lock(mutex_);
+    return histogram_;
+}
+
+void LiveCellHistogram::added(const PidLog & log, const PidLogEntry & entry)
+{
+    const uint16_t code = log.pid.code;
+    {
+        std::lock_guard lock(mutex_);
+        auto append = [&entry](std::deque<PidLogEntry> & entries) {
+            if (entries.empty() || entry.time > entries.back().time)
+                entries.push_back(entry);
+        };
+        if (code == xCode_)
+            append(xEntries_);
+        if (code == yCode_)
+            append(yEntries_);
+        if (code == valueCode_ && (!hasValues_ || entry.time > valueTime_))
+        {
+            pending_.push_back(entry);
+            valueTime_ = entry.time;
+            hasValues_ = true;
+        }
+        if (binPending() == 0)
+            return;
+    }
+    updateEvent_();
+}
+
+std::size_t LiveCellHistogram::binPending()
+{
+    std::size_t binned = 0;
+    while (!pending_.empty())
+    {
+        const PidLogEntry & entry = pending_.front();
+        double x, y;
+        if (!interpolate(xEntries_, entry.time, x) || !interpolate(yEntries_, entry.time, y))
+            break;
+        // Values before the first operating point are skipped
+        if (!std::isnan(x) && !std::isnan(y) && !std::isnan(entry.value))
+        {
+            histogram_.add(x, y, entry.value);
+            ++binned;
+        }
+        pending_.pop_front();
+    }
+
+    // Later values are not before the last one. Until the first value
+    // arrives, only the latest operating point is kept.
+    std::size_t oldest = !pending_.empty() ? pending_.front().time
+                         : hasValues_      ? valueTime_
+                                           : std::numeric_limits<std::size_t>::max();
+    dropBefore(xEntries_, oldest);
+    dropBefore(yEntries_, oldest);
+    return binned;
+}
+
+} // namespace lt
@@ -0,0 +1,153 @@
+#ifndef LT_CELLHISTOGRAM_H
+#define LT_CELLHISTOGRAM_H
+
+#include "lookup.h"
+
+#include "../datalog/datalog.h"
+#include "../support/event.h"
+#include "../support/job.h"
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace lt
+{
+
+// Statistics of the samples logged in one table cell
+struct CellStats
+{
+    // Samples closest to the cell
+    uint64_t count{0};
+    double mean{0.0};
+    // Sum of squared differences from the mean
+    double m2{0.0};
+    double min{std::numeric_limits<double>::infinity()};
+    double max{-std::numeric_limits<double>::infinity()};
+    // Bilinear weights and weighted values of the samples around the cell
+    double weight{0.0};
+    double weightedSum{0.0};
+
+    // Adds a sample closest to the cell
+    void add(double value) noexcept;
+    // Combines the statistics of two disjoint sets of samples
+    void merge(const CellStats & other) noexcept;
+
+    inline double variance() const noexcept { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+    inline double weightedMean() const noexcept { return weight > 0.0 ? weightedSum / weight : 0.0; }
+};
+
+/* Bins logged samples of a channel into the cells of a table, such as AFR
+ * error by RPM and load. Each sample updates the statistics of its
+ * nearest cell and spreads its bilinear weights over the four cells around
+ * it, which drive the correction suggestions. */
+class CellHistogram
+{
+public:
+    enum class Correction
+    {
+        // The channel is the fractional change each cell needs
+        Multiplicative,
+        // The channel is the amount each cell is off by
+        Additive,
+    };
+
+    explicit CellHistogram(TableLookup lookup);
+
+    /* Bins the entries of `value` at the operating points given by `x` and
+     * `y`, interpolated to the times of `value`. Splits the work across
+     * the threads of `pool`. Safe to call while entries are being added.
+     * Throws an exception if a PID is not in the log. */
+    static CellHistogram fromLog(const DataLog & log, TableLookup lookup, uint16_t x, uint16_t y, uint16_t value,
+                                 JobPool & pool = JobPool::global());
+
+    // Adds a sample at operating point (`x`, `y`). NaN values are ignored.
+    void add(double x, double y, double value) noexcept;
+
+    // Adds the samples (x[i], y[i], values[i]) for i in [0, count)
+    void add(const double * x, const double * y, const double * values, std::size_t count) noexcept;
+
+    // Same as add(), split across the threads of `pool`
+    void addParallel(const double * x, const double * y, const double * values, std::size_t count,
+                     JobPool & pool = JobPool::global());
+
+    // Adds the samples of a histogram with the same dimensions. Throws an
+    // exception if the dimensions differ.
+    void merge(const CellHistogram & other);
+
+    void clear() noexcept;
+
+    /* Returns corrected values for a table whose current values are
+     * `current`, in row-major order. Cells whose samples weigh less than
+     * `minWeight` are left unchanged. */
+    std::vector<double> suggest(const std::vector<double> & current, Correction mode, double minWeight = 1.0) const;
+
+    inline const CellStats & cell(int row, int column) const noexcept { return cells_[row * width() + column]; }
+    inline const std::vector<CellStats> & cells() const noexcept { return cells_; }
+
+    // Number of samples added
+    inline uint64_t samples() const noexcept { return samples_; }
+
+    inline int width() const noexcept { return lookup_.width(); }
+    inline int height() const noexcept { return lookup_.height(); }
+    inline const TableLookup & lookup() const noexcept { return lookup_; }
+
+private:
+    TableLookup lookup_;
+    std::vector<CellStats> cells_;
+    uint64_t samples_{0};
+};
+
+/* Keeps a CellHistogram up to date with a log that is being recorded.
+ * Entries already in the log are binned when it is created. New entries of
+ * the value PID wait until both operating point PIDs have an entry at or
+ * after them, and are then binned at the operating point interpolated in
+ * time, like fromLog() does. */
+class LiveCellHistogram
+{
+public:
+    LiveCellHistogram(DataLog & log, TableLookup lookup, uint16_t x, uint16_t y, uint16_t value,
+                      JobPool & pool = JobPool::global());
+
+    LiveCellHistogram(const LiveCellHistogram &) = delete;
+    LiveCellHistogram & operator=(const LiveCellHistogram &) = delete;
+
+    // Returns a copy of the current histogram
+    CellHistogram snapshot() const;
+
+    // Called from the logging thread after samples are added
+    template <typename Func> Event<>::ConnectionPtr onUpdate(Func && func) noexcept
+    {
+        return updateEvent_.connect(std::forward<Func>(func));
+    }
+
+private:
+    void added(const PidLog & log, const PidLogEntry & entry);
+    // Bins the pending values whose operating point is known and drops
+    // operating point entries no later value needs. Returns the number of
+    // samples added.
+    std::size_t binPending();
+
+    uint16_t xCode_, yCode_, valueCode_;
+
+    mutable std::mutex mutex_;
+    CellHistogram histogram_;
+    // Operating point entries from the last one at or before the oldest
+    // value that can still arrive or is pending
+    std::deque<PidLogEntry> xEntries_, yEntries_;
+    // Value entries logged after the last operating point entries
+    std::deque<PidLogEntry> pending_;
+    // Time of the last value entry. Entries that are not later were
+    // already seen, such as entries in the log when it was copied.
+    std::size_t valueTime_{0};
+    bool hasValues_{false};
+
+    Event<> updateEvent_;
+    DataLog::AddConnectionPtr connection_;
+};
+
+} // namespace lt
+
+#endif // LT_CELLHISTOGRAM_H
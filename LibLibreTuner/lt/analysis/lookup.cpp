@@ -0,0 +1,168 @@
+#include "lookup.h"
+
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace lt
+{
+
+Breakpoints::Breakpoints(const std::vector<double> & values) : count_(static_cast<int>(values.size()))
+{
+    if (values.empty())
+        throw std::runtime_error("breakpoints must not be empty");
+
+    descending_ = values.size() > 1 && values[1] < values[0];
+    std::size_t padded = 1;
+    while (padded < values.size())
+        padded *= 2;
+    values_.reserve(padded);
+    for (double value : values)
+    {
+        double stored = descending_ ? -value : value;
+        if (!values_.empty() && !(stored > values_.back()))
+            throw std::runtime_error("breakpoints must be strictly increasing or decreasing");
+        values_.push_back(stored);
+    }
+    values_.resize(padded, std::numeric_limits<double>::infinity());
+}
+
+Breakpoints Breakpoints::fromAxis(const Axis & axis, int count)
+{
+    if (count > axis.size())
+        throw std::runtime_error("axis '" + axis.name() + "' has fewer than " + std::to_string(count) + " entries");
+
+    std::vector<double> values(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i)
+        values[i] = axis.index(i);
+    return Breakpoints(values);
+}
+
+TableLookup::TableLookup(Breakpoints x, Breakpoints y) : x_(std::move(x)), y_(std::move(y))
+{
+    if (x_.size() == 0 || y_.size() == 0)
+        throw std::runtime_error("table lookup requires breakpoints for both axes");
+}
+
+namespace
+{
+Breakpoints indexBreakpoints(int count)
+{
+    std::vector<double> values(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i)
+        values[i] = i;
+    return Breakpoints(values);
+}
+} // namespace
+
+TableLookup TableLookup::fromTable(const Table & table)
+{
+    return TableLookup(table.xAxis() ? Breakpoints::fromAxis(*table.xAxis(), table.width())
+                                     : indexBreakpoints(table.width()),
+                       table.yAxis() ? Breakpoints::fromAxis(*table.yAxis(), table.height())
+                                     : indexBreakpoints(table.height()));
+}
+
+void TableLookup::locate(const double * x, const double * y, CellLookup * out, std::size_t count) const noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = locate(x[i], y[i]);
+}
+
+void TableLookup::locateParallel(const double * x, const double * y, CellLookup * out, std::size_t count,
+                                 JobPool & pool) const
+{
+    // Large enough to amortize scheduling, small enough to balance
+    constexpr std::size_t chunkSize = 16384;
+    std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t begin = chunk * chunkSize;
+        locate(x + begin, y + begin, out + begin, std::min(chunkSize, count - begin));
+    });
+}
+
+double TableLookup::interpolate(const CellLookup & cell, const double * values) const noexcept
+{
+    const int width = x_.size();
+    const int nextRow = std::min(cell.row + 1, y_.size() - 1);
+    const int nextColumn = std::min(cell.column + 1, width - 1);
+    const double wx = cell.columnWeight;
+    const double wy = cell.rowWeight;
+
+    double top = values[cell.row * width + cell.column] * (1.0 - wx) + values[cell.row * width + nextColumn] * wx;
+    double bottom = values[nextRow * width + cell.column] * (1.0 - wx) + values[nextRow * width + nextColumn] * wx;
+    return top * (1.0 - wy) + bottom * wy;
+}
+
+AlignedSamples alignSamples(const std::vector<const PidLog *> & logs, std::size_t first)
+{
+    AlignedSamples samples;
+    if (logs.empty())
+        return samples;
+    samples.channels.resize(logs.size());
+
+    const std::vector<PidLogEntry> & reference = logs.front()->entries;
+    if (first >= reference.size())
+        return samples;
+
+    // Only times covered by every PID can be interpolated
+    std::size_t begin = 0;
+    std::size_t end = std::numeric_limits<std::size_t>::max();
+    for (const PidLog * log : logs)
+    {
+        assert(log != nullptr);
+        if (log->entries.empty())
+            return samples;
+        begin = std::max(begin, log->entries.front().time);
+        end = std::min(end, log->entries.back().time);
+    }
+
+    auto byTime = [](const PidLogEntry & entry, std::size_t time) { return entry.time < time; };
+    auto it = std::lower_bound(reference.begin() + static_cast<std::ptrdiff_t>(first), reference.end(), begin, byTime);
+    std::size_t count = 0;
+    for (auto last = it; last != reference.end() && last->time <= end; ++last)
+        ++count;
+
+    samples.time.reserve(count);
+    for (auto & channel : samples.channels)
+        channel.reserve(count);
+
+    // Cursor into each log at the first entry not before the current time
+    std::vector<std::size_t> cursors(logs.size(), 0);
+    for (std::size_t i = 1; i < logs.size(); ++i)
+    {
+        const std::vector<PidLogEntry> & entries = logs[i]->entries;
+        cursors[i] = static_cast<std::size_t>(
+            std::lower_bound(entries.begin(), entries.end(), it == reference.end() ? end : it->time, byTime) -
+            entries.begin());
+    }
+
+    for (; count != 0; ++it, --count)
+    {
+        const std::size_t time = it->time;
+        samples.time.push_back(time);
+        samples.channels[0].push_back(it->value);
+
+        for (std::size_t i = 1; i < logs.size(); ++i)
+        {
+            const std::vector<PidLogEntry> & entries = logs[i]->entries;
+            std::size_t & cursor = cursors[i];
+            while (entries[cursor].time < time)
+                ++cursor;
+
+            const PidLogEntry & next = entries[cursor];
+            double value = next.value;
+            if (next.time != time)
+            {
+                // `time` is within the log, so there is an earlier entry
+                const PidLogEntry & previous = entries[cursor - 1];
+                double t = static_cast<double>(time - previous.time) / static_cast<double>(next.time - previous.time);
+                value = previous.value + (next.value - previous.value) * t;
+            }
+            samples.channels[i].push_back(value);
+        }
+    }
+    return samples;
+}
+
+} // namespace lt
@@ -0,0 +1,154 @@
+#ifndef LT_LOOKUP_H
+#define LT_LOOKUP_H
+
+#include "../datalog/datalog.h"
+#include "../rom/table.h"
+#include "../support/job.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace lt
+{
+
+// Breakpoints of a table axis, prepared for branchless search
+class Breakpoints
+{
+public:
+    struct Position
+    {
+        // Index of the breakpoint at or below the value
+        int index;
+        // Weight of the breakpoint at index + 1, in [0, 1]
+        double weight;
+    };
+
+    Breakpoints() = default;
+    // Throws an exception if `values` is empty or not strictly increasing
+    // or decreasing
+    explicit Breakpoints(const std::vector<double> & values);
+
+    // Uses the first `count` entries of `axis`
+    static Breakpoints fromAxis(const Axis & axis, int count);
+
+    /* Returns the interval containing `value`. Values beyond the first or
+     * last breakpoint are clamped to it, and NaN maps to the first
+     * breakpoint. The search takes log2(size) steps without branching on
+     * the data, so scattered samples do not cause mispredictions. */
+    inline Position locate(double value) const noexcept
+    {
+        if (count_ < 2)
+            return Position{0, 0.0};
+        if (descending_)
+            value = -value;
+
+        // The array is padded to a power of two with +inf, so every step
+        // halves the range
+        const double * base = values_.data();
+        std::size_t n = values_.size();
+        while (n > 1)
+        {
+            std::size_t half = n / 2;
+            base = base[half] <= value ? base + half : base;
+            n -= half;
+        }
+
+        int index = std::min(static_cast<int>(base - values_.data()), count_ - 2);
+        double low = values_[index];
+        double weight = (value - low) / (values_[index + 1] - low);
+        // Also maps NaN to 0
+        weight = std::max(0.0, std::min(weight, 1.0));
+        return Position{index, weight};
+    }
+
+    inline int size() const noexcept { return count_; }
+
+    // Returns the breakpoint at `index` in the original order
+    inline double operator[](int index) const noexcept
+    {
+        return descending_ ? -values_[index] : values_[index];
+    }
+
+private:
+    // Breakpoints followed by padding. Descending breakpoints are negated
+    // so the array ascends.
+    std::vector<double> values_;
+    int count_{0};
+    bool descending_{false};
+};
+
+// Position of an operating point in a table
+struct CellLookup
+{
+    // Cell at or below the point
+    int row, column;
+    // Weights of the next row and column. The cells around the point are
+    // weighted (1 - rowWeight) * (1 - columnWeight) for (row, column),
+    // (1 - rowWeight) * columnWeight for (row, column + 1) and so on.
+    float rowWeight, columnWeight;
+
+    // Cell closest to the point
+    inline int nearestRow() const noexcept { return row + (rowWeight > 0.5f ? 1 : 0); }
+    inline int nearestColumn() const noexcept { return column + (columnWeight > 0.5f ? 1 : 0); }
+};
+
+// Maps operating points to the cells of a table
+class TableLookup
+{
+public:
+    // `x` are the breakpoints of the columns and `y` of the rows
+    TableLookup(Breakpoints x, Breakpoints y);
+
+    // Uses the axes of `table`. A missing axis uses the cell indices as
+    // breakpoints.
+    static TableLookup fromTable(const Table & table);
+
+    inline CellLookup locate(double x, double y) const noexcept
+    {
+        Breakpoints::Position column = x_.locate(x);
+        Breakpoints::Position row = y_.locate(y);
+        return CellLookup{row.index, column.index, static_cast<float>(row.weight),
+                          static_cast<float>(column.weight)};
+    }
+
+    // Locates the points (x[i], y[i]) for i in [0, count)
+    void locate(const double * x, const double * y, CellLookup * out, std::size_t count) const noexcept;
+
+    // Same as locate(), split across the threads of `pool`
+    void locateParallel(const double * x, const double * y, CellLookup * out, std::size_t count,
+                        JobPool & pool = JobPool::global()) const;
+
+    // Bilinearly interpolates `values`, which hold an entry per cell in
+    // row-major order
+    double interpolate(const CellLookup & cell, const double * values) const noexcept;
+
+    inline int width() const noexcept { return x_.size(); }
+    inline int height() const noexcept { return y_.size(); }
+    inline const Breakpoints & x() const noexcept { return x_; }
+    inline const Breakpoints & y() const noexcept { return y_; }
+
+private:
+    Breakpoints x_, y_;
+};
+
+// Values of several PIDs at common times
+struct AlignedSamples
+{
+    // Milliseconds since log start
+    std::vector<std::size_t> time;
+    // channels[i][j] is the value of the i-th PID at time[j]
+    std::vector<std::vector<double>> channels;
+
+    inline std::size_t size() const noexcept { return time.size(); }
+};
+
+/* Resamples `logs` at the times of the entries of logs[0], starting with
+ * entry `first`. Other PIDs are interpolated linearly in time. Times
+ * outside the logged range of any PID are skipped. Entries must be in
+ * time order. */
+AlignedSamples alignSamples(const std::vector<const PidLog *> & logs, std::size_t first = 0);
+
+} // namespace lt
+
+#endif // LT_LOOKUP_H
@@ -30,38 +30,37 @@ UdsAuthenticator::UdsAuthenticator(network::Uds & uds, auth::Options options)
 {
 }
 
-void UdsAuthenticator::auth() { do_session(); }
+void UdsAuthenticator::auth() { syncWait(authAsync()); }
 
-void UdsAuthenticator::do_session()
+Task<void> UdsAuthenticator::authAsync()
 {
-    uds_.requestSession(options_.session);
-    do_request_seed();
-}
+    co_await uds_.requestSessionAsync(options_.session);
 
-void UdsAuthenticator::do_request_seed()
-{
-    std::vector<uint8_t> seed = uds_.requestSecuritySeed();
+    std::vector<uint8_t> seed = co_await uds_.requestSecuritySeedAsync();
 
     // Generate key from seed
-    uint32_t key = generateKey(0xC541A9, seed.data(), seed.size());
-    do_send_key(key);
-}
+    uint32_t key = generateKey(keyParameter, seed.data(), seed.size());
 
-void UdsAuthenticator::do_send_key(uint32_t key)
-{
     uint8_t kData[3];
     kData[0] = static_cast<uint8_t>( key & 0xFF );
     kData[1] = static_cast<uint8_t>( (key & 0xFF00) >> 8 );
     kData[2] = static_cast<uint8_t>( (key & 0xFF0000) >> 16 );
 
-    uds_.requestSecurityKey(kData, 3);
+    co_await uds_.requestSecurityKeyAsync(kData, 3);
 }
 
 uint32_t UdsAuthenticator::generateKey(uint32_t parameter, const uint8_t * seed,
                                        size_t size)
+{
+    return generateKey(options_.key, parameter, seed, size);
+}
+
+uint32_t UdsAuthenticator::generateKey(const std::string & key,
+                                       uint32_t parameter, const uint8_t * seed,
+                                       size_t size)
 {
     std::vector<uint8_t> nseed(seed, seed + size);
-    nseed.insert(nseed.end(), options_.key.begin(), options_.key.end());
+    nseed.insert(nseed.end(), key.begin(), key.end());
 
     // This is Mazda's key generation algorithm reverse engineered from a
     // Mazda 6 MPS ROM. Internally, the ECU uses a timer/counter for the seed
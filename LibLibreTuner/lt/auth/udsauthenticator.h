@@ -38,16 +38,21 @@ public:
     UdsAuthenticator(network::Uds & uds, Options options);
     /* Start authentication */
     void auth();
+    Task<void> authAsync();
 
     uint32_t generateKey(uint32_t parameter, const uint8_t * seed, size_t size);
 
+    /* Generates the key for `seed` with the algorithm used by Mazda ECUs.
+       Also used by the virtual ECU to check keys. */
+    static uint32_t generateKey(const std::string & key, uint32_t parameter,
+                                const uint8_t * seed, size_t size);
+
+    /* Parameter used by authAsync() */
+    static constexpr uint32_t keyParameter = 0xC541A9;
+
 private:
     network::Uds & uds_;
     Options options_;
-
-    void do_session();
-    void do_request_seed();
-    void do_send_key(uint32_t key);
 };
 } // namespace auth
 } // namespace lt
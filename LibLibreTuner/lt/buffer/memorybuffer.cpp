@@ -1,6 +1,9 @@
 #include "memorybuffer.h"
 #include "view.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace lt
 {
 View MemoryBuffer::view() { return View(*this, 0, size()); }
@@ -9,4 +12,50 @@ View MemoryBuffer::view(int offset, int size)
 {
     return View(*this, offset, size);
 }
-}
\ No newline at end of file
+
+void MemoryBuffer::write(int offset, const uint8_t * data, int size)
+{
+    if (offset < 0 || size < 0 || offset + size > this->size())
+        throw std::runtime_error("MemoryBuffer::write(): range out of bounds");
+    if (observer_)
+        notifyWrite(offset, data, size);
+    std::copy(data, data + size, data_.begin() + offset);
+    markDirty(offset, size);
+}
+
+void MemoryBuffer::markPages(int first, int last) noexcept
+{
+    for (int page = first; page <= last; ++page)
+        pages_[page / 64] |= uint64_t{1} << (page % 64);
+}
+
+bool MemoryBuffer::dirty() const noexcept
+{
+    return std::any_of(pages_.begin(), pages_.end(),
+                       [](uint64_t word) { return word != 0; });
+}
+
+bool MemoryBuffer::dirty(int offset, int size) const noexcept
+{
+    if (size <= 0)
+        return false;
+    int last = (offset + size - 1) / pageSize;
+    for (int page = offset / pageSize; page <= last; ++page)
+    {
+        if ((pages_[page / 64] >> (page % 64)) & 1)
+            return true;
+    }
+    return false;
+}
+
+void MemoryBuffer::clearDirty() noexcept
+{
+    std::fill(pages_.begin(), pages_.end(), 0);
+}
+
+void MemoryBuffer::resetPages()
+{
+    std::size_t pages = (data_.size() + pageSize - 1) / pageSize;
+    pages_.assign((pages + 63) / 64, 0);
+}
+} // namespace lt
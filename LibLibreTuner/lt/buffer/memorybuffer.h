@@ -3,18 +3,29 @@
 
 #include <vector>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <type_traits>
 
 namespace lt
 {
 class View;
 
+// Byte buffer that records which pages were modified. Writes through
+// View::set are recorded automatically; code writing through data(),
+// operator[] or iterators must call markDirty().
 class MemoryBuffer
 {
 public:
     using iterator = std::vector<uint8_t>::iterator;
     using const_iterator = std::vector<uint8_t>::const_iterator;
 
+    // Granularity of dirty tracking in bytes
+    static constexpr int pageSize = 256;
+
+    // Called before View::set or write() modify `size` bytes at `offset`
+    using WriteObserver = std::function<void(int offset, const uint8_t * before, const uint8_t * after, int size)>;
+
     MemoryBuffer(const MemoryBuffer&) = delete;
     MemoryBuffer(MemoryBuffer&&) = default;
     MemoryBuffer & operator=(const MemoryBuffer&) = delete;
@@ -23,6 +34,7 @@ public:
     MemoryBuffer() = default;
     explicit MemoryBuffer(std::vector<uint8_t> && data) : data_(std::move(data))
     {
+        resetPages();
     }
 
     template <typename It> MemoryBuffer(It begin, It end)
@@ -30,6 +42,7 @@ public:
         static_assert(sizeof(std::decay_t<decltype(*std::declval<It>())>) == 1,
                       "Iterator type must be byte");
         data_.assign(begin, end);
+        resetPages();
     }
 
     inline iterator begin() { return data_.begin(); }
@@ -48,14 +61,61 @@ public:
     View view();
     View view(int offset, int size);
 
+    // Copies `size` bytes to `offset`, notifying the observer and marking
+    // the range dirty. Throws an exception if the range is out of bounds.
+    void write(int offset, const uint8_t * data, int size);
+
+    inline void setWriteObserver(WriteObserver observer) { observer_ = std::move(observer); }
+    inline bool observed() const noexcept { return static_cast<bool>(observer_); }
+    inline void notifyWrite(int offset, const uint8_t * after, int size) const
+    {
+        observer_(offset, data_.data() + offset, after, size);
+    }
+
+    // Marks the pages overlapping the range as modified
+    inline void markDirty(int offset, int size) noexcept
+    {
+        if (size <= 0)
+            return;
+        int first = offset / pageSize;
+        int last = (offset + size - 1) / pageSize;
+        if (first == last)
+        {
+            pages_[first / 64] |= uint64_t{1} << (first % 64);
+            return;
+        }
+        markPages(first, last);
+    }
+
+    // Returns true if any page was modified since the last clearDirty()
+    bool dirty() const noexcept;
+    // Returns true if any page overlapping the range was modified
+    bool dirty(int offset, int size) const noexcept;
+
+    void clearDirty() noexcept;
+
+    template <class Archive>
+    void save(Archive & archive) const
+    {
+        archive(data_);
+    }
+
     template <class Archive>
-    void serialize(Archive & archive)
+    void load(Archive & archive)
     {
         archive(data_);
+        resetPages();
     }
 
 private:
+    void markPages(int first, int last) noexcept;
+    // Sizes the page bitmap to the data and clears it
+    void resetPages();
+
     std::vector<uint8_t> data_;
+    // One bit per page
+    std::vector<uint64_t> pages_;
+    WriteObserver observer_;
 };
 } // namespace lt
 
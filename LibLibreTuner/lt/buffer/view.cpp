@@ -12,7 +12,7 @@ View::View(MemoryBuffer & buffer, int offset, int size)
     assert(offset_ >= 0);
     assert(size_ >= 0);
 
-    if (offset_ + size_ >= buffer_.size())
+    if (offset_ + size_ > buffer_.size())
         throw std::runtime_error("view range exceeds buffer size");
 }
 
@@ -3,6 +3,7 @@
 
 #include "../support/endianness.h"
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <vector>
@@ -42,11 +43,43 @@ public:
 
         T val = endian::convert<T, endian::current, endianness>(t);
         uint8_t * repr = reinterpret_cast<uint8_t *>(&val);
+        if (buffer_.observed())
+            buffer_.notifyWrite(offset_ + offset, repr, static_cast<int>(sizeof(T)));
         for (std::size_t i = 0; i < sizeof(T); ++i)
         {
             *it = repr[i];
             std::advance(it, 1);
         }
+        buffer_.markDirty(offset_ + offset, static_cast<int>(sizeof(T)));
+    }
+
+    // Decodes `count` values starting at `offset` into `out`
+    template <typename T, Endianness endianness> void getRange(int offset, T * out, int count) const
+    {
+        if (offset < 0 || count < 0 || offset + count * static_cast<int>(sizeof(T)) > size())
+            throw std::runtime_error("View::getRange(): range out of bounds");
+        const uint8_t * src = buffer_.data() + offset_ + offset;
+        for (int i = 0; i < count; ++i)
+        {
+            T val;
+            std::memcpy(&val, src + i * sizeof(T), sizeof(T));
+            out[i] = endian::convert<T, endianness, endian::current>(val);
+        }
+    }
+
+    // Encodes `count` values and stores them at `offset` with a single
+    // MemoryBuffer::write
+    template <typename T, Endianness endianness> void setRange(int offset, const T * values, int count)
+    {
+        if (offset < 0 || count < 0 || offset + count * static_cast<int>(sizeof(T)) > size())
+            throw std::runtime_error("View::setRange(): range out of bounds");
+        std::vector<uint8_t> bytes(static_cast<std::size_t>(count) * sizeof(T));
+        for (int i = 0; i < count; ++i)
+        {
+            T val = endian::convert<T, endian::current, endianness>(values[i]);
+            std::memcpy(bytes.data() + i * sizeof(T), &val, sizeof(T));
+        }
+        buffer_.write(offset_ + offset, bytes.data(), static_cast<int>(bytes.size()));
     }
 
     inline int size() const { return size_; }
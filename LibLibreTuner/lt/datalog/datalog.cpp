@@ -18,35 +18,45 @@
 
 #include "datalog.h"
 
+#include <mutex>
+
 namespace lt
 {
 
 bool DataLog::add(const Pid & pid, PidLogEntry entry)
 {
-    PidLog * log = pidLog(pid);
-    if (log == nullptr)
+    PidLog * log;
     {
-        log = &addPid(pid);
-    }
+        std::unique_lock lock(mutex_);
+        // Look up and insert under one lock so two threads adding the first
+        // entry of a PID cannot replace each other's log
+        auto it = logs_.find(pid.code);
+        if (it == logs_.end())
+        {
+            it = logs_.emplace(pid.code, PidLog{pid, {}, {}}).first;
+        }
+        log = &it->second;
 
-    if (empty_)
-    {
-        empty_ = false;
-        beginTime_ = std::chrono::steady_clock::now();
-    }
+        if (empty_)
+        {
+            empty_ = false;
+            beginTime_ = std::chrono::steady_clock::now();
+        }
 
-    log->entries.emplace_back(entry);
-    if (entry.time > maxTime_)
-    {
-        maxTime_ = entry.time;
-    }
-    if (entry.value > maxValue_)
-    {
-        maxValue_ = entry.value;
-    }
-    else if (entry.value < minValue_)
-    {
-        minValue_ = entry.value;
+        log->entries.emplace_back(entry);
+        log->pyramid.add(entry);
+        if (entry.time > maxTime_)
+        {
+            maxTime_ = entry.time;
+        }
+        if (entry.value > maxValue_)
+        {
+            maxValue_ = entry.value;
+        }
+        else if (entry.value < minValue_)
+        {
+            minValue_ = entry.value;
+        }
     }
 
     addEvent_(*log, entry);
@@ -55,6 +65,7 @@ bool DataLog::add(const Pid & pid, PidLogEntry entry)
 
 PidLog * DataLog::pidLog(const Pid & pid) noexcept
 {
+    std::shared_lock lock(mutex_);
     auto it = logs_.find(pid.code);
     if (it == logs_.end())
     {
@@ -65,17 +76,64 @@ PidLog * DataLog::pidLog(const Pid & pid) noexcept
 
 PidLog & DataLog::addPid(const Pid & pid) noexcept
 {
-    PidLog log{pid, {}};
-    logs_.emplace(pid.code, std::move(log));
+    std::unique_lock lock(mutex_);
+    PidLog log{pid, {}, {}};
+    logs_.insert_or_assign(pid.code, std::move(log));
     return logs_.find(pid.code)->second;
 }
 
+std::vector<Pid> DataLog::pids() const
+{
+    std::shared_lock lock(mutex_);
+    std::vector<Pid> pids;
+    pids.reserve(logs_.size());
+    for (const auto & [code, log] : logs_)
+    {
+        pids.push_back(log.pid);
+    }
+    return pids;
+}
+
+bool DataLog::query(uint16_t code, std::size_t begin, std::size_t end, std::size_t maxBuckets,
+                    std::vector<PidLogEntry> & out) const
+{
+    std::shared_lock lock(mutex_);
+    auto it = logs_.find(code);
+    if (it == logs_.end())
+    {
+        return false;
+    }
+    it->second.pyramid.query(it->second.entries, begin, end, maxBuckets, out);
+    return true;
+}
+
+bool DataLog::copyEntries(const std::vector<uint16_t> & codes, std::vector<PidLog> & out) const
+{
+    std::shared_lock lock(mutex_);
+    out.clear();
+    out.reserve(codes.size());
+    for (uint16_t code : codes)
+    {
+        auto it = logs_.find(code);
+        if (it == logs_.end())
+        {
+            out.clear();
+            return false;
+        }
+        out.push_back(PidLog{it->second.pid, it->second.entries, {}});
+    }
+    return true;
+}
+
 bool DataLog::add(const Pid & pid, double value)
 {
-    if (empty_)
     {
-        empty_ = false;
-        beginTime_ = std::chrono::steady_clock::now();
+        std::unique_lock lock(mutex_);
+        if (empty_)
+        {
+            empty_ = false;
+            beginTime_ = std::chrono::steady_clock::now();
+        }
     }
 
     return add(
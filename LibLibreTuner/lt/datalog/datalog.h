@@ -22,10 +22,12 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
 #include "../support/event.h"
+#include "datalogpyramid.h"
 #include "pid.h"
 
 namespace lt
@@ -43,6 +45,8 @@ struct PidLog
 {
     Pid pid;
     std::vector<PidLogEntry> entries;
+    // Min/max summary of entries for drawing
+    DataLogPyramid pyramid;
 };
 
 class DataLog
@@ -69,6 +73,25 @@ public:
     // pid.
     PidLog & addPid(const Pid & pid) noexcept;
 
+    // Returns all PID logs keyed by PID code. Not safe to use while
+    // entries are being added from another thread.
+    inline const std::unordered_map<uint32_t, PidLog> & logs() const noexcept { return logs_; }
+
+    // Returns the PIDs in the log
+    std::vector<Pid> pids() const;
+
+    // Appends an approximation of the entries of a PID in the time window
+    // [begin, end] using at most `maxBuckets` summary buckets. Safe to call
+    // while entries are being added. Returns false if the PID is not in the
+    // log.
+    bool query(uint16_t code, std::size_t begin, std::size_t end, std::size_t maxBuckets,
+               std::vector<PidLogEntry> & out) const;
+
+    // Copies the entries of several PIDs at one point in time. Safe to call
+    // while entries are being added. Returns false if a PID is not in the
+    // log.
+    bool copyEntries(const std::vector<uint16_t> & codes, std::vector<PidLog> & out) const;
+
     inline std::string name() const noexcept { return name_; }
     inline void setName(const std::string & name) noexcept { name_ = name; }
 
@@ -98,6 +121,7 @@ private:
     AddEvent addEvent_;
 
     std::unordered_map<uint32_t, PidLog> logs_;
+    mutable std::shared_mutex mutex_;
 };
 using DataLogPtr = std::shared_ptr<DataLog>;
 
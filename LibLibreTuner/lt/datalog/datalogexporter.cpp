@@ -0,0 +1,339 @@
+#include "datalogexporter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include "../support/bytestream.h"
+#include "../support/crc32.h"
+#include "../support/job.h"
+
+namespace lt
+{
+
+namespace
+{
+std::ofstream openOutput(const std::filesystem::path & path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "' for writing");
+    return file;
+}
+
+// Closes and removes a partial output file
+bool abandon(std::ofstream & file, const std::filesystem::path & path)
+{
+    file.close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return false;
+}
+
+void writeCsvField(std::string & out, const std::string & field)
+{
+    if (field.find_first_of(",\"\n") == std::string::npos)
+    {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field)
+    {
+        if (c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+// Worst case length of a formatted number
+constexpr std::size_t MaxFieldSize = 32;
+// Target size of each block written to the file
+constexpr std::size_t BlockSize = 1 << 20;
+} // namespace
+
+DataLogExporter::DataLogExporter(const DataLog & log, ExportOptions options) : options_(std::move(options))
+{
+    options_.interval = std::max<std::size_t>(options_.interval, 1);
+
+    std::vector<const PidLog *> logs;
+    for (const auto & [code, pidLog] : log.logs())
+    {
+        if (!options_.pids.empty() &&
+            std::find(options_.pids.begin(), options_.pids.end(), pidLog.pid.code) == options_.pids.end())
+            continue;
+        logs.push_back(&pidLog);
+    }
+    std::sort(logs.begin(), logs.end(), [](const PidLog * a, const PidLog * b) { return a->pid.code < b->pid.code; });
+
+    std::size_t first = std::numeric_limits<std::size_t>::max();
+    std::size_t last = 0;
+    for (const PidLog * pidLog : logs)
+    {
+        columns_.push_back(Column{pidLog->pid, {}});
+        if (pidLog->entries.empty())
+            continue;
+        first = std::min(first, pidLog->entries.front().time);
+        last = std::max(last, pidLog->entries.back().time);
+    }
+
+    first = std::max(first, options_.begin);
+    last = std::min(last, options_.end);
+    if (first <= last)
+    {
+        times_.reserve((last - first) / options_.interval + 1);
+        for (std::size_t time = first; time <= last; time += options_.interval)
+            times_.push_back(time);
+    }
+
+    // Channels are independent, so resample them in parallel
+    JobPool::global().parallelFor(columns_.size(), [&](std::size_t index) {
+        const std::vector<PidLogEntry> & entries = logs[index]->entries;
+        std::vector<double> & values = columns_[index].values;
+        values.resize(times_.size());
+
+        // Index of the first entry after the current row
+        std::size_t next = 0;
+        for (std::size_t row = 0; row < times_.size(); ++row)
+        {
+            std::size_t time = times_[row];
+            while (next < entries.size() && entries[next].time <= time)
+                ++next;
+
+            if (next == 0)
+            {
+                values[row] = std::numeric_limits<double>::quiet_NaN();
+            }
+            else if (options_.resampling == Resampling::Linear && next < entries.size())
+            {
+                const PidLogEntry & a = entries[next - 1];
+                const PidLogEntry & b = entries[next];
+                double t = static_cast<double>(time - a.time) / static_cast<double>(b.time - a.time);
+                values[row] = a.value + (b.value - a.value) * t;
+            }
+            else
+            {
+                values[row] = entries[next - 1].value;
+            }
+        }
+    }, options_.threads);
+}
+
+unsigned DataLogExporter::threads() const noexcept
+{
+    unsigned threads = JobPool::global().threads() + 1;
+    if (options_.threads != 0)
+        return std::min(options_.threads, threads);
+    return threads;
+}
+
+bool DataLogExporter::writeCsv(const std::filesystem::path & path, JobControl * control) const
+{
+    std::ofstream file = openOutput(path);
+
+    std::string header = "time";
+    for (const Column & column : columns_)
+    {
+        header += ',';
+        writeCsvField(header, column.pid.unit.empty() ? column.pid.name
+                                                      : column.pid.name + " (" + column.pid.unit + ")");
+    }
+    header += '\n';
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    const std::size_t rowSize = MaxFieldSize * (columns_.size() + 1);
+    const std::size_t blockRows = std::max<std::size_t>(BlockSize / rowSize, 64);
+    const std::size_t blockCount = (times_.size() + blockRows - 1) / blockRows;
+
+    // Format a batch of blocks in parallel, then write them in order
+    const unsigned workers = threads();
+    std::vector<std::string> blocks(workers * 2);
+    for (std::size_t batch = 0; batch < blockCount; batch += blocks.size())
+    {
+        if (control != nullptr && control->canceled())
+            return abandon(file, path);
+        std::size_t count = std::min(blocks.size(), blockCount - batch);
+        JobPool::global().parallelFor(count, [&](std::size_t index) {
+            std::size_t rowBegin = (batch + index) * blockRows;
+            std::size_t rowEnd = std::min(rowBegin + blockRows, times_.size());
+
+            std::string & block = blocks[index];
+            block.resize((rowEnd - rowBegin) * rowSize);
+            char * out = block.data();
+            char * end = block.data() + block.size();
+            for (std::size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                out = std::to_chars(out, end, static_cast<double>(times_[row]) / 1000.0, std::chars_format::fixed, 3)
+                          .ptr;
+                for (const Column & column : columns_)
+                {
+                    *out++ = ',';
+                    double value = column.values[row];
+                    if (!std::isnan(value))
+                        out = std::to_chars(out, end, value).ptr;
+                }
+                *out++ = '\n';
+            }
+            block.resize(static_cast<std::size_t>(out - block.data()));
+        }, options_.threads);
+
+        for (std::size_t i = 0; i < count; ++i)
+            file.write(blocks[i].data(), static_cast<std::streamsize>(blocks[i].size()));
+        if (control != nullptr)
+            control->setProgress(static_cast<double>(batch + count) / static_cast<double>(blockCount));
+    }
+
+    file.close();
+    if (!file)
+        throw std::runtime_error("failed to write '" + path.string() + "'");
+    return true;
+}
+
+bool DataLogExporter::writeNpz(const std::filesystem::path & path, JobControl * control) const
+{
+    struct Member
+    {
+        std::string name;
+        // .npy header
+        std::string header;
+        const double * data;
+        uint32_t crc;
+        uint32_t offset;
+    };
+
+    // Every column is stored as a float64 .npy array
+    std::vector<double> seconds(times_.size());
+    std::transform(times_.begin(), times_.end(), seconds.begin(),
+                   [](std::size_t time) { return static_cast<double>(time) / 1000.0; });
+
+    std::vector<Member> members;
+    members.push_back(Member{"time", {}, seconds.data(), 0, 0});
+    for (const Column & column : columns_)
+    {
+        std::string name = column.pid.name.empty() ? "pid_" + std::to_string(column.pid.code) : column.pid.name;
+        std::replace_if(
+            name.begin(), name.end(), [](char c) { return c == '/' || c == '\\' || c < 0x20; }, '_');
+        if (std::any_of(members.begin(), members.end(), [&](const Member & m) { return m.name == name; }))
+            name += "_" + std::to_string(column.pid.code);
+        members.push_back(Member{std::move(name), {}, column.values.data(), 0, 0});
+    }
+
+    const std::size_t dataSize = times_.size() * sizeof(double);
+    for (Member & member : members)
+    {
+        std::string dict =
+            "{'descr': '<f8', 'fortran_order': False, 'shape': (" + std::to_string(times_.size()) + ",), }";
+        // Magic, version and length take 10 bytes. Pad to a multiple of 64.
+        std::size_t total = (10 + dict.size() + 1 + 63) / 64 * 64;
+        dict.append(total - 10 - dict.size() - 1, ' ');
+        dict += '\n';
+
+        member.header = std::string("\x93NUMPY\x01\x00", 8);
+        member.header += static_cast<char>(dict.size() & 0xFF);
+        member.header += static_cast<char>(dict.size() >> 8);
+        member.header += dict;
+        member.name += ".npy";
+
+        if (member.header.size() + dataSize > std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("log is too large to export as npz");
+    }
+
+    static_assert(endian::isLittle, "npz export assumes a little endian host");
+
+    JobPool::global().parallelFor(members.size(), [&](std::size_t index) {
+        Member & member = members[index];
+        uint32_t crc = crc32(reinterpret_cast<const uint8_t *>(member.header.data()), member.header.size());
+        member.crc = crc32(reinterpret_cast<const uint8_t *>(member.data), dataSize, crc);
+    }, options_.threads);
+
+    std::ofstream file = openOutput(path);
+
+    // Zip archive with stored (uncompressed) members
+    std::vector<uint8_t> buffer;
+    ByteWriter writer(buffer);
+    uint64_t offset = 0;
+    auto writeBuffer = [&]() {
+        file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        offset += buffer.size();
+        buffer.clear();
+    };
+
+    for (std::size_t index = 0; index < members.size(); ++index)
+    {
+        if (control != nullptr && control->canceled())
+            return abandon(file, path);
+        Member & member = members[index];
+        if (offset > std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("log is too large to export as npz");
+        member.offset = static_cast<uint32_t>(offset);
+        auto size = static_cast<uint32_t>(member.header.size() + dataSize);
+
+        writer.write<uint32_t>(0x04034B50);
+        writer.write<uint16_t>(20);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0x21);
+        writer.write(member.crc);
+        writer.write(size);
+        writer.write(size);
+        writer.write(static_cast<uint16_t>(member.name.size()));
+        writer.write<uint16_t>(0);
+        writer.write(reinterpret_cast<const uint8_t *>(member.name.data()), member.name.size());
+        writer.write(reinterpret_cast<const uint8_t *>(member.header.data()), member.header.size());
+        writeBuffer();
+
+        file.write(reinterpret_cast<const char *>(member.data), static_cast<std::streamsize>(dataSize));
+        offset += dataSize;
+        if (control != nullptr)
+            control->setProgress(static_cast<double>(index + 1) / static_cast<double>(members.size()));
+    }
+
+    uint64_t directoryOffset = offset;
+    for (const Member & member : members)
+    {
+        auto size = static_cast<uint32_t>(member.header.size() + dataSize);
+        writer.write<uint32_t>(0x02014B50);
+        writer.write<uint16_t>(20);
+        writer.write<uint16_t>(20);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0x21);
+        writer.write(member.crc);
+        writer.write(size);
+        writer.write(size);
+        writer.write(static_cast<uint16_t>(member.name.size()));
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint16_t>(0);
+        writer.write<uint32_t>(0);
+        writer.write(member.offset);
+        writer.write(reinterpret_cast<const uint8_t *>(member.name.data()), member.name.size());
+    }
+    auto directorySize = static_cast<uint32_t>(buffer.size());
+
+    if (directoryOffset > std::numeric_limits<uint32_t>::max() || members.size() > 0xFFFF)
+        throw std::runtime_error("log is too large to export as npz");
+
+    writer.write<uint32_t>(0x06054B50);
+    writer.write<uint16_t>(0);
+    writer.write<uint16_t>(0);
+    writer.write(static_cast<uint16_t>(members.size()));
+    writer.write(static_cast<uint16_t>(members.size()));
+    writer.write(directorySize);
+    writer.write(static_cast<uint32_t>(directoryOffset));
+    writer.write<uint16_t>(0);
+    writeBuffer();
+
+    file.close();
+    if (!file)
+        throw std::runtime_error("failed to write '" + path.string() + "'");
+    return true;
+}
+
+} // namespace lt
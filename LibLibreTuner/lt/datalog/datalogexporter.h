@@ -0,0 +1,82 @@
+#ifndef LT_DATALOGEXPORTER_H
+#define LT_DATALOGEXPORTER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "datalog.h"
+
+namespace lt
+{
+
+class JobControl;
+
+enum class Resampling
+{
+    // Use the most recent sample at or before each row
+    HoldLast,
+    // Interpolate between the samples around each row
+    Linear,
+};
+
+struct ExportOptions
+{
+    // Milliseconds between rows
+    std::size_t interval{100};
+    Resampling resampling{Resampling::HoldLast};
+    // Time window to export in milliseconds
+    std::size_t begin{0};
+    std::size_t end{std::numeric_limits<std::size_t>::max()};
+    // PIDs to export. Exports all PIDs if empty.
+    std::vector<uint16_t> pids;
+    // Maximum threads to use from the job pool. Uses the whole pool if 0.
+    unsigned threads{0};
+};
+
+// Exports a datalog as a table of time-aligned channels. Each channel is
+// resampled onto a common time grid. Rows before a channel's first sample
+// are empty (NaN).
+class DataLogExporter
+{
+public:
+    // Resamples the log. The log must not be modified while exporting.
+    explicit DataLogExporter(const DataLog & log, ExportOptions options = {});
+
+    // Writes comma-separated values with a header row. Time is in
+    // seconds. If `control` is set, progress is reported to it and the
+    // export stops when it is canceled. Returns false if canceled; the
+    // partial file is removed.
+    bool writeCsv(const std::filesystem::path & path, JobControl * control = nullptr) const;
+
+    // Writes an uncompressed NumPy archive with one float64 array per
+    // column, which pandas loads with pd.DataFrame(dict(np.load(path))).
+    // Progress and cancellation work as in writeCsv().
+    bool writeNpz(const std::filesystem::path & path, JobControl * control = nullptr) const;
+
+    inline std::size_t rows() const noexcept { return times_.size(); }
+    inline std::size_t columns() const noexcept { return columns_.size(); }
+
+    // Resampled values of a column
+    inline const std::vector<double> & column(std::size_t index) const { return columns_[index].values; }
+    inline const std::vector<std::size_t> & times() const noexcept { return times_; }
+
+private:
+    struct Column
+    {
+        Pid pid;
+        std::vector<double> values;
+    };
+
+    ExportOptions options_;
+    std::vector<std::size_t> times_;
+    std::vector<Column> columns_;
+
+    unsigned threads() const noexcept;
+};
+
+} // namespace lt
+
+#endif // LT_DATALOGEXPORTER_H
@@ -0,0 +1,478 @@
+#include "datalogfile.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "../support/crc32.h"
+
+namespace lt
+{
+
+using namespace datalogfile;
+
+namespace
+{
+void writePid(ByteWriter & writer, const Pid & pid)
+{
+    writer.write(pid.code);
+    writer.writeString(pid.name);
+    writer.writeString(pid.description);
+    writer.writeString(pid.formula);
+    writer.writeString(pid.unit);
+}
+
+// Appends the index and trailer
+void writeIndex(std::vector<uint8_t> & out, const std::vector<IndexEntry> & entries, uint64_t indexOffset)
+{
+    ByteWriter writer(out);
+    std::size_t begin = out.size();
+    for (const IndexEntry & entry : entries)
+    {
+        writer.write(entry.offset);
+        writer.write(entry.timeBegin);
+        writer.write(entry.timeEnd);
+        writer.write(static_cast<uint32_t>(entry.kind));
+        writer.write(static_cast<uint32_t>(0));
+    }
+    uint32_t crc = crc32(out.data() + begin, out.size() - begin);
+
+    writer.write(TrailerMagic);
+    writer.write(static_cast<uint32_t>(entries.size()));
+    writer.write(indexOffset);
+    writer.write(crc);
+    writer.write(static_cast<uint32_t>(0));
+}
+} // namespace
+
+DataLogWriter::DataLogWriter(const std::filesystem::path & path, const std::string & name,
+                             const std::vector<Pid> & pids, std::size_t chunkSize)
+    : file_(path, std::ios::binary | std::ios::out | std::ios::trunc), chunkSize_(std::max<std::size_t>(chunkSize, 1))
+{
+    if (!file_.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "' for writing");
+
+    ByteWriter writer(scratch_);
+    writer.write(HeaderMagic);
+    writer.write(Version);
+    writer.write(static_cast<uint16_t>(0));
+    writer.writeString(name);
+    writer.write(static_cast<uint32_t>(pids.size()));
+    for (const Pid & pid : pids)
+    {
+        writePid(writer, pid);
+        channelIndex_.emplace(pid.code, channels_.size());
+        channels_.push_back(Channel{pid.code, {}, {}});
+    }
+
+    file_.write(reinterpret_cast<const char *>(scratch_.data()), scratch_.size());
+    offset_ = scratch_.size();
+    scratch_.clear();
+}
+
+DataLogWriter::~DataLogWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+        // The chunks already written can still be recovered
+    }
+}
+
+void DataLogWriter::add(const Pid & pid, const PidLogEntry & entry)
+{
+    std::lock_guard lock(mutex_);
+    if (closed_)
+        throw std::runtime_error("datalog writer is closed");
+
+    auto it = channelIndex_.find(pid.code);
+    if (it == channelIndex_.end())
+    {
+        it = channelIndex_.emplace(pid.code, channels_.size()).first;
+        channels_.push_back(Channel{pid.code, {}, {}});
+        newPids_.push_back(pid);
+    }
+
+    if (buffered_ != 0)
+    {
+        // Times are stored as 32-bit offsets from the start of the chunk
+        std::size_t begin = std::min(chunkBegin_, entry.time);
+        std::size_t end = std::max(chunkEnd_, entry.time);
+        if (end - begin > std::numeric_limits<uint32_t>::max())
+            flushLocked();
+    }
+
+    if (buffered_ == 0)
+    {
+        chunkBegin_ = entry.time;
+        chunkEnd_ = entry.time;
+    }
+    else
+    {
+        chunkBegin_ = std::min(chunkBegin_, entry.time);
+        chunkEnd_ = std::max(chunkEnd_, entry.time);
+    }
+
+    Channel & channel = channels_[it->second];
+    channel.times.push_back(entry.time);
+    channel.values.push_back(entry.value);
+
+    if (++buffered_ >= chunkSize_)
+        flushLocked();
+}
+
+void DataLogWriter::attach(DataLog & log)
+{
+    connection_ = log.onAdd([this](const PidLog & pidLog, const PidLogEntry & entry) {
+        {
+            std::lock_guard lock(mutex_);
+            if (!error_.empty())
+                return;
+        }
+        try
+        {
+            add(pidLog.pid, entry);
+        }
+        catch (const std::exception & e)
+        {
+            std::lock_guard lock(mutex_);
+            if (error_.empty())
+                error_ = e.what();
+        }
+    });
+}
+
+std::string DataLogWriter::error() const
+{
+    std::lock_guard lock(mutex_);
+    return error_;
+}
+
+void DataLogWriter::flush()
+{
+    std::lock_guard lock(mutex_);
+    if (!closed_)
+        flushLocked();
+}
+
+void DataLogWriter::flushLocked()
+{
+    if (!newPids_.empty())
+    {
+        scratch_.assign(ChunkHeaderSize, 0);
+        ByteWriter writer(scratch_);
+        writer.write(static_cast<uint32_t>(newPids_.size()));
+        for (const Pid & pid : newPids_)
+            writePid(writer, pid);
+        writeChunk(ChunkKind::Pids, 0, 0);
+        newPids_.clear();
+    }
+
+    if (buffered_ == 0)
+        return;
+
+    scratch_.assign(ChunkHeaderSize, 0);
+    ByteWriter writer(scratch_);
+
+    uint16_t count = static_cast<uint16_t>(
+        std::count_if(channels_.begin(), channels_.end(), [](const Channel & c) { return !c.times.empty(); }));
+    writer.write(count);
+    writer.write(static_cast<uint16_t>(0));
+
+    for (const Channel & channel : channels_)
+    {
+        if (channel.times.empty())
+            continue;
+        auto [minIt, maxIt] = std::minmax_element(channel.values.begin(), channel.values.end());
+        auto [firstIt, lastIt] = std::minmax_element(channel.times.begin(), channel.times.end());
+        writer.write(channel.code);
+        writer.write(static_cast<uint16_t>(0));
+        writer.write(static_cast<uint32_t>(channel.times.size()));
+        writer.write(static_cast<uint64_t>(*firstIt));
+        writer.write(static_cast<uint64_t>(*lastIt));
+        writer.write(*minIt);
+        writer.write(*maxIt);
+    }
+
+    for (Channel & channel : channels_)
+    {
+        if (channel.times.empty())
+            continue;
+        for (std::size_t time : channel.times)
+            writer.write(static_cast<uint32_t>(time - chunkBegin_));
+        for (double value : channel.values)
+            writer.write(value);
+        // Keep the capacity for the next chunk
+        channel.times.clear();
+        channel.values.clear();
+    }
+
+    writeChunk(ChunkKind::Samples, chunkBegin_, chunkEnd_);
+    buffered_ = 0;
+}
+
+void DataLogWriter::writeChunk(ChunkKind kind, uint64_t timeBegin, uint64_t timeEnd)
+{
+    std::size_t payloadSize = scratch_.size() - ChunkHeaderSize;
+    uint32_t crc = crc32(scratch_.data() + ChunkHeaderSize, payloadSize);
+
+    ByteWriter writer(scratch_);
+    writer.patch<uint32_t>(0, ChunkMagic);
+    writer.patch<uint8_t>(4, static_cast<uint8_t>(kind));
+    writer.patch<uint32_t>(8, static_cast<uint32_t>(payloadSize));
+    writer.patch<uint32_t>(12, crc);
+    writer.patch<uint64_t>(16, timeBegin);
+    writer.patch<uint64_t>(24, timeEnd);
+
+    file_.write(reinterpret_cast<const char *>(scratch_.data()), scratch_.size());
+    // Hand the chunk to the OS so it survives a crash of the application
+    file_.flush();
+    if (!file_)
+        throw std::runtime_error("failed to write datalog chunk");
+
+    index_.push_back(IndexEntry{offset_, timeBegin, timeEnd, kind});
+    offset_ += scratch_.size();
+}
+
+void DataLogWriter::close()
+{
+    std::lock_guard lock(mutex_);
+    if (closed_)
+        return;
+    closed_ = true;
+    connection_.reset();
+
+    flushLocked();
+
+    scratch_.clear();
+    writeIndex(scratch_, index_, offset_);
+    file_.write(reinterpret_cast<const char *>(scratch_.data()), scratch_.size());
+    file_.close();
+    if (!file_)
+        throw std::runtime_error("failed to write datalog index");
+}
+
+void DataLogWriter::save(const DataLog & log, const std::filesystem::path & path, std::size_t chunkSize)
+{
+    std::vector<const PidLog *> logs;
+    std::vector<Pid> pids;
+    for (const auto & [code, pidLog] : log.logs())
+    {
+        logs.push_back(&pidLog);
+        pids.push_back(pidLog.pid);
+    }
+
+    DataLogWriter writer(path, log.name(), pids, chunkSize);
+
+    // Merge by time so each chunk covers a narrow time window
+    std::vector<std::size_t> positions(logs.size(), 0);
+    while (true)
+    {
+        std::size_t next = logs.size();
+        for (std::size_t i = 0; i < logs.size(); ++i)
+        {
+            if (positions[i] == logs[i]->entries.size())
+                continue;
+            if (next == logs.size() ||
+                logs[i]->entries[positions[i]].time < logs[next]->entries[positions[next]].time)
+                next = i;
+        }
+        if (next == logs.size())
+            break;
+
+        writer.add(logs[next]->pid, logs[next]->entries[positions[next]++]);
+    }
+
+    writer.close();
+}
+
+DataLogReader::DataLogReader(const std::filesystem::path & path) : file_(path)
+{
+    std::size_t headerEnd = readHeader();
+    if (!readIndex(headerEnd))
+    {
+        recovered_ = true;
+        scanChunks(headerEnd);
+    }
+
+    for (const IndexEntry & entry : index_)
+    {
+        if (entry.kind == ChunkKind::Pids)
+        {
+            ByteReader reader(file_.data() + entry.offset + ChunkHeaderSize, file_.end());
+            readPids(reader);
+        }
+        else if (entry.kind == ChunkKind::Samples)
+        {
+            chunks_.push_back(entry);
+        }
+    }
+
+    maxEnd_.resize(chunks_.size());
+    minBegin_.resize(chunks_.size());
+    for (std::size_t i = 0; i < chunks_.size(); ++i)
+        maxEnd_[i] = i == 0 ? chunks_[i].timeEnd : std::max(maxEnd_[i - 1], chunks_[i].timeEnd);
+    for (std::size_t i = chunks_.size(); i-- > 0;)
+        minBegin_[i] =
+            i + 1 == chunks_.size() ? chunks_[i].timeBegin : std::min(minBegin_[i + 1], chunks_[i].timeBegin);
+}
+
+std::size_t DataLogReader::readHeader()
+{
+    ByteReader reader(file_.begin(), file_.end());
+    if (file_.size() < 8 || reader.read<uint32_t>() != HeaderMagic)
+        throw std::runtime_error("file is not a LibreTuner datalog");
+    if (reader.read<uint16_t>() > Version)
+        throw std::runtime_error("unsupported datalog version");
+    reader.read<uint16_t>();
+    name_ = reader.readString();
+    readPids(reader);
+    return static_cast<std::size_t>(reader.pos() - file_.data());
+}
+
+void DataLogReader::readPids(ByteReader & reader)
+{
+    auto count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Pid pid;
+        pid.code = reader.read<uint16_t>();
+        pid.name = reader.readString();
+        pid.description = reader.readString();
+        pid.formula = reader.readString();
+        pid.unit = reader.readString();
+
+        if (pidIndex_.find(pid.code) == pidIndex_.end())
+        {
+            pidIndex_.emplace(pid.code, pids_.size());
+            pids_.emplace_back(std::move(pid));
+        }
+    }
+}
+
+bool DataLogReader::readIndex(std::size_t headerEnd)
+{
+    if (file_.size() < headerEnd + TrailerSize)
+        return false;
+
+    ByteReader trailer(file_.end() - TrailerSize, file_.end());
+    if (trailer.read<uint32_t>() != TrailerMagic)
+        return false;
+    auto count = trailer.read<uint32_t>();
+    auto indexOffset = trailer.read<uint64_t>();
+    auto crc = trailer.read<uint32_t>();
+
+    // Values come from the file, so compare without overflowing
+    if (indexOffset < headerEnd || indexOffset > file_.size() - TrailerSize ||
+        count != (file_.size() - TrailerSize - indexOffset) / IndexEntrySize ||
+        (file_.size() - TrailerSize - indexOffset) % IndexEntrySize != 0)
+        return false;
+    if (crc32(file_.data() + indexOffset, count * IndexEntrySize) != crc)
+        return false;
+
+    ByteReader reader(file_.data() + indexOffset, file_.end() - TrailerSize);
+    std::vector<IndexEntry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        IndexEntry entry;
+        entry.offset = reader.read<uint64_t>();
+        entry.timeBegin = reader.read<uint64_t>();
+        entry.timeEnd = reader.read<uint64_t>();
+        entry.kind = static_cast<ChunkKind>(reader.read<uint32_t>());
+        reader.read<uint32_t>();
+
+        // The chunk must lie entirely before the index
+        if (entry.offset < headerEnd || entry.offset > indexOffset || indexOffset - entry.offset < ChunkHeaderSize ||
+            loadLittle<uint32_t>(file_.data() + entry.offset) != ChunkMagic ||
+            loadLittle<uint32_t>(file_.data() + entry.offset + 8) > indexOffset - entry.offset - ChunkHeaderSize)
+            return false;
+        entries.push_back(entry);
+    }
+
+    index_ = std::move(entries);
+    validSize_ = indexOffset;
+    return true;
+}
+
+void DataLogReader::scanChunks(std::size_t offset)
+{
+    index_.clear();
+    while (file_.size() - offset >= ChunkHeaderSize)
+    {
+        ByteReader reader(file_.data() + offset, file_.end());
+        if (reader.read<uint32_t>() != ChunkMagic)
+            break;
+        auto kind = static_cast<ChunkKind>(reader.read<uint8_t>());
+        reader.take(3);
+        auto size = reader.read<uint32_t>();
+        auto crc = reader.read<uint32_t>();
+        auto timeBegin = reader.read<uint64_t>();
+        auto timeEnd = reader.read<uint64_t>();
+
+        if (reader.remaining() < size || crc32(reader.pos(), size) != crc)
+            break;
+
+        index_.push_back(IndexEntry{offset, timeBegin, timeEnd, kind});
+        offset += ChunkHeaderSize + size;
+    }
+    validSize_ = offset;
+}
+
+uint64_t DataLogReader::beginTime() const noexcept { return minBegin_.empty() ? 0 : minBegin_.front(); }
+
+uint64_t DataLogReader::endTime() const noexcept { return maxEnd_.empty() ? 0 : maxEnd_.back(); }
+
+std::pair<std::size_t, std::size_t> DataLogReader::chunksInRange(uint64_t begin, uint64_t end) const noexcept
+{
+    auto first = static_cast<std::size_t>(std::lower_bound(maxEnd_.begin(), maxEnd_.end(), begin) - maxEnd_.begin());
+    auto last = static_cast<std::size_t>(std::upper_bound(minBegin_.begin(), minBegin_.end(), end) - minBegin_.begin());
+    return {first, std::max(first, last)};
+}
+
+const Pid * DataLogReader::pid(uint16_t code) const noexcept
+{
+    auto it = pidIndex_.find(code);
+    if (it == pidIndex_.end())
+        return nullptr;
+    return &pids_[it->second];
+}
+
+void DataLogReader::readInto(DataLog & log, uint64_t begin, uint64_t end) const
+{
+    for (const Pid & pid : pids_)
+    {
+        if (log.pidLog(pid) == nullptr)
+            log.addPid(pid);
+    }
+    forEach(begin, end, [&log](const Pid & pid, const PidLogEntry & entry) { log.add(pid, entry); });
+}
+
+bool DataLogReader::recover(const std::filesystem::path & path)
+{
+    std::vector<IndexEntry> index;
+    std::size_t validSize;
+    {
+        DataLogReader reader(path);
+        if (!reader.recovered())
+            return false;
+        index = std::move(reader.index_);
+        validSize = reader.validSize_;
+    }
+
+    std::filesystem::resize_file(path, validSize);
+
+    std::vector<uint8_t> data;
+    writeIndex(data, index, validSize);
+    std::ofstream file(path, std::ios::binary | std::ios::out | std::ios::app);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "' for writing");
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    if (!file)
+        throw std::runtime_error("failed to write datalog index");
+    return true;
+}
+
+} // namespace lt
@@ -0,0 +1,267 @@
+#ifndef LT_DATALOGFILE_H
+#define LT_DATALOGFILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../os/mappedfile.h"
+#include "../support/bytestream.h"
+#include "datalog.h"
+
+namespace lt
+{
+
+/* Binary datalog file. All values are little endian.
+ *
+ *   Header   "LTDL" u16 version, u16 reserved, str name, u32 pid count, pids
+ *   Chunk    "LTCK" u8 kind, u8[3] reserved, u32 payload size, u32 payload crc32,
+ *            u64 first time, u64 last time, payload
+ *   Index    entries of u64 offset, u64 first time, u64 last time, u32 kind, u32 reserved
+ *   Trailer  "LTIX" u32 entry count, u64 index offset, u32 index crc32, u32 reserved
+ *
+ * Chunks are written as they fill, so a file whose writer died before
+ * writing the index is still readable up to the last intact chunk. */
+namespace datalogfile
+{
+constexpr uint32_t HeaderMagic = 0x4C44544C;  // "LTDL"
+constexpr uint32_t ChunkMagic = 0x4B43544C;   // "LTCK"
+constexpr uint32_t TrailerMagic = 0x5849544C; // "LTIX"
+constexpr uint16_t Version = 1;
+
+constexpr std::size_t ChunkHeaderSize = 32;
+constexpr std::size_t IndexEntrySize = 32;
+constexpr std::size_t TrailerSize = 24;
+// Size of a channel summary in a sample chunk
+constexpr std::size_t ChannelHeaderSize = 40;
+
+enum class ChunkKind : uint8_t
+{
+    // PIDs that were first seen after the header was written
+    Pids = 1,
+    // Per-PID sample arrays
+    Samples = 2,
+};
+
+struct IndexEntry
+{
+    uint64_t offset;
+    uint64_t timeBegin;
+    uint64_t timeEnd;
+    ChunkKind kind;
+};
+} // namespace datalogfile
+
+// Samples of a single PID inside a chunk. Points directly into the
+// mapped file.
+struct DataLogChannel
+{
+    uint16_t code;
+    uint32_t count;
+    uint64_t timeBegin;
+    uint64_t timeEnd;
+    double minValue;
+    double maxValue;
+
+    inline PidLogEntry entry(std::size_t index) const noexcept
+    {
+        return PidLogEntry{loadLittle<double>(values + index * sizeof(double)),
+                           static_cast<std::size_t>(base + loadLittle<uint32_t>(times + index * sizeof(uint32_t)))};
+    }
+
+    uint64_t base;
+    const uint8_t * times;
+    const uint8_t * values;
+};
+
+// Streams log entries to a file in fixed-size chunks. Memory use is
+// bounded by the chunk size regardless of the log length.
+class DataLogWriter
+{
+public:
+    static constexpr std::size_t DefaultChunkSize = 4096;
+
+    // Creates the file, overwriting any existing file. Throws an exception
+    // if the file cannot be opened.
+    DataLogWriter(const std::filesystem::path & path, const std::string & name, const std::vector<Pid> & pids,
+                  std::size_t chunkSize = DefaultChunkSize);
+    ~DataLogWriter();
+
+    DataLogWriter(const DataLogWriter &) = delete;
+    DataLogWriter & operator=(const DataLogWriter &) = delete;
+
+    // Buffers an entry. Writes a chunk when the buffer is full.
+    void add(const Pid & pid, const PidLogEntry & entry);
+
+    // Streams every entry added to `log` until the writer is closed. Write
+    // errors stop the stream and are kept for error() instead of being
+    // thrown on the logging thread.
+    void attach(DataLog & log);
+
+    // Returns the error that stopped an attached stream, or an empty string
+    std::string error() const;
+
+    // Writes buffered entries as a chunk
+    void flush();
+
+    // Flushes and writes the index. No entries can be added after closing.
+    void close();
+
+    // Writes an entire log to `path`
+    static void save(const DataLog & log, const std::filesystem::path & path,
+                     std::size_t chunkSize = DefaultChunkSize);
+
+private:
+    struct Channel
+    {
+        uint16_t code;
+        std::vector<std::size_t> times;
+        std::vector<double> values;
+    };
+
+    std::ofstream file_;
+    uint64_t offset_{0};
+    std::size_t chunkSize_;
+    std::size_t buffered_{0};
+    std::size_t chunkBegin_{0};
+    std::size_t chunkEnd_{0};
+    bool closed_{false};
+
+    std::vector<Channel> channels_;
+    std::unordered_map<uint16_t, std::size_t> channelIndex_;
+    std::vector<Pid> newPids_;
+    std::vector<datalogfile::IndexEntry> index_;
+    std::vector<uint8_t> scratch_;
+
+    mutable std::mutex mutex_;
+    std::string error_;
+    DataLog::AddConnectionPtr connection_;
+
+    void writeChunk(datalogfile::ChunkKind kind, uint64_t timeBegin, uint64_t timeEnd);
+    void flushLocked();
+};
+
+// Random-access reader for datalog files. The file is memory mapped and
+// chunks are located through the index, so seeking to a time window reads
+// only the chunks that overlap it.
+class DataLogReader
+{
+public:
+    // Opens a log. If the index is missing or damaged, it is rebuilt by
+    // scanning the intact chunks. Throws an exception if the header is
+    // invalid.
+    explicit DataLogReader(const std::filesystem::path & path);
+
+    inline const std::string & name() const noexcept { return name_; }
+    inline const std::vector<Pid> & pids() const noexcept { return pids_; }
+
+    // Returns true if the index had to be rebuilt
+    inline bool recovered() const noexcept { return recovered_; }
+
+    // Returns the size of the file up to the end of the last intact chunk
+    inline std::size_t validSize() const noexcept { return validSize_; }
+
+    // Number of sample chunks
+    inline std::size_t chunkCount() const noexcept { return chunks_.size(); }
+    inline const datalogfile::IndexEntry & chunk(std::size_t index) const { return chunks_[index]; }
+
+    uint64_t beginTime() const noexcept;
+    uint64_t endTime() const noexcept;
+
+    // Returns the range [first, last) of sample chunks that may contain
+    // entries in the time window [begin, end].
+    std::pair<std::size_t, std::size_t> chunksInRange(uint64_t begin, uint64_t end) const noexcept;
+
+    // Calls `func(const DataLogChannel &)` for each channel in a sample chunk
+    template <typename Func> void visitChunk(std::size_t index, Func && func) const
+    {
+        const datalogfile::IndexEntry & entry = chunks_[index];
+        ByteReader reader(file_.data() + entry.offset + datalogfile::ChunkHeaderSize, file_.end());
+        auto count = reader.read<uint16_t>();
+        reader.read<uint16_t>();
+
+        const uint8_t * headers = reader.take(count * datalogfile::ChannelHeaderSize);
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            ByteReader hr(headers + i * datalogfile::ChannelHeaderSize,
+                          headers + (i + 1) * datalogfile::ChannelHeaderSize);
+            DataLogChannel channel;
+            channel.code = hr.read<uint16_t>();
+            hr.read<uint16_t>();
+            channel.count = hr.read<uint32_t>();
+            channel.timeBegin = hr.read<uint64_t>();
+            channel.timeEnd = hr.read<uint64_t>();
+            channel.minValue = hr.read<double>();
+            channel.maxValue = hr.read<double>();
+            channel.base = entry.timeBegin;
+            channel.times = reader.take(channel.count * sizeof(uint32_t));
+            channel.values = reader.take(channel.count * sizeof(double));
+            func(static_cast<const DataLogChannel &>(channel));
+        }
+    }
+
+    // Calls `func(const Pid &, const PidLogEntry &)` for each entry in the
+    // time window [begin, end]
+    template <typename Func>
+    void forEach(uint64_t begin, uint64_t end, Func && func) const
+    {
+        auto [first, last] = chunksInRange(begin, end);
+        for (std::size_t i = first; i < last; ++i)
+        {
+            visitChunk(i, [&](const DataLogChannel & channel) {
+                if (channel.timeEnd < begin || channel.timeBegin > end)
+                    return;
+                const Pid * pid = this->pid(channel.code);
+                if (pid == nullptr)
+                    return;
+                for (uint32_t j = 0; j < channel.count; ++j)
+                {
+                    PidLogEntry e = channel.entry(j);
+                    if (e.time >= begin && e.time <= end)
+                        func(*pid, static_cast<const PidLogEntry &>(e));
+                }
+            });
+        }
+    }
+
+    // Adds entries in the time window to `log`
+    void readInto(DataLog & log, uint64_t begin = 0, uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+    // Returns the PID with the code or nullptr if it is not defined
+    const Pid * pid(uint16_t code) const noexcept;
+
+    // Repairs a log whose writer did not finish by truncating damaged
+    // data and rewriting the index. Returns true if the file was changed.
+    static bool recover(const std::filesystem::path & path);
+
+private:
+    os::MappedFile file_;
+    std::string name_;
+    std::vector<Pid> pids_;
+    std::unordered_map<uint16_t, std::size_t> pidIndex_;
+    // All chunks and sample chunks only
+    std::vector<datalogfile::IndexEntry> index_;
+    std::vector<datalogfile::IndexEntry> chunks_;
+    // Running maximum of chunk end times and running minimum (from the
+    // back) of chunk begin times. Both are sorted, so seeking is a binary
+    // search even if chunks overlap.
+    std::vector<uint64_t> maxEnd_;
+    std::vector<uint64_t> minBegin_;
+    std::size_t validSize_{0};
+    bool recovered_{false};
+
+    std::size_t readHeader();
+    bool readIndex(std::size_t headerEnd);
+    void scanChunks(std::size_t offset);
+    void readPids(ByteReader & reader);
+};
+
+} // namespace lt
+
+#endif // LT_DATALOGFILE_H
@@ -17,6 +17,7 @@
  */
 
 #include "datalogger.h"
+#include "../support/trace.h"
 
 #include <utility>
 
@@ -104,7 +105,11 @@ void UdsDataLogger::processNext()
     }
 
     // Request the data
-    std::vector<uint8_t> response = uds_->readDataByIdentifier(pid->code);
+    std::vector<uint8_t> response;
+    {
+        LT_TRACE_SPAN("datalog.request");
+        response = uds_->readDataByIdentifier(pid->code);
+    }
 
     PidEvaluator evaluator(*pid);
 
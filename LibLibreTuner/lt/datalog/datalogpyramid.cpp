@@ -0,0 +1,135 @@
+#include "datalogpyramid.h"
+
+#include <algorithm>
+
+#include "datalog.h"
+
+namespace lt
+{
+
+void DataLogPyramid::add(const PidLogEntry & entry)
+{
+    std::size_t index = count_++;
+
+    // A new level is started once the level below has two full buckets
+    while (levels_.empty() || index >= (BaseBucketSize << levels_.size()))
+    {
+        std::vector<DataLogBucket> level;
+        if (!levels_.empty())
+        {
+            // Seed from the level below, which covers every sample so far
+            const std::vector<DataLogBucket> & below = levels_.back();
+            for (std::size_t i = 0; i < below.size(); i += 2)
+            {
+                DataLogBucket bucket = below[i];
+                if (i + 1 < below.size())
+                {
+                    const DataLogBucket & next = below[i + 1];
+                    bucket.timeBegin = std::min(bucket.timeBegin, next.timeBegin);
+                    bucket.timeEnd = std::max(bucket.timeEnd, next.timeEnd);
+                    bucket.last = next.last;
+                    if (next.min < bucket.min)
+                    {
+                        bucket.min = next.min;
+                        bucket.minTime = next.minTime;
+                    }
+                    if (next.max > bucket.max)
+                    {
+                        bucket.max = next.max;
+                        bucket.maxTime = next.maxTime;
+                    }
+                }
+                level.push_back(bucket);
+            }
+        }
+        levels_.emplace_back(std::move(level));
+    }
+
+    for (std::size_t l = 0; l < levels_.size(); ++l)
+    {
+        std::vector<DataLogBucket> & level = levels_[l];
+        std::size_t bucketIndex = index / (BaseBucketSize << l);
+        if (bucketIndex == level.size())
+        {
+            level.push_back(DataLogBucket{entry.time, entry.time, entry.value, entry.value, entry.value, entry.value,
+                                          entry.time, entry.time});
+            continue;
+        }
+
+        DataLogBucket & bucket = level[bucketIndex];
+        bucket.timeBegin = std::min(bucket.timeBegin, entry.time);
+        bucket.timeEnd = std::max(bucket.timeEnd, entry.time);
+        bucket.last = entry.value;
+        if (entry.value < bucket.min)
+        {
+            bucket.min = entry.value;
+            bucket.minTime = entry.time;
+        }
+        if (entry.value > bucket.max)
+        {
+            bucket.max = entry.value;
+            bucket.maxTime = entry.time;
+        }
+    }
+}
+
+void DataLogPyramid::query(const std::vector<PidLogEntry> & entries, std::size_t begin, std::size_t end,
+                           std::size_t maxBuckets, std::vector<PidLogEntry> & out) const
+{
+    std::size_t count = std::min(count_, entries.size());
+    if (count == 0 || begin > end)
+        return;
+
+    auto byTime = [](const PidLogEntry & entry, std::size_t time) { return entry.time < time; };
+    std::size_t first = std::lower_bound(entries.begin(), entries.begin() + count, begin, byTime) - entries.begin();
+    std::size_t last = std::upper_bound(entries.begin(), entries.begin() + count, end,
+                                        [](std::size_t time, const PidLogEntry & entry) { return time < entry.time; }) -
+                       entries.begin();
+    if (first > 0)
+        --first;
+    if (last < count)
+        ++last;
+    if (first >= last)
+        return;
+
+    maxBuckets = std::max<std::size_t>(maxBuckets, 1);
+    std::size_t samples = last - first;
+    if (samples <= maxBuckets * 2 || levels_.empty())
+    {
+        out.insert(out.end(), entries.begin() + first, entries.begin() + last);
+        return;
+    }
+
+    // Pick the finest level that fits in the bucket budget
+    std::size_t l = 0;
+    while (l + 1 < levels_.size() && samples / (BaseBucketSize << l) > maxBuckets)
+        ++l;
+
+    const std::vector<DataLogBucket> & level = levels_[l];
+    std::size_t bucketSize = BaseBucketSize << l;
+    std::size_t lastBucket = std::min((last - 1) / bucketSize, level.size() - 1);
+    for (std::size_t b = first / bucketSize; b <= lastBucket; ++b)
+    {
+        const DataLogBucket & bucket = level[b];
+        out.push_back(PidLogEntry{bucket.first, bucket.timeBegin});
+        if (bucket.minTime <= bucket.maxTime)
+        {
+            out.push_back(PidLogEntry{bucket.min, bucket.minTime});
+            out.push_back(PidLogEntry{bucket.max, bucket.maxTime});
+        }
+        else
+        {
+            out.push_back(PidLogEntry{bucket.max, bucket.maxTime});
+            out.push_back(PidLogEntry{bucket.min, bucket.minTime});
+        }
+        out.push_back(PidLogEntry{bucket.last, bucket.timeEnd});
+    }
+}
+
+void DataLogPyramid::clear() noexcept
+{
+    levels_.clear();
+    count_ = 0;
+}
+
+} // namespace lt
@@ -0,0 +1,58 @@
+#ifndef LT_DATALOGPYRAMID_H
+#define LT_DATALOGPYRAMID_H
+
+#include <cstddef>
+#include <vector>
+
+namespace lt
+{
+
+struct PidLogEntry;
+
+// Summary of a run of consecutive samples
+struct DataLogBucket
+{
+    std::size_t timeBegin;
+    std::size_t timeEnd;
+    double first;
+    double last;
+    double min;
+    double max;
+    std::size_t minTime;
+    std::size_t maxTime;
+};
+
+// Level-of-detail pyramid over a PID's samples. Level 0 buckets hold
+// BaseBucketSize samples and each level above doubles the bucket size.
+// Buckets are updated as samples are added, so queries never touch
+// more buckets than the requested resolution.
+class DataLogPyramid
+{
+public:
+    static constexpr std::size_t BaseBucketSize = 16;
+
+    // Adds the next sample. Samples must be added in the same order as
+    // they are stored in the log.
+    void add(const PidLogEntry & entry);
+
+    // Appends points approximating `entries` in the time window
+    // [begin, end] to `out`. At most `maxBuckets` buckets are used, each
+    // producing up to four points (first, min, max, last). If the window
+    // has few enough samples, they are copied directly. One sample on each
+    // side of the window is included so lines reach the edges.
+    void query(const std::vector<PidLogEntry> & entries, std::size_t begin, std::size_t end,
+               std::size_t maxBuckets, std::vector<PidLogEntry> & out) const;
+
+    inline std::size_t levels() const noexcept { return levels_.size(); }
+    inline const std::vector<DataLogBucket> & level(std::size_t index) const { return levels_[index]; }
+
+    void clear() noexcept;
+
+private:
+    std::vector<std::vector<DataLogBucket>> levels_;
+    std::size_t count_{0};
+};
+
+} // namespace lt
+
+#endif // LT_DATALOGPYRAMID_H
@@ -21,6 +21,7 @@
 
 #include "../auth/auth.h"
 #include "../support/asyncroutine.h"
+#include "../support/task.h"
 
 #include <memory>
 #include <vector>
@@ -43,7 +44,8 @@ public:
 
     /* Starts downloading. Calls updateProgress if possible.
      * Returns false if canceled. */
-    virtual bool download() = 0;
+    inline bool download() { return syncWait(downloadAsync()); }
+    virtual Task<bool> downloadAsync() = 0;
 
     /* Cancels the active download */
     virtual void cancel() = 0;
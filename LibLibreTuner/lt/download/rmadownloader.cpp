@@ -18,6 +18,7 @@
 
 #include "rmadownloader.h"
 #include "auth/udsauthenticator.h"
+#include "support/trace.h"
 
 #include <algorithm>
 #include <cassert>
@@ -47,21 +48,25 @@ bool RMADownloader::update_progress()
     return downloadSize_ > 0;
 }
 
-bool RMADownloader::download()
+Task<bool> RMADownloader::downloadAsync()
 {
     canceled_ = false;
     downloadOffset_ = 0;
     downloadSize_ = totalSize_;
 
     // Authenticate
-    auth::UdsAuthenticator auth(*uds_, authOptions_);
-    auth.auth();
+    {
+        LT_TRACE_ASYNC_SPAN("rma.auth");
+        auth::UdsAuthenticator auth(*uds_, authOptions_);
+        co_await auth.authAsync();
+    }
 
     do
     {
+        LT_TRACE_ASYNC_SPAN("rma.chunk");
         size_t to_download =
             std::min<std::size_t>(static_cast<size_t>(downloadSize_), 0xFFE);
-        std::vector<uint8_t> data = uds_->requestReadMemoryAddress(
+        std::vector<uint8_t> data = co_await uds_->requestReadMemoryAddressAsync(
             static_cast<uint32_t>(downloadOffset_),
             static_cast<uint16_t>(to_download));
 
@@ -73,8 +78,9 @@ bool RMADownloader::download()
         downloadData_.insert(downloadData_.end(), data.begin(), data.end());
         downloadOffset_ += data.size();
         downloadSize_ -= data.size();
+        LT_TRACE_COUNTER("rma.bytes", downloadOffset_);
     } while (!canceled_ && update_progress());
-    return !canceled_;
+    co_return !canceled_;
 }
 
 void RMADownloader::cancel() { canceled_ = true; }
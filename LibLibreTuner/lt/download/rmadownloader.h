@@ -13,7 +13,7 @@ class RMADownloader : public Downloader
 public:
     RMADownloader(network::UdsPtr && uds, Options && options);
 
-    bool download() override;
+    Task<bool> downloadAsync() override;
     void cancel() override;
     virtual std::pair<const uint8_t *, size_t> data() override;
 
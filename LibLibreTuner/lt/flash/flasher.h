@@ -25,6 +25,7 @@
 
 #include "../auth/auth.h"
 #include "../support/asyncroutine.h"
+#include "../support/task.h"
 #include "flashmap.h"
 
 class PlatformLink;
@@ -46,7 +47,8 @@ public:
     virtual ~Flasher() = default;
 
     /* Flash map. Returns false if canceled. */
-    virtual bool flash(const FlashMap & flashable) = 0;
+    inline bool flash(const FlashMap & flashable) { return syncWait(flashAsync(flashable)); }
+    virtual Task<bool> flashAsync(const FlashMap & flashable) = 0;
 
     /* Cancels the active flash */
     virtual void cancel() = 0;
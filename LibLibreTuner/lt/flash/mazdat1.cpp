@@ -1,6 +1,7 @@
 #include "mazdat1.h"
 
 #include "auth/udsauthenticator.h"
+#include "support/trace.h"
 #include "support/util.hpp"
 
 #include <array>
@@ -15,78 +16,57 @@ MazdaT1Flasher::MazdaT1Flasher(network::UdsPtr && uds, FlashOptions && options)
     assert(uds_);
 }
 
-bool MazdaT1Flasher::flash(const FlashMap & flashmap)
+Task<bool> MazdaT1Flasher::flashAsync(const FlashMap & flashmap)
 {
     canceled_ = false;
-    flash_ = &flashmap;
-
-    auth::UdsAuthenticator auth(*uds_, authOptions_);
-    // auth_.auth(*uds_, auth::Options{key_, 0x85});
-    auth.auth();
 
+    {
+        LT_TRACE_ASYNC_SPAN("flash.auth");
+        auth::UdsAuthenticator auth(*uds_, authOptions_);
+        co_await auth.authAsync();
+    }
     if (canceled_)
-        return false;
-    return do_erase();
-}
+        co_return false;
 
-void MazdaT1Flasher::cancel() { canceled_ = true; }
-
-bool MazdaT1Flasher::do_erase()
-{
+    // Erase
     std::array<uint8_t, 3> eraseRequest = {0x00, 0xB2, 0x00};
-    network::UdsPacket res =
-        uds_->request(0xB1, eraseRequest.data(), eraseRequest.size());
-    if (canceled_)
     {
-        return false;
+        LT_TRACE_ASYNC_SPAN("flash.erase");
+        co_await uds_->requestAsync(0xB1, eraseRequest.data(), eraseRequest.size());
     }
-    return do_request_download();
-}
+    if (canceled_)
+        co_return false;
 
-bool MazdaT1Flasher::do_request_download()
-{
     // Send address...size
     std::array<uint8_t, 8> msg{};
-    writeBE<int32_t>(flash_->offset(), msg.begin(), msg.end());
-    writeBE<int32_t>(flash_->data().size(), msg.begin() + 4, msg.end());
-
-    // Send download request
-    network::UdsPacket _response =
-        uds_->request(network::UDS_REQ_REQUESTDOWNLOAD, msg.data(), msg.size());
-
+    writeBE<int32_t>(flashmap.offset(), msg.begin(), msg.end());
+    writeBE<int32_t>(flashmap.data().size(), msg.begin() + 4, msg.end());
+    co_await uds_->requestAsync(network::UDS_REQ_REQUESTDOWNLOAD, msg.data(),
+                                msg.size());
     if (canceled_)
-    {
-        return false;
-    }
+        co_return false;
 
     // Start uploading
-    sent_ = 0;
-    left_ = flash_->data().size();
-    return sendLoad();
-}
-
-bool MazdaT1Flasher::sendLoad()
-{
-    while (left_ != 0)
+    const std::size_t total = flashmap.data().size();
+    std::size_t sent = 0;
+    while (sent != total)
     {
-        size_t toSend = std::min<size_t>(left_, 0xFFE);
-        std::vector<uint8_t> data;
-        data.assign(flash_->data().begin() + sent_,
-                    flash_->data().begin() + sent_ + toSend);
-
-        sent_ += toSend;
-        left_ -= toSend;
-
-        network::UdsPacket res = uds_->request(network::UDS_REQ_TRANSFERDATA,
-                                               data.data(), data.size());
-
-        notifyProgress(static_cast<float>(sent_) / flash_->data().size());
-        if (canceled_)
+        size_t toSend = std::min<size_t>(total - sent, 0xFFE);
         {
-            return false;
+            LT_TRACE_ASYNC_SPAN("flash.transfer");
+            co_await uds_->requestAsync(network::UDS_REQ_TRANSFERDATA,
+                                        flashmap.data().data() + sent, toSend);
         }
+        sent += toSend;
+        LT_TRACE_COUNTER("flash.bytes", sent);
+
+        notifyProgress(static_cast<float>(sent) / total);
+        if (canceled_)
+            co_return false;
     }
-    return true;
+    co_return true;
 }
 
+void MazdaT1Flasher::cancel() { canceled_ = true; }
+
 } // namespace lt
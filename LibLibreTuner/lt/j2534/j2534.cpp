@@ -22,9 +22,14 @@
 #include "../libretuner.h"
 
 #include <cassert>
+#include <cstdlib>
 #include <sstream>
 
+#ifdef WIN32
 #include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
 
 namespace lt
 {
@@ -48,8 +53,8 @@ DevicePtr J2534::open(const char * port)
              const_cast<void *>(reinterpret_cast<const void *>(port)),
              &deviceId)) != 0)
     {
-        if (res == 0x8)
-        { // ERR_DEVICE_NOT_CONNECTED
+        if (res == ERR_DEVICE_NOT_CONNECTED)
+        {
             // Return nullptr. Don't throw an exception,
             // because the absence of a device is not an exceptional error
             return nullptr;
@@ -94,7 +99,7 @@ void J2534::readMsgs(uint32_t channel, PASSTHRU_MSG * pMsg, uint32_t & pNumMsgs,
 {
     assert(initialized());
     int32_t res = PassThruReadMsgs(channel, pMsg, &pNumMsgs, timeout);
-    if (res != 0 && res != 0x09 && res != 0x10)
+    if (res != STATUS_NOERROR && res != ERR_TIMEOUT && res != ERR_BUFFER_EMPTY)
     {
         throw Error(lastError());
     }
@@ -105,7 +110,8 @@ void J2534::writeMsgs(uint32_t channel, PASSTHRU_MSG * pMsg,
 {
     assert(initialized());
     int32_t res = PassThruWriteMsgs(channel, pMsg, &pNumMsgs, timeout);
-    if (res != 0)
+    // On timeout, pNumMsgs is the amount of messages sent
+    if (res != STATUS_NOERROR && res != ERR_TIMEOUT)
     {
         throw Error(lastError());
     }
@@ -126,6 +132,16 @@ void J2534::startMsgFilter(uint32_t channel, uint32_t type,
     }
 }
 
+void J2534::ioctl(uint32_t channel, Ioctl id, void * input, void * output)
+{
+    assert(initialized());
+    int32_t res = PassThruIoctl(channel, static_cast<uint32_t>(id), input, output);
+    if (res != STATUS_NOERROR)
+    {
+        throw Error(lastError());
+    }
+}
+
 void J2534::disconnect(uint32_t channel)
 {
     assert(initialized());
@@ -153,12 +169,17 @@ J2534::~J2534() noexcept
 {
     if (hDll_)
     {
+#ifdef WIN32
         FreeLibrary(reinterpret_cast<HMODULE>(hDll_));
+#else
+        dlclose(hDll_);
+#endif
     }
 }
 
 void J2534::load()
 {
+#ifdef WIN32
     if ((hDll_ = LoadLibrary(info_.functionLibrary.c_str())) == nullptr)
     {
         std::stringstream ss;
@@ -166,6 +187,13 @@ void J2534::load()
         throw Error("Failed to load library " + info_.functionLibrary + ": 0x" +
                     ss.str());
     }
+#else
+    if ((hDll_ = dlopen(info_.functionLibrary.c_str(), RTLD_NOW | RTLD_LOCAL)) == nullptr)
+    {
+        throw Error("Failed to load library " + info_.functionLibrary + ": " +
+                    dlerror());
+    }
+#endif
     PassThruOpen = reinterpret_cast<PassThruOpen_t>(getProc("PassThruOpen"));
     PassThruClose = reinterpret_cast<PassThruClose_t>(getProc("PassThruClose"));
     PassThruConnect =
@@ -201,8 +229,12 @@ void J2534::load()
 void * J2534::getProc(const char * proc)
 {
     assert(hDll_);
+#ifdef WIN32
     void * func = reinterpret_cast<void *>(
         GetProcAddress(reinterpret_cast<HMODULE>(hDll_), proc));
+#else
+    void * func = dlsym(hDll_, proc);
+#endif
     if (!func)
     {
         throw Error("Failed to get procedure from dll: " + std::string(proc));
@@ -277,6 +309,47 @@ void Channel::startMsgFilter(uint32_t type, const PASSTHRU_MSG * pMaskMsg,
                            pFlowControlMsg, pMsgID);
 }
 
+void Channel::ioctl(Ioctl id, void * input, void * output)
+{
+    assert(valid());
+    j2534_->ioctl(channel_, id, input, output);
+}
+
+void Channel::setConfig(std::initializer_list<SCONFIG> params)
+{
+    std::vector<SCONFIG> configs(params);
+    SCONFIG_LIST list{static_cast<uint32_t>(configs.size()), configs.data()};
+    ioctl(Ioctl::SetConfig, &list, nullptr);
+}
+
+uint32_t Channel::getConfig(Parameter parameter)
+{
+    SCONFIG config{static_cast<uint32_t>(parameter), 0};
+    SCONFIG_LIST list{1, &config};
+    ioctl(Ioctl::GetConfig, &list, nullptr);
+    return config.Value;
+}
+
+#ifndef WIN32
+std::vector<Info> detect_interfaces()
+{
+    std::vector<Info> interfaces;
+    const char * library = std::getenv("LT_J2534_LIBRARY");
+    if (library == nullptr || *library == '\0')
+    {
+        return interfaces;
+    }
+
+    // The library cannot describe itself without being opened, so assume
+    // it supports both CAN protocols
+    Info info;
+    info.name = std::string("PassThru (") + library + ")";
+    info.functionLibrary = library;
+    info.protocols = Protocol::CAN | Protocol::ISO15765;
+    interfaces.emplace_back(std::move(info));
+    return interfaces;
+}
+#else
 std::vector<Info> detect_interfaces()
 {
     std::vector<Info> interfaces;
@@ -383,6 +456,7 @@ std::vector<Info> detect_interfaces()
     RegCloseKey(hKeyPassthrough);
     return interfaces;
 }
+#endif
 
 } // namespace j2534
 } // namespace lt
@@ -19,8 +19,11 @@
 #ifndef J2534_H
 #define J2534_H
 
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -75,6 +78,19 @@
 #define BLOCK_FILTER 0x00000002
 #define FLOW_CONTROL_FILTER 0x00000003
 
+/////////////////
+// Return values
+/////////////////
+
+#define STATUS_NOERROR 0x00
+#define ERR_DEVICE_NOT_CONNECTED 0x08
+#define ERR_TIMEOUT 0x09
+#define ERR_BUFFER_EMPTY 0x10
+
+// Value of ISO15765_BS_TX and ISO15765_STMIN_TX that uses the values from
+// the ECU's flow control frames
+#define ISO15765_USE_ECU_VALUE 0xFFFF
+
 namespace lt
 {
 namespace j2534
@@ -192,6 +208,34 @@ enum class Ioctl
     BecomeMaster = 0x8003,
 };
 
+// Configuration parameters for GET_CONFIG and SET_CONFIG
+enum class Parameter : uint32_t
+{
+    DataRate = 0x01,
+    Loopback = 0x03,
+    // Block size and STmin sent in our flow control frames
+    Iso15765Bs = 0x1E,
+    Iso15765StMin = 0x1F,
+    // Block size and STmin used when sending, overriding the ECU's flow
+    // control frames unless set to ISO15765_USE_ECU_VALUE
+    Iso15765BsTx = 0x22,
+    Iso15765StMinTx = 0x23,
+    // Maximum number of flow control wait frames accepted
+    Iso15765WftMax = 0x25,
+};
+
+struct SCONFIG
+{
+    uint32_t Parameter;
+    uint32_t Value;
+};
+
+struct SCONFIG_LIST
+{
+    uint32_t NumOfParams;
+    SCONFIG * ConfigPtr;
+};
+
 class Device;
 using DevicePtr = std::shared_ptr<Device>;
 
@@ -223,6 +267,15 @@ public:
                         const PASSTHRU_MSG * pFlowControlMsg,
                         uint32_t & pMsgID);
 
+    // Calls PassThruIoctl on the channel
+    void ioctl(Ioctl id, void * input, void * output);
+
+    // Sets configuration parameters with SET_CONFIG
+    void setConfig(std::initializer_list<SCONFIG> params);
+
+    // Reads a configuration parameter with GET_CONFIG
+    uint32_t getConfig(Parameter parameter);
+
     /* Disconnects the channel from the j2534 device. The object
      * is in an invalid state after calling this method */
     void disconnect();
@@ -304,6 +357,7 @@ public:
                         const PASSTHRU_MSG * pPatternMsg,
                         const PASSTHRU_MSG * pFlowControlMsg,
                         uint32_t & pMsgID);
+    void ioctl(uint32_t channel, Ioctl id, void * input, void * output);
 
     // Disconnects a logical communication channel
     void disconnect(uint32_t channel);
@@ -325,6 +379,7 @@ public:
 private:
     Info info_;
 
+    // Library handle from LoadLibrary or dlopen
     void * hDll_{nullptr};
 
     bool loaded_{false};
@@ -350,6 +405,9 @@ private:
     PassThruSetProgrammingVoltage_t PassThruSetProgrammingVoltage{};
 };
 
+// Returns the installed interfaces. On Windows, these are read from the
+// registry. Elsewhere there is no registry, so the library named by the
+// LT_J2534_LIBRARY environment variable is used if set.
 std::vector<Info> detect_interfaces();
 
 } // namespace j2534
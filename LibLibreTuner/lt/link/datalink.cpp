@@ -1,18 +1,27 @@
 #include <utility>
 
+#include "../network/can/meteredcan.h"
 #include "../network/isotp/isotpcan.h"
 #include "datalink.h"
 
 namespace lt
 {
-DataLink::DataLink(std::string name) : name_(std::move(name)) {}
+DataLink::DataLink(std::string name)
+    : name_(std::move(name)),
+      metrics_(std::make_shared<network::LinkMetrics>())
+{
+}
 
 network::IsoTpPtr DataLink::isotp(const network::IsoTpOptions & options)
 {
     // Try to create a device from CAN
     network::CanPtr dev = can(500000);
     if (dev)
+    {
+        if (options.metrics)
+            dev = std::make_unique<network::MeteredCan>(std::move(dev), options.metrics);
         return std::make_unique<network::IsoTpCan>(std::move(dev), options);
+    }
     return nullptr;
 }
 
@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 
+#include "../network/linkmetrics.h"
 #include "../network/network.h"
 #include "../support/types.h"
 #include "../support/util.hpp"
@@ -16,6 +17,7 @@ enum class DataLinkFlags : unsigned
     None = 0,
     Port = 1 << 1,
     Baudrate = 1 << 2,
+    Speed = 1 << 3,
 };
 ENABLE_BITMASK(DataLinkFlags)
 
@@ -23,6 +25,7 @@ enum class DataLinkPortType
 {
     Serial,
     NetworkCan,
+    File,
 };
 
 class DataLink
@@ -73,8 +76,18 @@ public:
 
     virtual int baudrate() { return 0; }
 
+    // Playback speed multiplier for recorded links
+    virtual void setSpeed(double /*speed*/) {}
+
+    virtual double speed() const { return 1.0; }
+
+    // Statistics of every interface created through a PlatformLink on this
+    // link
+    inline const network::LinkMetricsPtr & metrics() const noexcept { return metrics_; }
+
 protected:
     std::string name_;
+    network::LinkMetricsPtr metrics_;
 };
 using DataLinkPtr = std::unique_ptr<DataLink>;
 } // namespace lt
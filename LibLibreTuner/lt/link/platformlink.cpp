@@ -4,6 +4,7 @@
 #include "../download/rmadownloader.h"
 #include "../flash/mazdat1.h"
 #include "../network/can/canlog.h"
+#include "../network/can/meteredcan.h"
 #include "../network/isotp/isotpcan.h"
 #include "../network/uds/isotpuds.h"
 
@@ -18,6 +19,7 @@ network::CanPtr PlatformLink::can()
         throw std::runtime_error(
             "CAN is unsupported with the selected datalink");
     }
+    can = std::make_unique<network::MeteredCan>(std::move(can), datalink_.metrics());
     if (canLog_)
     {
         return std::make_unique<network::CanLogProxy>(std::move(can), canLog_);
@@ -27,8 +29,10 @@ network::CanPtr PlatformLink::can()
 
 network::IsoTpPtr PlatformLink::isotp()
 {
-    network::IsoTpPtr isotp = datalink_.isotp(
-        network::IsoTpOptions{platform_.serverId, platform_.serverId + 8, platform_.baudrate});
+    network::IsoTpOptions options{platform_.serverId, platform_.serverId + 8,
+                                  platform_.baudrate};
+    options.metrics = datalink_.metrics();
+    network::IsoTpPtr isotp = datalink_.isotp(options);
     if (!isotp)
     {
         throw std::runtime_error(
@@ -39,7 +43,9 @@ network::IsoTpPtr PlatformLink::isotp()
 
 network::UdsPtr PlatformLink::uds()
 {
-    return std::make_unique<network::IsoTpUds>(isotp());
+    auto uds = std::make_unique<network::IsoTpUds>(isotp());
+    uds->setMetrics(datalink_.metrics());
+    return uds;
 }
 
 DtcScannerPtr PlatformLink::dtcScanner()
@@ -0,0 +1,17 @@
+#include "replay.h"
+
+#include <utility>
+
+#include "../network/can/tracefile.h"
+
+namespace lt
+{
+
+ReplayDataLink::ReplayDataLink(const std::string & name, std::string path) : DataLink(name), path_(std::move(path)) {}
+
+network::CanPtr ReplayDataLink::can(uint32_t /*baudrate*/)
+{
+    return std::make_unique<network::ReplayCan>(network::readTrace(path_), network::ReplayMode::Respond, speed_);
+}
+
+} // namespace lt
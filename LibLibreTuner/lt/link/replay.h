@@ -0,0 +1,42 @@
+#ifndef LT_REPLAY_DATALINK_H
+#define LT_REPLAY_DATALINK_H
+
+#include "../network/can/replaycan.h"
+#include "datalink.h"
+
+namespace lt
+{
+
+// Datalink that answers requests from a CAN trace (candump, ASC or BLF). Lets the
+// datalogger and other tools run without a vehicle.
+class ReplayDataLink : public DataLink
+{
+public:
+    explicit ReplayDataLink(const std::string & name, std::string path = "");
+
+    DataLinkType type() const override { return DataLinkType::Replay; }
+
+    NetworkProtocol supportedProtocols() const override { return NetworkProtocol::Can; }
+
+    // Loads the recording. Throws an exception if it cannot be read.
+    network::CanPtr can(uint32_t baudrate) override;
+
+    std::string port() const override { return path_; }
+    void setPort(const std::string & port) override { path_ = port; }
+
+    DataLinkFlags flags() const noexcept override { return DataLinkFlags::Port | DataLinkFlags::Speed; }
+
+    DataLinkPortType portType() const override { return DataLinkPortType::File; }
+
+    // Playback speed multiplier. 0 replays without delays.
+    double speed() const override { return speed_; }
+    void setSpeed(double speed) override { speed_ = speed; }
+
+private:
+    std::string path_;
+    double speed_{1.0};
+};
+
+} // namespace lt
+
+#endif // LT_REPLAY_DATALINK_H
@@ -0,0 +1,183 @@
+#include "asc.h"
+
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <stdexcept>
+
+#include "../../support/hex.h"
+
+namespace lt::network
+{
+
+namespace
+{
+bool parseNumber(std::string_view text, uint32_t & out, bool hex) noexcept
+{
+    if (hex)
+        return hex::parse(text, out);
+    auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+    return res.ec == std::errc() && res.ptr == text.data() + text.size();
+}
+} // namespace
+
+AscReader::AscReader(const std::filesystem::path & path)
+    : file_(path), scanner_(reinterpret_cast<const char *>(file_.begin()), reinterpret_cast<const char *>(file_.end()))
+{
+}
+
+AscReader::AscReader(std::string_view text) : scanner_(text.data(), text.data() + text.size()) {}
+
+bool AscReader::next(CanLogEntry & entry)
+{
+    std::string_view line;
+    while (scanner_.next(line))
+    {
+        std::string_view rest = line;
+        std::string_view first = detail::nextToken(rest);
+
+        if (first == "base")
+        {
+            hex_ = detail::nextToken(rest) != "dec";
+            continue;
+        }
+
+        // Frames start with a timestamp. Everything else is a header line,
+        // comment or event.
+        if (!detail::parseSeconds(first, entry.time))
+            continue;
+
+        // <time> <channel> <id>[x] <Rx|Tx> d <dlc> <data...>
+        std::string_view channel = detail::nextToken(rest);
+        if (channel.empty() || channel.front() < '0' || channel.front() > '9')
+            continue;
+
+        std::string_view idText = detail::nextToken(rest);
+        bool extended = !idText.empty() && (idText.back() == 'x' || idText.back() == 'X');
+        if (extended)
+            idText.remove_suffix(1);
+        uint32_t id = 0;
+        if (!parseNumber(idText, id, hex_) || id > max_can_id)
+            continue;
+
+        std::string_view direction = detail::nextToken(rest);
+        if (direction == "Tx")
+            entry.direction = CanMessageDirection::Outbound;
+        else if (direction == "Rx")
+            entry.direction = CanMessageDirection::Inbound;
+        else
+            continue;
+
+        if (detail::nextToken(rest) != "d")
+            continue;
+
+        uint32_t dlc = 0;
+        if (!parseNumber(detail::nextToken(rest), dlc, true) || dlc > 8)
+            throw std::runtime_error("asc line " + std::to_string(scanner_.lineNumber()) + ": invalid DLC");
+
+        uint8_t bytes[8];
+        for (uint32_t i = 0; i < dlc; ++i)
+        {
+            uint32_t value = 0;
+            if (!parseNumber(detail::nextToken(rest), value, hex_) || value > 0xFF)
+                throw std::runtime_error("asc line " + std::to_string(scanner_.lineNumber()) + ": invalid data");
+            bytes[i] = static_cast<uint8_t>(value);
+        }
+
+        entry.message.setMessage(id, bytes, static_cast<uint8_t>(dlc));
+        entry.message.setExtended(extended);
+        return true;
+    }
+    return false;
+}
+
+AscWriter::AscWriter(const std::filesystem::path & path) : out_(path) {}
+
+AscWriter::~AscWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+void AscWriter::writeHeader()
+{
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%a %b %d %H:%M:%S.000 %Y", std::localtime(&now));
+
+    std::string header = std::string("date ") + date + "\nbase hex  timestamps absolute\nno internal events logged\n" +
+                         "Begin Triggerblock " + date + "\n   0.000000 Start of measurement\n";
+    out_.write(header.data(), header.size());
+}
+
+void AscWriter::write(const CanLogEntry & entry)
+{
+    if (!started_)
+    {
+        started_ = true;
+        start_ = entry.time;
+        writeHeader();
+    }
+
+    char * begin = out_.reserve(128);
+    char * out = begin;
+
+    // Timestamps are relative to the first frame
+    auto micros = static_cast<uint64_t>(std::max<int64_t>((entry.time - start_).count(), 0));
+    char number[24];
+    char * numberEnd = std::to_chars(number, number + sizeof(number), micros / 1000000).ptr;
+    auto width = static_cast<std::ptrdiff_t>(numberEnd - number);
+    // Right align the seconds in four columns
+    for (std::ptrdiff_t i = width; i < 4; ++i)
+        *out++ = ' ';
+    out = std::copy(number, numberEnd, out);
+    *out++ = '.';
+    uint64_t fraction = micros % 1000000;
+    for (int i = 5; i >= 0; --i)
+    {
+        out[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    out += 6;
+
+    out = std::copy_n(" 1  ", 4, out);
+    uint32_t id = entry.message.id();
+    char * idBegin = out;
+    out = std::to_chars(out, out + 8, id, 16).ptr;
+    std::transform(idBegin, out, idBegin, [](char c) { return c >= 'a' && c <= 'f' ? static_cast<char>(c - 32) : c; });
+    if (entry.message.extended())
+        *out++ = 'x';
+    // Pad the id column to 15 characters
+    while (out - idBegin < 15)
+        *out++ = ' ';
+
+    out = std::copy_n(entry.direction == CanMessageDirection::Outbound ? " Tx   d " : " Rx   d ", 8, out);
+    *out++ = static_cast<char>('0' + entry.message.length());
+    for (uint8_t i = 0; i < entry.message.length(); ++i)
+    {
+        *out++ = ' ';
+        out = hex::write(out, entry.message[i]);
+    }
+    *out++ = '\n';
+
+    out_.commit(static_cast<std::size_t>(out - begin));
+}
+
+void AscWriter::close()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+    if (!started_)
+        writeHeader();
+    constexpr std::string_view footer = "End TriggerBlock\n";
+    out_.write(footer.data(), footer.size());
+    out_.close();
+}
+
+} // namespace lt::network
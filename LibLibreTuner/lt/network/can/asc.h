@@ -0,0 +1,48 @@
+#ifndef LT_ASC_H
+#define LT_ASC_H
+
+#include "../../os/mappedfile.h"
+#include "tracefile.h"
+
+namespace lt::network
+{
+
+// Reads Vector ASC logs. Only classic CAN data frames are returned; remote
+// frames, error frames, CAN FD frames and events are skipped.
+class AscReader : public TraceReader
+{
+public:
+    explicit AscReader(const std::filesystem::path & path);
+    // Reads from memory. The text must outlive the reader.
+    explicit AscReader(std::string_view text);
+
+    bool next(CanLogEntry & entry) override;
+
+private:
+    os::MappedFile file_;
+    detail::LineScanner scanner_;
+    // Ids and data are hex unless the header says "base dec"
+    bool hex_{true};
+};
+
+class AscWriter : public TraceWriter
+{
+public:
+    explicit AscWriter(const std::filesystem::path & path);
+    ~AscWriter() override;
+
+    void write(const CanLogEntry & entry) override;
+    void close() override;
+
+private:
+    detail::TraceOutput out_;
+    bool started_{false};
+    bool closed_{false};
+    std::chrono::microseconds start_{0};
+
+    void writeHeader();
+};
+
+} // namespace lt::network
+
+#endif // LT_ASC_H
@@ -0,0 +1,310 @@
+#include "blf.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include <zlib.h>
+
+#include "../../support/bytestream.h"
+
+namespace lt::network
+{
+
+using namespace blf;
+
+namespace
+{
+constexpr uint32_t FileMagic = 0x47474F4C;   // "LOGG"
+constexpr uint32_t ObjectMagic = 0x4A424F4C; // "LOBJ"
+
+// Objects may be followed by padding. Like other readers, look for the
+// next signature within a few bytes.
+std::size_t findObject(const uint8_t * data, std::size_t pos, std::size_t size) noexcept
+{
+    for (std::size_t end = std::min(pos + 8, size); pos + 4 <= end; ++pos)
+    {
+        if (loadLittle<uint32_t>(data + pos) == ObjectMagic)
+            return pos;
+    }
+    return size;
+}
+
+void writeSystemTime(ByteWriter & writer, std::time_t time)
+{
+    std::tm tm = *std::gmtime(&time);
+    writer.write(static_cast<uint16_t>(tm.tm_year + 1900));
+    writer.write(static_cast<uint16_t>(tm.tm_mon + 1));
+    writer.write(static_cast<uint16_t>(tm.tm_wday));
+    writer.write(static_cast<uint16_t>(tm.tm_mday));
+    writer.write(static_cast<uint16_t>(tm.tm_hour));
+    writer.write(static_cast<uint16_t>(tm.tm_min));
+    writer.write(static_cast<uint16_t>(tm.tm_sec));
+    writer.write(static_cast<uint16_t>(0));
+}
+} // namespace
+
+BlfReader::BlfReader(const std::filesystem::path & path) : file_(path)
+{
+    if (file_.size() < FileHeaderSize || loadLittle<uint32_t>(file_.data()) != FileMagic)
+        throw std::runtime_error("'" + path.string() + "' is not a BLF file");
+    pos_ = std::max<std::size_t>(loadLittle<uint32_t>(file_.data() + 4), FileHeaderSize);
+}
+
+std::size_t BlfReader::parseObject(const uint8_t * data, std::size_t size, CanLogEntry & entry, bool & found) const
+{
+    found = false;
+    if (size < ObjectHeaderBaseSize)
+        return 0;
+
+    auto headerSize = loadLittle<uint16_t>(data + 4);
+    auto objectSize = loadLittle<uint32_t>(data + 8);
+    auto type = loadLittle<uint32_t>(data + 12);
+    if (objectSize < ObjectHeaderBaseSize)
+        throw std::runtime_error("invalid BLF object size");
+    if (objectSize > size)
+        return 0;
+
+    if (type != CanMessageObject && type != CanMessage2Object)
+        return objectSize;
+
+    if (headerSize < ObjectHeaderBaseSize + ObjectHeaderV1Size || headerSize + 16u > objectSize)
+        throw std::runtime_error("invalid BLF CAN message");
+
+    // v1 and v2 headers both start with the flags and have the timestamp
+    // at offset 8
+    auto flags = loadLittle<uint32_t>(data + ObjectHeaderBaseSize);
+    uint64_t timestamp = loadLittle<uint64_t>(data + ObjectHeaderBaseSize + 8);
+    if (flags & TimeTenMicros)
+        entry.time = std::chrono::microseconds(timestamp * 10);
+    else
+        entry.time = std::chrono::microseconds(timestamp / 1000);
+
+    const uint8_t * message = data + headerSize;
+    uint8_t messageFlags = message[2];
+    uint8_t dlc = std::min<uint8_t>(message[3], 8);
+    uint32_t id = loadLittle<uint32_t>(message + 4);
+    if (messageFlags & Remote)
+        return objectSize;
+
+    entry.direction = (messageFlags & DirectionTx) ? CanMessageDirection::Outbound : CanMessageDirection::Inbound;
+    entry.message.setMessage(id & ~ExtendedId & max_can_id, message + 8, dlc);
+    entry.message.setExtended((id & ExtendedId) != 0);
+    found = true;
+    return objectSize;
+}
+
+bool BlfReader::nextContainer()
+{
+    const uint8_t * data = file_.data();
+    pos_ = findObject(data, pos_, file_.size());
+    if (pos_ + ObjectHeaderBaseSize > file_.size())
+        return false;
+
+    auto objectSize = loadLittle<uint32_t>(data + pos_ + 8);
+    auto type = loadLittle<uint32_t>(data + pos_ + 12);
+    if (objectSize < ObjectHeaderBaseSize || pos_ + objectSize > file_.size())
+        throw std::runtime_error("truncated BLF object");
+
+    // Drop consumed bytes before appending
+    buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(bufferPos_));
+    bufferPos_ = 0;
+
+    const uint8_t * object = data + pos_;
+    pos_ += objectSize;
+
+    if (type != LogContainerObject)
+    {
+        // Objects outside of containers are read directly
+        buffer_.insert(buffer_.end(), object, object + objectSize);
+        return true;
+    }
+
+    if (objectSize < ObjectHeaderBaseSize + ContainerHeaderSize)
+        throw std::runtime_error("invalid BLF container");
+    auto method = loadLittle<uint16_t>(object + ObjectHeaderBaseSize);
+    auto uncompressedSize = loadLittle<uint32_t>(object + ObjectHeaderBaseSize + 8);
+    const uint8_t * payload = object + ObjectHeaderBaseSize + ContainerHeaderSize;
+    std::size_t payloadSize = objectSize - ObjectHeaderBaseSize - ContainerHeaderSize;
+
+    if (method == None)
+    {
+        buffer_.insert(buffer_.end(), payload, payload + payloadSize);
+    }
+    else if (method == Zlib)
+    {
+        std::size_t offset = buffer_.size();
+        buffer_.resize(offset + uncompressedSize);
+        uLongf destSize = uncompressedSize;
+        if (uncompress(buffer_.data() + offset, &destSize, payload, static_cast<uLong>(payloadSize)) != Z_OK)
+            throw std::runtime_error("failed to decompress BLF container");
+        buffer_.resize(offset + destSize);
+    }
+    else
+    {
+        throw std::runtime_error("unsupported BLF compression method " + std::to_string(method));
+    }
+    return true;
+}
+
+bool BlfReader::next(CanLogEntry & entry)
+{
+    while (true)
+    {
+        std::size_t objectPos = findObject(buffer_.data(), bufferPos_, buffer_.size());
+        bool found = false;
+        std::size_t size = 0;
+        if (objectPos < buffer_.size())
+        {
+            bufferPos_ = objectPos;
+            size = parseObject(buffer_.data() + bufferPos_, buffer_.size() - bufferPos_, entry, found);
+        }
+        else if (bufferPos_ + 8 <= buffer_.size())
+        {
+            // No signature where one should be. Skip the rest of the buffer.
+            bufferPos_ = buffer_.size();
+        }
+        // Otherwise the signature may be split across containers. The tail
+        // is kept and searched again after the next container is appended.
+
+        if (size == 0)
+        {
+            // Incomplete or no object left. Append the next container.
+            if (!nextContainer())
+                return false;
+            continue;
+        }
+
+        bufferPos_ += size;
+        if (found)
+            return true;
+    }
+}
+
+BlfWriter::BlfWriter(const std::filesystem::path & path, int compressionLevel)
+    : out_(path), compressionLevel_(compressionLevel)
+{
+    // Reserve the header. It is rewritten with the final sizes on close.
+    std::vector<uint8_t> header(FileHeaderSize, 0);
+    out_.write(header.data(), header.size());
+    container_.reserve(MaxContainerSize + 64);
+}
+
+BlfWriter::~BlfWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+void BlfWriter::write(const CanLogEntry & entry)
+{
+    if (!started_)
+    {
+        started_ = true;
+        start_ = entry.time;
+    }
+    stop_ = entry.time;
+
+    constexpr uint32_t objectSize = ObjectHeaderBaseSize + ObjectHeaderV1Size + 16;
+    ByteWriter writer(container_);
+    writer.write(ObjectMagic);
+    writer.write(static_cast<uint16_t>(ObjectHeaderBaseSize + ObjectHeaderV1Size));
+    writer.write(static_cast<uint16_t>(1));
+    writer.write(objectSize);
+    writer.write(static_cast<uint32_t>(CanMessageObject));
+
+    writer.write(TimeOneNanos);
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(static_cast<uint64_t>(std::max<int64_t>((entry.time - start_).count(), 0)) * 1000);
+
+    uint32_t id = entry.message.id();
+    writer.write(static_cast<uint16_t>(1));
+    writer.write(static_cast<uint8_t>(entry.direction == CanMessageDirection::Outbound ? DirectionTx : 0));
+    writer.write(entry.message.length());
+    writer.write(entry.message.extended() ? id | ExtendedId : id);
+    std::array<uint8_t, 8> data{};
+    std::copy(entry.message.message(), entry.message.message() + entry.message.length(), data.begin());
+    writer.write(data.data(), data.size());
+
+    ++objectCount_;
+    if (container_.size() >= MaxContainerSize)
+        flushContainer();
+}
+
+void BlfWriter::flushContainer()
+{
+    if (container_.empty())
+        return;
+
+    compressed_.resize(compressBound(static_cast<uLong>(container_.size())));
+    uLongf compressedSize = static_cast<uLongf>(compressed_.size());
+    if (compress2(compressed_.data(), &compressedSize, container_.data(), static_cast<uLong>(container_.size()),
+                  compressionLevel_) != Z_OK)
+        throw std::runtime_error("failed to compress BLF container");
+
+    auto objectSize = static_cast<uint32_t>(ObjectHeaderBaseSize + ContainerHeaderSize + compressedSize);
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.write(ObjectMagic);
+    writer.write(static_cast<uint16_t>(ObjectHeaderBaseSize));
+    writer.write(static_cast<uint16_t>(1));
+    writer.write(objectSize);
+    writer.write(static_cast<uint32_t>(LogContainerObject));
+    writer.write(static_cast<uint16_t>(Zlib));
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(static_cast<uint32_t>(0));
+    writer.write(static_cast<uint32_t>(container_.size()));
+    writer.write(static_cast<uint32_t>(0));
+
+    out_.write(header.data(), header.size());
+    out_.write(compressed_.data(), compressedSize);
+    uint32_t padding = 0;
+    out_.write(&padding, objectSize % 4);
+
+    uncompressedSize_ += ObjectHeaderBaseSize + ContainerHeaderSize + container_.size();
+    container_.clear();
+}
+
+void BlfWriter::writeHeader()
+{
+    std::time_t now = std::time(nullptr);
+    std::time_t start = now - static_cast<std::time_t>((stop_ - start_).count() / 1000000);
+
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.write(FileMagic);
+    writer.write(static_cast<uint32_t>(FileHeaderSize));
+    // Application id, application version and BLF version 2.6.8.1
+    const uint8_t versions[8] = {5, 0, 0, 0, 2, 6, 8, 1};
+    writer.write(versions, sizeof(versions));
+    writer.write(static_cast<uint64_t>(out_.position()));
+    writer.write(uncompressedSize_);
+    writer.write(objectCount_);
+    writer.write(static_cast<uint32_t>(0));
+    writeSystemTime(writer, start);
+    writeSystemTime(writer, now);
+    header.resize(FileHeaderSize, 0);
+
+    out_.overwrite(0, header.data(), header.size());
+}
+
+void BlfWriter::close()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+    flushContainer();
+    out_.flush();
+    writeHeader();
+    out_.close();
+}
+
+} // namespace lt::network
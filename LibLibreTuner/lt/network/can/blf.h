@@ -0,0 +1,98 @@
+#ifndef LT_BLF_H
+#define LT_BLF_H
+
+#include "../../os/mappedfile.h"
+#include "tracefile.h"
+
+namespace lt::network
+{
+
+// Vector binary logging format
+namespace blf
+{
+constexpr std::size_t FileHeaderSize = 144;
+constexpr std::size_t ObjectHeaderBaseSize = 16;
+constexpr std::size_t ObjectHeaderV1Size = 16;
+constexpr std::size_t ObjectHeaderV2Size = 24;
+constexpr std::size_t ContainerHeaderSize = 16;
+// Uncompressed size of containers written by BlfWriter
+constexpr std::size_t MaxContainerSize = 128 * 1024;
+
+enum ObjectType : uint32_t
+{
+    CanMessageObject = 1,
+    LogContainerObject = 10,
+    CanMessage2Object = 86,
+};
+
+enum Compression : uint16_t
+{
+    None = 0,
+    Zlib = 2,
+};
+
+// Object header flags
+constexpr uint32_t TimeTenMicros = 1;
+constexpr uint32_t TimeOneNanos = 2;
+
+// CAN message flags
+constexpr uint8_t DirectionTx = 1;
+constexpr uint8_t Remote = 0x80;
+constexpr uint32_t ExtendedId = 0x80000000;
+} // namespace blf
+
+// Reads CAN frames from BLF files. Containers are decompressed one at a
+// time into a reused buffer.
+class BlfReader : public TraceReader
+{
+public:
+    explicit BlfReader(const std::filesystem::path & path);
+
+    bool next(CanLogEntry & entry) override;
+
+private:
+    os::MappedFile file_;
+    // Position of the next top-level object
+    std::size_t pos_{0};
+
+    // Decompressed objects. Objects can span containers, so the unread tail
+    // is kept when the next container is appended.
+    std::vector<uint8_t> buffer_;
+    std::size_t bufferPos_{0};
+    std::vector<uint8_t> scratch_;
+
+    // Parses the object at `data`. Returns the object size, or 0 if the
+    // object is incomplete.
+    std::size_t parseObject(const uint8_t * data, std::size_t size, CanLogEntry & entry, bool & found) const;
+    bool nextContainer();
+};
+
+// Writes zlib compressed BLF files
+class BlfWriter : public TraceWriter
+{
+public:
+    explicit BlfWriter(const std::filesystem::path & path, int compressionLevel = 6);
+    ~BlfWriter() override;
+
+    void write(const CanLogEntry & entry) override;
+    void close() override;
+
+private:
+    detail::TraceOutput out_;
+    int compressionLevel_;
+    std::vector<uint8_t> container_;
+    std::vector<uint8_t> compressed_;
+    uint64_t uncompressedSize_{blf::FileHeaderSize};
+    uint32_t objectCount_{0};
+    bool started_{false};
+    bool closed_{false};
+    std::chrono::microseconds start_{0};
+    std::chrono::microseconds stop_{0};
+
+    void flushContainer();
+    void writeHeader();
+};
+
+} // namespace lt::network
+
+#endif // LT_BLF_H
@@ -1,5 +1,7 @@
 #include "can.h"
 
+#include "../../os/iocontext.h"
+
 #include <cassert>
 
 namespace lt
@@ -15,6 +17,19 @@ void Can::send(uint32_t id, const uint8_t * data, size_t length)
     return send(CanMessage(id, data, static_cast<uint8_t>(length)));
 }
 
+void Can::sendBatch(const CanMessage * messages, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        send(messages[i]);
+}
+
+Task<bool> Can::recvAsync(CanMessage & message,
+                          std::chrono::milliseconds timeout)
+{
+    co_return co_await os::offload(
+        [this, &message, timeout]() { return recv(message, timeout); });
+}
+
 CanMessage::CanMessage(uint32_t id, const uint8_t * message, uint8_t length)
 {
     setMessage(id, message, length);
@@ -2,12 +2,15 @@
 #define CAN_H
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <memory>
 #include <queue>
 
+#include "../../support/task.h"
+
 namespace lt
 {
 namespace network
@@ -23,6 +26,7 @@ enum class CanError
 
 // Constants
 constexpr std::size_t max_can_id = (1 << 30) - 1;
+constexpr uint32_t max_standard_can_id = 0x7FF;
 
 class CanMessage
 {
@@ -32,12 +36,19 @@ public:
 
     inline uint32_t id() const noexcept { return id_; }
 
+    // Also marks ids that do not fit in 11 bits as extended
     inline void setId(uint32_t id) noexcept
     {
         assert(id <= max_can_id);
         id_ = id;
+        extended_ = id > max_standard_can_id;
     }
 
+    // True if the frame uses a 29-bit identifier. Short ids can be sent in
+    // either format, so readers that know the format set this after the id.
+    inline bool extended() const noexcept { return extended_; }
+    inline void setExtended(bool extended) noexcept { extended_ = extended || id_ > max_standard_can_id; }
+
     inline const uint8_t * message() const noexcept { return message_.data(); }
     inline uint8_t * message() noexcept { return message_.data(); }
 
@@ -74,6 +85,7 @@ public:
 private:
     std::array<uint8_t, 8> message_{0};
     uint8_t length_;
+    bool extended_{false};
     uint32_t id_ = 0;
 };
 
@@ -82,18 +94,19 @@ class CanMessageBuffer
 public:
     CanMessageBuffer(std::size_t limit = 2048) : limit_(limit) {}
 
+    // Drops the oldest message if the buffer is full
     void add(const CanMessage & message)
     {
         buffer_.emplace(message);
         if (buffer_.size() > limit_)
-            buffer_.pop();
+            dropOldest();
     }
 
     void add(CanMessage && message)
     {
         buffer_.emplace(std::move(message));
         if (buffer_.size() > limit_)
-            buffer_.pop();
+            dropOldest();
     }
 
     bool pop(CanMessage & message)
@@ -109,9 +122,20 @@ public:
 
     void clear() { buffer_ = std::queue<CanMessage>(); }
 
+    // Number of messages dropped since construction. May be read from any
+    // thread.
+    inline uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
 private:
+    void dropOldest()
+    {
+        buffer_.pop();
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
     std::queue<CanMessage> buffer_;
     std::size_t limit_{20};
+    std::atomic<uint64_t> dropped_{0};
 };
 
 class Can
@@ -127,11 +151,26 @@ public:
 
     virtual void send(const CanMessage & message) = 0;
 
+    // Sends `count` messages in order. Interfaces that can queue several
+    // messages in one call override this; the default sends them one at a
+    // time.
+    virtual void sendBatch(const CanMessage * messages, std::size_t count);
+
     // Returns false if the timeout expired and no message was read
     virtual bool recv(CanMessage & message,
                       std::chrono::milliseconds timeout) = 0;
 
+    // Same as recv() without blocking the calling thread. The default
+    // implementation runs recv() on the blocking pool, which holds a
+    // thread until it returns.
+    virtual Task<bool> recvAsync(CanMessage & message,
+                                 std::chrono::milliseconds timeout);
+
     virtual void clearBuffer() noexcept {}
+
+    // Number of received messages discarded because the receive buffer was
+    // full. Interfaces without a receive buffer return 0.
+    virtual uint64_t dropped() const noexcept { return 0; }
 };
 
 using CanPtr = std::unique_ptr<Can>;
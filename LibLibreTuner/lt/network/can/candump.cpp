@@ -0,0 +1,126 @@
+#include "candump.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+#include "../../support/hex.h"
+
+namespace lt::network
+{
+
+CandumpReader::CandumpReader(const std::filesystem::path & path, std::vector<uint32_t> outboundIds)
+    : file_(path), scanner_(reinterpret_cast<const char *>(file_.begin()), reinterpret_cast<const char *>(file_.end())),
+      outboundIds_(std::move(outboundIds))
+{
+}
+
+CandumpReader::CandumpReader(std::string_view text, std::vector<uint32_t> outboundIds)
+    : scanner_(text.data(), text.data() + text.size()), outboundIds_(std::move(outboundIds))
+{
+}
+
+bool CandumpReader::next(CanLogEntry & entry)
+{
+    std::string_view line;
+    while (scanner_.next(line))
+    {
+        // (seconds.micros) interface id#data
+        std::string_view rest = line;
+        std::string_view stamp = detail::nextToken(rest);
+        if (stamp.empty() || stamp.front() == '#')
+            continue;
+
+        auto fail = [this](const char * what) {
+            throw std::runtime_error("candump line " + std::to_string(scanner_.lineNumber()) + ": " + what);
+        };
+
+        if (stamp.size() < 3 || stamp.front() != '(' || stamp.back() != ')' ||
+            !detail::parseSeconds(stamp.substr(1, stamp.size() - 2), entry.time))
+            fail("invalid timestamp");
+
+        detail::nextToken(rest);
+        std::string_view frame = detail::nextToken(rest);
+        auto hash = frame.find('#');
+        if (hash == std::string_view::npos)
+            fail("missing '#' in frame");
+
+        uint32_t id = 0;
+        if (!hex::parse(frame.substr(0, hash), id) || id > max_can_id)
+            fail("invalid id");
+
+        std::string_view data = frame.substr(hash + 1);
+        if (!data.empty() && (data.front() == '#' || data.front() == 'R' || data.front() == 'r'))
+            continue;
+
+        uint8_t bytes[8];
+        int length = hex::decode(data, bytes, sizeof(bytes));
+        if (length < 0)
+            fail("invalid data");
+
+        entry.message.setMessage(id, bytes, static_cast<uint8_t>(length));
+        // candump writes extended ids with 8 digits
+        entry.message.setExtended(hash > 3);
+        entry.direction = std::find(outboundIds_.begin(), outboundIds_.end(), id) != outboundIds_.end()
+                              ? CanMessageDirection::Outbound
+                              : CanMessageDirection::Inbound;
+        return true;
+    }
+    return false;
+}
+
+CandumpWriter::CandumpWriter(const std::filesystem::path & path, std::string interface)
+    : out_(path), interface_(std::move(interface))
+{
+}
+
+CandumpWriter::~CandumpWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+void CandumpWriter::write(const CanLogEntry & entry)
+{
+    char * begin = out_.reserve(64 + interface_.size());
+    char * out = begin;
+
+    auto micros = static_cast<uint64_t>(std::max<int64_t>(entry.time.count(), 0));
+    *out++ = '(';
+    out = std::to_chars(out, out + 20, micros / 1000000).ptr;
+    *out++ = '.';
+    uint64_t fraction = micros % 1000000;
+    for (int i = 5; i >= 0; --i)
+    {
+        out[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    out += 6;
+    *out++ = ')';
+    *out++ = ' ';
+    out = std::copy(interface_.begin(), interface_.end(), out);
+    *out++ = ' ';
+
+    uint32_t id = entry.message.id();
+    out = entry.message.extended() ? hex::writeNumber(out, id, 8) : hex::writeNumber(out, id, 3);
+    *out++ = '#';
+    out = hex::encode(out, entry.message.message(), entry.message.length());
+    *out++ = '\n';
+
+    out_.commit(static_cast<std::size_t>(out - begin));
+}
+
+void CandumpWriter::close()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+    out_.close();
+}
+
+} // namespace lt::network
@@ -0,0 +1,48 @@
+#ifndef LT_CANDUMP_H
+#define LT_CANDUMP_H
+
+#include <string>
+
+#include "../../os/mappedfile.h"
+#include "tracefile.h"
+
+namespace lt::network
+{
+
+// Reads `candump -L` logs. candump does not record direction, so frames
+// whose id is in `outboundIds` are marked outbound. Remote and CAN FD
+// frames are skipped.
+class CandumpReader : public TraceReader
+{
+public:
+    explicit CandumpReader(const std::filesystem::path & path,
+                           std::vector<uint32_t> outboundIds = defaultOutboundIds);
+    // Reads from memory. The text must outlive the reader.
+    explicit CandumpReader(std::string_view text, std::vector<uint32_t> outboundIds = defaultOutboundIds);
+
+    bool next(CanLogEntry & entry) override;
+
+private:
+    os::MappedFile file_;
+    detail::LineScanner scanner_;
+    std::vector<uint32_t> outboundIds_;
+};
+
+class CandumpWriter : public TraceWriter
+{
+public:
+    explicit CandumpWriter(const std::filesystem::path & path, std::string interface = "can0");
+    ~CandumpWriter() override;
+
+    void write(const CanLogEntry & entry) override;
+    void close() override;
+
+private:
+    detail::TraceOutput out_;
+    std::string interface_;
+    bool closed_{false};
+};
+
+} // namespace lt::network
+
+#endif // LT_CANDUMP_H
@@ -1,5 +1,209 @@
-//
-// Created by Jacob on 4/9/2019.
-//
-
 #include "canlog.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../../support/bytestream.h"
+
+namespace lt::network
+{
+
+using namespace canlogfile;
+
+CanLog::CanLog(std::size_t capacity, std::chrono::milliseconds notifyInterval)
+    : ring_(std::max<std::size_t>(capacity, 1)), notifyInterval_(notifyInterval)
+{
+    notifier_ = std::thread([this]() { runNotifier(); });
+}
+
+CanLog::~CanLog()
+{
+    {
+        std::lock_guard lock(notifyMutex_);
+        stop_ = true;
+    }
+    notifyCv_.notify_one();
+    notifier_.join();
+}
+
+void CanLog::add(const CanLogEntry & entry)
+{
+    {
+        std::lock_guard lock(mutex_);
+        uint64_t sequence = total_;
+        ring_[sequence % ring_.size()] = entry;
+        if (spill_)
+            writeSpill(entry);
+
+        total_ = sequence + 1;
+        if (total_ - ringBegin_ > ring_.size())
+            ringBegin_ = total_ - ring_.size();
+    }
+
+    // Only wake the notifier if it is idle. Otherwise it picks up the entry
+    // with the current batch.
+    if (notifierWaiting_)
+    {
+        std::lock_guard lock(notifyMutex_);
+        notifyCv_.notify_one();
+    }
+}
+
+void CanLog::runNotifier()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(notifyMutex_);
+            notifierWaiting_ = true;
+            notifyCv_.wait(lock, [this]() { return stop_ || total_ > published_; });
+            notifierWaiting_ = false;
+            if (stop_)
+                return;
+
+            // Let more entries arrive so they are delivered together
+            if (notifyCv_.wait_for(lock, notifyInterval_, [this]() { return stop_; }))
+                return;
+        }
+
+        uint64_t first = published_;
+        uint64_t end = total_;
+        published_ = end;
+        if (end > first)
+            addEvent_(first, static_cast<std::size_t>(end - first));
+    }
+}
+
+std::size_t CanLog::size() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return static_cast<std::size_t>(total_ - ringBegin_);
+}
+
+uint64_t CanLog::total() const noexcept { return total_; }
+
+uint64_t CanLog::firstSequence() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    if (spill_)
+        return std::min(spillBegin_, ringBegin_);
+    return ringBegin_;
+}
+
+bool CanLog::get(uint64_t sequence, CanLogEntry & entry) const
+{
+    std::lock_guard lock(mutex_);
+    if (sequence >= total_)
+        return false;
+    if (sequence >= ringBegin_)
+    {
+        entry = ring_[sequence % ring_.size()];
+        return true;
+    }
+    return readSpill(sequence, entry);
+}
+
+std::vector<CanLogEntry> CanLog::entries(uint64_t first, std::size_t count) const
+{
+    std::vector<CanLogEntry> result;
+    entries(first, count, result);
+    return result;
+}
+
+uint64_t CanLog::entries(uint64_t first, std::size_t count, std::vector<CanLogEntry> & out) const
+{
+    std::lock_guard lock(mutex_);
+    out.clear();
+
+    uint64_t begin = spill_ ? std::min(spillBegin_, ringBegin_) : ringBegin_;
+    first = std::max(first, begin);
+    uint64_t end = std::min<uint64_t>(total_, first + count);
+    if (first >= end)
+        return first;
+
+    out.resize(static_cast<std::size_t>(end - first));
+    for (uint64_t sequence = first; sequence < end; ++sequence)
+    {
+        CanLogEntry & entry = out[static_cast<std::size_t>(sequence - first)];
+        if (sequence >= ringBegin_)
+            entry = ring_[sequence % ring_.size()];
+        else
+            readSpill(sequence, entry);
+    }
+    return first;
+}
+
+std::vector<CanLogEntry> CanLog::snapshot() const
+{
+    return entries(0, static_cast<std::size_t>(total()));
+}
+
+void CanLog::clear()
+{
+    std::lock_guard lock(mutex_);
+    ringBegin_ = total_;
+    spillBegin_ = total_;
+    if (spill_)
+    {
+        spill_->resize(HeaderSize);
+        std::memset(spill_->data() + 8, 0, 8);
+    }
+}
+
+void CanLog::setSpillFile(const std::filesystem::path & path)
+{
+    auto spill = std::make_unique<os::WritableMappedFile>(path, HeaderSize + RecordSize * ring_.size());
+    spill->resize(HeaderSize);
+
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.write(Magic);
+    writer.write(Version);
+    writer.write(static_cast<uint16_t>(RecordSize));
+    writer.write(static_cast<uint64_t>(0));
+    std::memcpy(spill->data(), header.data(), header.size());
+
+    std::lock_guard lock(mutex_);
+    spill_ = std::move(spill);
+    spillBegin_ = total_;
+}
+
+void CanLog::writeSpill(const CanLogEntry & entry)
+{
+    const uint64_t index = total_ - spillBegin_;
+    const std::size_t offset = HeaderSize + static_cast<std::size_t>(index) * RecordSize;
+    spill_->resize(offset + RecordSize);
+
+    uint8_t * record = spill_->data() + offset;
+    uint64_t time = endian::toLittle(static_cast<uint64_t>(entry.time.count()));
+    uint32_t id = entry.message.id();
+    if (entry.direction == CanMessageDirection::Outbound)
+        id |= OutboundFlag;
+    id = endian::toLittle(id);
+
+    std::memcpy(record, &time, 8);
+    std::memcpy(record + 8, &id, 4);
+    record[12] = entry.message.length();
+    record[13] = entry.message.extended() ? ExtendedFlag : 0;
+    std::memset(record + 14, 0, 2);
+    std::memcpy(record + 16, entry.message.message(), 8);
+
+    uint64_t count = endian::toLittle(index + 1);
+    std::memcpy(spill_->data() + 8, &count, 8);
+}
+
+bool CanLog::readSpill(uint64_t sequence, CanLogEntry & entry) const
+{
+    if (!spill_ || sequence < spillBegin_)
+        return false;
+
+    const uint8_t * record = spill_->data() + HeaderSize + static_cast<std::size_t>(sequence - spillBegin_) * RecordSize;
+    uint32_t id = loadLittle<uint32_t>(record + 8);
+    entry.time = std::chrono::microseconds(loadLittle<uint64_t>(record));
+    entry.direction = (id & OutboundFlag) != 0 ? CanMessageDirection::Outbound : CanMessageDirection::Inbound;
+    entry.message.setMessage(id & ~OutboundFlag, record + 16, std::min<uint8_t>(record[12], 8));
+    entry.message.setExtended((record[13] & ExtendedFlag) != 0);
+    return true;
+}
+
+} // namespace lt::network
@@ -1,10 +1,17 @@
 #ifndef LT_CANLOG_H
 #define LT_CANLOG_H
 
+#include "../../os/mappedfile.h"
 #include "../../support/event.h"
 #include "can.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace lt::network
@@ -20,32 +27,121 @@ struct CanLogEntry
 {
     CanMessageDirection direction;
     CanMessage message;
+    // Time since an arbitrary epoch. Only differences between entries are
+    // meaningful.
+    std::chrono::microseconds time{0};
 };
 
-#if defined(_MSC_VER)
-#pragma warning(push)
-#pragma warning(disable : 4099)
-#endif
-
-struct CanLog
+// Returns the current time for log entries
+inline std::chrono::microseconds canLogTime() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+}
+
+/* Spill file layout (little endian):
+ *   Header  "LTCL" u16 version, u16 record size, u64 record count
+ *   Record  u64 time (us), u32 id (bit 31 set if outbound), u8 length,
+ *           u8 flags (bit 0 set if the id is extended), u8[2] reserved,
+ *           u8[8] data */
+namespace canlogfile
 {
-    std::vector<CanLogEntry> messages_;
+constexpr uint32_t Magic = 0x4C43544C; // "LTCL"
+constexpr uint16_t Version = 1;
+constexpr std::size_t HeaderSize = 16;
+constexpr std::size_t RecordSize = 24;
+constexpr uint32_t OutboundFlag = 1u << 31;
+constexpr uint8_t ExtendedFlag = 1;
+} // namespace canlogfile
+
+// Log of CAN frames. The most recent entries are kept in a fixed-size
+// ring; older entries are dropped unless a spill file is set. Every entry
+// has a sequence number, starting at 0, that does not change when older
+// entries are dropped.
+//
+// Listeners are notified in batches from a background thread, so adding
+// an entry never waits on a listener.
+class CanLog
+{
+public:
+    // Called with the first sequence number and the count of new entries
+    using AddEvent = Event<uint64_t, std::size_t>;
+    using AddConnectionPtr = AddEvent::ConnectionPtr;
+
+    static constexpr std::size_t DefaultCapacity = 1 << 16;
+
+    explicit CanLog(std::size_t capacity = DefaultCapacity,
+                    std::chrono::milliseconds notifyInterval = std::chrono::milliseconds(20));
+    ~CanLog();
+
+    CanLog(const CanLog &) = delete;
+    CanLog & operator=(const CanLog &) = delete;
+
+    void add(const CanLogEntry & entry);
+
+    // Number of entries in memory
+    std::size_t size() const noexcept;
+    inline std::size_t capacity() const noexcept { return ring_.size(); }
+
+    // Number of entries ever added. Also the sequence number of the next
+    // entry.
+    uint64_t total() const noexcept;
+
+    // Sequence number of the oldest entry that can still be read, from
+    // memory or the spill file
+    uint64_t firstSequence() const noexcept;
+
+    // Reads an entry. Returns false if it has been dropped.
+    bool get(uint64_t sequence, CanLogEntry & entry) const;
+
+    // Returns up to `count` readable entries starting at `first`
+    std::vector<CanLogEntry> entries(uint64_t first, std::size_t count) const;
+    // Same as above, but reuses `out`. Returns the sequence number of the
+    // first entry read.
+    uint64_t entries(uint64_t first, std::size_t count, std::vector<CanLogEntry> & out) const;
 
-    inline std::size_t size() const noexcept { return messages_.size(); }
+    // Returns every readable entry
+    std::vector<CanLogEntry> snapshot() const;
 
-    template <typename T> inline void emplace_back(T && t)
+    // Writes every entry added from now on to a memory mapped file, so
+    // entries dropped from the ring can still be read. Throws an exception
+    // if the file cannot be created.
+    void setSpillFile(const std::filesystem::path & path);
+
+    // Removes all entries. Sequence numbers keep increasing.
+    void clear();
+
+    // Connects a listener. The callback runs on the notifier thread.
+    template <typename Func> AddConnectionPtr onAdd(Func && func)
     {
-        messages_.emplace_back(std::forward<T>(t));
-        eventAdded(messages_.back());
+        return addEvent_.connect(std::forward<Func>(func));
     }
 
-    Event<CanLogEntry &> eventAdded;
+private:
+    std::vector<CanLogEntry> ring_;
+    std::atomic<uint64_t> total_{0};
+    // Sequence number of the oldest entry in the ring
+    uint64_t ringBegin_{0};
+
+    std::unique_ptr<os::WritableMappedFile> spill_;
+    uint64_t spillBegin_{0};
+
+    mutable std::mutex mutex_;
+
+    // Notification
+    AddEvent addEvent_;
+    std::chrono::milliseconds notifyInterval_;
+    std::atomic<uint64_t> published_{0};
+    std::atomic<bool> notifierWaiting_{false};
+    std::mutex notifyMutex_;
+    std::condition_variable notifyCv_;
+    bool stop_{false};
+    std::thread notifier_;
+
+    void runNotifier();
+    void writeSpill(const CanLogEntry & entry);
+    bool readSpill(uint64_t sequence, CanLogEntry & entry) const;
 };
-
-#if defined(_MSC_VER)
-#pragma warning(pop)
-#endif
-
 using CanLogPtr = std::shared_ptr<CanLog>;
 
 // Proxies a CAN interface and logs all sent and received messages
@@ -65,8 +161,8 @@ public:
         can_->send(message);
         if (log_)
         {
-            log_->emplace_back(
-                CanLogEntry{CanMessageDirection::Outbound, message});
+            log_->add(CanLogEntry{CanMessageDirection::Outbound, message,
+                                  canLogTime()});
         }
     }
 
@@ -75,14 +171,28 @@ public:
         bool res = can_->recv(message, timeout);
         if (res && log_)
         {
-            log_->emplace_back(
-                CanLogEntry{CanMessageDirection::Inbound, message});
+            log_->add(CanLogEntry{CanMessageDirection::Inbound, message,
+                                  canLogTime()});
         }
         return res;
     }
 
+    Task<bool> recvAsync(CanMessage & message,
+                         std::chrono::milliseconds timeout) override
+    {
+        bool res = co_await can_->recvAsync(message, timeout);
+        if (res && log_)
+        {
+            log_->add(CanLogEntry{CanMessageDirection::Inbound, message,
+                                  canLogTime()});
+        }
+        co_return res;
+    }
+
     void clearBuffer() noexcept override { can_->clearBuffer(); }
 
+    uint64_t dropped() const noexcept override { return can_->dropped(); }
+
 private:
     CanPtr can_;
     CanLogPtr log_;
@@ -18,9 +18,10 @@
 
 #include "j2534can.h"
 
+#include "../../support/trace.h"
+
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <stdexcept>
 
 namespace lt
 {
@@ -28,7 +29,8 @@ namespace network
 {
 
 J2534Can::J2534Can(const j2534::DevicePtr & device, uint32_t baudrate)
-    : channel_(device->connect(j2534::Protocol::CAN, CAN_ID_BOTH, baudrate))
+    : channel_(device->connect(j2534::Protocol::CAN, CAN_ID_BOTH, baudrate)),
+      rxMsgs_(batchSize), txMsgs_(batchSize)
 {
     // Setup the filter
     j2534::PASSTHRU_MSG msgMask{};
@@ -47,43 +49,82 @@ J2534Can::J2534Can(const j2534::DevicePtr & device, uint32_t baudrate)
 
     uint32_t msgId;
     channel_.startMsgFilter(PASS_FILTER, &msgMask, &msgPattern, nullptr, msgId);
+
+    for (j2534::PASSTHRU_MSG & msg : txMsgs_)
+    {
+        msg.ProtocolID = static_cast<uint32_t>(j2534::Protocol::CAN);
+        msg.TxFlags = 0;
+    }
 }
 
 J2534Can::~J2534Can() = default;
 
-void J2534Can::send(const CanMessage & message)
+void J2534Can::send(const CanMessage & message) { sendBatch(&message, 1); }
+
+void J2534Can::sendBatch(const CanMessage * messages, std::size_t count)
 {
-    j2534::PASSTHRU_MSG msg{};
-    msg.ProtocolID = static_cast<uint32_t>(j2534::Protocol::CAN);
-    msg.TxFlags = 0;
-
-    // Add the CAN ID
-    uint32_t id = message.id();
-    msg.Data[0] = static_cast<unsigned char>( (id & 0xFF000000U) >> 24U );
-    msg.Data[1] = static_cast<unsigned char>( (id & 0xFF0000U) >> 16U );
-    msg.Data[2] = static_cast<unsigned char>( (id & 0xFF00U) >> 8U );
-    msg.Data[3] = static_cast<unsigned char>( id & 0xFFU );
-    std::copy(message.message(), message.message() + message.length(), msg.Data + 4);
-    // Message length + CAN ID length
-    msg.DataSize = message.length() + 4;
-
-    uint32_t numMsgs = 1;
-    // TODO: Configurable timeout (100ms should be good for now, right?)
-    if (message.id() == 0x7e0)
+    while (count != 0)
     {
-        std::ofstream file("j2534_out.txt", std::ios::app);
-        file << "[" << std::hex << message.id() << "] ->";
-        for (int i = 0; i < message.length(); ++i)
+        std::size_t amount = std::min(count, txMsgs_.size());
+        for (std::size_t i = 0; i < amount; ++i)
         {
-            file << std::hex << " " << static_cast<uint32_t>(message[i]);
+            const CanMessage & message = messages[i];
+            j2534::PASSTHRU_MSG & msg = txMsgs_[i];
+
+            // Add the CAN ID
+            uint32_t id = message.id();
+            msg.Data[0] = static_cast<unsigned char>( (id & 0xFF000000U) >> 24U );
+            msg.Data[1] = static_cast<unsigned char>( (id & 0xFF0000U) >> 16U );
+            msg.Data[2] = static_cast<unsigned char>( (id & 0xFF00U) >> 8U );
+            msg.Data[3] = static_cast<unsigned char>( id & 0xFFU );
+            std::copy(message.message(), message.message() + message.length(), msg.Data + 4);
+            // Message length + CAN ID length
+            msg.DataSize = message.length() + 4;
+            msg.TxFlags = message.extended() ? CAN_29BIT_ID : 0;
         }
-        file << "\n";
-        file.close();
+
+        uint32_t numMsgs = static_cast<uint32_t>(amount);
+        // TODO: Configurable timeout (100ms should be good for now, right?)
+        channel_.writeMsgs(txMsgs_.data(), numMsgs, 100);
+        if (numMsgs != amount)
+        {
+            throw std::runtime_error("Message write timed out");
+        }
+        messages += amount;
+        count -= amount;
+    }
+}
+
+void J2534Can::fill(uint32_t timeout)
+{
+    LT_TRACE_SPAN("j2534can.read");
+    // Drain what is queued without blocking. A blocking read only returns
+    // early once the whole batch has arrived, so it is only used for a
+    // single message.
+    uint32_t pNumMsgs = static_cast<uint32_t>(rxMsgs_.size());
+    channel_.readMsgs(rxMsgs_.data(), pNumMsgs, 0);
+    if (pNumMsgs == 0 && timeout != 0)
+    {
+        pNumMsgs = 1;
+        channel_.readMsgs(rxMsgs_.data(), pNumMsgs, timeout);
     }
-    channel_.writeMsgs(&msg, numMsgs, 100);
-    if (numMsgs != 1)
+    LT_TRACE_COUNTER("j2534can.messages", pNumMsgs);
+
+    // Fill buffer
+    for (std::size_t i = 0; i < pNumMsgs; ++i)
     {
-        throw std::runtime_error("Message write timed out");
+        j2534::PASSTHRU_MSG & msg = rxMsgs_[i];
+        if (msg.DataSize < 4)
+        {
+            // The message does not fit the CAN ID
+            continue;
+        }
+        uint32_t id = (msg.Data[0] << 24U) | (msg.Data[1] << 16U) | (msg.Data[2] << 8U) | (msg.Data[3]);
+
+        CanMessage can_msg;
+        can_msg.setMessage(id, msg.Data + 4, static_cast<uint8_t>(std::min<uint32_t>(msg.DataSize - 4, 8)));
+        can_msg.setExtended((msg.RxStatus & CAN_29BIT_ID) != 0);
+        buffer_.add(can_msg);
     }
 }
 
@@ -92,49 +133,16 @@ bool J2534Can::recv(CanMessage & message, std::chrono::milliseconds timeout)
     if (buffer_.pop(message))
         return true;
 
-    auto start = std::chrono::system_clock::now();
+    auto deadline = std::chrono::steady_clock::now() + timeout;
     while (true)
     {
-        if ((std::chrono::system_clock::now() - start) >= timeout)
-            return false;
-
-        std::array<j2534::PASSTHRU_MSG, 1> msgs{};
-        for (auto & msg : msgs)
-        {
-            msg.ProtocolID = static_cast<uint32_t>(j2534::Protocol::CAN);
-        }
-
-        uint32_t pNumMsgs = msgs.size();
-        channel_.readMsgs(msgs.data(), pNumMsgs, static_cast<uint32_t>(timeout.count()));
-
-        // Fill buffer
-        for (std::size_t i = 0; i < pNumMsgs; ++i)
-        {
-            j2534::PASSTHRU_MSG & msg = msgs[i];
-            if (msg.DataSize < 4)
-            {
-                // The message does not fit the CAN ID
-                continue;
-            }
-            uint32_t id = (msg.Data[0] << 24U) | (msg.Data[1] << 16U) | (msg.Data[2] << 8U) | (msg.Data[3]);
-
-            CanMessage can_msg;
-            can_msg.setMessage(id, msg.Data + 4, static_cast<uint8_t>(msg.DataSize - 4));
-            if (can_msg.id() == 0x7e8 || can_msg.id() == 0x7e0)
-            {
-                std::ofstream file("j2534_out.txt", std::ios::app);
-                file << "[" << std::hex << can_msg.id() << "] <-";
-                for (int j = 0; j < can_msg.length(); ++j)
-                {
-                    file << std::hex << " " << static_cast<uint32_t>(can_msg[j]);
-                }
-                file << "\n";
-                file.close();
-            }
-            buffer_.add(can_msg);
-        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        fill(static_cast<uint32_t>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0)));
         if (buffer_.pop(message))
             return true;
+        if (remaining.count() <= 0)
+            return false;
     }
 }
 
@@ -19,9 +19,8 @@
 #ifndef J2534CANINTERFACE_H
 #define J2534CANINTERFACE_H
 
-#include <atomic>
 #include <memory>
-#include <thread>
+#include <vector>
 
 #include "can.h"
 #include "j2534/j2534.h"
@@ -42,14 +41,31 @@ public:
     // Can interface
 public:
     virtual void send(const CanMessage & message) override;
+    // Writes up to `batchSize` messages per PassThruWriteMsgs call
+    virtual void sendBatch(const CanMessage * messages,
+                           std::size_t count) override;
     // Returns true if a message was received before the timeout
     virtual bool recv(CanMessage & message,
                       std::chrono::milliseconds timeout) override;
 
+    uint64_t dropped() const noexcept override { return buffer_.dropped(); }
+
+    // Messages read or written per PassThru call
+    static constexpr std::size_t batchSize = 64;
+
 private:
     j2534::Channel channel_;
 
     CanMessageBuffer buffer_;
+
+    // Preallocated message arrays. PASSTHRU_MSG is over 4 KiB, so these are
+    // not rebuilt for every call.
+    std::vector<j2534::PASSTHRU_MSG> rxMsgs_;
+    std::vector<j2534::PASSTHRU_MSG> txMsgs_;
+
+    // Moves every message queued on the device into buffer_. If none were
+    // queued, waits up to `timeout` for one.
+    void fill(uint32_t timeout);
 };
 
 } // namespace network
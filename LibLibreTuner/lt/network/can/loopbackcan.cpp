@@ -0,0 +1,41 @@
+#include "loopbackcan.h"
+
+namespace lt::network
+{
+
+std::pair<std::unique_ptr<LoopbackCan>, std::unique_ptr<LoopbackCan>> LoopbackCan::createPair()
+{
+    auto bus = std::make_shared<Bus>();
+    return {std::unique_ptr<LoopbackCan>(new LoopbackCan(bus, 0)),
+            std::unique_ptr<LoopbackCan>(new LoopbackCan(bus, 1))};
+}
+
+void LoopbackCan::send(const CanMessage & message) { sendBatch(&message, 1); }
+
+void LoopbackCan::sendBatch(const CanMessage * messages, std::size_t count)
+{
+    int peer = 1 - end_;
+    {
+        std::lock_guard lock(bus_->mutex);
+        for (std::size_t i = 0; i < count; ++i)
+            bus_->buffers[peer].add(messages[i]);
+    }
+    bus_->received[peer].notify_one();
+}
+
+bool LoopbackCan::recv(CanMessage & message, std::chrono::milliseconds timeout)
+{
+    std::unique_lock lock(bus_->mutex);
+    CanMessageBuffer & buffer = bus_->buffers[end_];
+    if (buffer.pop(message))
+        return true;
+    return bus_->received[end_].wait_for(lock, timeout, [&]() { return buffer.pop(message); });
+}
+
+void LoopbackCan::clearBuffer() noexcept
+{
+    std::lock_guard lock(bus_->mutex);
+    bus_->buffers[end_].clear();
+}
+
+} // namespace lt::network
@@ -0,0 +1,49 @@
+#ifndef LT_LOOPBACKCAN_H
+#define LT_LOOPBACKCAN_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "can.h"
+
+namespace lt::network
+{
+
+// One end of an in-process CAN bus. Frames sent on one end are received by
+// the other. Lets a virtual ECU run without CAN hardware.
+class LoopbackCan : public Can
+{
+public:
+    // Creates both ends of a new bus
+    static std::pair<std::unique_ptr<LoopbackCan>, std::unique_ptr<LoopbackCan>> createPair();
+
+    void send(const CanMessage & message) override;
+
+    void sendBatch(const CanMessage * messages, std::size_t count) override;
+
+    bool recv(CanMessage & message, std::chrono::milliseconds timeout) override;
+
+    void clearBuffer() noexcept override;
+
+    uint64_t dropped() const noexcept override { return bus_->buffers[end_].dropped(); }
+
+private:
+    struct Bus
+    {
+        std::mutex mutex;
+        std::condition_variable received[2];
+        // Frames waiting to be received by each end
+        CanMessageBuffer buffers[2];
+    };
+
+    LoopbackCan(std::shared_ptr<Bus> bus, int end) : bus_(std::move(bus)), end_(end) {}
+
+    std::shared_ptr<Bus> bus_;
+    int end_;
+};
+
+} // namespace lt::network
+
+#endif // LT_LOOPBACKCAN_H
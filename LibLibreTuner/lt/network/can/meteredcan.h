@@ -0,0 +1,82 @@
+#ifndef LT_METEREDCAN_H
+#define LT_METEREDCAN_H
+
+#include "../linkmetrics.h"
+#include "can.h"
+
+#include <cassert>
+
+namespace lt::network
+{
+
+// Counts the frames passing through a CAN interface
+class MeteredCan : public Can
+{
+public:
+    MeteredCan(CanPtr && can, LinkMetricsPtr metrics) : can_(std::move(can)), metrics_(std::move(metrics))
+    {
+        assert(can_ && metrics_);
+        lastDropped_ = can_->dropped();
+    }
+
+    void send(const CanMessage & message) override
+    {
+        can_->send(message);
+        metrics_->framesSent.add();
+        metrics_->bytesSent.add(message.length());
+    }
+
+    void sendBatch(const CanMessage * messages, std::size_t count) override
+    {
+        can_->sendBatch(messages, count);
+        uint64_t bytes = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            bytes += messages[i].length();
+        metrics_->framesSent.add(count);
+        metrics_->bytesSent.add(bytes);
+    }
+
+    bool recv(CanMessage & message, std::chrono::milliseconds timeout) override
+    {
+        bool res = can_->recv(message, timeout);
+        received(res, message);
+        return res;
+    }
+
+    Task<bool> recvAsync(CanMessage & message, std::chrono::milliseconds timeout) override
+    {
+        bool res = co_await can_->recvAsync(message, timeout);
+        received(res, message);
+        co_return res;
+    }
+
+    void clearBuffer() noexcept override { can_->clearBuffer(); }
+
+    uint64_t dropped() const noexcept override { return can_->dropped(); }
+
+private:
+    void received(bool res, const CanMessage & message)
+    {
+        if (res)
+        {
+            metrics_->framesReceived.add();
+            metrics_->bytesReceived.add(message.length());
+        }
+
+        uint64_t dropped = can_->dropped();
+        if (dropped > lastDropped_)
+        {
+            metrics_->framesDroppedOnReceive.add(dropped - lastDropped_);
+            lastDropped_ = dropped;
+        }
+    }
+
+    CanPtr can_;
+    LinkMetricsPtr metrics_;
+    // Drop count of the interface last added to the metrics
+    uint64_t lastDropped_{0};
+};
+
+} // namespace lt::network
+
+#endif // LT_METEREDCAN_H
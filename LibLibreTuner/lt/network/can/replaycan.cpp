@@ -0,0 +1,191 @@
+#include "replaycan.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace lt::network
+{
+
+ReplayCan::ReplayCan(std::vector<CanLogEntry> entries, ReplayMode mode, double speed)
+    : entries_(std::move(entries)), mode_(mode), speed_(std::max(speed, 0.0))
+{
+    for (std::size_t i = 0; i < entries_.size(); ++i)
+    {
+        if (entries_[i].direction != CanMessageDirection::Outbound)
+            continue;
+        exact_[exactKey(entries_[i].message)].push_back(i);
+        loose_[looseKey(entries_[i].message)].push_back(i);
+    }
+}
+
+ReplayCan::ReplayCan(const CanLog & log, ReplayMode mode, double speed) : ReplayCan(log.snapshot(), mode, speed) {}
+
+std::size_t ReplayCan::KeyHash::operator()(const Key & key) const noexcept
+{
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 0x100000001B3ull;
+    };
+    for (int i = 0; i < 4; ++i)
+        mix(static_cast<uint8_t>(key.id >> (i * 8)));
+    mix(key.length);
+    for (uint8_t byte : key.data)
+        mix(byte);
+    return static_cast<std::size_t>(hash);
+}
+
+ReplayCan::Key ReplayCan::exactKey(const CanMessage & message) noexcept
+{
+    Key key{message.id(), message.length(), {}};
+    std::copy(message.message(), message.message() + message.length(), key.data.begin());
+    return key;
+}
+
+ReplayCan::Key ReplayCan::looseKey(const CanMessage & message) noexcept
+{
+    uint8_t length = std::min<uint8_t>(message.length(), 3);
+    Key key{message.id(), 0, {}};
+    std::copy(message.message(), message.message() + length, key.data.begin());
+    return key;
+}
+
+std::size_t ReplayCan::find(const std::unordered_map<Key, std::vector<std::size_t>, KeyHash> & map,
+                            const Key & key) const noexcept
+{
+    auto it = map.find(key);
+    if (it == map.end())
+        return entries_.size();
+
+    const std::vector<std::size_t> & positions = it->second;
+    auto pos = std::lower_bound(positions.begin(), positions.end(), cursor_);
+    if (pos == positions.end())
+        pos = positions.begin();
+    return *pos;
+}
+
+ReplayCan::Clock::duration ReplayCan::scale(std::chrono::microseconds duration) const noexcept
+{
+    if (speed_ == 0.0 || duration.count() <= 0)
+        return Clock::duration::zero();
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::micro>(static_cast<double>(duration.count()) / speed_));
+}
+
+void ReplayCan::send(const CanMessage & message)
+{
+    if (mode_ != ReplayMode::Respond)
+        return;
+
+    std::lock_guard lock(mutex_);
+    std::size_t pos = find(exact_, exactKey(message));
+    if (pos == entries_.size())
+        pos = find(loose_, looseKey(message));
+    if (pos == entries_.size())
+    {
+        ++unmatched_;
+        return;
+    }
+
+    // Queue everything the ECU sent before the tester's next frame
+    Clock::time_point now = Clock::now();
+    std::chrono::microseconds base = entries_[pos].time;
+    std::size_t i = pos + 1;
+    for (; i < entries_.size() && entries_[i].direction == CanMessageDirection::Inbound; ++i)
+        pending_.push_back(Pending{now + scale(entries_[i].time - base), entries_[i].message});
+    cursor_ = i;
+
+    cv_.notify_all();
+}
+
+void ReplayCan::skipOutbound() noexcept
+{
+    while (timedPos_ < entries_.size() && entries_[timedPos_].direction != CanMessageDirection::Inbound)
+        ++timedPos_;
+}
+
+bool ReplayCan::recv(CanMessage & message, std::chrono::milliseconds timeout)
+{
+    Clock::time_point deadline = Clock::now() + timeout;
+    std::unique_lock lock(mutex_);
+
+    if (mode_ == ReplayMode::Timed)
+    {
+        if (!started_)
+        {
+            started_ = true;
+            start_ = Clock::now();
+        }
+
+        // Sleep without the lock so other receivers and clearBuffer() are
+        // not blocked, then check the position again since another receiver
+        // may have taken the frame
+        while (true)
+        {
+            skipOutbound();
+            if (timedPos_ == entries_.size())
+                return false;
+
+            Clock::time_point due = start_ + scale(entries_[timedPos_].time - entries_.front().time);
+            if (due <= Clock::now())
+            {
+                message = entries_[timedPos_++].message;
+                return true;
+            }
+
+            bool late = due > deadline;
+            lock.unlock();
+            std::this_thread::sleep_until(late ? deadline : due);
+            lock.lock();
+            if (late)
+                return false;
+        }
+    }
+
+    while (true)
+    {
+        if (pending_.empty())
+        {
+            if (cv_.wait_until(lock, deadline) == std::cv_status::timeout && pending_.empty())
+                return false;
+            continue;
+        }
+
+        Clock::time_point due = pending_.front().due;
+        if (due <= Clock::now())
+        {
+            message = pending_.front().message;
+            pending_.pop_front();
+            return true;
+        }
+        if (due > deadline)
+        {
+            cv_.wait_until(lock, deadline);
+            if (Clock::now() >= deadline)
+                return false;
+            continue;
+        }
+        cv_.wait_until(lock, due);
+    }
+}
+
+void ReplayCan::clearBuffer() noexcept
+{
+    std::lock_guard lock(mutex_);
+    pending_.clear();
+}
+
+std::size_t ReplayCan::unmatched() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return unmatched_;
+}
+
+bool ReplayCan::finished() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return mode_ == ReplayMode::Timed && timedPos_ >= entries_.size();
+}
+
+} // namespace lt::network
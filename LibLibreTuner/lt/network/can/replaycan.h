@@ -0,0 +1,113 @@
+#ifndef LT_REPLAYCAN_H
+#define LT_REPLAYCAN_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "can.h"
+#include "canlog.h"
+
+namespace lt::network
+{
+
+enum class ReplayMode
+{
+    // Each sent frame is matched against the recording and the inbound
+    // frames that followed it are played back. Lets UDS and ISO-TP
+    // conversations run against a recording.
+    Respond,
+    // Inbound frames are played back on the recorded timeline. Sent frames
+    // are ignored.
+    Timed,
+};
+
+// CAN interface that plays back a recording
+class ReplayCan : public Can
+{
+public:
+    // `speed` scales the recorded timing; 2.0 replays twice as fast. A speed
+    // of 0 replays without delays.
+    explicit ReplayCan(std::vector<CanLogEntry> entries, ReplayMode mode = ReplayMode::Respond, double speed = 1.0);
+    explicit ReplayCan(const CanLog & log, ReplayMode mode = ReplayMode::Respond, double speed = 1.0);
+
+    void send(const CanMessage & message) override;
+
+    bool recv(CanMessage & message, std::chrono::milliseconds timeout) override;
+
+    void clearBuffer() noexcept override;
+
+    // Returns the number of sent frames that had no match in the recording
+    std::size_t unmatched() const noexcept;
+
+    // Returns true once every inbound frame has been played in timed mode
+    bool finished() const noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key
+    {
+        uint32_t id;
+        uint8_t length;
+        std::array<uint8_t, 8> data;
+
+        bool operator==(const Key & other) const noexcept
+        {
+            return id == other.id && length == other.length && data == other.data;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key & key) const noexcept;
+    };
+
+    struct Pending
+    {
+        Clock::time_point due;
+        CanMessage message;
+    };
+
+    std::vector<CanLogEntry> entries_;
+    ReplayMode mode_;
+    double speed_;
+
+    // Positions of outbound frames. Loose keys only use the id and first
+    // three bytes (ISO-TP PCI, service and subfunction) so requests with
+    // varying parameters still get a response.
+    std::unordered_map<Key, std::vector<std::size_t>, KeyHash> exact_;
+    std::unordered_map<Key, std::vector<std::size_t>, KeyHash> loose_;
+    std::size_t cursor_{0};
+    std::size_t unmatched_{0};
+
+    std::deque<Pending> pending_;
+
+    // Timed mode
+    bool started_{false};
+    Clock::time_point start_;
+    std::size_t timedPos_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    static Key exactKey(const CanMessage & message) noexcept;
+    static Key looseKey(const CanMessage & message) noexcept;
+
+    // Returns the next position at or after the cursor, wrapping around.
+    // Returns entries_.size() if there is no match.
+    std::size_t find(const std::unordered_map<Key, std::vector<std::size_t>, KeyHash> & map,
+                     const Key & key) const noexcept;
+
+    Clock::duration scale(std::chrono::microseconds duration) const noexcept;
+
+    // Moves the timed cursor to the next inbound frame
+    void skipOutbound() noexcept;
+};
+
+} // namespace lt::network
+
+#endif // LT_REPLAYCAN_H
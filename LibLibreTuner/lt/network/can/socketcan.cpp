@@ -1,4 +1,5 @@
 #include "socketcan.h"
+#include "support/trace.h"
 
 #ifdef WITH_SOCKETCAN
 
@@ -12,6 +13,7 @@
 #include <linux/can/raw.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 
 namespace lt
@@ -19,110 +21,73 @@ namespace lt
 namespace network
 {
 
-bool SocketCanReceiver::recv(CanMessage & message,
-                             std::chrono::milliseconds timeout)
+SocketCan::SocketCan(const std::string & ifname, os::IoContext & context)
+    : socket_(AF_CAN, SOCK_RAW, CAN_RAW), context_(context), trigger_(context)
 {
-    std::chrono::steady_clock::time_point start =
-        std::chrono::steady_clock::now();
-    while ((std::chrono::steady_clock::now() - start) < timeout)
-    {
-        if (!running_)
-        {
-            if (result_.valid())
-            {
-                result_.get();
-            }
-            // If the result did not throw an exception, it was stop()'d
-            throw std::runtime_error("SocketCAN receiver thread is inactive");
-        }
+    sockaddr_can addr = {};
+    ifreq ifr;
 
-        if (buffer_.pop(message))
-        {
-            return true;
-        }
+    std::strcpy(ifr.ifr_name, ifname.c_str());
+    socket_.ioctl(SIOCGIFINDEX, &ifr);
 
-        std::unique_lock lk(mutex_);
-        received_.wait_for(lk, timeout -
-                                   (std::chrono::steady_clock::now() - start));
-    }
-    // Timed out
-    return false;
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    socket_.bind(reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+
+    context_.watch(socket_.descriptor(), [this]() { onReadable(); });
 }
 
-SocketCanReceiver::~SocketCanReceiver() { stop(); }
+SocketCan::~SocketCan() { context_.unwatch(socket_.descriptor()); }
 
-void SocketCanReceiver::work()
+void SocketCan::onReadable() noexcept
 {
-    while (!stop_)
+    LT_TRACE_SPAN("socketcan.read");
+    can_frame frame;
+    std::size_t received = 0;
+    while (true)
     {
-        can_frame frame;
-
-        int nbytes = socket_.recv(&frame, sizeof(can_frame), 0);
-        if (nbytes == 0)
+        ssize_t nbytes = socket_.recvNoExcept(&frame, sizeof(can_frame), MSG_DONTWAIT);
+        if (nbytes == -1)
         {
-            // Timed out
-            continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                break;
+
+            // Stop watching so the error is not reported again
+            std::lock_guard lock(mutex_);
+            error_ = std::make_exception_ptr(std::runtime_error(
+                std::string("SocketCAN read failed: ") + strerror(errno)));
+            context_.unwatch(socket_.descriptor());
+            break;
         }
+        if (nbytes != sizeof(can_frame))
+            continue;
 
-        // TODO: remove EFF/RTR/ERR flags
-        buffer_.add(CanMessage(frame.can_id, frame.data, frame.can_dlc));
-        received_.notify_all();
+        // TODO: remove RTR/ERR flags
+        bool extended = (frame.can_id & CAN_EFF_FLAG) != 0;
+        CanMessage message(frame.can_id & (extended ? CAN_EFF_MASK : CAN_SFF_MASK), frame.data,
+                           std::min<uint8_t>(frame.can_dlc, 8));
+        message.setExtended(extended);
+        std::lock_guard lock(mutex_);
+        buffer_.add(message);
+        ++received;
     }
-}
 
-void SocketCanReceiver::stop()
-{
-    if (!running_)
+    LT_TRACE_COUNTER("socketcan.frames", received);
+    if (received != 0 || error_)
     {
-        return;
+        received_.notify_all();
+        trigger_.fire();
     }
-    stop_ = true;
-    receiver_.join();
 }
 
-void SocketCanReceiver::start()
+bool SocketCan::pop(CanMessage & message)
 {
-    if (running_)
-    {
-        return;
-    }
-
-    stop_ = false;
-    running_ = true;
-    receiver_ = std::thread([this]() {
-        std::packaged_task<void()> task([this]() { work(); });
-
-        result_ = task.get_future();
-        task();
-        running_ = false;
-    });
-}
-
-void SocketCanReceiver::clearBuffer() { buffer_.clear(); }
-
-SocketCan::~SocketCan() {}
-
-SocketCan::SocketCan(const std::string & ifname)
-    : socket_(AF_CAN, SOCK_RAW, CAN_RAW), receiver_(socket_)
-{
-    sockaddr_can addr = {};
-    ifreq ifr;
-
-    std::strcpy(ifr.ifr_name, ifname.c_str());
-    socket_.ioctl(SIOCGIFINDEX, &ifr);
-
-    addr.can_family = AF_CAN;
-    addr.can_ifindex = ifr.ifr_ifindex;
-
-    socket_.bind(reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
-
-    // Set timeout to 1s
-    timeval tv = {0};
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    socket_.setsockopt(SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-    receiver_.start();
+    if (buffer_.pop(message))
+        return true;
+    if (error_)
+        std::rethrow_exception(error_);
+    return false;
 }
 
 void SocketCan::send(const CanMessage & message)
@@ -131,6 +96,8 @@ void SocketCan::send(const CanMessage & message)
 
     frame.can_dlc = message.length();
     frame.can_id = message.id();
+    if (message.extended())
+        frame.can_id |= CAN_EFF_FLAG;
     std::copy(message.message(), message.message() + message.length(),
               frame.data);
 
@@ -139,10 +106,41 @@ void SocketCan::send(const CanMessage & message)
 
 bool SocketCan::recv(CanMessage & message, std::chrono::milliseconds timeout)
 {
-    return receiver_.recv(message, timeout);
+    std::unique_lock lock(mutex_);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pop(message))
+    {
+        if (received_.wait_until(lock, deadline) == std::cv_status::timeout)
+            return pop(message);
+    }
+    return true;
+}
+
+Task<bool> SocketCan::recvAsync(CanMessage & message,
+                                std::chrono::milliseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            if (pop(message))
+                co_return true;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+            co_return false;
+        co_await trigger_.wait(remaining);
+    }
 }
 
-void SocketCan::clearBuffer() noexcept { receiver_.clearBuffer(); }
+void SocketCan::clearBuffer() noexcept
+{
+    std::lock_guard lock(mutex_);
+    buffer_.clear();
+}
 
 } // namespace network
 } // namespace lt
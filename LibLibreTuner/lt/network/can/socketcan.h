@@ -2,14 +2,14 @@
 #define SOCKETCAN_H
 
 #include "can.h"
+#include "os/iocontext.h"
 #include "os/socket.h"
 
-#include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <future>
+#include <exception>
 #include <mutex>
 #include <string>
-#include <thread>
 
 #ifdef WITH_SOCKETCAN
 
@@ -18,37 +18,9 @@ namespace lt
 namespace network
 {
 
-class SocketCanReceiver
-{
-public:
-    SocketCanReceiver(os::Socket & socket) : socket_(socket) {}
-
-    ~SocketCanReceiver();
-
-    // Returns the first message in the buffer and waits if empty.
-    // If the worker thread has thrown an exception, passes it here.
-    bool recv(CanMessage & message, std::chrono::milliseconds timeout);
-
-    void start();
-    void stop();
-
-    void clearBuffer();
-
-private:
-    os::Socket & socket_;
-
-    void work();
-
-    std::thread receiver_;
-    std::condition_variable received_;
-    std::atomic<bool> stop_{false};
-    std::atomic<bool> running_{false};
-    std::future<void> result_;
-    std::mutex mutex_;
-
-    CanMessageBuffer buffer_;
-};
-
+// Raw SocketCAN interface. The socket is watched by the I/O context, which
+// reads frames into a buffer as soon as they arrive; no thread is
+// dedicated to the interface.
 class SocketCan : public Can
 {
 public:
@@ -58,21 +30,40 @@ public:
 
     ~SocketCan() override;
 
-    SocketCan(const std::string & ifname);
+    SocketCan(const std::string & ifname,
+              os::IoContext & context = os::IoContext::global());
 
     // Can interface
 public:
     virtual void send(const CanMessage & message) override;
 
-    /* Returns false if the timeout expired and no message was read. */
+    /* Returns false if the timeout expired and no message was read. Throws
+       an exception if the socket failed. */
     virtual bool recv(CanMessage & message,
                       std::chrono::milliseconds timeout) override;
 
+    // Only one coroutine may receive at a time
+    virtual Task<bool> recvAsync(CanMessage & message,
+                                 std::chrono::milliseconds timeout) override;
+
     virtual void clearBuffer() noexcept override;
 
+    uint64_t dropped() const noexcept override { return buffer_.dropped(); }
+
 private:
     os::Socket socket_;
-    SocketCanReceiver receiver_;
+    os::IoContext & context_;
+
+    std::mutex mutex_;
+    std::condition_variable received_;
+    os::IoContext::Trigger trigger_;
+    CanMessageBuffer buffer_;
+    std::exception_ptr error_;
+
+    // Reads every pending frame. Runs on the I/O thread.
+    void onReadable() noexcept;
+    // Pops a message or rethrows a socket error. Requires mutex_.
+    bool pop(CanMessage & message);
 };
 
 } // namespace network
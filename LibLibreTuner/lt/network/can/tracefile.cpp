@@ -0,0 +1,229 @@
+#include "tracefile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+
+#include "asc.h"
+#include "blf.h"
+#include "candump.h"
+
+namespace lt::network
+{
+
+const std::vector<uint32_t> defaultOutboundIds = {0x7DF, 0x7E0, 0x7E1, 0x7E2, 0x7E3, 0x7E4, 0x7E5, 0x7E6, 0x7E7};
+
+TraceFormat traceFormat(const std::filesystem::path & path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    if (extension == ".asc")
+        return TraceFormat::Asc;
+    if (extension == ".blf")
+        return TraceFormat::Blf;
+    return TraceFormat::Candump;
+}
+
+TraceReaderPtr openTrace(const std::filesystem::path & path, const std::vector<uint32_t> & outboundIds)
+{
+    return openTrace(path, traceFormat(path), outboundIds);
+}
+
+TraceReaderPtr openTrace(const std::filesystem::path & path, TraceFormat format,
+                         const std::vector<uint32_t> & outboundIds)
+{
+    switch (format)
+    {
+    case TraceFormat::Candump:
+        return std::make_unique<CandumpReader>(path, outboundIds);
+    case TraceFormat::Asc:
+        return std::make_unique<AscReader>(path);
+    case TraceFormat::Blf:
+        return std::make_unique<BlfReader>(path);
+    }
+    throw std::runtime_error("unknown trace format");
+}
+
+TraceWriterPtr createTrace(const std::filesystem::path & path, TraceFormat format)
+{
+    switch (format)
+    {
+    case TraceFormat::Candump:
+        return std::make_unique<CandumpWriter>(path);
+    case TraceFormat::Asc:
+        return std::make_unique<AscWriter>(path);
+    case TraceFormat::Blf:
+        return std::make_unique<BlfWriter>(path);
+    }
+    throw std::runtime_error("unknown trace format");
+}
+
+std::vector<CanLogEntry> readTrace(const std::filesystem::path & path, const std::vector<uint32_t> & outboundIds)
+{
+    TraceReaderPtr reader = openTrace(path, outboundIds);
+    std::vector<CanLogEntry> entries;
+    CanLogEntry entry{};
+    while (reader->next(entry))
+        entries.push_back(entry);
+    return entries;
+}
+
+void importTrace(const std::filesystem::path & path, CanLog & log, const std::vector<uint32_t> & outboundIds)
+{
+    TraceReaderPtr reader = openTrace(path, outboundIds);
+    CanLogEntry entry{};
+    while (reader->next(entry))
+        log.add(entry);
+}
+
+void exportTrace(const std::filesystem::path & path, const CanLog & log, TraceFormat format)
+{
+    TraceWriterPtr writer = createTrace(path, format);
+    // Write in slices so large logs are not copied at once
+    constexpr std::size_t SliceSize = 4096;
+    uint64_t end = log.total();
+    for (uint64_t sequence = log.firstSequence(); sequence < end; sequence += SliceSize)
+    {
+        for (const CanLogEntry & entry : log.entries(sequence, SliceSize))
+            writer->write(entry);
+    }
+    writer->close();
+}
+
+namespace detail
+{
+
+bool LineScanner::next(std::string_view & line) noexcept
+{
+    if (pos_ >= end_)
+        return false;
+
+    const auto * newline = static_cast<const char *>(std::memchr(pos_, '\n', static_cast<std::size_t>(end_ - pos_)));
+    const char * lineEnd = newline != nullptr ? newline : end_;
+    line = std::string_view(pos_, static_cast<std::size_t>(lineEnd - pos_));
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    pos_ = newline != nullptr ? newline + 1 : end_;
+    ++lineNumber_;
+    return true;
+}
+
+std::string_view nextToken(std::string_view & text) noexcept
+{
+    std::size_t begin = 0;
+    while (begin < text.size() && (text[begin] == ' ' || text[begin] == '\t'))
+        ++begin;
+    std::size_t end = begin;
+    while (end < text.size() && text[end] != ' ' && text[end] != '\t')
+        ++end;
+
+    std::string_view token = text.substr(begin, end - begin);
+    text.remove_prefix(end);
+    return token;
+}
+
+bool parseSeconds(std::string_view text, std::chrono::microseconds & out) noexcept
+{
+    if (text.empty())
+        return false;
+
+    int64_t seconds = 0;
+    std::size_t i = 0;
+    for (; i < text.size() && text[i] != '.'; ++i)
+    {
+        if (text[i] < '0' || text[i] > '9' || seconds > (INT64_MAX / 10000000))
+            return false;
+        seconds = seconds * 10 + (text[i] - '0');
+    }
+
+    int64_t micros = 0;
+    int digits = 0;
+    if (i < text.size())
+    {
+        // Skip the '.'
+        for (++i; i < text.size(); ++i)
+        {
+            if (text[i] < '0' || text[i] > '9')
+                return false;
+            // Digits past microseconds are truncated
+            if (digits < 6)
+            {
+                micros = micros * 10 + (text[i] - '0');
+                ++digits;
+            }
+        }
+    }
+    for (; digits < 6; ++digits)
+        micros *= 10;
+
+    out = std::chrono::microseconds(seconds * 1000000 + micros);
+    return true;
+}
+
+TraceOutput::TraceOutput(const std::filesystem::path & path)
+    : file_(path, std::ios::binary | std::ios::out | std::ios::trunc)
+{
+    if (!file_.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "' for writing");
+    buffer_.resize(BlockSize);
+}
+
+char * TraceOutput::reserve(std::size_t size)
+{
+    if (used_ + size > buffer_.size())
+    {
+        flush();
+        if (size > buffer_.size())
+            buffer_.resize(size);
+    }
+    return buffer_.data() + used_;
+}
+
+void TraceOutput::write(const void * data, std::size_t size)
+{
+    if (size == 0)
+        return;
+    char * out = reserve(size);
+    std::memcpy(out, data, size);
+    commit(size);
+}
+
+void TraceOutput::flush()
+{
+    if (used_ == 0)
+        return;
+    file_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+    if (!file_)
+        throw std::runtime_error("failed to write trace file");
+    flushed_ += used_;
+    used_ = 0;
+}
+
+void TraceOutput::overwrite(std::size_t offset, const void * data, std::size_t size)
+{
+    if (offset + size > flushed_)
+        throw std::runtime_error("cannot overwrite unflushed trace data");
+    file_.seekp(static_cast<std::streamoff>(offset));
+    file_.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    file_.seekp(0, std::ios::end);
+    if (!file_)
+        throw std::runtime_error("failed to write trace file");
+}
+
+void TraceOutput::close()
+{
+    if (!file_.is_open())
+        return;
+    flush();
+    file_.close();
+    if (!file_)
+        throw std::runtime_error("failed to write trace file");
+}
+
+} // namespace detail
+
+} // namespace lt::network
@@ -0,0 +1,137 @@
+#ifndef LT_TRACEFILE_H
+#define LT_TRACEFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "canlog.h"
+
+namespace lt::network
+{
+
+enum class TraceFormat
+{
+    // SocketCAN `candump -L`
+    Candump,
+    // Vector ASCII log
+    Asc,
+    // Vector binary logging format
+    Blf,
+};
+
+// Diagnostic tester request ids. Formats that do not record direction
+// treat frames with these ids as outbound.
+extern const std::vector<uint32_t> defaultOutboundIds;
+
+// Streaming reader for a CAN trace
+class TraceReader
+{
+public:
+    virtual ~TraceReader() = default;
+
+    // Reads the next frame. Returns false at the end of the trace. Throws an
+    // exception on malformed data.
+    virtual bool next(CanLogEntry & entry) = 0;
+};
+using TraceReaderPtr = std::unique_ptr<TraceReader>;
+
+// Streaming writer for a CAN trace
+class TraceWriter
+{
+public:
+    virtual ~TraceWriter() = default;
+
+    virtual void write(const CanLogEntry & entry) = 0;
+
+    // Flushes and finishes the file. Throws an exception on write errors.
+    virtual void close() = 0;
+};
+using TraceWriterPtr = std::unique_ptr<TraceWriter>;
+
+// Guesses the format from the file extension (.log, .asc or .blf)
+TraceFormat traceFormat(const std::filesystem::path & path);
+
+// Opens a trace. The file is memory mapped and parsed as frames are read.
+TraceReaderPtr openTrace(const std::filesystem::path & path,
+                         const std::vector<uint32_t> & outboundIds = defaultOutboundIds);
+TraceReaderPtr openTrace(const std::filesystem::path & path, TraceFormat format,
+                         const std::vector<uint32_t> & outboundIds = defaultOutboundIds);
+
+TraceWriterPtr createTrace(const std::filesystem::path & path, TraceFormat format);
+
+// Reads every frame of a trace
+std::vector<CanLogEntry> readTrace(const std::filesystem::path & path,
+                                   const std::vector<uint32_t> & outboundIds = defaultOutboundIds);
+
+// Adds every frame of a trace to a log
+void importTrace(const std::filesystem::path & path, CanLog & log,
+                 const std::vector<uint32_t> & outboundIds = defaultOutboundIds);
+
+// Writes every readable entry of a log
+void exportTrace(const std::filesystem::path & path, const CanLog & log, TraceFormat format);
+
+namespace detail
+{
+// Splits text into lines without copying
+class LineScanner
+{
+public:
+    LineScanner(const char * begin, const char * end) : pos_(begin), end_(end) {}
+
+    // Returns the next line without the line ending
+    bool next(std::string_view & line) noexcept;
+
+    inline std::size_t lineNumber() const noexcept { return lineNumber_; }
+
+private:
+    const char * pos_;
+    const char * end_;
+    std::size_t lineNumber_{0};
+};
+
+// Returns the next whitespace separated token and removes it from `text`
+std::string_view nextToken(std::string_view & text) noexcept;
+
+// Parses "seconds[.fraction]" as microseconds
+bool parseSeconds(std::string_view text, std::chrono::microseconds & out) noexcept;
+
+// Buffered file output that writes in large blocks
+class TraceOutput
+{
+public:
+    static constexpr std::size_t BlockSize = 1 << 20;
+
+    explicit TraceOutput(const std::filesystem::path & path);
+
+    // Returns space for at least `size` bytes. Call commit() with the bytes
+    // used.
+    char * reserve(std::size_t size);
+    inline void commit(std::size_t size) noexcept { used_ += size; }
+
+    void write(const void * data, std::size_t size);
+    void flush();
+
+    // Overwrites bytes that have already been flushed
+    void overwrite(std::size_t offset, const void * data, std::size_t size);
+
+    // Bytes written so far, including buffered bytes
+    inline std::size_t position() const noexcept { return flushed_ + used_; }
+
+    void close();
+
+private:
+    std::ofstream file_;
+    std::vector<char> buffer_;
+    std::size_t used_{0};
+    std::size_t flushed_{0};
+};
+} // namespace detail
+
+} // namespace lt::network
+
+#endif // LT_TRACEFILE_H
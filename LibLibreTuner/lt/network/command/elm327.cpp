@@ -2,13 +2,64 @@
 
 #include "elm327.h"
 
-#include <iomanip>
-#include <sstream>
+#include "../../support/hex.h"
+
+#include <cctype>
 #include <stdexcept>
 
 namespace lt::network
 {
 
+namespace
+{
+// Returns the status a line reports, or Ok if it is response data
+ElmStatus lineStatus(std::string_view line) noexcept
+{
+    if (line == "?")
+        return ElmStatus::Unknown;
+    if (line == "NO DATA")
+        return ElmStatus::NoData;
+    if (line == "CAN ERROR")
+        return ElmStatus::CanError;
+    if (line == "BUFFER FULL")
+        return ElmStatus::BufferFull;
+    if (line == "STOPPED")
+        return ElmStatus::Stopped;
+    if (line.find("ERROR") != std::string_view::npos)
+        return ElmStatus::Error;
+    return ElmStatus::Ok;
+}
+
+std::string_view trimRight(std::string_view line) noexcept
+{
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+        line.remove_suffix(1);
+    return line;
+}
+} // namespace
+
+const char * toString(ElmStatus status) noexcept
+{
+    switch (status)
+    {
+    case ElmStatus::Ok:
+        return "ok";
+    case ElmStatus::Unknown:
+        return "received ? from elm";
+    case ElmStatus::NoData:
+        return "received no data";
+    case ElmStatus::CanError:
+        return "received CAN ERROR";
+    case ElmStatus::BufferFull:
+        return "elm buffer is full";
+    case ElmStatus::Stopped:
+        return "elm stopped the command";
+    case ElmStatus::Error:
+    default:
+        return "elm reported an error";
+    }
+}
+
 Elm327::Elm327(std::string port, serial::Settings serialSettings)
     : device_(std::move(port), serialSettings), reader_(device_)
 {
@@ -19,110 +70,130 @@ void Elm327::open() { device_.open(); }
 
 void Elm327::setProtocol(ElmProtocol protocol)
 {
-    std::stringstream ss;
-    ss << "AT SP " << std::hex << static_cast<uint32_t>(protocol);
-    sendCommand(ss.str());
+    char command[] = "AT SP 0";
+    hex::writeNumber(command + 6, static_cast<uint8_t>(protocol), 1);
+    sendCommand(command);
 }
 
-void Elm327::writeLine(std::string line)
+void Elm327::writeLine(std::string_view line)
 {
     if (!isOpen())
     {
         throw std::runtime_error(
             "attempted to write line to closed connection");
     }
-    line += "\r";
+    line_.assign(line);
+    line_ += '\r';
 
-    device_.write(line);
+    device_.write(line_);
 }
 
-std::vector<std::string> Elm327::sendCommand(const std::string & command)
+ElmStatus Elm327::sendCommand(std::string_view command, const LineCallback & onLine)
 {
     reader_.clear();
     writeLine(command);
 
-    std::vector<std::string> response;
-
-    std::string line;
+    ElmStatus status = ElmStatus::Ok;
+    bool first = true;
     while (true)
     {
-        line = reader_.readLine(">");
+        std::string_view line = trimRight(reader_.readLine(">"));
         if (line.empty())
             continue;
-        if (line == command && response.empty())
-            continue;
         if (line == ">")
             break;
+        // Echo, if enabled
+        if (std::exchange(first, false) && line == command)
+            continue;
 
-        if (line == "?")
-            throw std::runtime_error("received ? from elm");
-
-        if (line == "CAN ERROR")
-            throw std::runtime_error("received CAN ERROR");
-        if (line == "NO DATA")
-            throw std::runtime_error("received no data");
-
-        response.emplace_back(std::move(line));
+        // Keep reading after an error so the prompt is not left behind
+        // for the next command
+        if (ElmStatus s = lineStatus(line); s != ElmStatus::Ok)
+        {
+            status = s;
+            continue;
+        }
+        if (onLine)
+            onLine(line);
     }
-    return response;
+    return status;
 }
 
-void Elm327::sendBasicCommand(const std::string & command)
+void Elm327::sendBasicCommand(std::string_view command)
 {
-    std::vector<std::string> response = sendCommand(command);
-    if (response.size() != 1 || response.front() != "OK")
+    int lines = 0;
+    bool ok = false;
+    ElmStatus status = sendCommand(command, [&](std::string_view line) { ok = ++lines == 1 && line == "OK"; });
+    if (status != ElmStatus::Ok || !ok)
     {
         throw std::runtime_error("received invalid response, expected \"OK\"");
     }
 }
 
+void Elm327::identify()
+{
+    std::string version;
+    auto onLine = [&version](std::string_view line) {
+        if (version.empty())
+            version.assign(line);
+    };
+
+    // ELM327 clones answer STI with "?"
+    stn_ = sendCommand("STI", onLine) == ElmStatus::Ok && version.compare(0, 3, "STN") == 0;
+    if (!stn_)
+    {
+        version.clear();
+        sendCommand("AT I", onLine);
+    }
+    version_ = std::move(version);
+}
+
 void Elm327::setEcho(bool echo)
 {
-    std::string command = "AT E ";
-    command += echo ? '1' : '0';
-    sendBasicCommand(command);
+    sendBasicCommand(echo ? "AT E 1" : "AT E 0");
 }
 
 void Elm327::setHeaders(bool headers)
 {
-    std::string command = "AT H ";
-    command += headers ? '1' : '0';
-    sendBasicCommand(command);
+    sendBasicCommand(headers ? "AT H 1" : "AT H 0");
 }
 
 void Elm327::setCanFCId11(uint16_t id)
 {
-    std::stringstream ss;
-    ss << "AT FC SH " << std::setfill('0') << std::setw(3) << std::hex << id;
-    sendBasicCommand(ss.str());
+    char command[] = "AT FC SH 000";
+    hex::writeNumber(command + 9, id, 3);
+    sendBasicCommand(command);
 }
 
 void Elm327::setHeader(uint16_t header)
 {
-    std::stringstream ss;
-    ss << "AT SH " << std::setfill('0') << std::setw(3) << std::hex << header;
-    sendBasicCommand(ss.str());
+    char command[] = "AT SH 000";
+    hex::writeNumber(command + 6, header, 3);
+    sendBasicCommand(command);
 }
 
 void Elm327::setCanReceiveAddress11(uint16_t address)
 {
-    std::stringstream ss;
-    ss << "AT CRA " << std::setfill('0') << std::setw(3) << std::hex << address;
-    sendBasicCommand(ss.str());
+    char command[] = "AT CRA 000";
+    hex::writeNumber(command + 7, address, 3);
+    sendBasicCommand(command);
 }
 
 void Elm327::setPrintSpaces(bool printSpaces)
 {
-    std::string command = "AT S ";
-    command += printSpaces ? '1' : '0';
-    sendBasicCommand(command);
+    sendBasicCommand(printSpaces ? "AT S 1" : "AT S 0");
 }
 
 void Elm327::setTimeout(uint8_t timeout)
 {
-    std::stringstream ss;
-    ss << "AT ST " << std::setfill('0') << std::setw(2) << std::hex << timeout;
-    sendBasicCommand(ss.str());
+    char command[] = "AT ST 00";
+    hex::writeNumber(command + 6, timeout, 2);
+    sendBasicCommand(command);
+}
+
+void Elm327::setAllowLong(bool allowLong)
+{
+    sendBasicCommand(allowLong ? "AT AL" : "AT NL");
 }
 
-} // namespace lt::network
\ No newline at end of file
+} // namespace lt::network
@@ -1,9 +1,12 @@
 #ifndef LT_ELM327_H
 #define LT_ELM327_H
 
+#include <functional>
 #include <memory>
 #include <serial/bufferedreader.h>
 #include <serial/device.h>
+#include <string>
+#include <string_view>
 
 namespace lt::network
 {
@@ -25,9 +28,32 @@ enum class ElmProtocol : uint8_t
     USER2_CAN = 0xC,
 };
 
+// Outcome of a command, from the status lines the adapter prints
+enum class ElmStatus : uint8_t
+{
+    Ok,
+    // "?", the command was not understood
+    Unknown,
+    NoData,
+    CanError,
+    // The adapter ran out of memory while receiving
+    BufferFull,
+    // Interrupted by a character received while busy
+    Stopped,
+    // Other bus or receive errors
+    Error,
+};
+
+// Returns a description of the status for error messages
+const char * toString(ElmStatus status) noexcept;
+
 class Elm327
 {
 public:
+    // Called with each line of a response. The line is only valid during
+    // the call.
+    using LineCallback = std::function<void(std::string_view line)>;
+
     Elm327(std::string port = "",
            serial::Settings serialSettings = serial::Settings{});
 
@@ -56,7 +82,7 @@ public:
     void setCanReceiveAddress11(uint16_t address);
 
     // Appends CR to end of line and writes to serial
-    void writeLine(std::string line);
+    void writeLine(std::string_view line);
 
     // Enable or disables printing spaces
     void setPrintSpaces(bool printSpaces);
@@ -64,20 +90,40 @@ public:
     // Sets timeout byte (0 = 0ms, 0xFF = 1000ms)
     void setTimeout(uint8_t timeout);
 
-    // Sends a command and waits for a response. Returns response separated into
-    // lines.
-    std::vector<std::string> sendCommand(const std::string & command);
+    // Allows messages longer than 7 bytes (AT AL)
+    void setAllowLong(bool allowLong);
+
+    // Sends a command and calls `onLine` with each response line until the
+    // prompt. Echoed commands and status lines (NO DATA, CAN ERROR, ...)
+    // are not passed to `onLine`; the last status line is returned
+    // instead. Only throws if the device fails.
+    ElmStatus sendCommand(std::string_view command, const LineCallback & onLine = {});
 
     // Same as `sendCommand()` but throws an exception if the response is not
     // "OK"
-    void sendBasicCommand(const std::string & command);
+    void sendBasicCommand(std::string_view command);
+
+    // Reads the adapter version and checks for the STN11xx command set.
+    // Called once after opening; echo should be disabled first.
+    void identify();
+
+    // Returns true if the adapter is an STN11xx (OBDLink) and supports
+    // the ST commands, e.g. STPX for messages longer than 7 bytes.
+    inline bool isStn() const noexcept { return stn_; }
+
+    // Version line reported by the adapter, e.g. "ELM327 v1.5"
+    inline const std::string & version() const noexcept { return version_; }
 
 private:
     serial::Device device_;
     serial::BufferedReader reader_;
+    // Reused for outgoing lines
+    std::string line_;
+    std::string version_;
+    bool stn_{false};
 };
 using Elm327Ptr = std::shared_ptr<Elm327>;
 
 } // namespace lt::network
 
-#endif // LT_ELM327_H
\ No newline at end of file
+#endif // LT_ELM327_H
@@ -1,5 +1,7 @@
 #include "isotp.h"
 
+#include "../../os/iocontext.h"
+
 namespace lt::network
 {
 
@@ -25,4 +27,19 @@ void IsoTpPacket::append(const uint8_t * data, size_t size)
     data_.insert(data_.begin() + data_.size(), data, data + size);
 }
 
+Task<void> IsoTp::recvAsync(IsoTpPacket & result)
+{
+    co_await os::offload([this, &result]() { recv(result); });
+}
+
+Task<void> IsoTp::requestAsync(const IsoTpPacket & req, IsoTpPacket & result)
+{
+    co_await os::offload([this, &req, &result]() { request(req, result); });
+}
+
+Task<void> IsoTp::sendAsync(const IsoTpPacket & packet)
+{
+    co_await os::offload([this, &packet]() { send(packet); });
+}
+
 } // namespace lt::network
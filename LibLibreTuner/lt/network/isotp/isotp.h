@@ -1,7 +1,9 @@
 #ifndef ISOTP_H
 #define ISOTP_H
 
+#include "../../support/task.h"
 #include "../can/can.h"
+#include "../linkmetrics.h"
 
 #include <chrono>
 #include <cstdint>
@@ -15,6 +17,8 @@ struct IsoTpOptions
     uint32_t sourceId = 0x7E0, destId = 0x7E8;
     uint32_t baudrate = 500000;
     std::chrono::milliseconds timeout{6000};
+    // Optional. Receives timeout and flow control statistics.
+    LinkMetricsPtr metrics;
 };
 
 class IsoTpPacket
@@ -40,6 +44,10 @@ public:
 
     inline void clear() { data_.clear(); }
 
+    // Exchanges data with `other`. Lets buffers be reused without
+    // reallocating.
+    inline void swap(IsoTpPacket & other) noexcept { data_.swap(other.data_); }
+
     inline std::vector<uint8_t>::iterator begin() { return data_.begin(); }
     inline std::vector<uint8_t>::const_iterator begin() const { return data_.begin(); }
     inline std::vector<uint8_t>::const_iterator cbegin() const { return data_.cbegin(); }
@@ -89,9 +97,21 @@ public:
     virtual void send(const IsoTpPacket & packet) = 0;
 
     virtual void setOptions(const IsoTpOptions & options) = 0;
+
+    // Coroutine versions of the above. The default implementations run
+    // the blocking call on the blocking pool.
+    virtual Task<void> recvAsync(IsoTpPacket & result);
+    virtual Task<void> requestAsync(const IsoTpPacket & req, IsoTpPacket & result);
+    virtual Task<void> sendAsync(const IsoTpPacket & packet);
 };
 using IsoTpPtr = std::unique_ptr<IsoTp>;
 
+namespace detail
+{
+// Converts a separation time (STmin) parameter to a duration
+std::chrono::microseconds calculate_time(uint8_t st);
+} // namespace detail
+
 } // namespace lt::network
 
 #endif // ISOTP_H
@@ -1,5 +1,8 @@
 #include "isotpcan.h"
 
+#include "../../os/iocontext.h"
+#include "../../support/trace.h"
+
 #include <string>
 #include <thread>
 
@@ -45,6 +48,31 @@ constexpr uint8_t typeFirst = 1;
 constexpr uint8_t typeConsec = 2;
 constexpr uint8_t typeFlow = 3;
 
+namespace
+{
+// Context used to wait between frames in coroutines
+os::IoContext & ioContext()
+{
+    os::IoContext * context = os::IoContext::current();
+    return context != nullptr ? *context : os::IoContext::global();
+}
+
+FlowControlFrame parseFlowControl(const CanMessage & message)
+{
+    if (message.length() < 3)
+    {
+        throw std::runtime_error(
+            "received invalid flow control response: too short");
+    }
+
+    FlowControlFrame frame;
+    frame.fcFlag = message[0] & 0x0F;
+    frame.blockSize = message[1];
+    frame.st = message[2];
+    return frame;
+}
+} // namespace
+
 class MultiFrameReceiver
 {
 public:
@@ -56,12 +84,15 @@ public:
     }
 
     void recv();
+    Task<void> recvAsync();
 
     uint8_t nextConsec();
 
 private:
     void sendFlowControl();
     void recvConsecutiveFrames();
+    // Appends the payload of a consecutive frame
+    void append(const CanMessage & frame);
 
     IsoTpPacket & packet_;
     Can & can_;
@@ -82,6 +113,7 @@ public:
     }
 
     void send();
+    Task<void> sendAsync();
 
 private:
     FlowControlFrame recvFlowControl();
@@ -89,6 +121,15 @@ private:
     // Sends consecutive frames until blocksize reaches 0
     // or the end of the packet is reached
     void sendConsecFrames();
+    Task<void> sendConsecFramesAsync();
+
+    void sendFirstFrame();
+    // Sends the next consecutive frame. Returns true if another frame
+    // follows in the current block.
+    bool sendConsecFrame();
+    // Applies a flow control frame. Returns false for a wait frame. Throws
+    // if the remote aborted the transfer.
+    bool handleFlowControl(const FlowControlFrame & frame);
 
     uint8_t nextConsec();
 
@@ -112,7 +153,13 @@ IsoTpCan::~IsoTpCan() = default;
 void IsoTpCan::recv(IsoTpPacket & result)
 {
     assert(can_);
-    CanMessage message = recvNextFrame();
+    LT_TRACE_SPAN("isotp.recv");
+    recv(recvNextFrame(), result);
+}
+
+void IsoTpCan::recv(const CanMessage & message, IsoTpPacket & result)
+{
+    assert(can_);
     uint8_t type = message[0] >> 4;
     if (type == typeSingle)
     {
@@ -123,7 +170,7 @@ void IsoTpCan::recv(IsoTpPacket & result)
     if (type == typeFirst)
     {
         uint16_t length = ((message[0] & 0x0F) << 8) | message[1];
-        result.append(message.message() + 2, 6);
+        result.setData(message.message() + 2, 6);
         MultiFrameReceiver receiver(length - 6, result, *can_, options_, *this);
         receiver.recv();
         return;
@@ -133,15 +180,48 @@ void IsoTpCan::recv(IsoTpPacket & result)
         " or " + std::to_string(typeFirst) + ", got " + std::to_string(type));
 }
 
+Task<void> IsoTpCan::recvAsync(IsoTpPacket & result)
+{
+    assert(can_);
+    LT_TRACE_ASYNC_SPAN("isotp.recv");
+    CanMessage message = co_await recvNextFrameAsync();
+    uint8_t type = message[0] >> 4;
+    if (type == typeSingle)
+    {
+        uint8_t length = message[0] & 0x0F;
+        result.setData(message.message() + 1, length);
+        co_return;
+    }
+    if (type == typeFirst)
+    {
+        uint16_t length = ((message[0] & 0x0F) << 8) | message[1];
+        result.setData(message.message() + 2, 6);
+        MultiFrameReceiver receiver(length - 6, result, *can_, options_, *this);
+        co_await receiver.recvAsync();
+        co_return;
+    }
+    throw std::runtime_error(
+        "received invalid frame type. Expected " + std::to_string(typeSingle) +
+        " or " + std::to_string(typeFirst) + ", got " + std::to_string(type));
+}
+
 void IsoTpCan::request(const IsoTpPacket & req, IsoTpPacket & result)
 {
     send(req);
     recv(result);
 }
 
+Task<void> IsoTpCan::requestAsync(const IsoTpPacket & req,
+                                  IsoTpPacket & result)
+{
+    co_await sendAsync(req);
+    co_await recvAsync(result);
+}
+
 void IsoTpCan::send(const IsoTpPacket & packet)
 {
     assert(can_);
+    LT_TRACE_SPAN("isotp.send");
     // Determine if packet will fit into a single frame
     if (packet.size() <= 7)
     {
@@ -155,6 +235,21 @@ void IsoTpCan::send(const IsoTpPacket & packet)
     }
 }
 
+Task<void> IsoTpCan::sendAsync(const IsoTpPacket & packet)
+{
+    assert(can_);
+    LT_TRACE_ASYNC_SPAN("isotp.send");
+    if (packet.size() <= 7)
+    {
+        sendSingleFrame(packet.data(), packet.size());
+    }
+    else
+    {
+        MultiFrameSender sender(packet, *can_, options_, *this);
+        co_await sender.sendAsync();
+    }
+}
+
 void IsoTpCan::sendSingleFrame(const uint8_t * data, std::size_t size)
 {
     assert(can_);
@@ -199,7 +294,31 @@ std::vector<uint8_t> IsoTpPacketReader::readRemaining()
 
 void MultiFrameSender::send()
 {
-    // Send first frame
+    sendFirstFrame();
+    waitForFlowControl();
+}
+
+Task<void> MultiFrameSender::sendAsync()
+{
+    sendFirstFrame();
+    while (reader_.remaining() != 0)
+    {
+        FlowControlFrame frame;
+        {
+            LT_TRACE_ASYNC_SPAN("isotp.flowControl");
+            do
+            {
+                frame = parseFlowControl(
+                    co_await protocol_.recvNextFrameAsync(typeFlow));
+            } while (!handleFlowControl(frame));
+        }
+
+        co_await sendConsecFramesAsync();
+    }
+}
+
+void MultiFrameSender::sendFirstFrame()
+{
     CanMessage message;
     message.setId(options_.sourceId);
     message[0] = (typeFirst << 4) | ((reader_.remaining() & 0xF00) >> 8);
@@ -211,62 +330,81 @@ void MultiFrameSender::send()
     message.pad();
 
     can_.send(message);
-
-    waitForFlowControl();
 }
 
 FlowControlFrame MultiFrameSender::recvFlowControl()
 {
-    CanMessage message = protocol_.recvNextFrame(typeFlow);
+    LT_TRACE_SPAN("isotp.flowControl");
+    return parseFlowControl(protocol_.recvNextFrame(typeFlow));
+}
 
-    if (message.length() < 3)
+bool MultiFrameSender::handleFlowControl(const FlowControlFrame & frame)
+{
+    if (frame.fcFlag == 2)
     {
-        throw std::runtime_error(
-            "received invalid flow control response: too short");
+        if (options_.metrics)
+            options_.metrics->isoTpAborts.add();
+        throw std::runtime_error("remote requested to abort transfer");
+    }
+    if (frame.fcFlag == 1)
+    {
+        if (options_.metrics)
+            options_.metrics->isoTpWaits.add();
+        return false;
     }
 
-    FlowControlFrame frame;
-    frame.fcFlag = message[0] & 0x0F;
-    frame.blockSize = message[1];
-    frame.st = message[2];
-    return frame;
+    separationTime_ = detail::calculate_time(frame.st);
+    blockSize_ = frame.blockSize;
+    return true;
 }
 
 void MultiFrameSender::waitForFlowControl()
 {
     while (reader_.remaining() != 0)
     {
-        FlowControlFrame frame;
-        do
+        while (!handleFlowControl(recvFlowControl()))
         {
-            frame = recvFlowControl();
-            if (frame.fcFlag == 2)
-            {
-                throw std::runtime_error("remote requested to abort transfer");
-            }
-        } while (frame.fcFlag == 1);
-
-        separationTime_ = detail::calculate_time(frame.st);
-        blockSize_ = frame.blockSize;
+        }
 
         sendConsecFrames();
     }
 }
 
+bool MultiFrameSender::sendConsecFrame()
+{
+    CanMessage message;
+    message.setId(options_.sourceId);
+    message[0] = (typeConsec << 4) | nextConsec();
+    message.setLength(static_cast<uint8_t>(reader_.next(message.message() + 1, 7) + 1));
+    message.pad();
+    can_.send(message);
+
+    return reader_.remaining() != 0 && (blockSize_ == 0 || --blockSize_ != 0);
+}
+
 void MultiFrameSender::sendConsecFrames()
 {
+    bool more;
     do
     {
-        CanMessage message;
-        message.setId(options_.sourceId);
-        message[0] = (typeConsec << 4) | nextConsec();
-        message.setLength(static_cast<uint8_t>(reader_.next(message.message() + 1, 7) + 1));
-        message.pad();
-        can_.send(message);
+        more = sendConsecFrame();
+        if (separationTime_.count() != 0)
+        {
+            LT_TRACE_SPAN("isotp.stmin");
+            std::this_thread::sleep_for(separationTime_);
+        }
+    } while (more);
+}
 
-        std::this_thread::sleep_for(separationTime_);
-    } while (reader_.remaining() != 0 &&
-             (blockSize_ == 0 || --blockSize_ != 0));
+Task<void> MultiFrameSender::sendConsecFramesAsync()
+{
+    bool more;
+    do
+    {
+        more = sendConsecFrame();
+        LT_TRACE_ASYNC_SPAN("isotp.stmin");
+        co_await ioContext().sleep(separationTime_);
+    } while (more);
 }
 
 CanMessage IsoTpCan::recvNextFrame()
@@ -283,12 +421,34 @@ CanMessage IsoTpCan::recvNextFrame()
             return message;
         }
     }
+    if (options_.metrics)
+        options_.metrics->isoTpTimeouts.add();
     throw std::runtime_error("timed out");
 }
 
-CanMessage IsoTpCan::recvNextFrame(uint8_t expectedType)
+Task<CanMessage> IsoTpCan::recvNextFrameAsync()
+{
+    auto start = std::chrono::steady_clock::now();
+    CanMessage message;
+    while (co_await can_->recvAsync(message, options_.timeout) &&
+           (std::chrono::steady_clock::now() - start) < options_.timeout)
+    {
+        if (message.id() == options_.destId)
+        {
+            if (message.length() == 0)
+                throw std::runtime_error("received empty frame");
+            co_return message;
+        }
+    }
+    if (options_.metrics)
+        options_.metrics->isoTpTimeouts.add();
+    throw std::runtime_error("timed out");
+}
+
+namespace
+{
+void checkFrameType(const CanMessage & message, uint8_t expectedType)
 {
-    CanMessage message = recvNextFrame();
     uint8_t id = message[0] >> 4;
     if (id != expectedType)
     {
@@ -296,9 +456,23 @@ CanMessage IsoTpCan::recvNextFrame(uint8_t expectedType)
                                  std::to_string(id) + ", expected " +
                                  std::to_string(expectedType));
     }
+}
+} // namespace
+
+CanMessage IsoTpCan::recvNextFrame(uint8_t expectedType)
+{
+    CanMessage message = recvNextFrame();
+    checkFrameType(message, expectedType);
     return message;
 }
 
+Task<CanMessage> IsoTpCan::recvNextFrameAsync(uint8_t expectedType)
+{
+    CanMessage message = co_await recvNextFrameAsync();
+    checkFrameType(message, expectedType);
+    co_return message;
+}
+
 uint8_t MultiFrameSender::nextConsec()
 {
     uint8_t index = consecIndex_++;
@@ -315,6 +489,16 @@ void MultiFrameReceiver::recv()
     recvConsecutiveFrames();
 }
 
+Task<void> MultiFrameReceiver::recvAsync()
+{
+    sendFlowControl();
+    LT_TRACE_ASYNC_SPAN("isotp.consecutiveFrames");
+    while (size_ != 0)
+    {
+        append(co_await protocol_.recvNextFrameAsync(typeConsec));
+    }
+}
+
 uint8_t MultiFrameReceiver::nextConsec()
 {
     uint8_t index = consecIndex_++;
@@ -339,20 +523,24 @@ void MultiFrameReceiver::sendFlowControl()
 
 void MultiFrameReceiver::recvConsecutiveFrames()
 {
+    LT_TRACE_SPAN("isotp.consecutiveFrames");
     while (size_ != 0)
     {
-        CanMessage frame = protocol_.recvNextFrame(typeConsec);
-        uint8_t index = frame[0] & 0x0F;
-        if (index != nextConsec())
-        {
-            throw std::runtime_error(
-                "received invalid consecutive frame index");
-        }
-
-        uint16_t received = std::min<uint16_t>(frame.length() - 1, size_);
+        append(protocol_.recvNextFrame(typeConsec));
+    }
+}
 
-        packet_.append(frame.message() + 1, received);
-        size_ -= received;
+void MultiFrameReceiver::append(const CanMessage & frame)
+{
+    uint8_t index = frame[0] & 0x0F;
+    if (index != nextConsec())
+    {
+        throw std::runtime_error("received invalid consecutive frame index");
     }
+
+    uint16_t received = std::min<uint16_t>(frame.length() - 1, size_);
+
+    packet_.append(frame.message() + 1, received);
+    size_ -= received;
 }
 } // namespace lt::network
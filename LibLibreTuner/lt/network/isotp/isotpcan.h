@@ -17,11 +17,20 @@ public:
 
     void recv(IsoTpPacket & result) override;
 
+    // Receives a packet beginning with `first`, a single or first frame
+    // that was already read from the interface
+    void recv(const CanMessage & first, IsoTpPacket & result);
+
     // Sends a request and waits for a response
     void request(const IsoTpPacket & req, IsoTpPacket & result) override;
 
     void send(const IsoTpPacket & packet) override;
 
+    Task<void> recvAsync(IsoTpPacket & result) override;
+    Task<void> requestAsync(const IsoTpPacket & req,
+                            IsoTpPacket & result) override;
+    Task<void> sendAsync(const IsoTpPacket & packet) override;
+
     inline void setCan(CanPtr && can) { can_ = std::move(can); }
 
     // May return nullptr
@@ -37,6 +46,8 @@ public:
     // Receives next CAN message with proper id
     CanMessage recvNextFrame();
     CanMessage recvNextFrame(uint8_t expectedType);
+    Task<CanMessage> recvNextFrameAsync();
+    Task<CanMessage> recvNextFrameAsync(uint8_t expectedType);
 
 private:
     CanPtr can_;
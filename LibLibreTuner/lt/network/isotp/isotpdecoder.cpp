@@ -0,0 +1,566 @@
+#include "isotpdecoder.h"
+
+#include "isotp.h"
+#include "../can/tracefile.h"
+#include "../uds/uds.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace lt::network
+{
+
+namespace
+{
+constexpr uint8_t typeSingle = 0;
+constexpr uint8_t typeFirst = 1;
+constexpr uint8_t typeConsec = 2;
+constexpr uint8_t typeFlow = 3;
+
+constexpr uint8_t flowClear = 0;
+constexpr uint8_t flowWait = 1;
+constexpr uint8_t flowOverflow = 2;
+
+// Larger lengths are treated as corrupt first frames
+constexpr uint32_t maxTransferSize = 1 << 24;
+
+// Normal fixed addressing: 0x18DA <target> <source>
+constexpr uint32_t normalFixedMask = 0x1FFF0000;
+constexpr uint32_t normalFixedBase = 0x18DA0000;
+
+// Services whose sub-function may suppress the positive response
+bool canSuppress(uint8_t sid) noexcept
+{
+    switch (sid)
+    {
+    case UDS_REQ_SESSION:
+    case 0x11: // ECUReset
+    case UDS_REQ_SECURITY:
+    case 0x28: // CommunicationControl
+    case 0x3E: // TesterPresent
+    case 0x85: // ControlDTCSetting
+    case 0x87: // LinkControl
+        return true;
+    default:
+        return false;
+    }
+}
+} // namespace
+
+std::vector<IsoTpAddressPair> IsoTpDecoderOptions::defaultAddresses()
+{
+    std::vector<IsoTpAddressPair> addresses;
+    for (uint32_t i = 0; i < 8; ++i)
+        addresses.push_back(IsoTpAddressPair{0x7E0 + i, 0x7E8 + i});
+    return addresses;
+}
+
+double IsoTpTransfer::throughput() const noexcept
+{
+    auto micros = duration().count();
+    if (micros <= 0)
+        return 0.0;
+    return static_cast<double>(received) * 1000000.0 / static_cast<double>(micros);
+}
+
+const char * udsServiceName(uint8_t sid) noexcept
+{
+    switch (sid)
+    {
+    case 0x01:
+        return "ShowCurrentData";
+    case 0x02:
+        return "ShowFreezeFrameData";
+    case 0x03:
+        return "ShowStoredDTCs";
+    case 0x04:
+        return "ClearDTCs";
+    case 0x09:
+        return "RequestVehicleInformation";
+    case UDS_REQ_SESSION:
+        return "DiagnosticSessionControl";
+    case 0x11:
+        return "ECUReset";
+    case 0x14:
+        return "ClearDiagnosticInformation";
+    case 0x19:
+        return "ReadDTCInformation";
+    case UDS_REQ_READBYID:
+        return "ReadDataByIdentifier";
+    case UDS_REQ_READMEM:
+        return "ReadMemoryByAddress";
+    case 0x24:
+        return "ReadScalingDataByIdentifier";
+    case UDS_REQ_SECURITY:
+        return "SecurityAccess";
+    case 0x28:
+        return "CommunicationControl";
+    case 0x2A:
+        return "ReadDataByPeriodicIdentifier";
+    case 0x2C:
+        return "DynamicallyDefineDataIdentifier";
+    case 0x2E:
+        return "WriteDataByIdentifier";
+    case 0x2F:
+        return "InputOutputControlByIdentifier";
+    case 0x31:
+        return "RoutineControl";
+    case UDS_REQ_REQUESTDOWNLOAD:
+        return "RequestDownload";
+    case UDS_REQ_REQUESTUPLOAD:
+        return "RequestUpload";
+    case UDS_REQ_TRANSFERDATA:
+        return "TransferData";
+    case 0x37:
+        return "RequestTransferExit";
+    case 0x38:
+        return "RequestFileTransfer";
+    case 0x3D:
+        return "WriteMemoryByAddress";
+    case 0x3E:
+        return "TesterPresent";
+    case 0x85:
+        return "ControlDTCSetting";
+    case 0x87:
+        return "LinkControl";
+    default:
+        return nullptr;
+    }
+}
+
+IsoTpDecoder::IsoTpDecoder(IsoTpDecoderOptions options) : options_(std::move(options))
+{
+    clear();
+}
+
+void IsoTpDecoder::clear()
+{
+    channels_.clear();
+    ids_.clear();
+    transfers_.clear();
+    transactions_.clear();
+    payload_.clear();
+    stats_ = IsoTpDecoderStats{};
+
+    for (const IsoTpAddressPair & pair : options_.addresses)
+        addPair(pair.tester, pair.ecu);
+    functional_ = addChannel(options_.functionalId, true);
+}
+
+uint32_t IsoTpDecoder::addChannel(uint32_t id, bool tester)
+{
+    auto it = std::find(ids_.begin(), ids_.end(), id);
+    if (it != ids_.end())
+        return static_cast<uint32_t>(it - ids_.begin());
+
+    Channel channel{};
+    channel.id = id;
+    channel.peer = None;
+    channel.tester = tester;
+    channels_.push_back(channel);
+    ids_.push_back(id);
+    return static_cast<uint32_t>(channels_.size() - 1);
+}
+
+void IsoTpDecoder::addPair(uint32_t tester, uint32_t ecu)
+{
+    uint32_t a = addChannel(tester, true);
+    uint32_t b = addChannel(ecu, false);
+    channels_[a].peer = b;
+    channels_[b].peer = a;
+}
+
+uint32_t IsoTpDecoder::findChannel(uint32_t id)
+{
+    auto it = std::find(ids_.begin(), ids_.end(), id);
+    if (it != ids_.end())
+        return static_cast<uint32_t>(it - ids_.begin());
+
+    if (!options_.normalFixed || (id & normalFixedMask) != normalFixedBase)
+        return None;
+
+    uint32_t target = (id >> 8) & 0xFF;
+    uint32_t source = id & 0xFF;
+    uint32_t peer = normalFixedBase | (source << 8) | target;
+    // External test equipment uses source addresses 0xF0 and up
+    if (source >= 0xF0)
+        addPair(id, peer);
+    else
+        addPair(peer, id);
+    return static_cast<uint32_t>(std::find(ids_.begin(), ids_.end(), id) - ids_.begin());
+}
+
+void IsoTpDecoder::add(const CanLogEntry * entries, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        add(entries[i]);
+}
+
+void IsoTpDecoder::add(const CanLog & log)
+{
+    constexpr std::size_t SliceSize = 4096;
+    uint64_t end = log.total();
+    for (uint64_t sequence = log.firstSequence(); sequence < end; sequence += SliceSize)
+    {
+        std::vector<CanLogEntry> entries = log.entries(sequence, SliceSize);
+        add(entries.data(), entries.size());
+    }
+}
+
+void IsoTpDecoder::add(TraceReader & reader)
+{
+    CanLogEntry entry{};
+    while (reader.next(entry))
+        add(entry);
+}
+
+void IsoTpDecoder::add(const CanLogEntry & entry)
+{
+    ++stats_.frames;
+    const CanMessage & message = entry.message;
+    uint32_t index = findChannel(message.id());
+    if (index == None)
+    {
+        ++stats_.ignoredFrames;
+        return;
+    }
+
+    const uint8_t * data = message.message();
+    std::size_t length = message.length();
+    if (length == 0)
+    {
+        ++stats_.unexpectedFrames;
+        return;
+    }
+
+    switch (data[0] >> 4)
+    {
+    case typeSingle:
+    {
+        std::size_t size = data[0] & 0x0F;
+        std::size_t offset = 1;
+        if (size == 0 && length > 2)
+        {
+            // Escaped length used by CAN FD
+            size = data[1];
+            offset = 2;
+        }
+        if (size == 0 || offset + size > length)
+        {
+            ++stats_.unexpectedFrames;
+            return;
+        }
+        startTransfer(index, entry, static_cast<uint32_t>(size), data + offset, size);
+        endTransfer(index, IsoTpTransferStatus::Complete);
+        break;
+    }
+    case typeFirst:
+    {
+        if (length < 2)
+        {
+            ++stats_.unexpectedFrames;
+            return;
+        }
+        uint32_t size = ((data[0] & 0x0F) << 8) | data[1];
+        std::size_t offset = 2;
+        if (size == 0 && length >= 6)
+        {
+            // Escaped 32-bit length for messages over 4095 bytes
+            size = (static_cast<uint32_t>(data[2]) << 24) | (static_cast<uint32_t>(data[3]) << 16) |
+                   (static_cast<uint32_t>(data[4]) << 8) | data[5];
+            offset = 6;
+        }
+        if (size == 0 || size > maxTransferSize)
+        {
+            ++stats_.unexpectedFrames;
+            return;
+        }
+        startTransfer(index, entry, size, data + offset, length - offset);
+
+        Channel & channel = channels_[index];
+        channel.sequence = 1;
+        channel.previousConsecutive = false;
+        break;
+    }
+    case typeConsec:
+        consecutiveFrame(index, entry);
+        break;
+    case typeFlow:
+        flowControl(index, entry);
+        break;
+    default:
+        ++stats_.unexpectedFrames;
+        break;
+    }
+}
+
+void IsoTpDecoder::startTransfer(uint32_t index, const CanLogEntry & entry, uint32_t size, const uint8_t * data,
+                                 std::size_t length)
+{
+    Channel & channel = channels_[index];
+    if (channel.transfer != None)
+        endTransfer(index, IsoTpTransferStatus::Aborted);
+
+    IsoTpTransfer & transfer = transfers_.emplace_back();
+    transfer.id = channel.id;
+    transfer.fromTester = channel.tester;
+    transfer.size = size;
+    transfer.begin = entry.time;
+    transfer.end = entry.time;
+    transfer.frames = 1;
+    if (options_.keepPayload)
+    {
+        // The whole payload is reserved up front so interleaved transfers
+        // stay contiguous
+        transfer.offset = payload_.size();
+        payload_.resize(payload_.size() + size);
+    }
+
+    channel.transfer = static_cast<uint32_t>(transfers_.size() - 1);
+    channel.lastFrame = entry.time;
+    appendTransfer(transfer, data, length);
+}
+
+void IsoTpDecoder::appendTransfer(IsoTpTransfer & transfer, const uint8_t * data, std::size_t length)
+{
+    length = std::min<std::size_t>(length, transfer.size - transfer.received);
+    for (std::size_t i = transfer.received; i < IsoTpTransfer::HeadSize && i - transfer.received < length; ++i)
+        transfer.head[i] = data[i - transfer.received];
+    if (transfer.offset != std::numeric_limits<std::size_t>::max())
+        std::memcpy(payload_.data() + transfer.offset + transfer.received, data, length);
+    transfer.received += static_cast<uint32_t>(length);
+}
+
+void IsoTpDecoder::consecutiveFrame(uint32_t index, const CanLogEntry & entry)
+{
+    Channel & channel = channels_[index];
+    if (channel.transfer == None)
+    {
+        ++stats_.unexpectedFrames;
+        return;
+    }
+
+    const uint8_t * data = entry.message.message();
+    uint8_t sequence = data[0] & 0x0F;
+    if (sequence != channel.sequence)
+    {
+        endTransfer(index, IsoTpTransferStatus::SequenceError);
+        return;
+    }
+    channel.sequence = (sequence + 1) & 0x0F;
+
+    IsoTpTransfer & transfer = transfers_[channel.transfer];
+    if (channel.previousConsecutive)
+    {
+        auto gap = entry.time - channel.lastFrame;
+        transfer.minGap = std::min(transfer.minGap, gap);
+        transfer.maxGap = std::max(transfer.maxGap, gap);
+        transfer.totalGap += gap;
+        ++transfer.gaps;
+        if (gap + options_.stMinTolerance < channel.stMin)
+            ++transfer.stMinViolations;
+    }
+
+    // The frame after a full block follows a flow control frame, so its
+    // gap is not measured
+    channel.previousConsecutive = channel.blockSize == 0 || --channel.blockLeft != 0;
+
+    ++transfer.frames;
+    transfer.end = entry.time;
+    channel.lastFrame = entry.time;
+    appendTransfer(transfer, data + 1, entry.message.length() - 1u);
+    if (transfer.received >= transfer.size)
+        endTransfer(index, IsoTpTransferStatus::Complete);
+}
+
+void IsoTpDecoder::flowControl(uint32_t index, const CanLogEntry & entry)
+{
+    uint32_t senderIndex = channels_[index].peer;
+    if (senderIndex == None || channels_[senderIndex].transfer == None || entry.message.length() < 3)
+    {
+        ++stats_.unexpectedFrames;
+        return;
+    }
+
+    Channel & sender = channels_[senderIndex];
+    IsoTpTransfer & transfer = transfers_[sender.transfer];
+    const uint8_t * data = entry.message.message();
+    ++transfer.flowControlFrames;
+
+    switch (data[0] & 0x0F)
+    {
+    case flowClear:
+        if (transfer.flowControlFrames - transfer.flowControlWaits == 1)
+        {
+            transfer.blockSize = data[1];
+            transfer.stMin = data[2];
+            transfer.flowControlDelay = entry.time - transfer.begin;
+        }
+        transfer.flowControlWait += entry.time - sender.lastFrame;
+        sender.blockSize = data[1];
+        sender.blockLeft = data[1];
+        sender.stMin = detail::calculate_time(data[2]);
+        sender.previousConsecutive = false;
+        break;
+    case flowWait:
+        ++transfer.flowControlWaits;
+        break;
+    case flowOverflow:
+        endTransfer(senderIndex, IsoTpTransferStatus::Overflow);
+        break;
+    default:
+        ++stats_.unexpectedFrames;
+        break;
+    }
+}
+
+void IsoTpDecoder::endTransfer(uint32_t index, IsoTpTransferStatus status)
+{
+    Channel & channel = channels_[index];
+    std::size_t transfer = channel.transfer;
+    transfers_[transfer].status = status;
+    channel.transfer = None;
+    channel.previousConsecutive = false;
+    channel.blockSize = 0;
+
+    if (status != IsoTpTransferStatus::Complete)
+        return;
+    if (channel.tester)
+        request(index, transfer);
+    else
+        response(index, transfer);
+}
+
+void IsoTpDecoder::request(uint32_t index, std::size_t transferIndex)
+{
+    if (channels_[index].transaction != None)
+        closeTransaction(index, UdsTransactionStatus::NoResponse);
+
+    const IsoTpTransfer & transfer = transfers_[transferIndex];
+    UdsTransaction & transaction = transactions_.emplace_back();
+    transaction.sid = transfer.head[0];
+    transaction.request = transferIndex;
+    transaction.requestBegin = transfer.begin;
+    transaction.requestEnd = transfer.end;
+    transaction.responseBegin = transfer.end;
+    transaction.responseEnd = transfer.end;
+    // A suppressed positive response may still be answered negatively, so
+    // the transaction stays open
+    if (transfer.received >= 2 && (transfer.head[1] & 0x80) != 0 && canSuppress(transaction.sid))
+        transaction.status = UdsTransactionStatus::Suppressed;
+
+    channels_[index].transaction = static_cast<uint32_t>(transactions_.size() - 1);
+}
+
+void IsoTpDecoder::response(uint32_t index, std::size_t transferIndex)
+{
+    uint32_t owner = channels_[index].peer;
+    if (owner == None || channels_[owner].transaction == None)
+        owner = functional_;
+    if (channels_[owner].transaction == None)
+    {
+        ++stats_.unmatchedResponses;
+        return;
+    }
+
+    UdsTransaction & transaction = transactions_[channels_[owner].transaction];
+    const IsoTpTransfer & transfer = transfers_[transferIndex];
+    if (transfer.head[0] == UDS_RES_NEGATIVE && transfer.received >= 3 && transfer.head[1] == transaction.sid)
+    {
+        if (transfer.head[2] == UDS_NRES_RCRRP)
+        {
+            ++transaction.pending;
+            return;
+        }
+        transaction.status = UdsTransactionStatus::Negative;
+        transaction.negativeCode = transfer.head[2];
+    }
+    else if (transfer.head[0] == static_cast<uint8_t>(transaction.sid + 0x40))
+    {
+        transaction.status = UdsTransactionStatus::Positive;
+    }
+    else
+    {
+        ++stats_.unmatchedResponses;
+        return;
+    }
+
+    transaction.response = transferIndex;
+    transaction.responseBegin = transfer.begin;
+    transaction.responseEnd = transfer.end;
+    channels_[owner].transaction = None;
+}
+
+void IsoTpDecoder::closeTransaction(uint32_t index, UdsTransactionStatus status)
+{
+    UdsTransaction & transaction = transactions_[channels_[index].transaction];
+    if (transaction.status == UdsTransactionStatus::Active)
+        transaction.status = status;
+    channels_[index].transaction = None;
+}
+
+void IsoTpDecoder::finish()
+{
+    for (uint32_t i = 0; i < channels_.size(); ++i)
+    {
+        if (channels_[i].transfer != None)
+            endTransfer(i, IsoTpTransferStatus::Incomplete);
+    }
+    for (uint32_t i = 0; i < channels_.size(); ++i)
+    {
+        if (channels_[i].transaction != None)
+            closeTransaction(i, UdsTransactionStatus::NoResponse);
+    }
+}
+
+const uint8_t * IsoTpDecoder::payload(const IsoTpTransfer & transfer) const noexcept
+{
+    if (transfer.offset == std::numeric_limits<std::size_t>::max())
+        return nullptr;
+    return payload_.data() + transfer.offset;
+}
+
+std::vector<UdsServiceSummary> IsoTpDecoder::summarize() const
+{
+    std::array<UdsServiceSummary, 256> services{};
+    for (const UdsTransaction & transaction : transactions_)
+    {
+        UdsServiceSummary & service = services[transaction.sid];
+        service.sid = transaction.sid;
+        ++service.count;
+        service.pending += transaction.pending;
+        service.requestBytes += transfers_[transaction.request].received;
+        service.totalTime += transaction.duration();
+
+        switch (transaction.status)
+        {
+        case UdsTransactionStatus::Negative:
+            ++service.negative;
+            break;
+        case UdsTransactionStatus::NoResponse:
+        case UdsTransactionStatus::Active:
+            ++service.noResponse;
+            break;
+        default:
+            break;
+        }
+
+        if (transaction.response != UdsTransaction::npos)
+        {
+            service.responseBytes += transfers_[transaction.response].received;
+            service.totalLatency += transaction.latency();
+            service.maxLatency = std::max(service.maxLatency, transaction.latency());
+        }
+    }
+
+    std::vector<UdsServiceSummary> summary;
+    std::copy_if(services.begin(), services.end(), std::back_inserter(summary),
+                 [](const UdsServiceSummary & service) { return service.count != 0; });
+    std::sort(summary.begin(), summary.end(), [](const UdsServiceSummary & a, const UdsServiceSummary & b) {
+        return a.totalTime > b.totalTime;
+    });
+    return summary;
+}
+
+} // namespace lt::network
@@ -0,0 +1,265 @@
+#ifndef LT_ISOTPDECODER_H
+#define LT_ISOTPDECODER_H
+
+#include "../can/canlog.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lt::network
+{
+
+class TraceReader;
+
+struct IsoTpAddressPair
+{
+    // Tester (request) and ECU (response) CAN ids
+    uint32_t tester, ecu;
+};
+
+struct IsoTpDecoderOptions
+{
+    // Physical address pairs to decode. Defaults to the OBD-II pairs
+    // 0x7E0-0x7E7 / 0x7E8-0x7EF.
+    std::vector<IsoTpAddressPair> addresses = defaultAddresses();
+    // Functional request id. Responses on any ECU id may answer it.
+    uint32_t functionalId{0x7DF};
+    // Also decodes 29-bit normal fixed addressing (0x18DAxxyy) ids as
+    // they appear
+    bool normalFixed{true};
+    // Copies reassembled payloads. If false, only the first bytes of each
+    // transfer are kept, which is enough for UDS annotation.
+    bool keepPayload{true};
+    // Gaps shorter than STmin by less than this are not counted as
+    // violations, to allow for capture timestamp jitter
+    std::chrono::microseconds stMinTolerance{0};
+
+    static std::vector<IsoTpAddressPair> defaultAddresses();
+};
+
+enum class IsoTpTransferStatus : uint8_t
+{
+    // Still receiving frames
+    Active,
+    Complete,
+    // Superseded by a new first or single frame
+    Aborted,
+    // Consecutive frame with the wrong sequence number
+    SequenceError,
+    // Receiver answered with flow control overflow
+    Overflow,
+    // The capture ended before the transfer completed
+    Incomplete,
+};
+
+// A reassembled ISO-TP message
+struct IsoTpTransfer
+{
+    static constexpr std::size_t HeadSize = 4;
+
+    // CAN id of the sender
+    uint32_t id{0};
+    IsoTpTransferStatus status{IsoTpTransferStatus::Active};
+    bool fromTester{false};
+
+    // Length announced in the single or first frame
+    uint32_t size{0};
+    // Bytes received so far
+    uint32_t received{0};
+    // First bytes of the payload
+    std::array<uint8_t, HeadSize> head{};
+    // Offset of the payload in IsoTpDecoder::payloadData(), or npos if
+    // payloads are not kept
+    std::size_t offset{std::numeric_limits<std::size_t>::max()};
+
+    std::chrono::microseconds begin{0}, end{0};
+
+    // Frames sent by the sender, including the first frame
+    uint32_t frames{0};
+    uint32_t flowControlFrames{0};
+    uint32_t flowControlWaits{0};
+
+    // Parameters of the first clear-to-send flow control frame
+    uint8_t blockSize{0};
+    uint8_t stMin{0};
+
+    // Time from the first frame to the first flow control frame
+    std::chrono::microseconds flowControlDelay{0};
+    // Time from the last frame of each block to the flow control frame
+    // that releases the next block, summed
+    std::chrono::microseconds flowControlWait{0};
+    // Gaps between consecutive frames within a block
+    std::chrono::microseconds minGap{std::chrono::microseconds::max()};
+    std::chrono::microseconds maxGap{0};
+    std::chrono::microseconds totalGap{0};
+    uint32_t gaps{0};
+    // Gaps shorter than STmin
+    uint32_t stMinViolations{0};
+
+    inline bool singleFrame() const noexcept { return frames == 1 && flowControlFrames == 0; }
+    inline uint8_t sid() const noexcept { return received > 0 ? head[0] : 0; }
+    inline std::chrono::microseconds duration() const noexcept { return end - begin; }
+    inline std::chrono::microseconds meanGap() const noexcept
+    {
+        return gaps == 0 ? std::chrono::microseconds(0) : totalGap / gaps;
+    }
+
+    // Payload bytes per second
+    double throughput() const noexcept;
+};
+
+enum class UdsTransactionStatus : uint8_t
+{
+    Active,
+    Positive,
+    Negative,
+    // A positive response was suppressed by the request
+    Suppressed,
+    // Another request or the end of the capture came first
+    NoResponse,
+};
+
+// A UDS request and its final response
+struct UdsTransaction
+{
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    uint8_t sid{0};
+    UdsTransactionStatus status{UdsTransactionStatus::Active};
+    // Negative response code, if negative
+    uint8_t negativeCode{0};
+    // Response pending (0x78) responses received before the final response
+    uint32_t pending{0};
+    // Indices into IsoTpDecoder::transfers()
+    std::size_t request{npos};
+    std::size_t response{npos};
+
+    std::chrono::microseconds requestBegin{0}, requestEnd{0};
+    // Start and end of the final response
+    std::chrono::microseconds responseBegin{0}, responseEnd{0};
+
+    // Time from the end of the request to the start of the final response
+    inline std::chrono::microseconds latency() const noexcept { return responseBegin - requestEnd; }
+    // Time from the start of the request to the end of the final response
+    inline std::chrono::microseconds duration() const noexcept { return responseEnd - requestBegin; }
+};
+
+// Totals for one UDS service
+struct UdsServiceSummary
+{
+    uint8_t sid{0};
+    uint32_t count{0};
+    uint32_t negative{0};
+    uint32_t noResponse{0};
+    uint32_t pending{0};
+    uint64_t requestBytes{0};
+    uint64_t responseBytes{0};
+    std::chrono::microseconds totalTime{0};
+    std::chrono::microseconds totalLatency{0};
+    std::chrono::microseconds maxLatency{0};
+};
+
+struct IsoTpDecoderStats
+{
+    uint64_t frames{0};
+    // Frames on ids that are not decoded
+    uint64_t ignoredFrames{0};
+    // Consecutive or flow control frames without a transfer, and frames
+    // with an invalid PCI
+    uint64_t unexpectedFrames{0};
+    // Responses that do not match an open request
+    uint64_t unmatchedResponses{0};
+};
+
+// Returns the name of a UDS or OBD-II service, or nullptr if unknown
+const char * udsServiceName(uint8_t sid) noexcept;
+
+// Passively reassembles ISO-TP messages from captured CAN frames and pairs
+// UDS requests with their responses. Frames must be added in capture order.
+// Decoding keeps a small amount of state per CAN id and does not allocate
+// per frame.
+class IsoTpDecoder
+{
+public:
+    explicit IsoTpDecoder(IsoTpDecoderOptions options = {});
+
+    void add(const CanLogEntry & entry);
+    void add(const CanLogEntry * entries, std::size_t count);
+    // Adds every readable entry of a log
+    void add(const CanLog & log);
+    // Adds every frame of a trace
+    void add(TraceReader & reader);
+
+    // Closes active transfers and transactions at the end of a capture
+    void finish();
+
+    void clear();
+
+    inline const std::vector<IsoTpTransfer> & transfers() const noexcept { return transfers_; }
+    inline const std::vector<UdsTransaction> & transactions() const noexcept { return transactions_; }
+    inline const IsoTpDecoderStats & stats() const noexcept { return stats_; }
+
+    // Returns the reassembled payload of a transfer, or nullptr if payloads
+    // are not kept. The payload has `received` bytes.
+    const uint8_t * payload(const IsoTpTransfer & transfer) const noexcept;
+
+    // Totals per UDS service, sorted by total time
+    std::vector<UdsServiceSummary> summarize() const;
+
+private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    struct Channel
+    {
+        uint32_t id;
+        // Index of the channel that sends flow control for this channel
+        uint32_t peer;
+        bool tester;
+        // Index of the active transfer, or None
+        uint32_t transfer{None};
+        // Index of the open transaction (tester channels), or None
+        uint32_t transaction{None};
+        uint8_t sequence{0};
+        // Block size of the last flow control frame, 0 if unlimited
+        uint8_t blockSize{0};
+        // Consecutive frames left in the current block
+        uint8_t blockLeft{0};
+        // Whether the last frame was a consecutive frame in the same block
+        bool previousConsecutive{false};
+        std::chrono::microseconds stMin{0};
+        std::chrono::microseconds lastFrame{0};
+    };
+
+    IsoTpDecoderOptions options_;
+    std::vector<Channel> channels_;
+    // Ids of channels_, kept separately for a cache friendly search
+    std::vector<uint32_t> ids_;
+    uint32_t functional_{None};
+
+    std::vector<IsoTpTransfer> transfers_;
+    std::vector<UdsTransaction> transactions_;
+    std::vector<uint8_t> payload_;
+    IsoTpDecoderStats stats_;
+
+    uint32_t addChannel(uint32_t id, bool tester);
+    void addPair(uint32_t tester, uint32_t ecu);
+    uint32_t findChannel(uint32_t id);
+
+    void startTransfer(uint32_t channel, const CanLogEntry & entry, uint32_t size, const uint8_t * data,
+                       std::size_t length);
+    void appendTransfer(IsoTpTransfer & transfer, const uint8_t * data, std::size_t length);
+    void consecutiveFrame(uint32_t channel, const CanLogEntry & entry);
+    void flowControl(uint32_t channel, const CanLogEntry & entry);
+    void endTransfer(uint32_t channel, IsoTpTransferStatus status);
+
+    void request(uint32_t channel, std::size_t transfer);
+    void response(uint32_t channel, std::size_t transfer);
+    void closeTransaction(uint32_t channel, UdsTransactionStatus status);
+};
+
+} // namespace lt::network
+
+#endif // LT_ISOTPDECODER_H
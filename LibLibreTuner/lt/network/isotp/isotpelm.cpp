@@ -1,49 +1,66 @@
 #include "isotpelm.h"
 
-#include "../../support/util.hpp"
+#include "../../support/hex.h"
 
 #include <algorithm>
 #include <cassert>
-#include <iomanip>
-#include <sstream>
+#include <stdexcept>
 
 namespace lt::network
 {
-namespace detail
+namespace
 {
-inline uint8_t hexToInt(char c)
+// Longest message an ELM327 can send as a single frame
+constexpr std::size_t maxSingleFrame = 7;
+
+// Decodes up to `limit` bytes of hex and appends them to `packet`. Returns
+// false if the text is not hex.
+bool appendHex(IsoTpPacket & packet, std::string_view text, std::size_t limit)
 {
-    if (c >= '0' && c <= '9')
-    {
-        return static_cast<uint8_t>(c - '0');
-    }
-    if (c >= 'a' && c <= 'z')
-    {
-        return 0xA + static_cast<uint8_t>(c - 'a');
-    }
-    if (c >= 'A' && c <= 'Z')
+    if (text.size() % 2 != 0)
+        return false;
+
+    uint8_t bytes[64];
+    std::size_t remaining = std::min(text.size() / 2, limit);
+    while (remaining != 0)
     {
-        return 0xA + static_cast<uint8_t>(c - 'A');
+        std::size_t chunk = std::min(remaining, sizeof(bytes));
+        if (hex::decode(text.substr(0, chunk * 2), bytes, chunk) < 0)
+            return false;
+        packet.append(bytes, chunk);
+        text.remove_prefix(chunk * 2);
+        remaining -= chunk;
     }
-    throw std::runtime_error(std::string("invalid hex character: ") + c);
+    return true;
 }
 
-template <typename Iter> std::string decodeHex(Iter begin, Iter end)
+// Returns the number of responses to tell the adapter to wait for, or 0 to
+// wait for its timeout. Only used for requests that are safe to repeat and
+// have exactly one response, so the adapter returns as soon as it arrives
+// instead of waiting out the timeout after every request.
+int responseHint(const IsoTpPacket & packet)
 {
-    std::string decoded;
-    for (auto it = begin; it != end; ++it)
+    if (packet.empty())
+        return 0;
+    switch (packet[0])
     {
-        uint8_t byte = hexToInt(*it) << 4;
-        if (++it == end)
-        {
-            break;
-        }
-        byte |= hexToInt(*it);
-        decoded += static_cast<char>(byte);
+    case 0x22: // ReadDataByIdentifier
+    case 0x23: // ReadMemoryByAddress
+        return 1;
+    case 0x3E: // TesterPresent, unless the response is suppressed
+        return packet.size() >= 2 && (packet[1] & 0x80) != 0 ? 0 : 1;
+    default:
+        return 0;
     }
-    return decoded;
 }
-} // namespace detail
+
+// Returns true if the packet is a negative response with code 0x78
+// (request correctly received, response pending)
+bool isResponsePending(const IsoTpPacket & packet)
+{
+    return packet.size() == 3 && packet[0] == 0x7F && packet[2] == 0x78;
+}
+} // namespace
 
 IsoTpElm::IsoTpElm(Elm327Ptr device, IsoTpOptions options)
     : device_(std::move(device)), options_(options)
@@ -56,51 +73,105 @@ IsoTpElm::IsoTpElm(Elm327Ptr device, IsoTpOptions options)
 
     // Disable  echo
     device_->setEcho(false);
+    // Check for the STN11xx command set
+    device_->identify();
     // Set protocol
     device_->setProtocol(ElmProtocol::ISO_15765_4_CAN_11bit_500);
     // Disable printing spaces
     device_->setPrintSpaces(false);
     // Disable printing headers
     device_->setHeaders(false);
+    // Allow long messages
+    device_->setAllowLong(true);
+    if (device_->isStn())
+    {
+        // Segment messages longer than 7 bytes sent with STPX
+        device_->sendBasicCommand("STCSEGT 1");
+    }
 
     updateOptions();
 }
 
 void IsoTpElm::recv(IsoTpPacket & result)
 {
-    if (buffer_.empty())
+    if (next_ == count_)
     {
         throw std::runtime_error("no ressponses remaining from last request");
     }
-    result = std::move(buffer_.front());
-    buffer_.pop();
+    result.swap(packets_[next_++]);
 }
 
 void IsoTpElm::request(const IsoTpPacket & req, IsoTpPacket & result)
 {
     send(req);
 
-    if (buffer_.empty())
+    if (next_ == count_)
     {
         throw std::runtime_error("received no response");
     }
 
-    result = std::move(buffer_.front());
-    buffer_.pop();
+    result.swap(packets_[next_++]);
 }
 
 void IsoTpElm::send(const IsoTpPacket & packet)
 {
+    int responses = responseHint(packet);
+    transmit(packet, responses);
+
+    if (responses != 0 && count_ != 0 && isResponsePending(packets_[count_ - 1]))
+    {
+        // The adapter stopped listening after the pending response. Hinted
+        // requests can be repeated, so send it again and wait for the
+        // final response with the adapter timeout.
+        transmit(packet, 0);
+    }
+}
+
+void IsoTpElm::transmit(const IsoTpPacket & packet, int responses)
+{
+    count_ = 0;
+    next_ = 0;
+    expectedLength_ = 0;
+    receiving_ = false;
+    error_ = nullptr;
+
+    command_.clear();
+    bool extended = packet.size() > maxSingleFrame;
+    if (extended)
+    {
+        if (!device_->isStn())
+        {
+            throw std::runtime_error("ELM327 adapters cannot send messages longer than 7 bytes");
+        }
+        command_ = "STPX D:";
+    }
+
     // Format packet into hex string
-    std::stringstream ss;
-    for (uint8_t ch : packet)
+    std::size_t offset = command_.size();
+    command_.resize(offset + packet.size() * 2);
+    hex::encode(command_.data() + offset, packet.data(), packet.size());
+
+    if (responses != 0)
     {
-        ss << std::hex << std::setw(2) << std::setfill('0')
-           << static_cast<uint32_t>(ch);
+        // A trailing digit after the data is the response count
+        if (extended)
+            command_ += ",R:";
+        command_ += hex::digits[responses & 0xF];
     }
 
-    std::vector<std::string> response = device_->sendCommand(ss.str());
-    processResponse(response);
+    ElmStatus status = device_->sendCommand(command_, [this](std::string_view line) { processLine(line); });
+    if (receiving_ && error_ == nullptr)
+    {
+        error_ = "message did not meet expected length";
+    }
+    if (error_ != nullptr)
+    {
+        throw std::runtime_error(error_);
+    }
+    if (status != ElmStatus::Ok)
+    {
+        throw std::runtime_error(toString(status));
+    }
 }
 
 void IsoTpElm::setOptions(const IsoTpOptions & options)
@@ -116,82 +187,89 @@ void IsoTpElm::updateOptions()
     // TODO: set timeout
 }
 
-void IsoTpElm::processResponse(std::vector<std::string> & response)
+IsoTpPacket & IsoTpElm::beginPacket()
 {
-    IsoTpPacket packet;
+    if (count_ == packets_.size())
+    {
+        packets_.emplace_back();
+    }
+    IsoTpPacket & packet = packets_[count_];
+    packet.clear();
+    return packet;
+}
+
+void IsoTpElm::finishPacket() noexcept
+{
+    ++count_;
+    receiving_ = false;
+}
 
-    int expectedLength = 0;
+void IsoTpElm::processLine(std::string_view line)
+{
+    // Only the first error is reported
+    if (error_ != nullptr)
+    {
+        return;
+    }
 
-    for (std::string & line : response)
+    if (line.size() == 3)
     {
-        // Strip whitespace
-        lt::remove_whitespace(line);
-        if (line.empty())
+        // Multi-line packet length. Data lines always have an even length.
+        if (receiving_)
         {
-            continue;
+            // Last multi-line response was incomplete
+            error_ = "message did not meet expected length";
+            return;
         }
-
-        if (line.size() == 3)
+        uint16_t length;
+        if (!hex::parse(line, length))
         {
-            // Multi-line packet length
-
-            if (!packet.empty())
-            {
-                // Last multi-line response was incomplete
-                throw std::runtime_error(
-                    "message did not meet expected length");
-            }
-            std::size_t pos;
-            expectedLength = std::stoul(line, &pos, 16);
-            if (pos != 3)
-            {
-                // Non-numeric character somewhere
-                throw std::runtime_error("unexpected character in response: " +
-                                         line);
-            }
-            continue;
+            error_ = "unexpected character in response";
+            return;
         }
+        beginPacket();
+        expectedLength_ = length;
+        receiving_ = true;
+        return;
+    }
 
-        auto delim = std::find(line.begin(), line.end(), ':');
-        if (delim != line.end())
+    if (auto delim = line.find(':'); delim != std::string_view::npos)
+    {
+        // Part of multi-line packet
+        if (!receiving_)
         {
-            // Part of multi-line packet
-            auto msgBegin = delim + 1;
-            std::string message = detail::decodeHex(msgBegin, line.end());
-            expectedLength -= message.size();
-            if (expectedLength < 0)
-            {
-                // Remove extra bytes
-                std::size_t toRemove =
-                    std::min<std::size_t>(message.size(), -expectedLength);
-                message.erase(message.begin() + (message.size() - toRemove),
-                              message.end());
-                expectedLength += toRemove;
-            }
-            // Can ranges please come sooner?
-            packet.append(reinterpret_cast<const uint8_t *>(message.c_str()),
-                          message.length());
-
-            if (expectedLength <= 0)
-            {
-                buffer_.emplace(std::move(packet));
-                packet.clear();
-            }
-            continue;
+            error_ = "received frame without message length";
+            return;
         }
-
-        if (!packet.empty())
+        IsoTpPacket & packet = packets_[count_];
+        std::size_t before = packet.size();
+        // Padding past the expected length is dropped
+        if (!appendHex(packet, line.substr(delim + 1), static_cast<std::size_t>(expectedLength_)))
         {
-            // The last message did not meet the expected length.
-            throw std::runtime_error("message did not meet expected length");
+            error_ = "unexpected character in response";
+            return;
         }
+        expectedLength_ -= static_cast<int>(packet.size() - before);
+        if (expectedLength_ <= 0)
+        {
+            finishPacket();
+        }
+        return;
+    }
+
+    if (receiving_)
+    {
+        // The last message did not meet the expected length.
+        error_ = "message did not meet expected length";
+        return;
+    }
 
-        // Single-line message
-        std::string message = detail::decodeHex(line.begin(), line.end());
-        packet.append(reinterpret_cast<const uint8_t *>(message.c_str()),
-                      message.length());
-        buffer_.emplace(std::move(packet));
-        packet.clear();
+    // Single-line message
+    if (!appendHex(beginPacket(), line, line.size() / 2))
+    {
+        error_ = "unexpected character in response";
+        return;
     }
+    finishPacket();
 }
 } // namespace lt::network
@@ -4,7 +4,9 @@
 #include "../command/elm327.h"
 #include "isotp.h"
 
-#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace lt::network
 {
@@ -30,10 +32,30 @@ private:
     Elm327Ptr device_;
     IsoTpOptions options_;
 
-    std::queue<IsoTpPacket> buffer_;
+    // Responses to the last request. Packets are reused between requests
+    // so their buffers are only allocated once.
+    std::vector<IsoTpPacket> packets_;
+    std::size_t count_{0};
+    std::size_t next_{0};
 
-    // Extracts packets from ELM327 response and fills buffer
-    void processResponse(std::vector<std::string> & response);
+    // Multi-line response state
+    int expectedLength_{0};
+    bool receiving_{false};
+    // First malformed line of the last response, if any
+    const char * error_{nullptr};
+
+    // Reused hex command line
+    std::string command_;
+
+    // Sends a packet, optionally telling the adapter how many responses to
+    // wait for, and collects the responses
+    void transmit(const IsoTpPacket & packet, int responses);
+
+    // Extracts packets from an ELM327 response line
+    void processLine(std::string_view line);
+
+    IsoTpPacket & beginPacket();
+    void finishPacket() noexcept;
 };
 
 } // namespace lt::network
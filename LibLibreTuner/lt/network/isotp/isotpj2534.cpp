@@ -1,10 +1,15 @@
 #include "isotpj2534.h"
-#include <iostream>
+
+#include "../../support/trace.h"
+
+#include <algorithm>
+#include <stdexcept>
 
 namespace lt::network
 {
 IsoTpJ2534::IsoTpJ2534(j2534::DevicePtr device, IsoTpOptions options)
-    : device_(std::move(device)), channel_(device_->connect(j2534::Protocol::ISO15765, 0, options.baudrate)), options_(options)
+    : device_(std::move(device)), channel_(device_->connect(j2534::Protocol::ISO15765, 0, options.baudrate)), options_(options),
+      rxMsgs_(batchSize)
 {
     // Setup the filter
     j2534::PASSTHRU_MSG msgMask{};
@@ -35,19 +40,41 @@ IsoTpJ2534::IsoTpJ2534(j2534::DevicePtr device, IsoTpOptions options)
 
     uint32_t msgId;
     channel_.startMsgFilter(FLOW_CONTROL_FILTER, &msgMask, &msgPattern, &msgFlowControl, msgId);
+
+    // Receive like IsoTpCan: no block limit and no separation time, so the
+    // ECU sends whole responses without waiting for more flow control.
+    // Sending follows the ECU's flow control.
+    channel_.setConfig({
+        {static_cast<uint32_t>(j2534::Parameter::Iso15765Bs), 0},
+        {static_cast<uint32_t>(j2534::Parameter::Iso15765StMin), 0},
+        {static_cast<uint32_t>(j2534::Parameter::Iso15765BsTx), ISO15765_USE_ECU_VALUE},
+        {static_cast<uint32_t>(j2534::Parameter::Iso15765StMinTx), ISO15765_USE_ECU_VALUE},
+    });
+
+    txMsg_.ProtocolID = static_cast<uint32_t>(j2534::Protocol::ISO15765);
+    txMsg_.TxFlags = ISO15765_FRAME_PAD;
 }
 
-void IsoTpJ2534::recv(IsoTpPacket & result)
+void IsoTpJ2534::fill(uint32_t timeout)
 {
-    while (true)
+    LT_TRACE_SPAN("isotpj2534.read");
+    // Drain what is queued without blocking. A blocking read only returns
+    // early once the whole batch has arrived, so it is only used for a
+    // single message.
+    uint32_t pNumMsgs = static_cast<uint32_t>(rxMsgs_.size());
+    channel_.readMsgs(rxMsgs_.data(), pNumMsgs, 0);
+    if (pNumMsgs == 0 && timeout != 0)
     {
-        j2534::PASSTHRU_MSG msg{};
-        msg.ProtocolID = static_cast<uint32_t>(j2534::Protocol::ISO15765);
-
-        uint32_t pNumMsgs = 1;
-        channel_.readMsgs(&msg, pNumMsgs, static_cast<uint32_t>(options_.timeout.count()));
+        pNumMsgs = 1;
+        channel_.readMsgs(rxMsgs_.data(), pNumMsgs, timeout);
+    }
 
-        // Fill buffer
+    for (std::size_t i = 0; i < pNumMsgs; ++i)
+    {
+        const j2534::PASSTHRU_MSG & msg = rxMsgs_[i];
+        // Skip transmit confirmations and first frame indications
+        if ((msg.RxStatus & (TX_MSG_TYPE | START_OF_MESSAGE)) != 0)
+            continue;
         if (msg.DataSize <= 4)
         {
             // The message does not fit the CAN ID
@@ -56,11 +83,30 @@ void IsoTpJ2534::recv(IsoTpPacket & result)
         uint32_t id = (msg.Data[0] << 24U) | (msg.Data[1] << 16U) | (msg.Data[2] << 8U) | (msg.Data[3]);
         if (id != options_.destId)
             continue;
-        result.setData(std::next(std::begin(msg.Data), 4), msg.DataSize - 4);
-        return;
+        pending_.emplace_back(msg.Data + 4, msg.DataSize - 4);
     }
 }
 
+void IsoTpJ2534::recv(IsoTpPacket & result)
+{
+    auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+    while (pending_.empty())
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            if (options_.metrics)
+                options_.metrics->isoTpTimeouts.add();
+            throw std::runtime_error("timed out waiting for ISO-TP message");
+        }
+        fill(static_cast<uint32_t>(remaining.count()));
+    }
+
+    result.swap(pending_.front());
+    pending_.pop_front();
+}
+
 void IsoTpJ2534::request(const IsoTpPacket & req, IsoTpPacket & result)
 {
     send(req);
@@ -69,27 +115,28 @@ void IsoTpJ2534::request(const IsoTpPacket & req, IsoTpPacket & result)
 
 void IsoTpJ2534::send(const IsoTpPacket & packet)
 {
-    j2534::PASSTHRU_MSG msg{};
-    msg.ProtocolID = static_cast<uint32_t>(j2534::Protocol::ISO15765);
-    msg.TxFlags = ISO15765_FRAME_PAD;
-
     if (packet.size() > 4124)
         throw std::runtime_error("IsoTp packet exceeds maximum size (4124)");
 
     uint32_t id = options_.sourceId;
-    msg.Data[0] = static_cast<unsigned char>( (id & 0xFF000000U) >> 24U );
-    msg.Data[1] = static_cast<unsigned char>( (id & 0xFF0000U) >> 16U );
-    msg.Data[2] = static_cast<unsigned char>( (id & 0xFF00U) >> 8U );
-    msg.Data[3] = static_cast<unsigned char>( id & 0xFFU );
+    txMsg_.Data[0] = static_cast<unsigned char>( (id & 0xFF000000U) >> 24U );
+    txMsg_.Data[1] = static_cast<unsigned char>( (id & 0xFF0000U) >> 16U );
+    txMsg_.Data[2] = static_cast<unsigned char>( (id & 0xFF00U) >> 8U );
+    txMsg_.Data[3] = static_cast<unsigned char>( id & 0xFFU );
 
-    std::copy(packet.begin(), packet.end(), std::next(std::begin(msg.Data), 4));
-    msg.DataSize = packet.size() + 4;
+    std::copy(packet.begin(), packet.end(), std::next(std::begin(txMsg_.Data), 4));
+    txMsg_.DataSize = static_cast<uint32_t>(packet.size() + 4);
 
     uint32_t numMsgs = 1;
-    // TODO: Configurable timeout (100ms should be good for now, right?)
-    channel_.writeMsgs(&msg, numMsgs, 100);
+    // Multi-frame messages wait on the ECU's flow control, so allow the
+    // whole ISO-TP timeout
+    channel_.writeMsgs(&txMsg_, numMsgs, static_cast<uint32_t>(options_.timeout.count()));
     if (numMsgs != 1)
+    {
+        if (options_.metrics)
+            options_.metrics->isoTpTimeouts.add();
         throw std::runtime_error("Message write timed out");
+    }
 }
 
 }
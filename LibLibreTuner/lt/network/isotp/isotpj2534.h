@@ -4,10 +4,14 @@
 #include "isotp.h"
 #include "j2534/j2534.h"
 
+#include <deque>
+#include <vector>
+
 namespace lt::network
 {
 
-// ISO 15765-2 transport layer (ISO-TP) for sending large packets over CAN
+// ISO 15765-2 transport layer (ISO-TP) for sending large packets over CAN.
+// Segmentation and flow control are done by the device's ISO15765 channel.
 class IsoTpJ2534 : public IsoTp
 {
 public:
@@ -26,10 +30,24 @@ public:
         options_ = options;
     }
 
+    // Messages read per PassThruReadMsgs call
+    static constexpr std::size_t batchSize = 16;
+
 private:
     j2534::DevicePtr device_;
     j2534::Channel channel_;
     IsoTpOptions options_;
+
+    // Preallocated message arrays
+    std::vector<j2534::PASSTHRU_MSG> rxMsgs_;
+    j2534::PASSTHRU_MSG txMsg_{};
+
+    // Received packets not yet returned by recv()
+    std::deque<IsoTpPacket> pending_;
+
+    // Reads the messages queued on the device into pending_. If none were
+    // queued, waits up to `timeout` for one.
+    void fill(uint32_t timeout);
 };
 
 }
@@ -0,0 +1,57 @@
+#ifndef LT_LINKMETRICS_H
+#define LT_LINKMETRICS_H
+
+#include "../support/metrics.h"
+
+#include <array>
+#include <initializer_list>
+#include <memory>
+
+namespace lt::network
+{
+
+// Traffic and error statistics of a data link. Shared by every interface
+// created from the link and updated from whichever thread uses them.
+struct LinkMetrics
+{
+    // CAN frames. Links with native ISO-TP (PassThru ISO15765) do not
+    // report frames.
+    Counter framesSent;
+    Counter framesReceived;
+    Counter bytesSent;
+    Counter bytesReceived;
+    // Received frames discarded because the receive buffer was full. Sends
+    // are not counted; a send that fails throws instead.
+    Counter framesDroppedOnReceive;
+
+    // ISO-TP
+    Counter isoTpTimeouts;
+    // Flow control frames asking the sender to wait
+    Counter isoTpWaits;
+    // Transfers aborted by the receiver through flow control
+    Counter isoTpAborts;
+
+    // UDS
+    Counter udsRequests;
+    // Response pending (RCRRP) responses
+    Counter udsResponsePending;
+    // Negative responses indexed by NRC, excluding RCRRP
+    std::array<Counter, 256> udsNegativeResponses;
+    // Microseconds from sending a request to its final response
+    Histogram udsLatency;
+
+    void reset() noexcept
+    {
+        for (Counter * counter : {&framesSent, &framesReceived, &bytesSent, &bytesReceived, &framesDroppedOnReceive,
+                                  &isoTpTimeouts, &isoTpWaits, &isoTpAborts, &udsRequests, &udsResponsePending})
+            counter->reset();
+        for (Counter & counter : udsNegativeResponses)
+            counter.reset();
+        udsLatency.reset();
+    }
+};
+using LinkMetricsPtr = std::shared_ptr<LinkMetrics>;
+
+} // namespace lt::network
+
+#endif // LT_LINKMETRICS_H
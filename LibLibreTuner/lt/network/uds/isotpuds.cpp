@@ -13,6 +13,26 @@ UdsPacket IsoTpUds::requestRaw(const UdsPacket & packet)
     return receiveRaw();
 }
 
+Task<UdsPacket> IsoTpUds::requestRawAsync(const UdsPacket & packet)
+{
+    IsoTpPacket isotpPacket;
+    isotpPacket.append(&packet.code, 1);
+    isotpPacket.append(packet.data.data(), packet.data.size());
+    co_await isotp_->sendAsync(isotpPacket);
+
+    co_return co_await receiveRawAsync();
+}
+
+Task<UdsPacket> IsoTpUds::receiveRawAsync()
+{
+    IsoTpPacket res;
+    co_await isotp_->recvAsync(res);
+
+    std::vector<uint8_t> data;
+    res.moveInto(data);
+    co_return UdsPacket(data.data(), data.size());
+}
+
 UdsPacket IsoTpUds::receiveRaw()
 {
     IsoTpPacket res;
@@ -19,6 +19,8 @@ public:
     // Inherited via Uds
     virtual UdsPacket requestRaw(const UdsPacket & packet) override;
     virtual UdsPacket receiveRaw() override;
+    Task<UdsPacket> requestRawAsync(const UdsPacket & packet) override;
+    Task<UdsPacket> receiveRawAsync() override;
 
 private:
     IsoTpPtr isotp_;
@@ -1,5 +1,8 @@
 #include "uds.h"
 
+#include "../../os/iocontext.h"
+#include "../../support/trace.h"
+
 #include <array>
 #include <sstream>
 #include <stdexcept>
@@ -9,47 +12,39 @@ namespace lt
 namespace network
 {
 
-UdsPacket Uds::request(uint8_t sid, const uint8_t * data, size_t size)
+namespace
 {
-    // Receive until we get a non-response-pending packet
-
-    // Build request
-    UdsPacket request(sid, data, size);
-
-    UdsPacket response = requestRaw(request);
-
-    do
+// Returns false if the response is pending (RCRRP) and another one must be
+// received. Throws an exception on other negative responses.
+bool checkResponse(uint8_t sid, const UdsPacket & response)
+{
+    if (response.negative())
     {
-        if (response.negative())
+        uint8_t code = response.negativeCode();
+        if (code == UDS_NRES_RCRRP)
         {
-            uint8_t code = response.negativeCode();
-            if (code == UDS_NRES_RCRRP)
-            {
-                // Response pending
-                response = receiveRaw();
-                continue;
-            }
-            std::stringstream ss;
-            ss << "negative UDS response: 0x" << std::hex
-               << static_cast<int>(code) << " (" << std::dec
-               << static_cast<int>(code) << ")";
-            throw std::runtime_error(ss.str());
+            // Response pending
+            return false;
         }
+        std::stringstream ss;
+        ss << "negative UDS response: 0x" << std::hex
+           << static_cast<int>(code) << " (" << std::dec
+           << static_cast<int>(code) << ")";
+        throw std::runtime_error(ss.str());
+    }
 
-        if (response.code != sid + 0x40)
-        {
-            throw std::runtime_error("uds response id (" +
-                                     std::to_string(response.code) +
-                                     ") does not match expected id (" +
-                                     std::to_string(sid + 0x40) + ")");
-        }
-        return response;
-    } while (true);
+    if (response.code != sid + 0x40)
+    {
+        throw std::runtime_error("uds response id (" +
+                                 std::to_string(response.code) +
+                                 ") does not match expected id (" +
+                                 std::to_string(sid + 0x40) + ")");
+    }
+    return true;
 }
 
-std::vector<uint8_t> Uds::requestSession(uint8_t type)
+std::vector<uint8_t> sessionRecord(uint8_t type, UdsPacket res)
 {
-    UdsPacket res = request(UDS_REQ_SESSION, &type, 1);
     if (res.data.empty())
     {
         throw std::runtime_error("received empty session control response");
@@ -61,42 +56,44 @@ std::vector<uint8_t> Uds::requestSession(uint8_t type)
     }
 
     res.data.erase(res.data.begin());
-    return res.data;
+    return std::move(res.data);
 }
 
-std::vector<uint8_t> Uds::requestSecuritySeed()
+constexpr uint8_t securityRequestSeed = 1;
+
+std::vector<uint8_t> securitySeed(UdsPacket res)
 {
-    uint8_t req[] = {1};
-    UdsPacket res = request(UDS_REQ_SECURITY, req, 1);
     if (res.data.empty())
     {
         throw std::runtime_error("received empty security access packet");
     }
 
-    if (res.data[0] != req[0])
+    if (res.data[0] != securityRequestSeed)
     {
         throw std::runtime_error("securityAccessType mismatch");
     }
 
     res.data.erase(res.data.begin(), res.data.begin() + 1);
-    return res.data;
+    return std::move(res.data);
 }
 
-void Uds::requestSecurityKey(const uint8_t * key, size_t size)
+std::vector<uint8_t> securityKeyRequest(const uint8_t * key, size_t size)
 {
     std::vector<uint8_t> req(size + 1);
     req[0] = 2;
     std::copy(key, key + size, req.data() + 1);
+    return req;
+}
 
-    UdsPacket res = request(UDS_REQ_SECURITY, req.data(), req.size());
+void checkSecurityKey(const UdsPacket & res)
+{
     if (res.data.empty())
     {
         throw std::runtime_error("received empty security access response");
     }
 }
 
-std::vector<uint8_t> Uds::requestReadMemoryAddress(uint32_t address,
-                                                   uint16_t length)
+std::array<uint8_t, 6> readMemoryRequest(uint32_t address, uint16_t length)
 {
     std::array<uint8_t, 6> req;
     req[0] = static_cast<uint8_t>( (address & 0xFF000000) >> 24 );
@@ -106,20 +103,151 @@ std::vector<uint8_t> Uds::requestReadMemoryAddress(uint32_t address,
 
     req[4] = static_cast<uint8_t>( length >> 8 );
     req[5] = static_cast<uint8_t>( length & 0xFF );
-
-    UdsPacket res = request(UDS_REQ_READMEM, req.data(), req.size());
-
-    return res.data;
+    return req;
 }
 
-std::vector<uint8_t> Uds::readDataByIdentifier(uint16_t id)
+std::array<uint8_t, 2> identifierRequest(uint16_t id)
 {
     std::array<uint8_t, 2> req;
     req[0] = id >> 8;
     req[1] = id & 0xFF;
+    return req;
+}
+} // namespace
+
+void Uds::record(const UdsPacket & response,
+                 std::chrono::steady_clock::time_point start) noexcept
+{
+    if (response.negative())
+    {
+        uint8_t code = response.negativeCode();
+        if (code == UDS_NRES_RCRRP)
+        {
+            metrics_->udsResponsePending.add();
+            return;
+        }
+        metrics_->udsNegativeResponses[code].add();
+    }
+    metrics_->udsLatency.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count()));
+}
+
+UdsPacket Uds::request(uint8_t sid, const uint8_t * data, size_t size)
+{
+    LT_TRACE_SPAN("uds.request");
+    auto start = std::chrono::steady_clock::now();
+    if (metrics_)
+        metrics_->udsRequests.add();
+
+    // Receive until we get a non-response-pending packet
+    UdsPacket response = requestRaw(UdsPacket(sid, data, size));
+    if (metrics_)
+        record(response, start);
+    while (!checkResponse(sid, response))
+    {
+        LT_TRACE_SPAN("uds.responsePending");
+        response = receiveRaw();
+        if (metrics_)
+            record(response, start);
+    }
+    return response;
+}
+
+Task<UdsPacket> Uds::requestAsync(uint8_t sid, const uint8_t * data,
+                                  size_t size)
+{
+    LT_TRACE_ASYNC_SPAN("uds.request");
+    auto start = std::chrono::steady_clock::now();
+    if (metrics_)
+        metrics_->udsRequests.add();
+
+    UdsPacket response = co_await requestRawAsync(UdsPacket(sid, data, size));
+    if (metrics_)
+        record(response, start);
+    while (!checkResponse(sid, response))
+    {
+        LT_TRACE_ASYNC_SPAN("uds.responsePending");
+        response = co_await receiveRawAsync();
+        if (metrics_)
+            record(response, start);
+    }
+    co_return response;
+}
+
+std::vector<uint8_t> Uds::requestSession(uint8_t type)
+{
+    return sessionRecord(type, request(UDS_REQ_SESSION, &type, 1));
+}
+
+Task<std::vector<uint8_t>> Uds::requestSessionAsync(uint8_t type)
+{
+    co_return sessionRecord(type,
+                            co_await requestAsync(UDS_REQ_SESSION, &type, 1));
+}
+
+std::vector<uint8_t> Uds::requestSecuritySeed()
+{
+    return securitySeed(request(UDS_REQ_SECURITY, &securityRequestSeed, 1));
+}
+
+Task<std::vector<uint8_t>> Uds::requestSecuritySeedAsync()
+{
+    co_return securitySeed(
+        co_await requestAsync(UDS_REQ_SECURITY, &securityRequestSeed, 1));
+}
+
+void Uds::requestSecurityKey(const uint8_t * key, size_t size)
+{
+    std::vector<uint8_t> req = securityKeyRequest(key, size);
+    checkSecurityKey(request(UDS_REQ_SECURITY, req.data(), req.size()));
+}
+
+Task<void> Uds::requestSecurityKeyAsync(const uint8_t * key, size_t size)
+{
+    std::vector<uint8_t> req = securityKeyRequest(key, size);
+    checkSecurityKey(
+        co_await requestAsync(UDS_REQ_SECURITY, req.data(), req.size()));
+}
 
-    UdsPacket res = request(UDS_REQ_READBYID, req.data(), req.size());
-    return res.data;
+std::vector<uint8_t> Uds::requestReadMemoryAddress(uint32_t address,
+                                                   uint16_t length)
+{
+    std::array<uint8_t, 6> req = readMemoryRequest(address, length);
+    return request(UDS_REQ_READMEM, req.data(), req.size()).data;
+}
+
+Task<std::vector<uint8_t>>
+Uds::requestReadMemoryAddressAsync(uint32_t address, uint16_t length)
+{
+    std::array<uint8_t, 6> req = readMemoryRequest(address, length);
+    co_return (co_await requestAsync(UDS_REQ_READMEM, req.data(), req.size()))
+        .data;
+}
+
+std::vector<uint8_t> Uds::readDataByIdentifier(uint16_t id)
+{
+    std::array<uint8_t, 2> req = identifierRequest(id);
+    return request(UDS_REQ_READBYID, req.data(), req.size()).data;
+}
+
+Task<std::vector<uint8_t>> Uds::readDataByIdentifierAsync(uint16_t id)
+{
+    std::array<uint8_t, 2> req = identifierRequest(id);
+    co_return (co_await requestAsync(UDS_REQ_READBYID, req.data(), req.size()))
+        .data;
+}
+
+Task<UdsPacket> Uds::requestRawAsync(const UdsPacket & packet)
+{
+    co_return co_await os::offload(
+        [this, &packet]() { return requestRaw(packet); });
+}
+
+Task<UdsPacket> Uds::receiveRawAsync()
+{
+    co_return co_await os::offload([this]() { return receiveRaw(); });
 }
 
 } // namespace network
@@ -1,10 +1,14 @@
 #ifndef LT_UDS_H
 #define LT_UDS_H
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "../../support/task.h"
+#include "../linkmetrics.h"
+
 namespace lt
 {
 namespace network
@@ -78,11 +82,36 @@ public:
 
     std::vector<uint8_t> readDataByIdentifier(uint16_t id);
 
+    /* Coroutine versions of the above */
+    Task<UdsPacket> requestAsync(uint8_t sid, const uint8_t * data, size_t size);
+    Task<std::vector<uint8_t>> requestSessionAsync(uint8_t type);
+    Task<std::vector<uint8_t>> requestSecuritySeedAsync();
+    Task<void> requestSecurityKeyAsync(const uint8_t * key, size_t size);
+    Task<std::vector<uint8_t>> requestReadMemoryAddressAsync(uint32_t address,
+                                                             uint16_t length);
+    Task<std::vector<uint8_t>> readDataByIdentifierAsync(uint16_t id);
+
     // Sends a request but does not throw an exception on negative errors.
     // Must not handle RCRRP or other negative responses.
     virtual UdsPacket requestRaw(const UdsPacket & packet) = 0;
 
     virtual UdsPacket receiveRaw() = 0;
+
+    // The default implementations run requestRaw() and receiveRaw() on the
+    // blocking pool
+    virtual Task<UdsPacket> requestRawAsync(const UdsPacket & packet);
+    virtual Task<UdsPacket> receiveRawAsync();
+
+    // Optional. Receives response codes and latency of request() and
+    // requestAsync().
+    inline void setMetrics(LinkMetricsPtr metrics) noexcept { metrics_ = std::move(metrics); }
+    inline const LinkMetricsPtr & metrics() const noexcept { return metrics_; }
+
+private:
+    // Records a response to a request sent at `start`
+    void record(const UdsPacket & response, std::chrono::steady_clock::time_point start) noexcept;
+
+    LinkMetricsPtr metrics_;
 };
 using UdsPtr = std::unique_ptr<Uds>;
 
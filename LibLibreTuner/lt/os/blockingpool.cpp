@@ -0,0 +1,73 @@
+#include "blockingpool.h"
+
+#include <thread>
+
+namespace lt::os
+{
+
+BlockingPool::BlockingPool(std::chrono::milliseconds idleTimeout) : idleTimeout_(idleTimeout) {}
+
+BlockingPool::~BlockingPool()
+{
+    std::unique_lock lock(mutex_);
+    stop_ = true;
+    wake_.notify_all();
+    exited_.wait(lock, [this]() { return threads_ == 0; });
+}
+
+void BlockingPool::post(std::function<void()> func)
+{
+    std::lock_guard lock(mutex_);
+    queue_.emplace_back(std::move(func));
+    // Idle threads that were notified but have not woken yet still count as
+    // idle, so compare against the queue rather than checking for zero
+    if (queue_.size() > idle_)
+    {
+        ++threads_;
+        std::thread([this]() { run(); }).detach();
+    }
+    else
+    {
+        wake_.notify_one();
+    }
+}
+
+std::size_t BlockingPool::threads() const
+{
+    std::lock_guard lock(mutex_);
+    return threads_;
+}
+
+BlockingPool & BlockingPool::global()
+{
+    static BlockingPool pool;
+    return pool;
+}
+
+void BlockingPool::run()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        if (queue_.empty())
+        {
+            ++idle_;
+            bool woken = wake_.wait_for(lock, idleTimeout_, [this]() { return stop_ || !queue_.empty(); });
+            --idle_;
+            if (queue_.empty() && (stop_ || !woken))
+                break;
+            continue;
+        }
+
+        std::function<void()> func = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        func();
+        lock.lock();
+    }
+
+    --threads_;
+    exited_.notify_all();
+}
+
+} // namespace lt::os
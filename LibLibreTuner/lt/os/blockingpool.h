@@ -0,0 +1,52 @@
+#ifndef LT_BLOCKINGPOOL_H
+#define LT_BLOCKINGPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace lt::os
+{
+
+// Threads for calls that block on I/O, such as a recv on a transport without
+// readiness notification. Unlike JobPool, a thread is started whenever no
+// idle one is available, so a call that blocks for a long time never delays
+// another. Idle threads exit after `idleTimeout`.
+class BlockingPool
+{
+public:
+    explicit BlockingPool(std::chrono::milliseconds idleTimeout = std::chrono::seconds(10));
+    // Waits for running calls to finish. Queued calls still run.
+    ~BlockingPool();
+
+    BlockingPool(const BlockingPool &) = delete;
+    BlockingPool & operator=(const BlockingPool &) = delete;
+
+    void post(std::function<void()> func);
+
+    // Number of live threads, including idle ones
+    std::size_t threads() const;
+
+    // Pool shared by the library
+    static BlockingPool & global();
+
+private:
+    void run();
+
+    std::chrono::milliseconds idleTimeout_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable exited_;
+    std::deque<std::function<void()>> queue_;
+    std::size_t threads_{0};
+    std::size_t idle_{0};
+    bool stop_{false};
+};
+
+} // namespace lt::os
+
+#endif // LT_BLOCKINGPOOL_H
@@ -0,0 +1,258 @@
+#include "durablefile.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lt::os
+{
+
+#ifdef _WIN32
+
+DurableFile::DurableFile(const std::filesystem::path & path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open '" + path.string() + "'");
+    file_ = file;
+    created_ = GetLastError() != ERROR_ALREADY_EXISTS;
+}
+
+void DurableFile::close() noexcept
+{
+    if (file_ != nullptr)
+        CloseHandle(file_);
+    file_ = nullptr;
+}
+
+void DurableFile::write(const void * data, std::size_t size)
+{
+    LARGE_INTEGER end{};
+    if (!SetFilePointerEx(file_, end, nullptr, FILE_END))
+        throw std::runtime_error("failed to seek file");
+
+    auto * bytes = static_cast<const uint8_t *>(data);
+    while (size != 0)
+    {
+        DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(size, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(file_, bytes, chunk, &written, nullptr))
+            throw std::runtime_error("failed to write file");
+        bytes += written;
+        size -= written;
+    }
+}
+
+std::size_t DurableFile::read(uint64_t offset, void * data, std::size_t size)
+{
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(offset);
+    if (!SetFilePointerEx(file_, position, nullptr, FILE_BEGIN))
+        throw std::runtime_error("failed to seek file");
+
+    auto * bytes = static_cast<uint8_t *>(data);
+    std::size_t total = 0;
+    while (total != size)
+    {
+        DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(size - total, 1u << 30));
+        DWORD read = 0;
+        if (!ReadFile(file_, bytes + total, chunk, &read, nullptr))
+            throw std::runtime_error("failed to read file");
+        if (read == 0)
+            break;
+        total += read;
+    }
+    return total;
+}
+
+void DurableFile::sync()
+{
+    if (!FlushFileBuffers(file_))
+        throw std::runtime_error("failed to flush file");
+}
+
+void DurableFile::truncate(uint64_t size)
+{
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(file_, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file_))
+        throw std::runtime_error("failed to truncate file");
+}
+
+uint64_t DurableFile::size() const
+{
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size))
+        throw std::runtime_error("failed to get file size");
+    return static_cast<uint64_t>(size.QuadPart);
+}
+
+DurableFile::DurableFile(DurableFile && other) noexcept
+    : file_(std::exchange(other.file_, nullptr)), created_(other.created_)
+{
+}
+
+DurableFile & DurableFile::operator=(DurableFile && other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        file_ = std::exchange(other.file_, nullptr);
+        created_ = other.created_;
+    }
+    return *this;
+}
+
+#else
+
+DurableFile::DurableFile(const std::filesystem::path & path)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+    if (fd_ == -1 && errno == ENOENT)
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+        created_ = fd_ != -1;
+        // Lost a race with another process creating it
+        if (fd_ == -1 && errno == EEXIST)
+            fd_ = ::open(path.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+    }
+    if (fd_ == -1)
+        throw std::runtime_error("failed to open '" + path.string() + "'");
+}
+
+void DurableFile::close() noexcept
+{
+    if (fd_ != -1)
+        ::close(fd_);
+    fd_ = -1;
+}
+
+void DurableFile::write(const void * data, std::size_t size)
+{
+    auto * bytes = static_cast<const uint8_t *>(data);
+    while (size != 0)
+    {
+        ssize_t written = ::write(fd_, bytes, size);
+        if (written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("failed to write file");
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+std::size_t DurableFile::read(uint64_t offset, void * data, std::size_t size)
+{
+    auto * bytes = static_cast<uint8_t *>(data);
+    std::size_t total = 0;
+    while (total != size)
+    {
+        ssize_t res = ::pread(fd_, bytes + total, size - total, static_cast<off_t>(offset + total));
+        if (res == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("failed to read file");
+        }
+        if (res == 0)
+            break;
+        total += static_cast<std::size_t>(res);
+    }
+    return total;
+}
+
+void DurableFile::sync()
+{
+#ifdef __APPLE__
+    // fsync only reaches the drive cache on macOS
+    if (::fcntl(fd_, F_FULLFSYNC) == -1 && ::fsync(fd_) == -1)
+#elif defined(__linux__)
+    if (::fdatasync(fd_) == -1)
+#else
+    if (::fsync(fd_) == -1)
+#endif
+        throw std::runtime_error("failed to sync file");
+}
+
+void DurableFile::truncate(uint64_t size)
+{
+    if (::ftruncate(fd_, static_cast<off_t>(size)) == -1)
+        throw std::runtime_error("failed to truncate file");
+}
+
+uint64_t DurableFile::size() const
+{
+    struct stat st;
+    if (::fstat(fd_, &st) == -1)
+        throw std::runtime_error("failed to get file size");
+    return static_cast<uint64_t>(st.st_size);
+}
+
+DurableFile::DurableFile(DurableFile && other) noexcept
+    : fd_(std::exchange(other.fd_, -1)), created_(other.created_)
+{
+}
+
+DurableFile & DurableFile::operator=(DurableFile && other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+        created_ = other.created_;
+    }
+    return *this;
+}
+
+#endif
+
+DurableFile::~DurableFile() { close(); }
+
+void writeFileAtomic(const std::filesystem::path & path, const void * data, std::size_t size)
+{
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    std::filesystem::remove(temp);
+    {
+        DurableFile file(temp);
+        file.write(data, size);
+        file.sync();
+    }
+    // Replaces the destination atomically on both POSIX and Windows
+    std::filesystem::rename(temp, path);
+    // Make the rename itself durable
+    syncDirectory(path.parent_path());
+}
+
+void syncDirectory(const std::filesystem::path & path)
+{
+#ifndef _WIN32
+    int dir = ::open(path.empty() ? "." : path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dir != -1)
+    {
+        ::fsync(dir);
+        ::close(dir);
+    }
+#else
+    (void)path;
+#endif
+}
+
+} // namespace lt::os
@@ -0,0 +1,75 @@
+#ifndef LT_DURABLEFILE_H
+#define LT_DURABLEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace lt::os
+{
+
+// File opened for reading and writing whose contents can be flushed to
+// stable storage. Writes go to the end of the file.
+class DurableFile
+{
+public:
+    DurableFile() = default;
+    // Opens or creates the file at `path`. Throws an exception on failure.
+    explicit DurableFile(const std::filesystem::path & path);
+    ~DurableFile();
+
+    DurableFile(const DurableFile &) = delete;
+    DurableFile & operator=(const DurableFile &) = delete;
+    DurableFile(DurableFile && other) noexcept;
+    DurableFile & operator=(DurableFile && other) noexcept;
+
+    // Appends `size` bytes. Throws an exception on failure.
+    void write(const void * data, std::size_t size);
+
+    // Reads up to `size` bytes at `offset`. Returns the amount read.
+    std::size_t read(uint64_t offset, void * data, std::size_t size);
+
+    // Blocks until written data is on stable storage
+    void sync();
+
+    // Sets the file size. Later writes go to the new end.
+    void truncate(uint64_t size);
+
+    uint64_t size() const;
+
+    // Returns true if the constructor created the file. The new directory
+    // entry survives a crash only after syncDirectory().
+    inline bool created() const noexcept { return created_; }
+
+    void close() noexcept;
+    inline bool isOpen() const noexcept
+    {
+#ifdef _WIN32
+        return file_ != nullptr;
+#else
+        return fd_ != -1;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    void * file_{nullptr};
+#else
+    int fd_{-1};
+#endif
+    bool created_{false};
+};
+
+// Replaces the file at `path` with `size` bytes. The data is written to a
+// temporary file that is synced and renamed over `path`, so after a crash
+// `path` holds either the old or the new contents.
+void writeFileAtomic(const std::filesystem::path & path, const void * data, std::size_t size);
+
+// Flushes the directory at `path` so entries created or renamed in it
+// survive a crash. An empty path is the current directory. Does nothing on
+// Windows, where the file system journals directory changes.
+void syncDirectory(const std::filesystem::path & path);
+
+} // namespace lt::os
+
+#endif // LT_DURABLEFILE_H
@@ -0,0 +1,414 @@
+#include "iocontext.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+namespace lt::os
+{
+
+namespace
+{
+thread_local IoContext * currentContext = nullptr;
+
+#ifdef __linux__
+// epoll user data of the eventfd and timerfd. Waiters are identified by
+// address, which is never odd.
+constexpr uint64_t wakeTag = 0;
+constexpr uint64_t timerTag = 2;
+
+// Watches are identified by descriptor and generation rather than address,
+// since a watch can be removed while its event is still pending. The low
+// bit is set to tell them apart from waiters.
+constexpr uint64_t watchTag = 1;
+
+uint64_t watchData(int fd, uint32_t generation)
+{
+    return static_cast<uint64_t>(generation) << 32 | static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 1 | watchTag;
+}
+
+int watchFd(uint64_t data) { return static_cast<int>((data & 0xFFFFFFFF) >> 1); }
+
+uint32_t watchGeneration(uint64_t data) { return static_cast<uint32_t>(data >> 32); }
+
+void watchDescriptor(int epoll, int fd, uint64_t tag)
+{
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = tag;
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == -1)
+        throw std::runtime_error(std::string("failed to watch descriptor: ") + strerror(errno));
+}
+#endif
+} // namespace
+
+IoContext::IoContext()
+{
+#ifdef __linux__
+    try
+    {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_ == -1)
+            throw std::runtime_error(std::string("failed to create epoll instance: ") + strerror(errno));
+
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd_ == -1)
+            throw std::runtime_error(std::string("failed to create eventfd: ") + strerror(errno));
+        watchDescriptor(epoll_, wakeFd_, wakeTag);
+
+        // steady_clock is CLOCK_MONOTONIC on Linux, so deadlines can be
+        // used as absolute timer values
+        timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timerFd_ == -1)
+            throw std::runtime_error(std::string("failed to create timerfd: ") + strerror(errno));
+        watchDescriptor(epoll_, timerFd_, timerTag);
+    }
+    catch (...)
+    {
+        for (int fd : {timerFd_, wakeFd_, epoll_})
+        {
+            if (fd != -1)
+                close(fd);
+        }
+        throw;
+    }
+#endif
+
+    thread_ = std::thread([this]() { run(); });
+}
+
+IoContext::~IoContext()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake();
+    thread_.join();
+
+#ifdef __linux__
+    close(timerFd_);
+    close(wakeFd_);
+    close(epoll_);
+#endif
+}
+
+IoContext & IoContext::global()
+{
+    static IoContext context;
+    return context;
+}
+
+IoContext * IoContext::current() noexcept { return currentContext; }
+
+bool IoContext::isIoThread() const noexcept { return currentContext == this; }
+
+void IoContext::post(std::coroutine_handle<> handle)
+{
+    {
+        std::lock_guard lock(mutex_);
+        handles_.push_back(handle);
+    }
+    wake();
+}
+
+void IoContext::post(std::function<void()> func)
+{
+    {
+        std::lock_guard lock(mutex_);
+        functions_.emplace_back(std::move(func));
+    }
+    wake();
+}
+
+void IoContext::wake()
+{
+    if (isIoThread())
+        return;
+#ifdef __linux__
+    uint64_t one = 1;
+    // Only fails if the counter would overflow, which still wakes the loop
+    [[maybe_unused]] ssize_t res = ::write(wakeFd_, &one, sizeof(one));
+#else
+    wakeCv_.notify_one();
+#endif
+}
+
+void IoContext::addTimer(Waiter & waiter, Clock::time_point deadline)
+{
+    waiter.timer = nextTimer_++;
+    timerWaiters_.emplace(waiter.timer, &waiter);
+    timers_.push(Timer{deadline, waiter.timer});
+}
+
+void IoContext::SleepAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    waiter_.handle = handle;
+    {
+        std::lock_guard lock(context_.mutex_);
+        context_.addTimer(waiter_, Clock::now() + duration_);
+    }
+    context_.wake();
+}
+
+bool IoContext::Trigger::Awaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    IoContext & context = trigger_.context_;
+    {
+        std::lock_guard lock(context.mutex_);
+        if (trigger_.pending_)
+        {
+            trigger_.pending_ = false;
+            waiter_.ready = true;
+            return false;
+        }
+        waiter_.handle = handle;
+        waiter_.trigger = &trigger_;
+        trigger_.waiter_ = &waiter_;
+        context.addTimer(waiter_, Clock::now() + timeout_);
+    }
+    context.wake();
+    return true;
+}
+
+void IoContext::Trigger::fire()
+{
+    {
+        std::lock_guard lock(context_.mutex_);
+        if (waiter_ == nullptr)
+        {
+            pending_ = true;
+            return;
+        }
+        context_.timerWaiters_.erase(waiter_->timer);
+        waiter_->ready = true;
+        context_.handles_.push_back(waiter_->handle);
+        waiter_ = nullptr;
+    }
+    context_.wake();
+}
+
+#ifdef __linux__
+void IoContext::addReadable(Waiter & waiter, int fd, Clock::time_point deadline)
+{
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = reinterpret_cast<uintptr_t>(&waiter);
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) == -1)
+    {
+        // One-shot descriptors stay registered after firing
+        if (errno != EEXIST || epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &event) == -1)
+            throw std::runtime_error(std::string("failed to watch descriptor: ") + strerror(errno));
+    }
+    waiter.fd = fd;
+    addTimer(waiter, deadline);
+}
+
+void IoContext::ReadableAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    waiter_.handle = handle;
+    {
+        std::lock_guard lock(context_.mutex_);
+        context_.addReadable(waiter_, fd_, Clock::now() + timeout_);
+    }
+    context_.wake();
+}
+
+void IoContext::watch(int fd, std::function<void()> callback)
+{
+    auto watch = std::make_shared<Watch>();
+    watch->fd = fd;
+    watch->callback = std::move(callback);
+
+    std::lock_guard lock(mutex_);
+    if (watches_.count(fd) != 0)
+        throw std::runtime_error("descriptor is already watched");
+    watch->generation = nextGeneration_++;
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = watchData(fd, watch->generation);
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) == -1)
+        throw std::runtime_error(std::string("failed to watch descriptor: ") + strerror(errno));
+    watches_.emplace(fd, std::move(watch));
+}
+
+void IoContext::unwatch(int fd)
+{
+    std::unique_lock lock(mutex_);
+    auto it = watches_.find(fd);
+    if (it == watches_.end())
+        return;
+
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+    Watch * watch = it->second.get();
+    if (!isIoThread())
+        dispatched_.wait(lock, [&]() { return dispatching_ != watch; });
+    watches_.erase(fd);
+}
+
+void IoContext::armTimer()
+{
+    while (!timers_.empty() && timerWaiters_.count(timers_.top().id) == 0)
+        timers_.pop();
+
+    Clock::time_point deadline = timers_.empty() ? Clock::time_point::max() : timers_.top().deadline;
+    if (deadline == armed_)
+        return;
+    armed_ = deadline;
+
+    itimerspec spec{};
+    if (deadline != Clock::time_point::max())
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        // A zero value disarms the timer
+        ns = std::max<decltype(ns)>(ns, 1);
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+#endif
+
+void IoContext::run()
+{
+    currentContext = this;
+
+    std::vector<std::coroutine_handle<>> handles;
+    std::vector<std::function<void()>> functions;
+#ifdef __linux__
+    std::vector<epoll_event> events(64);
+    std::vector<std::shared_ptr<Watch>> ready;
+#endif
+
+    while (true)
+    {
+        bool idle;
+        {
+            std::unique_lock lock(mutex_);
+            if (stop_)
+                return;
+            idle = handles_.empty() && functions_.empty();
+
+#ifdef __linux__
+            armTimer();
+#else
+            if (idle)
+            {
+                while (!timers_.empty() && timerWaiters_.count(timers_.top().id) == 0)
+                    timers_.pop();
+                if (timers_.empty())
+                    wakeCv_.wait(lock);
+                else
+                    wakeCv_.wait_until(lock, timers_.top().deadline);
+            }
+#endif
+        }
+
+#ifdef __linux__
+        int count = epoll_wait(epoll_, events.data(), static_cast<int>(events.size()), idle ? -1 : 0);
+        if (count == -1)
+        {
+            // Interrupted by a signal
+            count = 0;
+        }
+#endif
+
+        {
+            std::lock_guard lock(mutex_);
+#ifdef __linux__
+            for (int i = 0; i < count; ++i)
+            {
+                uint64_t tag = events[i].data.u64;
+                if (tag == wakeTag || tag == timerTag)
+                {
+                    uint64_t value;
+                    [[maybe_unused]] ssize_t res = ::read(tag == wakeTag ? wakeFd_ : timerFd_, &value, sizeof(value));
+                    if (tag == timerTag)
+                        armed_ = Clock::time_point::max();
+                    continue;
+                }
+
+                if ((tag & watchTag) != 0)
+                {
+                    // Dropped if the watch was removed after epoll_wait
+                    // returned
+                    auto it = watches_.find(watchFd(tag));
+                    if (it != watches_.end() && it->second->generation == watchGeneration(tag))
+                        ready.push_back(it->second);
+                    continue;
+                }
+
+                auto * waiter = reinterpret_cast<Waiter *>(static_cast<uintptr_t>(tag));
+                timerWaiters_.erase(waiter->timer);
+                waiter->ready = true;
+                handles_.push_back(waiter->handle);
+            }
+#endif
+
+            // Expire timers
+            Clock::time_point now = Clock::now();
+            while (!timers_.empty() && timers_.top().deadline <= now)
+            {
+                auto it = timerWaiters_.find(timers_.top().id);
+                timers_.pop();
+                if (it == timerWaiters_.end())
+                    continue;
+                Waiter * waiter = it->second;
+                timerWaiters_.erase(it);
+#ifdef __linux__
+                if (waiter->fd != -1)
+                    epoll_ctl(epoll_, EPOLL_CTL_DEL, waiter->fd, nullptr);
+#endif
+                if (waiter->trigger != nullptr)
+                    waiter->trigger->waiter_ = nullptr;
+                handles_.push_back(waiter->handle);
+            }
+
+            handles.swap(handles_);
+            functions.swap(functions_);
+        }
+
+#ifdef __linux__
+        // The copies in `ready` keep each watch alive in case its callback
+        // unwatches it
+        for (const std::shared_ptr<Watch> & watch : ready)
+        {
+            {
+                // The watch may have been removed by an earlier callback or
+                // another thread
+                std::lock_guard lock(mutex_);
+                auto it = watches_.find(watch->fd);
+                if (it == watches_.end() || it->second != watch)
+                    continue;
+                dispatching_ = watch.get();
+            }
+            watch->callback();
+            {
+                std::lock_guard lock(mutex_);
+                dispatching_ = nullptr;
+            }
+            dispatched_.notify_all();
+        }
+        ready.clear();
+#endif
+
+        // Resumed outside the lock; coroutines may register new waiters
+        for (std::function<void()> & func : functions)
+            func();
+        for (std::coroutine_handle<> handle : handles)
+            handle.resume();
+        handles.clear();
+        functions.clear();
+    }
+}
+
+} // namespace lt::os
@@ -0,0 +1,348 @@
+#ifndef LT_IOCONTEXT_H
+#define LT_IOCONTEXT_H
+
+#include "../support/task.h"
+#include "blockingpool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace lt::os
+{
+
+// Executor and reactor for link I/O. One thread waits on timers and, on
+// Linux, file descriptor readiness with epoll, and resumes the coroutines
+// or calls the transports waiting on them. Coroutines run on that thread
+// between suspensions, so many sessions can share it as long as they do
+// not block. On Linux, timers use a timerfd with microsecond precision.
+class IoContext
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Starts the I/O thread
+    IoContext();
+    // Stops the I/O thread. Coroutines still waiting on the context are
+    // not resumed.
+    ~IoContext();
+
+    IoContext(const IoContext &) = delete;
+    IoContext & operator=(const IoContext &) = delete;
+
+    class Trigger;
+
+private:
+    // Waiting coroutine. Readable waits use its address as epoll user data.
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;
+        int fd{-1};
+        uint64_t timer{0};
+        Trigger * trigger{nullptr};
+        // Set if the descriptor became ready or the trigger fired before
+        // the timeout
+        bool ready{false};
+    };
+
+    struct Watch
+    {
+        int fd;
+        // Distinguishes this watch from earlier ones on the same descriptor
+        uint32_t generation;
+        std::function<void()> callback;
+    };
+
+public:
+    class SleepAwaiter
+    {
+    public:
+        SleepAwaiter(IoContext & context, std::chrono::microseconds duration) noexcept
+            : context_(context), duration_(duration)
+        {
+        }
+
+        inline bool await_ready() const noexcept { return duration_.count() <= 0; }
+        void await_suspend(std::coroutine_handle<> handle);
+        inline void await_resume() const noexcept {}
+
+    private:
+        IoContext & context_;
+        std::chrono::microseconds duration_;
+        Waiter waiter_;
+    };
+
+#ifdef __linux__
+    class ReadableAwaiter
+    {
+    public:
+        ReadableAwaiter(IoContext & context, int fd, std::chrono::microseconds timeout) noexcept
+            : context_(context), fd_(fd), timeout_(timeout)
+        {
+        }
+
+        inline bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        inline bool await_resume() const noexcept { return waiter_.ready; }
+
+    private:
+        IoContext & context_;
+        int fd_;
+        std::chrono::microseconds timeout_;
+        Waiter waiter_;
+    };
+#endif
+
+    // Wakes a coroutine waiting with a timeout. Only one coroutine may wait
+    // on a trigger at a time. The trigger must outlive the wait.
+    class Trigger
+    {
+    public:
+        explicit Trigger(IoContext & context) noexcept : context_(context) {}
+
+        Trigger(const Trigger &) = delete;
+        Trigger & operator=(const Trigger &) = delete;
+
+        class Awaiter
+        {
+        public:
+            Awaiter(Trigger & trigger, std::chrono::microseconds timeout) noexcept
+                : trigger_(trigger), timeout_(timeout)
+            {
+            }
+
+            inline bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle);
+            inline bool await_resume() const noexcept { return waiter_.ready; }
+
+        private:
+            Trigger & trigger_;
+            std::chrono::microseconds timeout_;
+            Waiter waiter_;
+        };
+
+        // Resumes on the I/O thread once fire() is called or the timeout
+        // expires. co_await returns false on timeout. Returns immediately
+        // if fire() was called since the last wait.
+        inline Awaiter wait(std::chrono::microseconds timeout) noexcept { return Awaiter(*this, timeout); }
+
+        // Wakes the waiting coroutine. Safe to call from any thread.
+        void fire();
+
+    private:
+        friend IoContext;
+
+        IoContext & context_;
+        Waiter * waiter_{nullptr};
+        bool pending_{false};
+    };
+
+    // Resumes a coroutine on the I/O thread
+    void post(std::coroutine_handle<> handle);
+    // Calls a function on the I/O thread. The function must not throw.
+    void post(std::function<void()> func);
+
+    // Resumes the awaiting coroutine on the I/O thread after `duration`
+    inline SleepAwaiter sleep(std::chrono::microseconds duration) noexcept { return SleepAwaiter(*this, duration); }
+
+#ifdef __linux__
+    // Resumes the awaiting coroutine on the I/O thread once `fd` is
+    // readable or `timeout` expires. co_await returns false on timeout.
+    // Only one coroutine may wait on a descriptor at a time.
+    inline ReadableAwaiter readable(int fd, std::chrono::microseconds timeout) noexcept
+    {
+        return ReadableAwaiter(*this, fd, timeout);
+    }
+
+    // Calls `callback` on the I/O thread whenever `fd` is readable, until
+    // unwatch() is called. The callback must read the descriptor or
+    // unwatch it, and must not throw.
+    void watch(int fd, std::function<void()> callback);
+
+    // Stops watching `fd`. When called from another thread, waits for a
+    // running callback to return.
+    void unwatch(int fd);
+#endif
+
+    // Starts a task on the I/O thread. The future receives its result.
+    template <typename T> std::future<T> spawn(Task<T> task);
+
+    // Returns true if called from this context's I/O thread
+    bool isIoThread() const noexcept;
+
+    // Returns the context whose I/O thread is calling, or nullptr
+    static IoContext * current() noexcept;
+
+    // Context shared by the library
+    static IoContext & global();
+
+private:
+    struct Timer
+    {
+        Clock::time_point deadline;
+        uint64_t id;
+
+        inline bool operator>(const Timer & other) const noexcept { return deadline > other.deadline; }
+    };
+
+    std::mutex mutex_;
+    std::vector<std::coroutine_handle<>> handles_;
+    std::vector<std::function<void()>> functions_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+    std::unordered_map<uint64_t, Waiter *> timerWaiters_;
+    uint64_t nextTimer_{1};
+    bool stop_{false};
+
+#ifdef __linux__
+    int epoll_{-1};
+    int wakeFd_{-1};
+    int timerFd_{-1};
+    // Deadline the timerfd is armed for
+    Clock::time_point armed_{Clock::time_point::max()};
+
+    std::unordered_map<int, std::shared_ptr<Watch>> watches_;
+    uint32_t nextGeneration_{0};
+    // Watch whose callback is running
+    Watch * dispatching_{nullptr};
+    std::condition_variable dispatched_;
+#else
+    std::condition_variable wakeCv_;
+#endif
+    std::thread thread_;
+
+    void run();
+    void wake();
+    // Both require mutex_ to be held
+    void addTimer(Waiter & waiter, Clock::time_point deadline);
+#ifdef __linux__
+    void addReadable(Waiter & waiter, int fd, Clock::time_point deadline);
+    // Arms the timerfd for the earliest timer. Requires mutex_.
+    void armTimer();
+#endif
+};
+
+namespace detail
+{
+// Coroutine that starts when resumed and frees itself when done
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() noexcept
+        {
+            return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        inline std::suspend_always initial_suspend() const noexcept { return {}; }
+        inline std::suspend_never final_suspend() const noexcept { return {}; }
+        inline void return_void() const noexcept {}
+        inline void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T> DetachedTask runSpawned(Task<T> task, std::promise<T> promise)
+{
+    try
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            co_await std::move(task);
+            promise.set_value();
+        }
+        else
+        {
+            promise.set_value(co_await std::move(task));
+        }
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+template <typename F> class OffloadAwaiter
+{
+public:
+    using Result = std::invoke_result_t<F &>;
+
+    explicit OffloadAwaiter(F func) : func_(std::move(func)) {}
+
+    inline bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        IoContext * context = IoContext::current();
+        BlockingPool::global().post([this, handle, context]() {
+            try
+            {
+                if constexpr (std::is_void_v<Result>)
+                {
+                    func_();
+                    result_.emplace(true);
+                }
+                else
+                {
+                    result_.emplace(func_());
+                }
+            }
+            catch (...)
+            {
+                error_ = std::current_exception();
+            }
+
+            if (context != nullptr)
+                context->post(handle);
+            else
+                handle.resume();
+        });
+    }
+
+    Result await_resume()
+    {
+        if (error_)
+            std::rethrow_exception(error_);
+        if constexpr (!std::is_void_v<Result>)
+            return std::move(*result_);
+    }
+
+private:
+    F func_;
+    std::optional<std::conditional_t<std::is_void_v<Result>, bool, Result>> result_;
+    std::exception_ptr error_;
+};
+} // namespace detail
+
+template <typename T> std::future<T> IoContext::spawn(Task<T> task)
+{
+    std::promise<T> promise;
+    std::future<T> future = promise.get_future();
+    post(std::coroutine_handle<>(detail::runSpawned(std::move(task), std::move(promise)).handle));
+    return future;
+}
+
+// Runs a blocking function on the blocking pool and returns its result to
+// the awaiting coroutine. The coroutine resumes on its I/O thread if it was
+// running on one, otherwise on the pool thread. Used for transports that
+// have no readiness notification (J2534, ELM327 and loopback). Each call in
+// flight holds a thread, so sessions on those transports do not scale the
+// way reactor-driven ones do.
+template <typename F> detail::OffloadAwaiter<std::decay_t<F>> offload(F && func)
+{
+    return detail::OffloadAwaiter<std::decay_t<F>>(std::forward<F>(func));
+}
+
+} // namespace lt::os
+
+#endif // LT_IOCONTEXT_H
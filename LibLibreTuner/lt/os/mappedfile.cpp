@@ -0,0 +1,278 @@
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lt::os
+{
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path & path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open '" + path.string() + "' for mapping");
+    file_ = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        close();
+        throw std::runtime_error("failed to get size of '" + path.string() + "'");
+    }
+    if (size.QuadPart == 0)
+        return;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        close();
+        throw std::runtime_error("failed to map '" + path.string() + "'");
+    }
+    mapping_ = mapping;
+
+    void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        close();
+        throw std::runtime_error("failed to map view of '" + path.string() + "'");
+    }
+    data_ = static_cast<const uint8_t *>(view);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+}
+
+void MappedFile::close() noexcept
+{
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle(mapping_);
+    if (file_ != nullptr)
+        CloseHandle(file_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = nullptr;
+    size_ = 0;
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+      file_(std::exchange(other.file_, nullptr)), mapping_(std::exchange(other.mapping_, nullptr))
+{
+}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        file_ = std::exchange(other.file_, nullptr);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+    }
+    return *this;
+}
+
+WritableMappedFile::WritableMappedFile(const std::filesystem::path & path, std::size_t initialCapacity)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to create '" + path.string() + "'");
+    file_ = file;
+    open_ = true;
+    map(std::max<std::size_t>(initialCapacity, 4096));
+}
+
+void WritableMappedFile::unmap() noexcept
+{
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle(mapping_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+}
+
+void WritableMappedFile::map(std::size_t capacity)
+{
+    unmap();
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(capacity);
+    HANDLE mapping = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    if (mapping == nullptr)
+        throw std::runtime_error("failed to map file for writing");
+    mapping_ = mapping;
+
+    void * view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+    if (view == nullptr)
+        throw std::runtime_error("failed to map view of file for writing");
+    data_ = static_cast<uint8_t *>(view);
+    capacity_ = capacity;
+}
+
+void WritableMappedFile::close() noexcept
+{
+    if (!open_)
+        return;
+    unmap();
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(size_);
+    SetFilePointerEx(file_, size, nullptr, FILE_BEGIN);
+    SetEndOfFile(file_);
+    CloseHandle(file_);
+    file_ = nullptr;
+    open_ = false;
+    capacity_ = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path & path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("failed to open '" + path.string() + "' for mapping: " + strerror(errno));
+
+    struct stat st
+    {
+    };
+    if (::fstat(fd, &st) == -1)
+    {
+        ::close(fd);
+        throw std::runtime_error("failed to stat '" + path.string() + "': " + strerror(errno));
+    }
+
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    void * map = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file
+    ::close(fd);
+    if (map == MAP_FAILED)
+        throw std::runtime_error("failed to map '" + path.string() + "': " + strerror(errno));
+
+    data_ = static_cast<const uint8_t *>(map);
+    size_ = static_cast<std::size_t>(st.st_size);
+}
+
+void MappedFile::close() noexcept
+{
+    if (data_ != nullptr)
+        ::munmap(const_cast<uint8_t *>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+{
+}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+WritableMappedFile::WritableMappedFile(const std::filesystem::path & path, std::size_t initialCapacity)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ == -1)
+        throw std::runtime_error("failed to create '" + path.string() + "': " + strerror(errno));
+    open_ = true;
+    try
+    {
+        map(std::max<std::size_t>(initialCapacity, 4096));
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+}
+
+void WritableMappedFile::unmap() noexcept
+{
+    if (data_ != nullptr)
+        ::munmap(data_, capacity_);
+    data_ = nullptr;
+}
+
+void WritableMappedFile::map(std::size_t capacity)
+{
+    unmap();
+    if (::ftruncate(fd_, static_cast<off_t>(capacity)) == -1)
+        throw std::runtime_error(std::string("failed to grow mapped file: ") + strerror(errno));
+
+    void * map = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+        throw std::runtime_error(std::string("failed to map file for writing: ") + strerror(errno));
+    data_ = static_cast<uint8_t *>(map);
+    capacity_ = capacity;
+}
+
+void WritableMappedFile::close() noexcept
+{
+    if (!open_)
+        return;
+    unmap();
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) == -1)
+    {
+        // The file keeps its reserved size. Readers use the header to
+        // find the end of the data.
+    }
+    ::close(fd_);
+    fd_ = -1;
+    open_ = false;
+    capacity_ = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+WritableMappedFile::~WritableMappedFile() { close(); }
+
+void WritableMappedFile::reserve(std::size_t size)
+{
+    if (size <= capacity_)
+        return;
+    // Grow geometrically so appends are amortized constant time
+    map(std::max(size, capacity_ * 2));
+}
+
+void WritableMappedFile::resize(std::size_t size)
+{
+    reserve(size);
+    size_ = size;
+}
+
+} // namespace lt::os
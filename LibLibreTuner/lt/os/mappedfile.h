@@ -0,0 +1,95 @@
+#ifndef LT_MAPPEDFILE_H
+#define LT_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace lt::os
+{
+
+// Read-only memory mapping of a whole file. Pages are loaded lazily by the
+// OS, so opening a multi-gigabyte file is constant time.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    // Maps the file at `path`. Throws an exception if the file cannot be
+    // opened or mapped.
+    explicit MappedFile(const std::filesystem::path & path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile && other) noexcept;
+    MappedFile & operator=(MappedFile && other) noexcept;
+
+    // Unmaps the file. The object is empty after calling this method.
+    void close() noexcept;
+
+    inline const uint8_t * data() const noexcept { return data_; }
+    inline std::size_t size() const noexcept { return size_; }
+    inline bool empty() const noexcept { return size_ == 0; }
+
+    inline const uint8_t * begin() const noexcept { return data_; }
+    inline const uint8_t * end() const noexcept { return data_ + size_; }
+
+private:
+    const uint8_t * data_{nullptr};
+    std::size_t size_{0};
+#ifdef _WIN32
+    void * file_{nullptr};
+    void * mapping_{nullptr};
+#endif
+};
+
+// Read-write shared mapping of a file that grows as data is appended.
+// The file is truncated to the written size when closed.
+class WritableMappedFile
+{
+public:
+    WritableMappedFile() = default;
+    // Creates or truncates the file at `path`. Throws an exception on
+    // failure.
+    explicit WritableMappedFile(const std::filesystem::path & path, std::size_t initialCapacity = 1 << 20);
+    ~WritableMappedFile();
+
+    WritableMappedFile(const WritableMappedFile &) = delete;
+    WritableMappedFile & operator=(const WritableMappedFile &) = delete;
+
+    // Ensures at least `size` bytes are mapped. May move the mapping, which
+    // invalidates pointers returned by data(). Throws an exception on
+    // failure.
+    void reserve(std::size_t size);
+
+    // Sets the logical size of the file, reserving space if needed
+    void resize(std::size_t size);
+
+    // Truncates the file to its logical size and unmaps it
+    void close() noexcept;
+
+    inline uint8_t * data() noexcept { return data_; }
+    inline const uint8_t * data() const noexcept { return data_; }
+    inline std::size_t size() const noexcept { return size_; }
+    inline std::size_t capacity() const noexcept { return capacity_; }
+    inline bool isOpen() const noexcept { return open_; }
+
+private:
+    uint8_t * data_{nullptr};
+    std::size_t size_{0};
+    std::size_t capacity_{0};
+    bool open_{false};
+#ifdef _WIN32
+    void * file_{nullptr};
+    void * mapping_{nullptr};
+#else
+    int fd_{-1};
+#endif
+
+    void unmap() noexcept;
+    void map(std::size_t capacity);
+};
+
+} // namespace lt::os
+
+#endif // LT_MAPPEDFILE_H
@@ -1,6 +1,7 @@
 #include <utility>
 
 #include "project.h"
+#include "../libretuner.h"
 
 #include <cassert>
 #include <fstream>
@@ -79,6 +80,20 @@ TunePtr Project::loadTune(const std::string & filename)
     auto tune = std::make_shared<Tune>(rom, std::move(data));
     tune->setPath(tunesDir_ / filename);
     tune->setName(meta.name);
+    try
+    {
+        if (std::size_t recovered = tune->openJournal(); recovered != 0)
+        {
+            lt::log("recovered " + std::to_string(recovered) +
+                    " unsaved edits of tune '" + filename + "'");
+        }
+    }
+    catch (const std::exception & e)
+    {
+        // The tune is still usable, only without crash recovery
+        lt::log("failed to open journal of tune '" + filename +
+                "': " + e.what());
+    }
     tuneCache_.emplace(filename, tune);
     return tune;
 }
@@ -101,7 +116,8 @@ std::vector<MetaData> getMetaData(fs::path & dir, bool requiresExtension,
     for (const auto & entry : fs::directory_iterator(dir))
     {
         if (!entry.is_regular_file() ||
-            (requiresExtension && entry.path().extension() != extension))
+            (requiresExtension && entry.path().extension() != extension) ||
+            entry.path().extension() == TuneJournal::extension)
             continue;
 
         std::ifstream file(entry.path(), std::ios::binary | std::ios::in);
@@ -267,6 +283,8 @@ bool Project::deleteRom(const std::string & filename)
 bool Project::deleteTune(const std::string & filename)
 {
     tuneCache_.erase(filename);
+    std::error_code ec;
+    fs::remove(TuneJournal::pathFor(tunesDir_ / filename), ec);
     return fs::remove(tunesDir_ / filename);
 }
 
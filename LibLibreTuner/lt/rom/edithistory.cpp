@@ -0,0 +1,187 @@
+#include "edithistory.h"
+
+#include "../buffer/memorybuffer.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace lt
+{
+
+namespace
+{
+const std::string emptyLabel;
+
+// Keeps writes made by the history itself from being recorded
+class ApplyingGuard
+{
+public:
+    explicit ApplyingGuard(bool & applying) : applying_(applying) { applying_ = true; }
+    ~ApplyingGuard() { applying_ = false; }
+
+private:
+    bool & applying_;
+};
+} // namespace
+
+void EditHistory::record(int offset, const uint8_t * before, const uint8_t * after, int size)
+{
+    assert(offset >= 0 && size >= 0);
+    if (applying_ || size == 0)
+        return;
+
+    truncateRedo();
+
+    // The first write of a group opens its step
+    bool open = depth_ != 0 && groupOpen_;
+    if (!open)
+    {
+        steps_.push_back(Step{depth_ != 0 ? std::move(groupLabel_) : std::string(), ranges_.size(), 0});
+        current_ = steps_.size();
+        groupOpen_ = depth_ != 0;
+    }
+
+    Step & step = steps_.back();
+    if (open && step.rangeCount != 0)
+    {
+        Range & last = ranges_.back();
+        if (last.offset + last.size == offset)
+        {
+            // Contents of the last range end the arenas, so extending it
+            // only appends
+            before_.insert(before_.end(), before, before + size);
+            after_.insert(after_.end(), after, after + size);
+            last.size += size;
+            return;
+        }
+    }
+
+    ranges_.push_back(Range{offset, size, before_.size()});
+    before_.insert(before_.end(), before, before + size);
+    after_.insert(after_.end(), after, after + size);
+    ++step.rangeCount;
+
+    if (depth_ == 0)
+        enforceBudget();
+}
+
+void EditHistory::beginGroup(std::string label)
+{
+    if (depth_++ == 0)
+    {
+        groupLabel_ = std::move(label);
+        groupOpen_ = false;
+    }
+}
+
+void EditHistory::endGroup()
+{
+    assert(depth_ > 0);
+    if (--depth_ == 0)
+    {
+        groupOpen_ = false;
+        enforceBudget();
+    }
+}
+
+bool EditHistory::undo(MemoryBuffer & buffer)
+{
+    if (!canUndo())
+        return false;
+
+    const Step & step = steps_[current_ - 1];
+    ApplyingGuard guard(applying_);
+    // Ranges of one step may overlap, so restore them newest first
+    for (std::size_t i = step.firstRange + step.rangeCount; i-- != step.firstRange;)
+    {
+        const Range & range = ranges_[i];
+        buffer.write(range.offset, before_.data() + range.data, range.size);
+    }
+    --current_;
+    return true;
+}
+
+bool EditHistory::redo(MemoryBuffer & buffer)
+{
+    if (!canRedo())
+        return false;
+
+    const Step & step = steps_[current_];
+    ApplyingGuard guard(applying_);
+    for (std::size_t i = step.firstRange; i != step.firstRange + step.rangeCount; ++i)
+    {
+        const Range & range = ranges_[i];
+        buffer.write(range.offset, after_.data() + range.data, range.size);
+    }
+    ++current_;
+    return true;
+}
+
+const std::string & EditHistory::undoLabel() const noexcept
+{
+    return canUndo() ? steps_[current_ - 1].label : emptyLabel;
+}
+
+const std::string & EditHistory::redoLabel() const noexcept
+{
+    return canRedo() ? steps_[current_].label : emptyLabel;
+}
+
+void EditHistory::clear() noexcept
+{
+    steps_.clear();
+    ranges_.clear();
+    before_.clear();
+    after_.clear();
+    current_ = 0;
+    groupOpen_ = false;
+}
+
+void EditHistory::truncateRedo()
+{
+    if (current_ == steps_.size())
+        return;
+
+    const Step & first = steps_[current_];
+    std::size_t data = first.firstRange < ranges_.size() ? ranges_[first.firstRange].data : before_.size();
+    ranges_.resize(first.firstRange);
+    before_.resize(data);
+    after_.resize(data);
+    steps_.resize(current_);
+}
+
+void EditHistory::enforceBudget()
+{
+    if (memoryUsage() <= budget_)
+        return;
+
+    // Trim below the budget so the arenas are not shifted on every edit.
+    // The newest step is kept even if it exceeds the budget on its own.
+    const std::size_t target = budget_ / 4 * 3;
+    std::size_t dropSteps = 0;
+    std::size_t dropRanges = 0;
+    std::size_t dropBytes = 0;
+    while (dropSteps + 1 < steps_.size() &&
+           memoryUsage() - 2 * dropBytes - dropRanges * sizeof(Range) - dropSteps * sizeof(Step) > target)
+    {
+        const Step & step = steps_[dropSteps++];
+        dropRanges += step.rangeCount;
+        dropBytes = dropRanges < ranges_.size() ? ranges_[dropRanges].data : before_.size();
+    }
+    if (dropSteps == 0)
+        return;
+
+    assert(current_ >= dropSteps);
+    steps_.erase(steps_.begin(), steps_.begin() + static_cast<std::ptrdiff_t>(dropSteps));
+    ranges_.erase(ranges_.begin(), ranges_.begin() + static_cast<std::ptrdiff_t>(dropRanges));
+    before_.erase(before_.begin(), before_.begin() + static_cast<std::ptrdiff_t>(dropBytes));
+    after_.erase(after_.begin(), after_.begin() + static_cast<std::ptrdiff_t>(dropBytes));
+
+    for (Step & step : steps_)
+        step.firstRange -= dropRanges;
+    for (Range & range : ranges_)
+        range.data -= dropBytes;
+    current_ -= dropSteps;
+}
+
+} // namespace lt
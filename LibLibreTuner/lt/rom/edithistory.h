@@ -0,0 +1,120 @@
+#ifndef LT_EDITHISTORY_H
+#define LT_EDITHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lt
+{
+
+class MemoryBuffer;
+
+/* Undo and redo history of edits to a memory buffer. Each step holds the
+ * byte ranges it changed along with their old and new contents. The bytes
+ * of all steps live in two arenas, so recording an edit does not allocate
+ * once the arenas have grown. When the history exceeds the memory budget the
+ * oldest steps are forgotten.
+ *
+ * Writes recorded between beginGroup() and endGroup() form a single step.
+ * Consecutive writes to adjacent bytes within a step are merged into one
+ * range, so a full table operation is undone with a single copy. */
+class EditHistory
+{
+public:
+    static constexpr std::size_t defaultBudget = 4 * 1024 * 1024;
+
+    // Groups the writes made during its lifetime into one step
+    class Group
+    {
+    public:
+        Group(EditHistory & history, std::string label) : history_(history)
+        {
+            history_.beginGroup(std::move(label));
+        }
+        ~Group() { history_.endGroup(); }
+
+        Group(const Group &) = delete;
+        Group & operator=(const Group &) = delete;
+
+    private:
+        EditHistory & history_;
+    };
+
+    explicit EditHistory(std::size_t budget = defaultBudget) : budget_(budget) {}
+
+    // Records a write of `size` bytes at `offset`. Forgets the steps that
+    // can be redone. Writes made outside of a group form their own step.
+    void record(int offset, const uint8_t * before, const uint8_t * after, int size);
+
+    // Starts a step. Groups may be nested; the outermost label is kept.
+    void beginGroup(std::string label);
+    void endGroup();
+
+    // Writes the old contents of the last step to `buffer`. Returns false
+    // if there is nothing to undo.
+    bool undo(MemoryBuffer & buffer);
+    // Writes the new contents of the last undone step to `buffer`. Returns
+    // false if there is nothing to redo.
+    bool redo(MemoryBuffer & buffer);
+
+    inline bool canUndo() const noexcept { return current_ != 0 && depth_ == 0; }
+    inline bool canRedo() const noexcept { return current_ != steps_.size() && depth_ == 0; }
+
+    // Labels of the steps undo() and redo() would apply. Empty if there is
+    // no such step or it has no label.
+    const std::string & undoLabel() const noexcept;
+    const std::string & redoLabel() const noexcept;
+
+    // Forgets all steps
+    void clear() noexcept;
+
+    // Number of steps that can be undone or redone
+    inline std::size_t size() const noexcept { return steps_.size(); }
+    // Bytes held by the arenas and the step and range records
+    inline std::size_t memoryUsage() const noexcept
+    {
+        return before_.size() + after_.size() + ranges_.size() * sizeof(Range) + steps_.size() * sizeof(Step);
+    }
+    inline std::size_t budget() const noexcept { return budget_; }
+
+private:
+    struct Range
+    {
+        int offset, size;
+        // Position of the contents in the arenas
+        std::size_t data;
+    };
+
+    struct Step
+    {
+        std::string label;
+        // Ranges of the step in ranges_
+        std::size_t firstRange, rangeCount;
+    };
+
+    // Removes steps after current_
+    void truncateRedo();
+    // Removes the oldest steps until the history fits in the budget
+    void enforceBudget();
+
+    std::size_t budget_;
+    std::vector<Step> steps_;
+    std::vector<Range> ranges_;
+    // Old and new contents of every range
+    std::vector<uint8_t> before_, after_;
+    // Number of steps that can be undone
+    std::size_t current_{0};
+    // Nesting depth of open groups
+    int depth_{0};
+    // Label of the open group and whether its step was created
+    std::string groupLabel_;
+    bool groupOpen_{false};
+    // Set while undo() and redo() write to the buffer
+    bool applying_{false};
+};
+
+} // namespace lt
+
+#endif // LT_EDITHISTORY_H
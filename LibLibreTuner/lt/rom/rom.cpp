@@ -20,6 +20,8 @@
 #include "table.h"
 
 #include "definition/platform.h"
+#include "os/durablefile.h"
+#include "support/crc32.h"
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/string.hpp>
@@ -27,6 +29,7 @@
 
 #include <cassert>
 #include <fstream>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
@@ -48,18 +51,9 @@ EntriesPtr<double> createEntries(Endianness endianness, DataType dataType, const
 }
 } // namespace detail
 
-bool Tune::dirty() const noexcept
-{
-    for (const auto & [id, table] : tables_)
-    {
-        if (table->dirty())
-            return true;
-    }
-    return false;
-}
-
 void Tune::clearDirty() noexcept
 {
+    data_.clearDirty();
     for (const auto & [id, table] : tables_)
     {
         if (table->dirty())
@@ -174,17 +168,65 @@ Tune::MetaData Tune::metadata() const noexcept
     return md;
 }
 
-void Tune::save() const
+void Tune::save()
 {
     if (path_.empty())
         throw std::runtime_error("attempt to save ROM without a path");
 
-    std::ofstream file(path_, std::ios::binary | std::ios::out);
-    if (!file.is_open())
-        throw std::runtime_error("failed to open tune file '" + path_.string() + "' for writing");
+    std::ostringstream stream(std::ios::binary | std::ios::out);
+    {
+        cereal::BinaryOutputArchive archive(stream);
+        archive(metadata(), data_);
+    }
+    std::string contents = stream.str();
+    os::writeFileAtomic(path_, contents.data(), contents.size());
+
+    savedCrc_ = crc32(data_.data(), data_.size());
+    if (journal_)
+        journal_->reset(savedCrc_, static_cast<uint32_t>(data_.size()));
+    else
+        openJournal();
+}
 
-    cereal::BinaryOutputArchive archive(file);
-    archive(metadata(), data_);
+std::size_t Tune::openJournal()
+{
+    if (path_.empty())
+        throw std::runtime_error("attempt to open tune journal without a path");
+
+    journal_.reset();
+
+    savedCrc_ = crc32(data_.data(), data_.size());
+    auto journal = std::make_unique<TuneJournal>(TuneJournal::pathFor(path_), savedCrc_,
+                                                 static_cast<uint32_t>(data_.size()));
+
+    // Recovered edits are already in the journal. They become one undo
+    // step.
+    const std::vector<TuneJournal::Edit> & edits = journal->recovered();
+    if (!edits.empty())
+    {
+        EditHistory::Group group(history_, "Recover Edits");
+        for (const TuneJournal::Edit & edit : edits)
+            data_.write(edit.offset, edit.after.data(), static_cast<int>(edit.after.size()));
+    }
+
+    journal_ = std::move(journal);
+    return edits.size();
+}
+
+void Tune::discardJournal()
+{
+    if (journal_)
+        journal_->reset(savedCrc_, static_cast<uint32_t>(data_.size()));
+}
+
+bool Tune::undo()
+{
+    return history_.undo(data_);
+}
+
+bool Tune::redo()
+{
+    return history_.redo(data_);
 }
 
 Tune::Tune(RomPtr rom) : Tune(rom, MemoryBuffer(rom->cbegin(), rom->cend())) {}
@@ -196,6 +238,12 @@ Tune::Tune(RomPtr rom, MemoryBuffer && data) : base_(std::move(rom)), data_(std:
     if ((unsigned int) base_->size() != size())
         throw std::runtime_error("The base ROM and tune data size do not match (" + std::to_string(base_->size()) +
                                  " vs " + std::to_string(size()) + "). The tune or base ROM is corrupt.");
+
+    data_.setWriteObserver([this](int offset, const uint8_t * before, const uint8_t * after, int size) {
+        history_.record(offset, before, after, size);
+        if (journal_)
+            journal_->append(offset, before, after, size);
+    });
 }
 
 Rom::MetaData Rom::metadata() const noexcept
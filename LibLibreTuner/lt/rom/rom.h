@@ -28,6 +28,8 @@
 #include "../definition/model.h"
 #include "../definition/platform.h"
 #include "../buffer/memorybuffer.h"
+#include "edithistory.h"
+#include "tunejournal.h"
 #include "table.h"
 
 namespace lt
@@ -121,16 +123,42 @@ public:
     explicit Tune(RomPtr rom);
     explicit Tune(RomPtr rom, MemoryBuffer && data);
 
+    // Edits are recorded through a pointer to the tune
+    Tune(const Tune &) = delete;
+    Tune & operator=(const Tune &) = delete;
+
     inline const std::string & name() const noexcept { return name_; }
     inline const RomPtr & base() const noexcept { return base_; }
     inline const std::filesystem::path & path() const noexcept { return path_; }
 
-    // Returns true if any table is dirty
-    bool dirty() const noexcept;
+    // Returns true if the data was modified since the last clearDirty()
+    inline bool dirty() const noexcept { return data_.dirty(); }
 
-    // Clears dirty bit of all tables
+    // Clears the modified ranges and the dirty bit of all tables
     void clearDirty() noexcept;
 
+    // Opens the journal next to the tune file and applies edits that were
+    // not saved before the last crash. Later edits are recorded in the
+    // journal until the tune is saved. Returns the number of recovered
+    // edits. Requires a path.
+    std::size_t openJournal();
+
+    // Forgets edits that were not saved, so they are not recovered when
+    // the tune is loaded again
+    void discardJournal();
+
+    // Returns nullptr if no journal is open
+    inline TuneJournal * journal() noexcept { return journal_.get(); }
+
+    // Undo history of edits made since the tune was loaded. Use
+    // EditHistory::Group to make bulk edits a single step.
+    inline EditHistory & history() noexcept { return history_; }
+
+    // Reverts or reapplies the last step of the history. Returns false if
+    // there is nothing to undo or redo.
+    bool undo();
+    bool redo();
+
     void setName(const std::string & name) { name_ = name; }
     void setBase(const RomPtr & rom) { base_ = rom; }
     void setPath(std::filesystem::path path) { path_ = std::move(path); }
@@ -167,8 +195,9 @@ public:
     /* Constructs tune metadata */
     MetaData metadata() const noexcept;
 
-    // Saves tune to `path_`
-    void save() const;
+    // Saves tune to `path_`. The file is replaced atomically and the
+    // journal is emptied, opening it if needed.
+    void save();
 
     inline iterator begin() { return data_.begin(); }
     inline const_iterator cbegin() const { return data_.cbegin(); };
@@ -187,6 +216,11 @@ private:
     std::unordered_map<std::string, AxisPtr> axes_;
 
     std::filesystem::path path_;
+
+    EditHistory history_;
+    std::unique_ptr<TuneJournal> journal_;
+    // CRC-32 of the data in the tune file
+    uint32_t savedCrc_{0};
 };
 using TunePtr = std::shared_ptr<Tune>;
 using WeakTunePtr = std::weak_ptr<Tune>;
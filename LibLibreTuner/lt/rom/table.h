@@ -1,10 +1,14 @@
 #ifndef LIBRETUNER_TABLE_H
 #define LIBRETUNER_TABLE_H
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
-#include <limits>
 
 #include "../buffer/view.h"
 #include "../support/types.h"
@@ -23,6 +27,20 @@ public:
     virtual void set(int index, PresentedType value) = 0;
     virtual int size() const noexcept = 0;
 
+    // Reads `count` entries starting at `index`
+    virtual void getRange(int index, PresentedType * out, int count) const
+    {
+        for (int i = 0; i < count; ++i)
+            out[i] = get(index + i);
+    }
+
+    // Writes `count` entries starting at `index`
+    virtual void setRange(int index, const PresentedType * values, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            set(index + i, values[i]);
+    }
+
     virtual ~Entries() = default;
 };
 
@@ -38,10 +56,40 @@ public:
     {
         return static_cast<PresentedType>(view_.get<T, endianness>(index * sizeof(T)));
     }
-    void set(int index, PresentedType value) { view_.set<T, endianness>(static_cast<T>(value), index * sizeof(T)); }
-    int size() const noexcept { return view_.size() / sizeof(T); }
+    void set(int index, PresentedType value) override
+    {
+        view_.set<T, endianness>(encode(value), index * static_cast<int>(sizeof(T)));
+    }
+    int size() const noexcept override { return view_.size() / static_cast<int>(sizeof(T)); }
+
+    void getRange(int index, PresentedType * out, int count) const override
+    {
+        std::vector<T> raw(static_cast<std::size_t>(count));
+        view_.getRange<T, endianness>(index * static_cast<int>(sizeof(T)), raw.data(), count);
+        std::transform(raw.begin(), raw.end(), out, [](T t) { return static_cast<PresentedType>(t); });
+    }
+
+    // Encodes all entries before writing them with one buffer write
+    void setRange(int index, const PresentedType * values, int count) override
+    {
+        std::vector<T> raw(static_cast<std::size_t>(count));
+        std::transform(values, values + count, raw.begin(), encode);
+        view_.setRange<T, endianness>(index * static_cast<int>(sizeof(T)), raw.data(), count);
+    }
 
 private:
+    // Integers are rounded and saturated, as converting an out-of-range
+    // value is undefined
+    static T encode(PresentedType value) noexcept
+    {
+        if constexpr (std::is_integral_v<T> && std::is_floating_point_v<PresentedType>)
+        {
+            value = std::clamp<PresentedType>(std::round(value), std::numeric_limits<T>::lowest(),
+                                              std::numeric_limits<T>::max());
+        }
+        return static_cast<T>(value);
+    }
+
     View view_;
 };
 
@@ -233,6 +281,188 @@ public:
         dirty_ = true;
     }
 
+    // Rectangular block of cells
+    struct Region
+    {
+        int row, column, height, width;
+
+        inline int size() const noexcept { return height * width; }
+        inline bool empty() const noexcept { return height <= 0 || width <= 0; }
+
+        bool operator==(const Region &) const = default;
+    };
+
+    // Returns the region covering the whole table
+    inline Region region() const noexcept { return Region{0, 0, height_, width_}; }
+
+    // Returns the part of `region` that lies inside the table
+    Region clip(const Region & region) const noexcept
+    {
+        int row = std::max(region.row, 0);
+        int column = std::max(region.column, 0);
+        int bottom = std::min(region.row + region.height, height_);
+        int right = std::min(region.column + region.width, width_);
+        return Region{row, column, std::max(bottom - row, 0), std::max(right - column, 0)};
+    }
+
+    /* Returns the entries of `region` in row-major order. Throws an
+     * exception if the region is out-of-bounds. Handles scale and unit conversion. */
+    std::vector<PresentedType> getRegion(const Region & region) const
+    {
+        checkRegion(region);
+        std::vector<PresentedType> values(static_cast<std::size_t>(region.size()));
+        forEachRow(region, [&](int index, int offset, int count) {
+            entries_->getRange(index, values.data() + offset, count);
+        });
+
+        for (PresentedType & value : values)
+            value = static_cast<PresentedType>(value * scale_);
+        if (unit_)
+        {
+            for (PresentedType & value : values)
+                value = unit_->convert(value);
+        }
+        return values;
+    }
+
+    /* Sets the entries of `region` to `values` in row-major order. Values
+     * are clamped to the table bounds. The region is written with one
+     * buffer write per row, or a single write if it spans whole rows.
+     * Throws an exception if the region is out-of-bounds. Handles scale and
+     * unit conversion. */
+    void setRegion(const Region & region, const PresentedType * values)
+    {
+        checkRegion(region);
+        std::vector<PresentedType> entries(values, values + region.size());
+        for (PresentedType & entry : entries)
+            entry = static_cast<PresentedType>(std::clamp(entry, bounds_.minimum, bounds_.maximum) / scale_);
+        if (unit_)
+        {
+            for (PresentedType & entry : entries)
+                entry = unit_->convert(entry);
+        }
+
+        forEachRow(region, [&](int index, int offset, int count) {
+            entries_->setRange(index, entries.data() + offset, count);
+        });
+        dirty_ = true;
+    }
+
+    // Multiplies the entries of `region` by `factor`
+    void multiply(const Region & region, PresentedType factor)
+    {
+        std::vector<PresentedType> values = getRegion(region);
+        for (PresentedType & value : values)
+            value *= factor;
+        setRegion(region, values.data());
+    }
+
+    // Adds `amount` to the entries of `region`
+    void add(const Region & region, PresentedType amount)
+    {
+        std::vector<PresentedType> values = getRegion(region);
+        for (PresentedType & value : values)
+            value += amount;
+        setRegion(region, values.data());
+    }
+
+    // Sets every entry of `region` to `value`
+    void fill(const Region & region, PresentedType value)
+    {
+        std::vector<PresentedType> values(static_cast<std::size_t>(std::max(region.size(), 0)), value);
+        setRegion(region, values.data());
+    }
+
+    /* Replaces the entries of `region` with values interpolated between
+     * its corners. Interpolation is bilinear if the region has more than
+     * one row and column, and linear otherwise. */
+    void interpolate(const Region & region)
+    {
+        std::vector<PresentedType> values = getRegion(region);
+        if (values.empty())
+            return;
+
+        const int width = region.width;
+        const int height = region.height;
+        const double topLeft = values.front();
+        const double topRight = values[width - 1];
+        const double bottomLeft = values[(height - 1) * width];
+        const double bottomRight = values.back();
+
+        for (int row = 0; row < height; ++row)
+        {
+            double y = height > 1 ? static_cast<double>(row) / (height - 1) : 0.0;
+            double left = topLeft + (bottomLeft - topLeft) * y;
+            double right = topRight + (bottomRight - topRight) * y;
+            for (int column = 0; column < width; ++column)
+            {
+                double x = width > 1 ? static_cast<double>(column) / (width - 1) : 0.0;
+                values[row * width + column] = static_cast<PresentedType>(left + (right - left) * x);
+            }
+        }
+        setRegion(region, values.data());
+    }
+
+    /* Applies a Gaussian blur with a standard deviation of `sigma` cells
+     * to `region`. Only entries inside the region contribute, so its edges
+     * are not pulled toward neighbouring cells. */
+    void smooth(const Region & region, double sigma = 1.0)
+    {
+        if (sigma <= 0.0)
+            throw std::runtime_error("smoothing sigma must be positive");
+
+        std::vector<PresentedType> values = getRegion(region);
+        if (values.empty())
+            return;
+
+        const int radius = std::max(1, static_cast<int>(std::ceil(3.0 * sigma)));
+        std::vector<double> kernel(static_cast<std::size_t>(radius) + 1);
+        for (int i = 0; i <= radius; ++i)
+            kernel[i] = std::exp(-(i * i) / (2.0 * sigma * sigma));
+
+        // The kernel is separable, so blur the rows and then the columns
+        std::vector<PresentedType> blurred(values.size());
+        auto pass = [&](const std::vector<PresentedType> & in, std::vector<PresentedType> & out, int lines,
+                        int length, int lineStride, int step) {
+            for (int line = 0; line < lines; ++line)
+            {
+                const int base = line * lineStride;
+                for (int i = 0; i < length; ++i)
+                {
+                    double sum = 0.0;
+                    double weight = 0.0;
+                    const int first = std::max(i - radius, 0);
+                    const int last = std::min(i + radius, length - 1);
+                    for (int j = first; j <= last; ++j)
+                    {
+                        double k = kernel[std::abs(j - i)];
+                        sum += k * in[base + j * step];
+                        weight += k;
+                    }
+                    out[base + i * step] = static_cast<PresentedType>(sum / weight);
+                }
+            }
+        };
+        pass(values, blurred, region.height, region.width, region.width, 1);
+        pass(blurred, values, region.width, region.height, 1, region.width);
+        setRegion(region, values.data());
+    }
+
+    /* Copies the entries of `from` in `source` to the cells starting at
+     * (`row`, `column`). Cells that fall outside of this table are skipped.
+     * Entries are copied as presented values, so the tables may differ in
+     * data type and scale. `source` may be this table. */
+    void copy(const BasicTable & source, const Region & from, int row, int column)
+    {
+        Region to = clip(Region{row, column, from.height, from.width});
+        if (to.empty())
+            return;
+
+        std::vector<PresentedType> values = source.getRegion(
+            Region{from.row + to.row - row, from.column + to.column - column, to.height, to.width});
+        setRegion(to, values.data());
+    }
+
     // Getters
     inline const std::string & name() const noexcept { return name_; }
     inline const std::string & description() const noexcept { return description_; }
@@ -274,6 +504,30 @@ private:
     bool dirty_{false};
     std::unique_ptr<UnitGroup> unit_;
 
+    void checkRegion(const Region & region) const
+    {
+        if (region.row < 0 || region.column < 0 || region.height < 0 || region.width < 0 ||
+            region.row + region.height > height_ || region.column + region.width > width_)
+            throw std::runtime_error("region (" + std::to_string(region.row) + ", " + std::to_string(region.column) +
+                                     ", " + std::to_string(region.height) + "x" + std::to_string(region.width) +
+                                     ") out of bounds.");
+    }
+
+    // Calls `func(index, offset, count)` for each run of contiguous entries
+    // in `region`, where `offset` is the position of the run in the region
+    template <typename Func> void forEachRow(const Region & region, Func && func) const
+    {
+        if (region.empty())
+            return;
+        if (region.column == 0 && region.width == width_)
+        {
+            func(region.row * width_, 0, region.size());
+            return;
+        }
+        for (int row = 0; row < region.height; ++row)
+            func((region.row + row) * width_ + region.column, row * region.width, region.width);
+    }
+
     BasicTable(std::string name, std::string description, Bounds<PresentedType> bounds,
                EntriesPtr<PresentedType> && entries, EntriesPtr<PresentedType> && baseEntries, int width, int height,
                AxisTypePtr && xAxis, AxisTypePtr && yAxis, double scale, std::unique_ptr<UnitGroup> && unit)
@@ -374,7 +628,8 @@ public:
         AxisTypePtr yAxis_;
         std::string name_;
         std::string description_;
-        Bounds<PresentedType> bounds_;
+        Bounds<PresentedType> bounds_{std::numeric_limits<PresentedType>::lowest(),
+                                      std::numeric_limits<PresentedType>::max()};
         EntriesPtr<PresentedType> entries_;
         EntriesPtr<PresentedType> baseEntries_;
         std::unique_ptr<UnitGroup> unit_;
@@ -0,0 +1,207 @@
+#include "tunejournal.h"
+
+#include "../support/bytestream.h"
+#include "../support/crc32.h"
+
+#include <cassert>
+
+namespace lt
+{
+
+TuneJournal::TuneJournal(std::filesystem::path path, uint32_t baseCrc, uint32_t baseSize,
+                         std::chrono::milliseconds syncInterval)
+    : path_(std::move(path)), syncInterval_(syncInterval), file_(path_)
+{
+    uint64_t valid = readRecords(baseCrc, baseSize);
+    if (valid == 0)
+    {
+        recovered_.clear();
+        writeHeader(baseCrc, baseSize);
+    }
+    else if (valid != file_.size())
+    {
+        // Drop the torn record so new records follow valid ones
+        file_.truncate(valid);
+        file_.sync();
+    }
+    count_ = recovered_.size();
+    // The header is synced, but a new file can still vanish in a crash
+    // until its directory entry is
+    if (file_.created())
+        os::syncDirectory(path_.parent_path());
+
+    thread_ = std::thread([this]() { run(); });
+}
+
+TuneJournal::~TuneJournal()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+
+    if (count_ == 0 && !error_)
+    {
+        file_.close();
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+}
+
+std::filesystem::path TuneJournal::pathFor(const std::filesystem::path & tunePath)
+{
+    std::filesystem::path path = tunePath;
+    path += extension;
+    return path;
+}
+
+void TuneJournal::append(int offset, const uint8_t * before, const uint8_t * after, int size)
+{
+    assert(offset >= 0 && size >= 0);
+    {
+        std::lock_guard lock(mutex_);
+        if (error_)
+            std::rethrow_exception(error_);
+
+        std::size_t start = pending_.size();
+        ByteWriter writer(pending_);
+        writer.write(static_cast<uint32_t>(offset));
+        writer.write(static_cast<uint32_t>(size));
+        writer.write(before, static_cast<std::size_t>(size));
+        writer.write(after, static_cast<std::size_t>(size));
+        writer.write(crc32(pending_.data() + start, pending_.size() - start));
+
+        queued_ += pending_.size() - start;
+        ++count_;
+    }
+    wake_.notify_one();
+}
+
+void TuneJournal::sync()
+{
+    std::unique_lock lock(mutex_);
+    uint64_t target = queued_;
+    if (durable_ < target)
+    {
+        syncRequested_ = true;
+        wake_.notify_one();
+        synced_.wait(lock, [&]() { return durable_ >= target || error_; });
+    }
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void TuneJournal::reset(uint32_t baseCrc, uint32_t baseSize)
+{
+    sync();
+    std::lock_guard lock(mutex_);
+    // Everything queued was written, so the thread is waiting for work
+    writeHeader(baseCrc, baseSize);
+    recovered_.clear();
+    count_ = 0;
+}
+
+std::size_t TuneJournal::count() const
+{
+    std::lock_guard lock(mutex_);
+    return count_;
+}
+
+void TuneJournal::run()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this]() { return stop_ || syncRequested_ || !pending_.empty(); });
+        if (pending_.empty())
+        {
+            // A sync() covered by the batch just written. Leaving the request
+            // set would flush the next edit without waiting for the sync
+            // interval.
+            syncRequested_ = false;
+            if (stop_)
+                break;
+            continue;
+        }
+
+        // Let edits made in quick succession share one sync
+        if (!stop_ && !syncRequested_)
+            wake_.wait_for(lock, syncInterval_, [this]() { return stop_ || syncRequested_; });
+
+        std::vector<uint8_t> batch;
+        batch.swap(pending_);
+        uint64_t target = queued_;
+        syncRequested_ = false;
+
+        lock.unlock();
+        std::exception_ptr error;
+        try
+        {
+            file_.write(batch.data(), batch.size());
+            file_.sync();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        if (error)
+            error_ = error;
+        else
+            durable_ = target;
+        synced_.notify_all();
+        if (error)
+            break;
+    }
+}
+
+void TuneJournal::writeHeader(uint32_t baseCrc, uint32_t baseSize)
+{
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.write(magic);
+    writer.write(version);
+    writer.write(uint16_t{0});
+    writer.write(baseCrc);
+    writer.write(baseSize);
+
+    file_.truncate(0);
+    file_.write(header.data(), header.size());
+    file_.sync();
+}
+
+uint64_t TuneJournal::readRecords(uint32_t baseCrc, uint32_t baseSize)
+{
+    std::vector<uint8_t> data(static_cast<std::size_t>(file_.size()));
+    data.resize(file_.read(0, data.data(), data.size()));
+    if (data.size() < headerSize || loadLittle<uint32_t>(data.data()) != magic ||
+        loadLittle<uint16_t>(data.data() + 4) != version || loadLittle<uint32_t>(data.data() + 8) != baseCrc ||
+        loadLittle<uint32_t>(data.data() + 12) != baseSize)
+    {
+        return 0;
+    }
+
+    std::size_t pos = headerSize;
+    while (data.size() - pos >= 8)
+    {
+        uint32_t offset = loadLittle<uint32_t>(data.data() + pos);
+        uint32_t size = loadLittle<uint32_t>(data.data() + pos + 4);
+        std::size_t recordSize = 8 + 2 * static_cast<std::size_t>(size) + 4;
+        if (offset + static_cast<uint64_t>(size) > baseSize || data.size() - pos < recordSize)
+            break;
+
+        const uint8_t * record = data.data() + pos;
+        if (crc32(record, recordSize - 4) != loadLittle<uint32_t>(record + recordSize - 4))
+            break;
+
+        recovered_.push_back(Edit{static_cast<int>(offset), std::vector<uint8_t>(record + 8, record + 8 + size),
+                                  std::vector<uint8_t>(record + 8 + size, record + 8 + 2 * size)});
+        pos += recordSize;
+    }
+    return pos;
+}
+
+} // namespace lt
@@ -0,0 +1,110 @@
+#ifndef LT_TUNEJOURNAL_H
+#define LT_TUNEJOURNAL_H
+
+#include "../os/durablefile.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lt
+{
+
+/* Append-only log of edits to tune data, kept next to the tune file so
+ * unsaved edits survive a crash. Edits are written and synced in batches by
+ * a background thread.
+ *
+ * File layout (little endian):
+ *   Header  "LTTJ" u16 version, u16 reserved, u32 CRC-32 and u32 size of
+ *           the tune data the edits apply to
+ *   Record  u32 offset, u32 size, u8[size] old bytes, u8[size] new bytes,
+ *           u32 CRC-32 of the preceding fields
+ *
+ * Replay stops at the first incomplete or corrupt record, which is where a
+ * crash interrupted a write. */
+class TuneJournal
+{
+public:
+    static constexpr auto extension = ".journal";
+    static constexpr uint32_t magic = 0x4A54544C; // "LTTJ"
+    static constexpr uint16_t version = 1;
+    static constexpr std::size_t headerSize = 16;
+
+    struct Edit
+    {
+        int offset;
+        std::vector<uint8_t> before, after;
+    };
+
+    // Opens or creates the journal at `path` for tune data with the given
+    // CRC-32 and size. Edits recorded against the same data are kept and
+    // returned by recovered(). Edits recorded against other data, such as
+    // a journal left behind after its edits were saved, are discarded.
+    TuneJournal(std::filesystem::path path, uint32_t baseCrc, uint32_t baseSize,
+                std::chrono::milliseconds syncInterval = std::chrono::milliseconds(200));
+    // Syncs pending edits. Removes the file if it holds no edits.
+    ~TuneJournal();
+
+    TuneJournal(const TuneJournal &) = delete;
+    TuneJournal & operator=(const TuneJournal &) = delete;
+
+    // Returns the journal path of the tune at `tunePath`
+    static std::filesystem::path pathFor(const std::filesystem::path & tunePath);
+
+    // Edits found when the journal was opened
+    inline const std::vector<Edit> & recovered() const noexcept { return recovered_; }
+
+    // Queues an edit. It is synced within the sync interval. Throws the
+    // error of a failed background write.
+    void append(int offset, const uint8_t * before, const uint8_t * after, int size);
+
+    // Blocks until every queued edit is on stable storage
+    void sync();
+
+    // Discards all edits. Later edits apply to tune data with the given
+    // CRC-32 and size, such as after the tune file was rewritten.
+    void reset(uint32_t baseCrc, uint32_t baseSize);
+
+    // Number of edits in the journal, including recovered edits
+    std::size_t count() const;
+
+    inline const std::filesystem::path & path() const noexcept { return path_; }
+
+private:
+    // Writes queued records in batches
+    void run();
+    // Truncates the file and writes a new header. Requires that the
+    // background thread is idle.
+    void writeHeader(uint32_t baseCrc, uint32_t baseSize);
+    // Reads the records of an existing journal. Returns the size of the
+    // valid part of the file, or 0 if the header does not match.
+    uint64_t readRecords(uint32_t baseCrc, uint32_t baseSize);
+
+    std::filesystem::path path_;
+    std::chrono::milliseconds syncInterval_;
+    os::DurableFile file_;
+    std::vector<Edit> recovered_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable synced_;
+    // Encoded records waiting to be written
+    std::vector<uint8_t> pending_;
+    // Bytes queued and bytes synced since the journal was opened
+    uint64_t queued_{0};
+    uint64_t durable_{0};
+    bool syncRequested_{false};
+    bool stop_{false};
+    std::exception_ptr error_;
+    std::size_t count_{0};
+    std::thread thread_;
+};
+
+} // namespace lt
+
+#endif // LT_TUNEJOURNAL_H
@@ -10,6 +10,12 @@ SessionScanner::SessionScanner() {}
 
 void SessionScanner::scan(network::Uds & protocol, uint8_t minimum,
                           uint8_t maximum)
+{
+    syncWait(scanAsync(protocol, minimum, maximum));
+}
+
+Task<void> SessionScanner::scanAsync(network::Uds & protocol, uint8_t minimum,
+                                     uint8_t maximum)
 {
     for (int session = minimum; session <= maximum; ++session)
     {
@@ -19,7 +25,7 @@ void SessionScanner::scan(network::Uds & protocol, uint8_t minimum,
         uint8_t sessionByte = static_cast<uint8_t>(session);
         try
         {
-            network::UdsPacket res = protocol.requestRaw(
+            network::UdsPacket res = co_await protocol.requestRawAsync(
                 network::UdsPacket(network::UDS_REQ_SESSION, &sessionByte, 1));
             if (!res.negative())
             {
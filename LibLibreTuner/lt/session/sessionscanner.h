@@ -19,6 +19,8 @@ public:
 
     void scan(network::Uds & protocol, uint8_t minimum = 0,
               uint8_t maximum = 0xFF);
+    Task<void> scanAsync(network::Uds & protocol, uint8_t minimum = 0,
+                         uint8_t maximum = 0xFF);
 
     void onSuccess(SuccessCallback && cb);
 
@@ -0,0 +1,454 @@
+#include "virtualecu.h"
+
+#include "../auth/udsauthenticator.h"
+#include "../network/uds/uds.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lt::sim
+{
+namespace
+{
+using network::IsoTpPacket;
+
+// How often the receive loop checks if the ECU was stopped
+constexpr std::chrono::milliseconds pollInterval{50};
+
+/* Negative response codes */
+constexpr uint8_t serviceNotSupported = 0x11;
+constexpr uint8_t subFunctionNotSupported = 0x12;
+constexpr uint8_t incorrectMessageLength = 0x13;
+constexpr uint8_t conditionsNotCorrect = 0x22;
+constexpr uint8_t requestSequenceError = 0x24;
+constexpr uint8_t requestOutOfRange = 0x31;
+constexpr uint8_t securityAccessDenied = 0x33;
+constexpr uint8_t invalidKey = 0x35;
+
+constexpr uint8_t SID_ERASE = 0xB1;
+constexpr uint8_t SID_TESTER_PRESENT = 0x3E;
+
+void negative(IsoTpPacket & response, uint8_t sid, uint8_t code)
+{
+    const uint8_t data[] = {network::UDS_RES_NEGATIVE, sid, code};
+    response.setData(data, sizeof(data));
+}
+
+void positive(IsoTpPacket & response, uint8_t sid, const uint8_t * data = nullptr, std::size_t size = 0)
+{
+    uint8_t code = sid + 0x40;
+    response.setData(&code, 1);
+    response.append(data, size);
+}
+
+uint32_t readBE32(const IsoTpPacket & packet, int offset)
+{
+    return (static_cast<uint32_t>(packet[offset]) << 24) | (static_cast<uint32_t>(packet[offset + 1]) << 16) |
+           (static_cast<uint32_t>(packet[offset + 2]) << 8) | packet[offset + 3];
+}
+
+// Triangle wave over the full 16-bit range. Each identifier gets a period
+// between 1 and 16 seconds.
+void waveSource(uint16_t id, std::chrono::steady_clock::duration elapsed, std::vector<uint8_t> & value)
+{
+    long long period = 1000 * (1 + (id & 0xF));
+    long long phase = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() % period;
+    long long half = period / 2;
+    long long level = phase < half ? phase : period - phase;
+    auto result = static_cast<uint16_t>(level * 0xFFFF / half);
+    value.push_back(static_cast<uint8_t>(result >> 8));
+    value.push_back(static_cast<uint8_t>(result & 0xFF));
+}
+} // namespace
+
+VirtualEcu::VirtualEcu(network::CanPtr && can, VirtualEcuOptions options)
+    : options_(std::move(options))
+{
+    assert(can);
+    network::IsoTpOptions isotpOptions;
+    // The ECU sends on the tester's receive id
+    isotpOptions.sourceId = options_.responseId;
+    isotpOptions.destId = options_.requestId;
+    isotpOptions.timeout = std::chrono::milliseconds(1000);
+    isotp_.setOptions(isotpOptions);
+    isotp_.setCan(std::move(can));
+
+    if (!options_.didSource)
+    {
+        options_.didSource = waveSource;
+    }
+}
+
+VirtualEcu::~VirtualEcu() { stop(); }
+
+void VirtualEcu::start()
+{
+    if (thread_.joinable())
+    {
+        throw std::runtime_error("virtual ECU is already running");
+    }
+    running_ = true;
+    thread_ = std::thread([this]() { serve(); });
+}
+
+void VirtualEcu::run()
+{
+    running_ = true;
+    serve();
+}
+
+void VirtualEcu::stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+std::vector<uint8_t> VirtualEcu::image() const
+{
+    std::lock_guard lock(mutex_);
+    return options_.image;
+}
+
+void VirtualEcu::serve()
+{
+    start_ = std::chrono::steady_clock::now();
+    network::Can & can = *isotp_.can();
+
+    network::CanMessage frame;
+    IsoTpPacket request;
+    IsoTpPacket response;
+    while (running_)
+    {
+        if (!can.recv(frame, pollInterval))
+            continue;
+        // Flow control and consecutive frames only belong to transfers in
+        // progress
+        if (frame.id() != options_.requestId || frame.length() == 0 || (frame[0] >> 4) > 1)
+            continue;
+
+        try
+        {
+            isotp_.recv(frame, request);
+            if (request.empty())
+                continue;
+
+            response.clear();
+            handle(request, response);
+            ++requests_;
+            if (response.empty())
+                continue;
+
+            std::chrono::microseconds delay = latency(request[0]);
+            if (delay.count() != 0)
+            {
+                if (options_.responsePending && response[0] != network::UDS_RES_NEGATIVE)
+                {
+                    IsoTpPacket pending;
+                    negative(pending, request[0], network::UDS_NRES_RCRRP);
+                    isotp_.send(pending);
+                }
+                std::this_thread::sleep_for(delay);
+            }
+            isotp_.send(response);
+        }
+        catch (const std::exception &)
+        {
+            // The tester stopped responding mid-transfer. Wait for the next
+            // request.
+        }
+    }
+}
+
+std::chrono::microseconds VirtualEcu::latency(uint8_t sid) const noexcept
+{
+    auto it = options_.serviceLatency.find(sid);
+    return it != options_.serviceLatency.end() ? it->second : options_.latency;
+}
+
+long long VirtualEcu::imageOffset(uint32_t address, std::size_t length) const noexcept
+{
+    if (address < options_.baseAddress)
+        return -1;
+    std::size_t offset = address - options_.baseAddress;
+    if (offset > options_.image.size() || length > options_.image.size() - offset)
+        return -1;
+    return static_cast<long long>(offset);
+}
+
+void VirtualEcu::handle(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    switch (sid)
+    {
+    case network::UDS_REQ_SESSION:
+        sessionControl(request, response);
+        break;
+    case network::UDS_REQ_SECURITY:
+        securityAccess(request, response);
+        break;
+    case network::UDS_REQ_READMEM:
+        readMemory(request, response);
+        break;
+    case network::UDS_REQ_READBYID:
+        readDataById(request, response);
+        break;
+    case SID_ERASE:
+        erase(request, response);
+        break;
+    case network::UDS_REQ_REQUESTDOWNLOAD:
+        requestDownload(request, response);
+        break;
+    case network::UDS_REQ_TRANSFERDATA:
+        transferData(request, response);
+        break;
+    case SID_TESTER_PRESENT:
+        if (request.size() < 2)
+        {
+            negative(response, sid, incorrectMessageLength);
+        }
+        else if ((request[1] & 0x80) == 0)
+        {
+            // The suppress bit is clear
+            uint8_t type = request[1];
+            positive(response, sid, &type, 1);
+        }
+        break;
+    case 0x03: // OBD-II stored codes
+        readDtcs(options_.dtcs, sid, response);
+        break;
+    case 0x07: // OBD-II pending codes
+        readDtcs(options_.pendingDtcs, sid, response);
+        break;
+    default:
+        negative(response, sid, serviceNotSupported);
+        break;
+    }
+}
+
+void VirtualEcu::sessionControl(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    if (request.size() != 2)
+    {
+        negative(response, request[0], incorrectMessageLength);
+        return;
+    }
+
+    uint8_t type = request[1];
+    if (type != 0x01 && type != options_.auth.session)
+    {
+        negative(response, request[0], subFunctionNotSupported);
+        return;
+    }
+
+    // Changing sessions relocks the ECU
+    session_ = type;
+    unlocked_ = false;
+    seed_.clear();
+    positive(response, request[0], &type, 1);
+}
+
+void VirtualEcu::securityAccess(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    if (request.size() < 2)
+    {
+        negative(response, sid, incorrectMessageLength);
+        return;
+    }
+    if (session_ != options_.auth.session)
+    {
+        negative(response, sid, conditionsNotCorrect);
+        return;
+    }
+
+    if (request[1] == 0x01)
+    {
+        // Real ECUs derive the seed from a free running timer. A linear
+        // congruential generator keeps runs repeatable.
+        seedCounter_ = (seedCounter_ * 1103515245 + 12345) & 0xFFFFFF;
+        seed_ = {static_cast<uint8_t>(seedCounter_ >> 16), static_cast<uint8_t>(seedCounter_ >> 8),
+                 static_cast<uint8_t>(seedCounter_)};
+        unlocked_ = false;
+
+        uint8_t data[4] = {0x01, seed_[0], seed_[1], seed_[2]};
+        positive(response, sid, data, sizeof(data));
+        return;
+    }
+
+    if (request[1] == 0x02)
+    {
+        if (seed_.empty())
+        {
+            negative(response, sid, requestSequenceError);
+            return;
+        }
+        if (request.size() != 5)
+        {
+            negative(response, sid, incorrectMessageLength);
+            return;
+        }
+
+        uint32_t key = auth::UdsAuthenticator::generateKey(
+            options_.auth.key, auth::UdsAuthenticator::keyParameter, seed_.data(), seed_.size());
+        // Each seed may only be used once
+        seed_.clear();
+
+        // The key is sent least significant byte first
+        uint32_t received = request[2] | (request[3] << 8) | (request[4] << 16);
+        if (received != key)
+        {
+            negative(response, sid, invalidKey);
+            return;
+        }
+
+        unlocked_ = true;
+        uint8_t type = 0x02;
+        positive(response, sid, &type, 1);
+        return;
+    }
+
+    negative(response, sid, subFunctionNotSupported);
+}
+
+void VirtualEcu::readMemory(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    if (request.size() != 7)
+    {
+        negative(response, sid, incorrectMessageLength);
+        return;
+    }
+    if (!unlocked_)
+    {
+        negative(response, sid, securityAccessDenied);
+        return;
+    }
+
+    uint32_t address = readBE32(request, 1);
+    std::size_t length = (request[5] << 8) | request[6];
+
+    std::lock_guard lock(mutex_);
+    long long offset = imageOffset(address, length);
+    if (offset < 0 || length == 0)
+    {
+        negative(response, sid, requestOutOfRange);
+        return;
+    }
+    positive(response, sid, options_.image.data() + offset, length);
+}
+
+void VirtualEcu::readDataById(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    if (request.size() != 3)
+    {
+        negative(response, sid, incorrectMessageLength);
+        return;
+    }
+
+    auto id = static_cast<uint16_t>((request[1] << 8) | request[2]);
+    std::vector<uint8_t> value;
+    options_.didSource(id, std::chrono::steady_clock::now() - start_, value);
+    if (value.empty())
+    {
+        negative(response, sid, requestOutOfRange);
+        return;
+    }
+
+    // The identifier is echoed before the value
+    uint8_t echo[2] = {request[1], request[2]};
+    positive(response, sid, echo, sizeof(echo));
+    response.append(value.data(), value.size());
+}
+
+void VirtualEcu::erase(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    if (!unlocked_)
+    {
+        negative(response, sid, securityAccessDenied);
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        std::fill(options_.image.begin(), options_.image.end(), 0xFF);
+    }
+    positive(response, sid, request.data() + 1, request.size() - 1);
+}
+
+void VirtualEcu::requestDownload(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    if (request.size() != 9)
+    {
+        negative(response, sid, incorrectMessageLength);
+        return;
+    }
+    if (!unlocked_)
+    {
+        negative(response, sid, securityAccessDenied);
+        return;
+    }
+
+    uint32_t address = readBE32(request, 1);
+    uint32_t size = readBE32(request, 5);
+
+    std::lock_guard lock(mutex_);
+    long long offset = imageOffset(address, size);
+    if (offset < 0)
+    {
+        negative(response, sid, requestOutOfRange);
+        return;
+    }
+    downloadOffset_ = static_cast<std::size_t>(offset);
+    downloadRemaining_ = size;
+
+    // lengthFormatIdentifier and the largest TransferData request (0xFFF)
+    const uint8_t data[] = {0x20, 0x0F, 0xFF};
+    positive(response, sid, data, sizeof(data));
+}
+
+void VirtualEcu::transferData(const IsoTpPacket & request, IsoTpPacket & response)
+{
+    uint8_t sid = request[0];
+    if (downloadRemaining_ == 0)
+    {
+        negative(response, sid, requestSequenceError);
+        return;
+    }
+
+    // Mazda ECUs take raw data without a block sequence counter
+    std::size_t size = request.size() - 1;
+    if (size == 0 || size > downloadRemaining_)
+    {
+        negative(response, sid, requestOutOfRange);
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        std::copy(request.begin() + 1, request.end(), options_.image.begin() + downloadOffset_);
+    }
+    downloadOffset_ += size;
+    downloadRemaining_ -= size;
+    positive(response, sid);
+}
+
+void VirtualEcu::readDtcs(const std::vector<uint16_t> & codes, uint8_t sid, IsoTpPacket & response)
+{
+    positive(response, sid);
+    auto count = static_cast<uint8_t>(std::min<std::size_t>(codes.size(), 0xFF));
+    response.append(&count, 1);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const uint8_t code[2] = {static_cast<uint8_t>(codes[i] >> 8), static_cast<uint8_t>(codes[i] & 0xFF)};
+        response.append(code, sizeof(code));
+    }
+}
+
+} // namespace lt::sim
@@ -0,0 +1,129 @@
+#ifndef LT_VIRTUALECU_H
+#define LT_VIRTUALECU_H
+
+#include "../auth/auth.h"
+#include "../network/isotp/isotpcan.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lt::sim
+{
+
+// Produces the value of a data identifier. `elapsed` is the time since the
+// ECU started. Leaving `value` empty rejects the identifier.
+using DidSource = std::function<void(uint16_t id, std::chrono::steady_clock::duration elapsed,
+                                     std::vector<uint8_t> & value)>;
+
+struct VirtualEcuOptions
+{
+    // Requests are received on `requestId` and answered from `responseId`
+    uint32_t requestId = 0x7E0, responseId = 0x7E8;
+
+    // Expected session and key of the seed/key exchange
+    auth::Options auth;
+
+    // Emulated flash memory, mapped at `baseAddress`
+    std::vector<uint8_t> image;
+    uint32_t baseAddress = 0;
+
+    // Delay before every response. Services in `serviceLatency` use their
+    // own delay instead.
+    std::chrono::microseconds latency{0};
+    std::unordered_map<uint8_t, std::chrono::microseconds> serviceLatency;
+    // Sends a response pending (RCRRP) response before delayed responses
+    bool responsePending = false;
+
+    // Stored and pending diagnostic codes, reported with OBD-II services 03
+    // and 07
+    std::vector<uint16_t> dtcs, pendingDtcs;
+
+    // Values of ReadDataByIdentifier. If empty, every identifier reads as a
+    // 16-bit wave that changes over time.
+    DidSource didSource;
+};
+
+// Emulates a Mazda ECU speaking UDS over ISO-TP. Supports session control,
+// seed/key security access, ReadMemoryByAddress, erase, RequestDownload,
+// TransferData, ReadDataByIdentifier, TesterPresent and OBD-II DTC reads,
+// which is enough to run the downloader, flasher, data logger and DTC
+// scanner without a car.
+class VirtualEcu
+{
+public:
+    // Takes ownership of the CAN interface the ECU is attached to
+    explicit VirtualEcu(network::CanPtr && can, VirtualEcuOptions options = VirtualEcuOptions());
+    ~VirtualEcu();
+
+    VirtualEcu(const VirtualEcu &) = delete;
+    VirtualEcu & operator=(const VirtualEcu &) = delete;
+
+    // Starts answering requests on a new thread
+    void start();
+
+    // Answers requests on the calling thread until stop() is called
+    void run();
+
+    // Stops the ECU and waits for the thread started by start()
+    void stop();
+
+    // Returns a copy of the flash image
+    std::vector<uint8_t> image() const;
+
+    // Number of requests answered
+    inline std::size_t requests() const noexcept { return requests_; }
+
+private:
+    network::IsoTpCan isotp_;
+    VirtualEcuOptions options_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<std::size_t> requests_{0};
+    std::chrono::steady_clock::time_point start_;
+
+    // Guards the image, which is written by the ECU thread
+    mutable std::mutex mutex_;
+
+    // Security state
+    uint8_t session_{0x01};
+    bool unlocked_{false};
+    std::vector<uint8_t> seed_;
+    uint32_t seedCounter_{0x3A5C71};
+
+    // Active RequestDownload
+    std::size_t downloadOffset_{0};
+    std::size_t downloadRemaining_{0};
+
+    // Receive loop
+    void serve();
+
+    // Builds the response to `request` in `response`. An empty response is
+    // not sent.
+    void handle(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+
+    void sessionControl(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void securityAccess(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void readMemory(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void readDataById(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void erase(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void requestDownload(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void transferData(const network::IsoTpPacket & request, network::IsoTpPacket & response);
+    void readDtcs(const std::vector<uint16_t> & codes, uint8_t sid, network::IsoTpPacket & response);
+
+    // Returns the offset of [address, address + length) in the image or -1
+    // if it is out of range
+    long long imageOffset(uint32_t address, std::size_t length) const noexcept;
+
+    std::chrono::microseconds latency(uint8_t sid) const noexcept;
+};
+
+} // namespace lt::sim
+
+#endif // LT_VIRTUALECU_H
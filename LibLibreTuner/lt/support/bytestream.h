@@ -0,0 +1,115 @@
+#ifndef LT_BYTESTREAM_H
+#define LT_BYTESTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "endianness.h"
+
+namespace lt
+{
+
+// Appends little endian values to a byte vector
+class ByteWriter
+{
+public:
+    explicit ByteWriter(std::vector<uint8_t> & out) : out_(out) {}
+
+    template <typename T> void write(T value)
+    {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic type");
+        value = endian::toLittle(value);
+        const auto * raw = reinterpret_cast<const uint8_t *>(&value);
+        out_.insert(out_.end(), raw, raw + sizeof(T));
+    }
+
+    void write(const uint8_t * data, std::size_t size) { out_.insert(out_.end(), data, data + size); }
+
+    // Writes a string prefixed by its 16-bit length
+    void writeString(std::string_view str)
+    {
+        if (str.size() > 0xFFFF)
+            str = str.substr(0, 0xFFFF);
+        write(static_cast<uint16_t>(str.size()));
+        write(reinterpret_cast<const uint8_t *>(str.data()), str.size());
+    }
+
+    // Overwrites a previously written value at `offset`
+    template <typename T> void patch(std::size_t offset, T value)
+    {
+        value = endian::toLittle(value);
+        std::memcpy(out_.data() + offset, &value, sizeof(T));
+    }
+
+    inline std::size_t size() const noexcept { return out_.size(); }
+
+private:
+    std::vector<uint8_t> & out_;
+};
+
+// Reads little endian values from a byte range. Throws an exception
+// when reading past the end.
+class ByteReader
+{
+public:
+    ByteReader(const uint8_t * begin, const uint8_t * end) : pos_(begin), end_(end) {}
+
+    template <typename T> T read()
+    {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic type");
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return endian::fromLittle(value);
+    }
+
+    std::string readString()
+    {
+        auto size = read<uint16_t>();
+        require(size);
+        std::string str(reinterpret_cast<const char *>(pos_), size);
+        pos_ += size;
+        return str;
+    }
+
+    // Returns a pointer to the next `size` bytes and skips past them
+    const uint8_t * take(std::size_t size)
+    {
+        require(size);
+        const uint8_t * data = pos_;
+        pos_ += size;
+        return data;
+    }
+
+    inline const uint8_t * pos() const noexcept { return pos_; }
+    inline std::size_t remaining() const noexcept { return static_cast<std::size_t>(end_ - pos_); }
+
+private:
+    const uint8_t * pos_;
+    const uint8_t * end_;
+
+    void require(std::size_t size) const
+    {
+        if (remaining() < size)
+            throw std::runtime_error("unexpected end of data");
+    }
+};
+
+// Reads a little endian value from unaligned memory without bounds checking
+template <typename T> inline T loadLittle(const uint8_t * data) noexcept
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return endian::fromLittle(value);
+}
+
+} // namespace lt
+
+#endif // LT_BYTESTREAM_H
@@ -0,0 +1,44 @@
+#ifndef LT_CRC32_H
+#define LT_CRC32_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lt
+{
+namespace detail
+{
+constexpr std::array<uint32_t, 256> makeCrc32Table() noexcept
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+        {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint32_t, 256> crc32Table = makeCrc32Table();
+} // namespace detail
+
+// Updates a running CRC-32 (IEEE 802.3) with `size` bytes. Start with
+// crc = 0.
+inline uint32_t crc32(const uint8_t * data, std::size_t size, uint32_t crc = 0) noexcept
+{
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        crc = detail::crc32Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace lt
+
+#endif // LT_CRC32_H
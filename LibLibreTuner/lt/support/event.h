@@ -1,112 +1,284 @@
 #ifndef LT_EVENT_H
 #define LT_EVENT_H
 
-#include <forward_list>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace lt
 {
 
 template <typename... Args> class EventState;
 
+// Keeps a listener connected. The listener is disconnected when the
+// connection is destroyed.
 template <typename... Args> class EventConnection
 {
 public:
-    using Func = std::function<void(Args...)>;
     using State = EventState<Args...>;
 
-    template <typename F>
-    EventConnection(F && func, std::weak_ptr<State> && state)
-        : callback_(std::forward<F>(func)), state_(std::move(state))
+    EventConnection(std::weak_ptr<State> state, uint32_t index, uint32_t generation) noexcept
+        : state_(std::move(state)), index_(index), generation_(generation)
     {
     }
 
-    // Disconnects from the event
+    ~EventConnection() { disconnect(); }
+
+    EventConnection(const EventConnection &) = delete;
+    EventConnection & operator=(const EventConnection &) = delete;
+
+    // Disconnects from the event. The listener may still be running on
+    // another thread when this returns.
     void disconnect() noexcept
     {
-        /*if (auto state = state_.lock()) {
-            state->disconnect(this);
-        };*/
+        if (auto state = state_.lock())
+            state->disconnect(index_, generation_);
         state_.reset();
     }
 
-    template <typename... A> void operator()(A &&... args) const
-    {
-        callback_(std::forward<A>(args)...);
-    }
-
 private:
-    Func callback_;
     std::weak_ptr<State> state_;
+    uint32_t index_;
+    uint32_t generation_;
 };
 
+// Listener list shared by an event and its connections.
+//
+// Listeners are stored contiguously in an immutable list. Connecting or
+// disconnecting publishes a new copy (copy-on-write), so dispatching only
+// takes a reader count and never locks. Replaced lists are freed once no
+// dispatch can be reading them. Each slot index has a generation that is
+// bumped on disconnect, so stale connections cannot remove a listener that
+// reused their index.
+//
+// Readers are counted per epoch parity. A list retired in epoch e can only
+// be held by a dispatch that started in epoch e or earlier. The epoch is
+// only advanced when the counter it moves to is empty, so once it reaches
+// e + 2 both counters have drained since the list was retired. Writers and
+// the last dispatch to leave an epoch advance it, so lists are freed even
+// while dispatches on other threads keep overlapping.
 template <typename... Args> class EventState
 {
 public:
-    using Connection = EventConnection<Args...>;
+    using Func = std::function<void(Args...)>;
+
+    EventState() = default;
+    ~EventState() { delete current_.load(); }
+
+    EventState(const EventState &) = delete;
+    EventState & operator=(const EventState &) = delete;
 
     template <typename... A> void dispatch(A &&... args) const
     {
-        for (const std::weak_ptr<Connection> & connPtr : connections_)
+        ReadGuard guard(*this);
+        if (const SlotList * slots = current_.load())
         {
-            if (auto conn = connPtr.lock())
-            {
-                (*conn)(std::forward<A>(args)...);
-            }
+            // Arguments are not forwarded as every listener receives them
+            for (const Slot & slot : *slots)
+                slot.callback(args...);
         }
     }
 
-    // Removes expired connections
-    void removeExpired() noexcept
+    // Calls every listener with each element of [begin, end). Each listener
+    // receives the whole range before the next one is called. Elements are
+    // unpacked with std::apply if the event has more than one argument.
+    template <typename It> void dispatchRange(It begin, It end) const
     {
-        connections_.remove_if([](auto & conn) { return conn.expired(); });
+        ReadGuard guard(*this);
+        const SlotList * slots = current_.load();
+        if (slots == nullptr)
+            return;
+
+        for (const Slot & slot : *slots)
+        {
+            for (It it = begin; it != end; ++it)
+            {
+                if constexpr (sizeof...(Args) == 1)
+                    slot.callback(*it);
+                else
+                    std::apply(slot.callback, *it);
+            }
+        }
     }
 
-    // Adds a connection to the dispatch list
-    void add(std::weak_ptr<Connection> conn) noexcept
+    // Adds a listener. Returns the slot index and generation.
+    std::pair<uint32_t, uint32_t> connect(Func && func)
     {
-        connections_.emplace_front(std::move(conn));
+        std::lock_guard lock(mutex_);
+        bool reuse = !freeIndices_.empty();
+        uint32_t index = reuse ? freeIndices_.back() : static_cast<uint32_t>(generations_.size());
+        if (!reuse)
+            generations_.reserve(generations_.size() + 1);
+
+        const SlotList * current = current_.load();
+        auto slots = current != nullptr ? std::make_unique<SlotList>(*current) : std::make_unique<SlotList>();
+        slots->push_back(Slot{std::move(func), index});
+        publish(std::move(slots));
+
+        if (reuse)
+            freeIndices_.pop_back();
+        else
+            generations_.push_back(0);
+        return {index, generations_[index]};
     }
 
-    // Disconnects a connection
-    void disconnect(Connection * connection) noexcept
+    // Removes a listener. Does nothing if the generation is stale.
+    void disconnect(uint32_t index, uint32_t generation) noexcept
     {
-        connections_.remove_if([connection](auto & c) {
-            if (auto s = c.lock())
+        std::lock_guard lock(mutex_);
+        if (index >= generations_.size() || generations_[index] != generation)
+            return;
+        try
+        {
+            auto slots = std::make_unique<SlotList>();
+            const SlotList * current = current_.load();
+            slots->reserve(current->size() - 1);
+            for (const Slot & slot : *current)
             {
-                return s.get() == connection;
+                if (slot.index != index)
+                    slots->push_back(slot);
             }
-            return true; // connection has expired
-        });
+            freeIndices_.reserve(freeIndices_.size() + 1);
+            publish(std::move(slots));
+        }
+        catch (...)
+        {
+            // Out of memory. The listener stays connected.
+            return;
+        }
+        ++generations_[index];
+        freeIndices_.push_back(index);
+    }
+
+    std::size_t size() const noexcept
+    {
+        ReadGuard guard(*this);
+        const SlotList * slots = current_.load();
+        return slots != nullptr ? slots->size() : 0;
+    }
+
+    // Number of replaced lists that have not been freed yet
+    std::size_t retired() const noexcept
+    {
+        std::lock_guard lock(mutex_);
+        return retired_.size();
     }
 
 private:
-    std::forward_list<std::weak_ptr<Connection>> connections_;
+    struct Slot
+    {
+        Func callback;
+        uint32_t index;
+    };
+    using SlotList = std::vector<Slot>;
+
+    struct Retired
+    {
+        std::unique_ptr<const SlotList> slots;
+        uint32_t epoch;
+    };
+
+    // Counts a dispatch in the current epoch
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const EventState & state) noexcept
+            : state_(state), readers_(state.readers_[state.epoch_.load() & 1])
+        {
+            ++readers_;
+        }
+
+        ~ReadGuard()
+        {
+            if (--readers_ == 0 && state_.retiring_.load())
+                state_.tryReclaim();
+        }
+
+    private:
+        const EventState & state_;
+        std::atomic<uint32_t> & readers_;
+    };
+
+    std::atomic<const SlotList *> current_{nullptr};
+    mutable std::atomic<uint32_t> readers_[2]{};
+    mutable std::atomic<uint32_t> epoch_{0};
+    // Set while retired_ is not empty, so dispatches only lock when there
+    // is something to free
+    mutable std::atomic<bool> retiring_{false};
+
+    // Writer state
+    mutable std::mutex mutex_;
+    std::vector<uint32_t> generations_;
+    std::vector<uint32_t> freeIndices_;
+    // Replaced lists that a dispatch may still be reading, oldest first
+    mutable std::vector<Retired> retired_;
+
+    // Replaces the current list. Has no effect if it throws.
+    void publish(std::unique_ptr<SlotList> slots)
+    {
+        retired_.reserve(retired_.size() + 1);
+        retired_.push_back(Retired{std::unique_ptr<const SlotList>(current_.exchange(slots.release())), epoch_.load()});
+        retiring_ = true;
+        reclaim();
+    }
+
+    // Called by a dispatch that emptied its counter. Never blocks; if the
+    // lock is taken, a later dispatch or write frees the lists instead.
+    void tryReclaim() const noexcept
+    {
+        std::unique_lock lock(mutex_, std::try_to_lock);
+        if (lock.owns_lock())
+            reclaim();
+    }
+
+    // Frees lists retired two or more epochs ago, advancing the epoch while
+    // the counter it moves to is empty. Requires the lock.
+    void reclaim() const noexcept
+    {
+        while (true)
+        {
+            uint32_t epoch = epoch_.load();
+            auto done = std::find_if(retired_.begin(), retired_.end(),
+                                     [epoch](const Retired & retired) { return epoch - retired.epoch < 2; });
+            retired_.erase(retired_.begin(), done);
+            if (retired_.empty() || readers_[(epoch + 1) & 1].load() != 0)
+                break;
+            epoch_ = epoch + 1;
+        }
+        retiring_ = !retired_.empty();
+    }
 };
 
 template <typename... Args> class Event
 {
 public:
     using State = EventState<Args...>;
-    using Connection = typename State::Connection;
+    using Connection = EventConnection<Args...>;
     using ConnectionPtr = std::shared_ptr<Connection>;
 
     Event() : state_(std::make_shared<State>()) {}
 
-    // Creates a new connection with a callback
-    template <typename Func> ConnectionPtr connect(Func && f) noexcept
+    // Creates a new connection with a callback. Safe to call from any
+    // thread, including from a listener.
+    template <typename Func> ConnectionPtr connect(Func && f)
     {
-        ConnectionPtr conn =
-            std::make_shared<Connection>(std::forward<Func>(f), state_);
-        state_->add(conn);
-        return conn;
+        auto [index, generation] = state_->connect(typename State::Func(std::forward<Func>(f)));
+        return std::make_shared<Connection>(state_, index, generation);
     }
 
-    template <typename... A> void operator()(A &&... args)
-    {
-        state_->dispatch(std::forward<A>(args)...);
-    }
+    template <typename... A> void operator()(A &&... args) const { state_->dispatch(std::forward<A>(args)...); }
+
+    // Dispatches each element of a range. See EventState::dispatchRange.
+    template <typename It> void dispatchRange(It begin, It end) const { state_->dispatchRange(begin, end); }
+
+    // Number of connected listeners
+    inline std::size_t listeners() const noexcept { return state_->size(); }
 
 private:
     std::shared_ptr<State> state_;
@@ -0,0 +1,102 @@
+#ifndef LT_HEX_H
+#define LT_HEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace lt::hex
+{
+namespace detail
+{
+constexpr std::array<int8_t, 256> makeTable() noexcept
+{
+    std::array<int8_t, 256> table{};
+    for (auto & value : table)
+        value = -1;
+    for (int i = 0; i < 10; ++i)
+        table['0' + i] = static_cast<int8_t>(i);
+    for (int i = 0; i < 6; ++i)
+    {
+        table['a' + i] = static_cast<int8_t>(10 + i);
+        table['A' + i] = static_cast<int8_t>(10 + i);
+    }
+    return table;
+}
+
+inline constexpr std::array<int8_t, 256> table = makeTable();
+} // namespace detail
+
+inline constexpr char digits[] = "0123456789ABCDEF";
+
+// Returns the value of a hex digit or -1 if the character is not a hex
+// digit
+constexpr int value(char c) noexcept { return detail::table[static_cast<unsigned char>(c)]; }
+
+// Parses an unsigned hex number. Returns false if the text is empty, has
+// non-hex characters or overflows.
+template <typename T> constexpr bool parse(std::string_view text, T & out) noexcept
+{
+    if (text.empty() || text.size() > sizeof(T) * 2)
+        return false;
+    T result = 0;
+    for (char c : text)
+    {
+        int v = value(c);
+        if (v < 0)
+            return false;
+        result = static_cast<T>((result << 4) | static_cast<T>(v));
+    }
+    out = result;
+    return true;
+}
+
+// Decodes pairs of hex digits into bytes. Returns the number of bytes
+// written or -1 if the text has an odd length, non-hex characters or does
+// not fit in `capacity`.
+inline int decode(std::string_view text, uint8_t * out, std::size_t capacity) noexcept
+{
+    if (text.size() % 2 != 0 || text.size() / 2 > capacity)
+        return -1;
+    for (std::size_t i = 0; i < text.size(); i += 2)
+    {
+        int high = value(text[i]);
+        int low = value(text[i + 1]);
+        if ((high | low) < 0)
+            return -1;
+        out[i / 2] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return static_cast<int>(text.size() / 2);
+}
+
+// Writes two uppercase hex digits and returns the end of the output
+inline char * write(char * out, uint8_t byte) noexcept
+{
+    out[0] = digits[byte >> 4];
+    out[1] = digits[byte & 0xF];
+    return out + 2;
+}
+
+// Writes bytes as uppercase hex and returns the end of the output
+inline char * encode(char * out, const uint8_t * data, std::size_t size) noexcept
+{
+    for (std::size_t i = 0; i < size; ++i)
+        out = write(out, data[i]);
+    return out;
+}
+
+// Writes `value` as `width` uppercase hex digits
+template <typename T> inline char * writeNumber(char * out, T value, int width) noexcept
+{
+    for (int i = width - 1; i >= 0; --i)
+    {
+        out[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+    return out + width;
+}
+
+} // namespace lt::hex
+
+#endif // LT_HEX_H
@@ -4,13 +4,268 @@
 
 #include "job.h"
 
+#include <stdexcept>
+
 namespace lt
 {
 
+namespace
+{
+// Pool and worker index of the current thread
+thread_local JobPool * currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+constexpr std::size_t noWorker = static_cast<std::size_t>(-1);
+} // namespace
+
 void JobControl::setProgress(double progress) noexcept
 {
     job_->progress_ = progress;
     job_->eventProgress_(progress);
 }
 
-} // namespace lt
\ No newline at end of file
+void Job::start(JobPool & pool)
+{
+    std::lock_guard lock(mutex_);
+    if (running_)
+    {
+        throw std::runtime_error("run() called on active job");
+    }
+    running_ = true;
+    finished_ = false;
+    error_ = nullptr;
+    pool_ = &pool;
+}
+
+void Job::finish(std::exception_ptr error)
+{
+    std::vector<detail::PoolTask> continuations;
+    {
+        std::lock_guard lock(mutex_);
+        error_ = std::move(error);
+        finished_ = true;
+        running_ = false;
+        continuations.swap(continuations_);
+    }
+    finishedCv_.notify_all();
+
+    for (detail::PoolTask & continuation : continuations)
+        continuation();
+}
+
+void Job::cancel() noexcept
+{
+    canceled_ = true;
+    eventCanceled_();
+
+    std::vector<JobPtr> tracked;
+    {
+        std::lock_guard lock(mutex_);
+        for (const Tracked & t : tracked_)
+            tracked.push_back(t.job);
+    }
+    for (const JobPtr & job : tracked)
+        job->cancel();
+}
+
+void Job::track(const JobPtr & job, double weight)
+{
+    std::weak_ptr<Job> self = weak_from_this();
+    auto connection = job->onProgress([self](double) {
+        if (auto job = self.lock())
+            job->updateProgress();
+    });
+
+    {
+        std::lock_guard lock(mutex_);
+        tracked_.push_back(Tracked{job, weight, std::move(connection)});
+    }
+
+    if (canceled_)
+        job->cancel();
+    updateProgress();
+}
+
+void Job::updateProgress()
+{
+    double progress;
+    {
+        std::lock_guard lock(mutex_);
+        double total = 0.0;
+        double weighted = 0.0;
+        for (const Tracked & t : tracked_)
+        {
+            total += t.weight;
+            weighted += t.weight * t.job->progress();
+        }
+        if (total <= 0.0)
+            return;
+        progress = weighted / total;
+    }
+    progress_ = progress;
+    eventProgress_(progress);
+}
+
+void Job::wait()
+{
+    JobPool * pool;
+    {
+        std::lock_guard lock(mutex_);
+        pool = pool_;
+    }
+
+    if (pool != nullptr && pool->isWorkerThread())
+    {
+        // Blocking a pool thread could deadlock if the job is queued
+        // behind us, so help run tasks instead
+        while (true)
+        {
+            {
+                std::lock_guard lock(mutex_);
+                if (!running_)
+                    break;
+            }
+            if (!pool->runPending())
+            {
+                std::unique_lock lock(mutex_);
+                finishedCv_.wait_for(lock, std::chrono::milliseconds(1), [this]() { return !running_; });
+            }
+        }
+    }
+    else
+    {
+        std::unique_lock lock(mutex_);
+        finishedCv_.wait(lock, [this]() { return !running_; });
+    }
+
+    if (std::exception_ptr error = this->error())
+        std::rethrow_exception(error);
+}
+
+std::exception_ptr Job::error() const
+{
+    std::lock_guard lock(mutex_);
+    return error_;
+}
+
+JobPool::JobPool(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned i = 0; i < threads; ++i)
+        local_.emplace_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < threads; ++i)
+        threads_.emplace_back([this, i]() { runWorker(i); });
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread & thread : threads_)
+        thread.join();
+}
+
+JobPool & JobPool::global()
+{
+    static JobPool pool;
+    return pool;
+}
+
+bool JobPool::isWorkerThread() const noexcept { return currentPool == this; }
+
+void JobPool::post(detail::PoolTask task, JobPriority priority)
+{
+    Queue & queue = isWorkerThread() ? *local_[currentWorker] : shared_;
+    // Counted first so pending_ never drops below the queued tasks
+    ++pending_;
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks[static_cast<std::size_t>(priority)].emplace_back(std::move(task));
+    }
+
+    {
+        // Pairs with the predicate check in runWorker so the wakeup is
+        // not lost
+        std::lock_guard lock(sleepMutex_);
+    }
+    wake_.notify_one();
+}
+
+bool JobPool::pop(std::size_t self, detail::PoolTask & task)
+{
+    if (pending_ == 0)
+        return false;
+
+    auto take = [&](Queue & queue, std::size_t priority, bool newest) {
+        std::lock_guard lock(queue.mutex);
+        std::deque<detail::PoolTask> & tasks = queue.tasks[priority];
+        if (tasks.empty())
+            return false;
+        if (newest)
+        {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        --pending_;
+        return true;
+    };
+
+    for (std::size_t priority = PriorityCount; priority-- > 0;)
+    {
+        // Own tasks first, newest first for cache locality
+        if (self != noWorker && take(*local_[self], priority, true))
+            return true;
+        if (take(shared_, priority, false))
+            return true;
+        // Steal the oldest task from another worker
+        for (std::size_t i = 1; i <= local_.size(); ++i)
+        {
+            std::size_t victim = (self == noWorker ? i - 1 : self + i) % local_.size();
+            if (victim != self && take(*local_[victim], priority, false))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool JobPool::runPending()
+{
+    detail::PoolTask task;
+    if (!pop(isWorkerThread() ? currentWorker : noWorker, task))
+        return false;
+    task();
+    return true;
+}
+
+void JobPool::runWorker(std::size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        detail::PoolTask task;
+        if (pop(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock lock(sleepMutex_);
+        wake_.wait(lock, [this]() { return stop_ || pending_ != 0; });
+        if (stop_ && pending_ == 0)
+            return;
+    }
+}
+
+} // namespace lt
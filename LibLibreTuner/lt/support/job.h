@@ -1,8 +1,16 @@
 #ifndef LT_JOB_H
 #define LT_JOB_H
 
-#include <future>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 #include "event.h"
@@ -10,22 +18,73 @@
 namespace lt
 {
 
+enum class JobPriority
+{
+    Low,
+    Normal,
+    High,
+};
+
+namespace detail
+{
+// Move-only type-erased callable
+class PoolTask
+{
+public:
+    PoolTask() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, PoolTask>>>
+    PoolTask(F && f) : impl_(std::make_unique<Impl<std::decay_t<F>>>(std::forward<F>(f)))
+    {
+    }
+
+    inline void operator()() { impl_->run(); }
+    inline explicit operator bool() const noexcept { return static_cast<bool>(impl_); }
+
+private:
+    struct Base
+    {
+        virtual ~Base() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename F> struct Impl : Base
+    {
+        explicit Impl(F && f) : func(std::move(f)) {}
+        explicit Impl(const F & f) : func(f) {}
+        void run() override { func(); }
+        F func;
+    };
+
+    std::unique_ptr<Base> impl_;
+};
+} // namespace detail
+
 class JobControl;
+class JobPool;
 
 class Job : public std::enable_shared_from_this<Job>
 {
 public:
     friend JobControl;
 
+    // Runs `f(JobControl, args...)` on the global job pool. Throws if the
+    // job is already running.
     template <typename F, class... Args> void run(F && f, Args &&... args);
 
+    // Same as run(), on a specific pool
+    template <typename F, class... Args> void runOn(JobPool & pool, F && f, Args &&... args);
+
     inline bool running() const noexcept { return running_; }
 
-    inline void cancel() noexcept
-    {
-        canceled_ = true;
-        eventCanceled_();
-    }
+    inline JobPriority priority() const noexcept { return priority_; }
+    inline void setPriority(JobPriority priority) noexcept { priority_ = priority; }
+
+    // Requests cancellation. The job function must check
+    // JobControl::canceled(). Tracked jobs are canceled as well.
+    void cancel() noexcept;
+
+    inline bool canceled() const noexcept { return canceled_; }
 
     template <typename F> Event<>::ConnectionPtr onCanceled(F && f) noexcept
     {
@@ -42,14 +101,50 @@ public:
     // Returns current job progress, a ratio between 0.0 and 1.0
     inline double progress() const noexcept { return progress_; }
 
+    // Adds the progress of another job to this job's progress, weighted by
+    // `weight`. While any job is tracked, progress() is the weighted mean
+    // of the tracked jobs.
+    void track(const std::shared_ptr<Job> & job, double weight = 1.0);
+
+    // Runs `f(JobControl)` as a new job on the same pool once this job
+    // finishes, whether it succeeded, failed or was canceled. Returns the
+    // new job.
+    template <typename F> std::shared_ptr<Job> then(F && f);
+
+    // Blocks until the job finishes and rethrows any exception it threw.
+    // Pool threads run other jobs while they wait.
+    void wait();
+
+    // Exception thrown by the job function, if any
+    std::exception_ptr error() const;
+
 private:
-    std::thread thread_;
+    struct Tracked
+    {
+        std::shared_ptr<Job> job;
+        double weight;
+        Event<double>::ConnectionPtr connection;
+    };
+
     std::atomic<bool> running_{false};
     std::atomic<bool> canceled_{false};
+    std::atomic<JobPriority> priority_{JobPriority::Normal};
     Event<> eventCanceled_;
     Event<double> eventProgress_;
 
-    double progress_{0};
+    std::atomic<double> progress_{0};
+
+    JobPool * pool_{nullptr};
+    mutable std::mutex mutex_;
+    std::condition_variable finishedCv_;
+    bool finished_{false};
+    std::exception_ptr error_;
+    std::vector<detail::PoolTask> continuations_;
+    std::vector<Tracked> tracked_;
+
+    void start(JobPool & pool);
+    void finish(std::exception_ptr error);
+    void updateProgress();
 };
 
 using JobPtr = std::shared_ptr<Job>;
@@ -70,25 +165,188 @@ private:
     JobPtr job_;
 };
 
+// Fixed-size work-stealing thread pool.
+//
+// Each worker has a deque per priority. Tasks posted from a worker go to
+// its own deque and are run newest first; idle workers steal the oldest
+// tasks from the other workers. Tasks posted from other threads go to a
+// shared queue. Higher priority tasks are always taken first.
 class JobPool
 {
 public:
+    // Uses the hardware concurrency if `threads` is 0
+    explicit JobPool(unsigned threads = 0);
+    // Runs the remaining tasks, then joins the workers
+    ~JobPool();
+
+    JobPool(const JobPool &) = delete;
+    JobPool & operator=(const JobPool &) = delete;
+
+    // Queues a task. The task must not throw; use submit() for work that
+    // can fail.
+    void post(detail::PoolTask task, JobPriority priority = JobPriority::Normal);
+
+    // Creates a job and runs `f(JobControl, args...)` on this pool
+    template <typename F, class... Args> JobPtr submit(F && f, Args &&... args)
+    {
+        auto job = std::make_shared<Job>();
+        job->runOn(*this, std::forward<F>(f), std::forward<Args>(args)...);
+        return job;
+    }
+
+    // Calls func(i) for i in [0, count) on up to `maxThreads` threads,
+    // including the calling thread. Returns when every call has finished
+    // and rethrows the first exception. Remaining calls are skipped after
+    // an exception. Safe to call from a pool thread.
+    template <typename Func> void parallelFor(std::size_t count, Func && func, unsigned maxThreads = 0);
+
+    // Runs one queued task on the calling thread. Returns false if none was
+    // queued.
+    bool runPending();
+
+    inline unsigned threads() const noexcept { return static_cast<unsigned>(threads_.size()); }
+
+    // Returns true if called from one of this pool's threads
+    bool isWorkerThread() const noexcept;
+
+    // Pool shared by the library
+    static JobPool & global();
+
 private:
-    std::vector<JobPtr> jobs_;
+    static constexpr std::size_t PriorityCount = 3;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::array<std::deque<detail::PoolTask>, PriorityCount> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> local_;
+    Queue shared_;
+    std::vector<std::thread> threads_;
+
+    std::atomic<std::size_t> pending_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    bool stop_{false};
+
+    void runWorker(std::size_t index);
+    bool pop(std::size_t self, detail::PoolTask & task);
 };
 
 template <typename F, class... Args> void Job::run(F && f, Args &&... args)
 {
-    if (running_)
+    runOn(JobPool::global(), std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template <typename F, class... Args> void Job::runOn(JobPool & pool, F && f, Args &&... args)
+{
+    start(pool);
+    pool.post(
+        [self = shared_from_this(), f = std::forward<F>(f),
+         args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            try
+            {
+                std::apply([&](auto &&... a) { f(JobControl(self), std::forward<decltype(a)>(a)...); },
+                           std::move(args));
+            }
+            catch (...)
+            {
+                self->finish(std::current_exception());
+                return;
+            }
+            self->finish(nullptr);
+        },
+        priority_);
+}
+
+template <typename F> JobPtr Job::then(F && f)
+{
+    auto next = std::make_shared<Job>();
+    next->setPriority(priority_);
+
+    std::unique_lock lock(mutex_);
+    JobPool * pool = pool_ != nullptr ? pool_ : &JobPool::global();
+    detail::PoolTask continuation = [next, pool, f = std::forward<F>(f)]() mutable { next->runOn(*pool, std::move(f)); };
+    if (!finished_ && running_)
+    {
+        continuations_.emplace_back(std::move(continuation));
+        return next;
+    }
+    lock.unlock();
+    continuation();
+    return next;
+}
+
+template <typename Func> void JobPool::parallelFor(std::size_t count, Func && func, unsigned maxThreads)
+{
+    unsigned workers = std::max(threads(), 1u) + (isWorkerThread() ? 0u : 1u);
+    if (maxThreads != 0)
+        workers = std::min(workers, maxThreads);
+    workers = static_cast<unsigned>(std::min<std::size_t>(workers, count));
+    if (workers <= 1)
     {
-        throw std::runtime_error("run() called on active job");
+        for (std::size_t i = 0; i < count; ++i)
+            func(i);
+        return;
     }
-    std::packaged_task task(std::forward<F>(f));
-    running_ = true;
-    thread_ = std::thread([&, task{std::move(task)}] {
-        task(JobControl(shared_from_this()), std::forward<Args>(args)...);
-        running_ = false;
-    });
+
+    // Helpers may start after the loop is done, so the state is shared
+    struct State
+    {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    std::size_t total = count;
+    auto * target = &func;
+
+    auto loop = [state, total, target]() {
+        std::size_t completed = 0;
+        for (std::size_t i = state->next++; i < total; i = state->next++)
+        {
+            if (!state->failed)
+            {
+                try
+                {
+                    (*target)(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard lock(state->mutex);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                    state->failed = true;
+                }
+            }
+            ++completed;
+        }
+        if (completed != 0 && (state->done += completed) == total)
+        {
+            std::lock_guard lock(state->mutex);
+            state->finished.notify_all();
+        }
+    };
+
+    for (unsigned i = 1; i < workers; ++i)
+        post(loop, JobPriority::High);
+    loop();
+
+    // Wait for calls still running on other threads
+    while (state->done != total)
+    {
+        if (isWorkerThread() && runPending())
+            continue;
+        std::unique_lock lock(state->mutex);
+        state->finished.wait_for(lock, std::chrono::milliseconds(1), [&]() { return state->done == total; });
+    }
+
+    if (state->error)
+        std::rethrow_exception(state->error);
 }
 
 } // namespace lt
@@ -0,0 +1,58 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lt
+{
+
+double Histogram::mean() const noexcept
+{
+    uint64_t n = count();
+    if (n == 0)
+        return 0.0;
+    return static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+uint64_t Histogram::percentile(double percentile) const noexcept
+{
+    uint64_t n = count();
+    if (n == 0)
+        return 0;
+
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(n))), 1);
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucketCount; ++i)
+    {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return std::min(lowest(i + 1) - 1, max());
+    }
+    return max();
+}
+
+std::vector<Histogram::Bucket> Histogram::buckets() const
+{
+    std::vector<Bucket> buckets;
+    for (std::size_t i = 0; i < bucketCount; ++i)
+    {
+        uint64_t count = counts_[i].load(std::memory_order_relaxed);
+        if (count != 0)
+            buckets.push_back(Bucket{lowest(i), lowest(i + 1) - 1, count});
+    }
+    return buckets;
+}
+
+void Histogram::reset() noexcept
+{
+    for (auto & count : counts_)
+        count.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace lt
@@ -0,0 +1,112 @@
+#ifndef LT_METRICS_H
+#define LT_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lt
+{
+
+// Monotonic event count. Safe to update from any thread.
+class Counter
+{
+public:
+    inline void add(uint64_t amount = 1) noexcept { value_.fetch_add(amount, std::memory_order_relaxed); }
+    inline uint64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+    inline void reset() noexcept { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Histogram with logarithmic buckets. Values below 2^subBucketBits (32)
+// each get their own bucket. Above that, each power of two range is split
+// linearly into halfCount (16) parts, so recorded values keep a relative
+// precision of about 6% across the whole range. Values above `maxValue` are counted in the last bucket.
+// Recording is lock free and safe from any thread.
+class Histogram
+{
+public:
+    static constexpr int subBucketBits = 5;
+    static constexpr int valueBits = 40;
+    static constexpr uint64_t maxValue = (uint64_t{1} << valueBits) - 1;
+
+    static constexpr std::size_t subBucketCount = std::size_t{1} << subBucketBits;
+    static constexpr std::size_t halfCount = subBucketCount / 2;
+    static constexpr std::size_t bucketCount = (valueBits - subBucketBits) * halfCount + subBucketCount;
+
+    struct Bucket
+    {
+        // Inclusive range of the values counted in the bucket
+        uint64_t lowest, highest;
+        uint64_t count;
+    };
+
+    inline void record(uint64_t value) noexcept
+    {
+        if (value > maxValue)
+            value = maxValue;
+        counts_[index(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t min = min_.load(std::memory_order_relaxed);
+        while (value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed))
+        {
+        }
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    inline uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    // Returns 0 if nothing was recorded
+    inline uint64_t min() const noexcept { return count() == 0 ? 0 : min_.load(std::memory_order_relaxed); }
+    inline uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+    double mean() const noexcept;
+
+    // Returns the upper bound of the bucket holding the value at `percentile`
+    // (0-100), limited to the largest recorded value. Returns 0 if nothing
+    // was recorded.
+    uint64_t percentile(double percentile) const noexcept;
+
+    // Returns every bucket with a nonzero count in ascending order
+    std::vector<Bucket> buckets() const;
+
+    // Not atomic with respect to concurrent recording
+    void reset() noexcept;
+
+    // Bucket of `value`
+    static constexpr std::size_t index(uint64_t value) noexcept
+    {
+        int shift = std::bit_width(value) - subBucketBits;
+        if (shift <= 0)
+            return static_cast<std::size_t>(value);
+        return static_cast<std::size_t>(shift) * halfCount + static_cast<std::size_t>(value >> shift);
+    }
+
+    // Lowest value counted in bucket `index`
+    static constexpr uint64_t lowest(std::size_t index) noexcept
+    {
+        if (index < subBucketCount)
+            return index;
+        std::size_t shift = (index - subBucketCount) / halfCount + 1;
+        return static_cast<uint64_t>(index - shift * halfCount) << shift;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, bucketCount> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{0};
+};
+
+} // namespace lt
+
+#endif // LT_METRICS_H
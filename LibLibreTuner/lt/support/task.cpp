@@ -0,0 +1,21 @@
+#include "task.h"
+
+namespace lt::detail
+{
+
+void SyncSignal::set() noexcept
+{
+    std::lock_guard lock(mutex_);
+    set_ = true;
+    cv_.notify_all();
+}
+
+void SyncSignal::wait()
+{
+    // Blocking calls are offloaded to the blocking pool, so the task never
+    // waits on work queued behind a job pool thread
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this]() { return set_; });
+}
+
+} // namespace lt::detail
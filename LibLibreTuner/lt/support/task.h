@@ -0,0 +1,264 @@
+#ifndef LT_TASK_H
+#define LT_TASK_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace lt
+{
+
+template <typename T = void> class Task;
+
+namespace detail
+{
+class TaskPromiseBase
+{
+public:
+    // Resumes the awaiting coroutine, if any, when the task finishes
+    struct FinalAwaiter
+    {
+        inline bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            std::coroutine_handle<> continuation = handle.promise().continuation_;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        inline void await_resume() const noexcept {}
+    };
+
+    inline std::suspend_always initial_suspend() const noexcept { return {}; }
+    inline FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    inline void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+    inline void setContinuation(std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+protected:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr error_;
+};
+
+template <typename T> class TaskPromise : public TaskPromiseBase
+{
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U> void return_value(U && value) { value_.emplace(std::forward<U>(value)); }
+
+    T result()
+    {
+        if (error_)
+            std::rethrow_exception(error_);
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <> class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+    Task<void> get_return_object() noexcept;
+
+    inline void return_void() const noexcept {}
+
+    inline void result()
+    {
+        if (error_)
+            std::rethrow_exception(error_);
+    }
+};
+} // namespace detail
+
+// Lazily started coroutine. The body runs when the task is awaited and the
+// awaiting coroutine resumes, on whatever thread finished the task, with
+// its result or exception.
+template <typename T> class [[nodiscard]] Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+
+    Task(Task && other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task & operator=(Task && other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task & operator=(const Task &) = delete;
+
+    // Destroying a task that has started but not finished is undefined
+    ~Task()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    inline bool valid() const noexcept { return static_cast<bool>(handle_); }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            Handle handle;
+
+            inline bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().setContinuation(awaiting);
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    Handle handle_;
+};
+
+namespace detail
+{
+template <typename T> Task<T> TaskPromise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// One-shot flag for syncWait
+class SyncSignal
+{
+public:
+    void set() noexcept;
+    // Blocks until set() is called
+    void wait();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool set_{false};
+};
+
+// Coroutine started eagerly that signals when it finishes. The frame is
+// left suspended at the end so syncWait can destroy it after waking.
+struct SyncWaitDriver
+{
+    struct promise_type
+    {
+        SyncSignal * signal{nullptr};
+
+        SyncWaitDriver get_return_object() noexcept
+        {
+            return SyncWaitDriver{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        inline std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        auto final_suspend() const noexcept
+        {
+            struct Awaiter
+            {
+                inline bool await_ready() const noexcept { return false; }
+                inline void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                {
+                    handle.promise().signal->set();
+                }
+                inline void await_resume() const noexcept {}
+            };
+            return Awaiter{};
+        }
+
+        inline void return_void() const noexcept {}
+        inline void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T>
+SyncWaitDriver syncWaitDriver(Task<T> & task, std::optional<T> & result, std::exception_ptr & error)
+{
+    try
+    {
+        result.emplace(co_await std::move(task));
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+}
+
+inline SyncWaitDriver syncWaitDriver(Task<void> & task, std::exception_ptr & error)
+{
+    try
+    {
+        co_await std::move(task);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+}
+} // namespace detail
+
+// Runs a task and blocks until it finishes. Returns its result or rethrows
+// its exception. Must not be called from the thread the task resumes on,
+// e.g. an I/O thread the task waits on.
+template <typename T> T syncWait(Task<T> task)
+{
+    detail::SyncSignal signal;
+    std::exception_ptr error;
+
+    if constexpr (std::is_void_v<T>)
+    {
+        detail::SyncWaitDriver driver = detail::syncWaitDriver(task, error);
+        driver.handle.promise().signal = &signal;
+        driver.handle.resume();
+        signal.wait();
+        driver.handle.destroy();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+    else
+    {
+        std::optional<T> result;
+        detail::SyncWaitDriver driver = detail::syncWaitDriver(task, result, error);
+        driver.handle.promise().signal = &signal;
+        driver.handle.resume();
+        signal.wait();
+        driver.handle.destroy();
+
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*result);
+    }
+}
+
+} // namespace lt
+
+#endif // LT_TASK_H
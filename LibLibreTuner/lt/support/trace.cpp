@@ -0,0 +1,139 @@
+#include "trace.h"
+
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace lt::trace
+{
+namespace detail
+{
+std::atomic<bool> enabled{true};
+const Clock::time_point epoch = Clock::now();
+std::atomic<int64_t> nextAsyncId{1};
+thread_local ThreadBuffer * currentBuffer = nullptr;
+
+namespace
+{
+struct Registry
+{
+    std::mutex mutex;
+    // Buffers outlive their threads so events can be exported afterwards
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry & registry()
+{
+    static Registry instance;
+    return instance;
+}
+} // namespace
+
+ThreadBuffer & registerThread()
+{
+    Registry & reg = registry();
+    std::lock_guard lock(reg.mutex);
+    reg.buffers.emplace_back(std::make_unique<ThreadBuffer>(static_cast<uint32_t>(reg.buffers.size() + 1)));
+    currentBuffer = reg.buffers.back().get();
+    return *currentBuffer;
+}
+} // namespace detail
+
+namespace
+{
+void writeName(std::ostream & out, const char * name)
+{
+    out << '"';
+    for (const char * c = name; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+// Trace events use microseconds
+void writeMicroseconds(std::ostream & out, int64_t ns)
+{
+    if (ns < 0)
+    {
+        out << '-';
+        ns = -ns;
+    }
+    int64_t fraction = ns % 1000;
+    out << ns / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10)
+        << static_cast<char>('0' + fraction % 10);
+}
+} // namespace
+
+void clear()
+{
+    detail::Registry & reg = detail::registry();
+    std::lock_guard lock(reg.mutex);
+    for (auto & buffer : reg.buffers)
+        buffer->clear();
+}
+
+std::size_t dropped()
+{
+    detail::Registry & reg = detail::registry();
+    std::lock_guard lock(reg.mutex);
+    std::size_t total = 0;
+    for (auto & buffer : reg.buffers)
+        total += buffer->dropped();
+    return total;
+}
+
+void writeChromeTrace(std::ostream & out)
+{
+    detail::Registry & reg = detail::registry();
+    std::lock_guard lock(reg.mutex);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto & buffer : reg.buffers)
+    {
+        std::size_t size = buffer->size();
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const Event & event = (*buffer)[i];
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            first = false;
+            writeName(out, event.name);
+            out << ",\"pid\":1,\"tid\":" << buffer->id() << ",\"ts\":";
+            writeMicroseconds(out, event.begin);
+            switch (event.type)
+            {
+            case EventType::Span:
+                out << ",\"ph\":\"X\",\"dur\":";
+                writeMicroseconds(out, event.value);
+                break;
+            case EventType::Counter:
+                out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << '}';
+                break;
+            case EventType::AsyncBegin:
+            case EventType::AsyncEnd:
+                // Nestable async events are matched by category and id
+                out << ",\"ph\":\"" << (event.type == EventType::AsyncBegin ? 'b' : 'e')
+                    << "\",\"cat\":\"async\",\"id\":" << event.value;
+                break;
+            }
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+}
+
+void writeChromeTrace(const std::filesystem::path & path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open trace file '" + path.string() + "' for writing");
+    }
+    writeChromeTrace(file);
+}
+
+} // namespace lt::trace
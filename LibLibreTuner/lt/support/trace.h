@@ -0,0 +1,200 @@
+#ifndef LT_TRACE_H
+#define LT_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+
+// Trace spans and counters for finding where time goes in link routines.
+// Enabled by defining LT_ENABLE_TRACING (the ENABLE_TRACING CMake option).
+// Otherwise the macros expand to nothing and have no cost.
+//
+//   LT_TRACE_SPAN("isotp.send");          // Times the enclosing scope
+//   LT_TRACE_ASYNC_SPAN("uds.request");   // Same, across co_await
+//   LT_TRACE_COUNTER("rma.bytes", total); // Records a value
+//
+// A coroutine can resume on another thread, so a span that is open across
+// co_await must be an async span. Its begin and end are separate events
+// matched by id, and appear on their own track rather than the thread's.
+//
+// Names must be string literals or otherwise outlive the trace. Events are
+// recorded into a buffer owned by the calling thread without locking and
+// can be exported as Chrome trace-event JSON, which chrome://tracing and
+// Perfetto open.
+
+namespace lt::trace
+{
+
+using Clock = std::chrono::steady_clock;
+
+enum class EventType : uint8_t
+{
+    Span,
+    Counter,
+    AsyncBegin,
+    AsyncEnd,
+};
+
+struct Event
+{
+    const char * name;
+    EventType type;
+    // Nanoseconds since the trace epoch
+    int64_t begin;
+    // Span duration in nanoseconds, the counter value or the async span id
+    int64_t value;
+};
+
+// Events of one thread. Only the owning thread writes; the count is
+// published with release ordering so exports can read completed events
+// while the thread is still tracing. Events past the capacity are dropped.
+class ThreadBuffer
+{
+public:
+    static constexpr std::size_t capacity = 1 << 16;
+
+    explicit ThreadBuffer(uint32_t id) : events_(new Event[capacity]), id_(id) {}
+
+    inline void push(const Event & event) noexcept
+    {
+        std::size_t size = size_.load(std::memory_order_relaxed);
+        if (size == capacity)
+        {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        events_[size] = event;
+        size_.store(size + 1, std::memory_order_release);
+    }
+
+    inline std::size_t size() const noexcept { return size_.load(std::memory_order_acquire); }
+    inline const Event & operator[](std::size_t index) const noexcept { return events_[index]; }
+    inline std::size_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    inline uint32_t id() const noexcept { return id_; }
+
+    // Not safe while the owning thread is tracing
+    inline void clear() noexcept
+    {
+        size_.store(0, std::memory_order_release);
+        dropped_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<Event[]> events_;
+    std::atomic<std::size_t> size_{0};
+    std::atomic<std::size_t> dropped_{0};
+    uint32_t id_;
+};
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+extern const Clock::time_point epoch;
+extern std::atomic<int64_t> nextAsyncId;
+
+extern thread_local ThreadBuffer * currentBuffer;
+
+// Creates the calling thread's buffer
+ThreadBuffer & registerThread();
+
+// Returns the calling thread's buffer, registering it on first use
+inline ThreadBuffer & threadBuffer()
+{
+    ThreadBuffer * buffer = currentBuffer;
+    return buffer != nullptr ? *buffer : registerThread();
+}
+
+inline int64_t now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
+} // namespace detail
+
+// Recording can be paused at runtime when tracing is compiled in. Enabled
+// by default.
+inline void setEnabled(bool enabled) noexcept { detail::enabled.store(enabled, std::memory_order_relaxed); }
+inline bool enabled() noexcept { return detail::enabled.load(std::memory_order_relaxed); }
+
+// Records the lifetime of the object as a span
+class Span
+{
+public:
+    explicit Span(const char * name) noexcept : name_(name), begin_(enabled() ? detail::now() : -1) {}
+
+    ~Span()
+    {
+        if (begin_ >= 0)
+            detail::threadBuffer().push({name_, EventType::Span, begin_, detail::now() - begin_});
+    }
+
+    Span(const Span &) = delete;
+    Span & operator=(const Span &) = delete;
+
+private:
+    const char * name_;
+    int64_t begin_;
+};
+
+// Records the lifetime of the object as an async span. Begin and end are
+// recorded on the threads that create and destroy it.
+class AsyncSpan
+{
+public:
+    explicit AsyncSpan(const char * name) noexcept
+        : name_(name), id_(enabled() ? detail::nextAsyncId.fetch_add(1, std::memory_order_relaxed) : 0)
+    {
+        if (id_ != 0)
+            detail::threadBuffer().push({name_, EventType::AsyncBegin, detail::now(), id_});
+    }
+
+    ~AsyncSpan()
+    {
+        if (id_ != 0)
+            detail::threadBuffer().push({name_, EventType::AsyncEnd, detail::now(), id_});
+    }
+
+    AsyncSpan(const AsyncSpan &) = delete;
+    AsyncSpan & operator=(const AsyncSpan &) = delete;
+
+private:
+    const char * name_;
+    // 0 if tracing was disabled when the span started
+    int64_t id_;
+};
+
+inline void counter(const char * name, int64_t value) noexcept
+{
+    if (enabled())
+        detail::threadBuffer().push({name, EventType::Counter, detail::now(), value});
+}
+
+// Discards all recorded events. Must not be called while other threads are
+// tracing.
+void clear();
+
+// Number of events dropped because a thread buffer was full
+std::size_t dropped();
+
+// Writes every recorded event as Chrome trace-event JSON
+void writeChromeTrace(std::ostream & out);
+void writeChromeTrace(const std::filesystem::path & path);
+
+} // namespace lt::trace
+
+#define LT_TRACE_CONCAT_(a, b) a##b
+#define LT_TRACE_CONCAT(a, b) LT_TRACE_CONCAT_(a, b)
+
+#ifdef LT_ENABLE_TRACING
+#define LT_TRACE_SPAN(name) ::lt::trace::Span LT_TRACE_CONCAT(ltTraceSpan, __LINE__)(name)
+#define LT_TRACE_ASYNC_SPAN(name) ::lt::trace::AsyncSpan LT_TRACE_CONCAT(ltTraceSpan, __LINE__)(name)
+#define LT_TRACE_COUNTER(name, value) ::lt::trace::counter(name, static_cast<int64_t>(value))
+#else
+#define LT_TRACE_SPAN(name) static_cast<void>(0)
+#define LT_TRACE_ASYNC_SPAN(name) static_cast<void>(0)
+#define LT_TRACE_COUNTER(name, value) static_cast<void>(0)
+#endif
+
+#endif // LT_TRACE_H
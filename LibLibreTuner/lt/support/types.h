@@ -167,6 +167,8 @@ enum class DataLinkType
     SocketCan,
     PassThru,
     Elm,
+    // Plays back a recording
+    Replay,
     Invalid,
 };
 
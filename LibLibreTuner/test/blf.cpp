@@ -0,0 +1,145 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/can/blf.h>
+#include <lt/support/bytestream.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace lt;
+using namespace lt::network;
+
+namespace
+{
+constexpr uint32_t ObjectMagic = 0x4A424F4C;
+
+std::vector<uint8_t> canObject(uint32_t id, uint8_t value, uint64_t time)
+{
+    std::vector<uint8_t> object;
+    ByteWriter writer(object);
+    writer.write(ObjectMagic);
+    writer.write(static_cast<uint16_t>(blf::ObjectHeaderBaseSize + blf::ObjectHeaderV1Size));
+    writer.write(static_cast<uint16_t>(1));
+    writer.write(static_cast<uint32_t>(blf::ObjectHeaderBaseSize + blf::ObjectHeaderV1Size + 16));
+    writer.write(static_cast<uint32_t>(blf::CanMessageObject));
+    writer.write(blf::TimeOneNanos);
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(time * 1000);
+    writer.write(static_cast<uint16_t>(1));
+    writer.write(static_cast<uint8_t>(0));
+    writer.write(static_cast<uint8_t>(8));
+    writer.write(id);
+    for (int i = 0; i < 8; ++i)
+        writer.write(static_cast<uint8_t>(value + i));
+    return object;
+}
+
+void writeContainer(std::vector<uint8_t> & file, const uint8_t * payload, std::size_t size)
+{
+    ByteWriter writer(file);
+    auto objectSize = static_cast<uint32_t>(blf::ObjectHeaderBaseSize + blf::ContainerHeaderSize + size);
+    writer.write(ObjectMagic);
+    writer.write(static_cast<uint16_t>(blf::ObjectHeaderBaseSize));
+    writer.write(static_cast<uint16_t>(1));
+    writer.write(objectSize);
+    writer.write(static_cast<uint32_t>(blf::LogContainerObject));
+    writer.write(static_cast<uint16_t>(blf::None));
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(static_cast<uint32_t>(0));
+    writer.write(static_cast<uint32_t>(size));
+    writer.write(static_cast<uint32_t>(0));
+    writer.write(payload, size);
+    file.resize(file.size() + objectSize % 4, 0);
+}
+
+std::vector<uint8_t> fileHeader()
+{
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.write(static_cast<uint32_t>(0x47474F4C));
+    writer.write(static_cast<uint32_t>(blf::FileHeaderSize));
+    header.resize(blf::FileHeaderSize, 0);
+    return header;
+}
+
+std::vector<CanLogEntry> readAll(const std::filesystem::path & path)
+{
+    BlfReader reader(path);
+    std::vector<CanLogEntry> entries;
+    CanLogEntry entry;
+    while (reader.next(entry))
+        entries.push_back(entry);
+    return entries;
+}
+} // namespace
+
+TEST_CASE("BLF objects spanning containers are read")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_span.blf";
+
+    std::vector<uint8_t> payload;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        std::vector<uint8_t> object = canObject(0x7E0 + i, static_cast<uint8_t>(i * 16), i * 100);
+        payload.insert(payload.end(), object.begin(), object.end());
+    }
+
+    // Split within the signature, the header, the message and between objects
+    for (std::size_t split : {1u, 2u, 3u, 4u, 10u, 20u, 40u, 48u, 50u, 100u})
+    {
+        CAPTURE(split);
+        std::vector<uint8_t> file = fileHeader();
+        writeContainer(file, payload.data(), split);
+        writeContainer(file, payload.data() + split, payload.size() - split);
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(file.data()), file.size());
+
+        std::vector<CanLogEntry> entries = readAll(path);
+        REQUIRE(entries.size() == 3);
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            CHECK(entries[i].message.id() == 0x7E0 + i);
+            CHECK(entries[i].message.length() == 8);
+            CHECK(entries[i].message.message()[7] == i * 16 + 7);
+            CHECK(entries[i].time == std::chrono::microseconds(i * 100));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("BLF round trip")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_roundtrip.blf";
+
+    // Enough frames for several containers
+    const uint32_t count = 10000;
+    {
+        BlfWriter writer(path);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint8_t data[3] = {static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 0x55};
+            CanMessage message(0x100 + i % 0x600, data, 3);
+            message.setExtended(i % 5 == 0);
+            writer.write(CanLogEntry{i % 2 == 0 ? CanMessageDirection::Outbound : CanMessageDirection::Inbound,
+                                     message, std::chrono::microseconds(i * 10)});
+        }
+        writer.close();
+    }
+
+    std::vector<CanLogEntry> entries = readAll(path);
+    REQUIRE(entries.size() == count);
+    std::size_t mismatches = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const CanLogEntry & entry = entries[i];
+        if (entry.message.id() != 0x100 + i % 0x600 || entry.message.extended() != (i % 5 == 0) ||
+            entry.message.length() != 3 ||
+            entry.message.message()[0] != static_cast<uint8_t>(i) || entry.time != std::chrono::microseconds(i * 10) ||
+            (entry.direction == CanMessageDirection::Outbound) != (i % 2 == 0))
+            ++mismatches;
+    }
+    CHECK(mismatches == 0);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,43 @@
+#include <catch2/catch.hpp>
+
+#include <lt/os/blockingpool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace lt;
+
+TEST_CASE("Blocking calls do not wait for each other")
+{
+    os::BlockingPool pool(std::chrono::milliseconds(50));
+
+    // Every call blocks until all of them have started, which only finishes
+    // if each gets its own thread
+    const int count = 32;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int started = 0;
+    std::atomic<int> finished{0};
+    for (int i = 0; i < count; ++i)
+    {
+        pool.post([&]() {
+            std::unique_lock lock(mutex);
+            ++started;
+            cv.notify_all();
+            if (cv.wait_for(lock, std::chrono::seconds(5), [&]() { return started == count; }))
+                ++finished;
+        });
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (finished != count && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CHECK(finished == count);
+
+    // Idle threads exit
+    while (pool.threads() != 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(pool.threads() == 0);
+}
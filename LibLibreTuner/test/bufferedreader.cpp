@@ -0,0 +1,132 @@
+#include <catch2/catch.hpp>
+
+#include <serial/bufferedreader.h>
+
+#ifdef __linux__
+#include "fakeserial.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+std::unique_ptr<serial::Device> openDevice(const FakeSerial & fake)
+{
+    serial::Settings settings;
+    settings.baudrate = 0;
+    settings.readTimeout = 200ms;
+    auto device = std::make_unique<serial::Device>(fake.path(), settings);
+    device->open();
+    return device;
+}
+
+// Writes `data` after the reader has had time to drain what is buffered
+std::thread writeLater(FakeSerial & fake, std::string data)
+{
+    return std::thread([&fake, data = std::move(data)]() {
+        std::this_thread::sleep_for(20ms);
+        fake.write(data);
+    });
+}
+} // namespace
+
+TEST_CASE("Buffered reads compact unread data")
+{
+    FakeSerial fake;
+    auto device = openDevice(fake);
+    serial::BufferedReader reader(*device, 8);
+
+    SECTION("Reads continue past the end of the buffer")
+    {
+        fake.write("01234567");
+        CHECK(reader.read(5) == "01234");
+
+        // The buffer ends at its capacity, so the 3 unread bytes move to
+        // the front before the next device read
+        std::thread writer = writeLater(fake, "89AB");
+        CHECK(reader.read(6) == "56789A");
+        writer.join();
+        CHECK(reader.read(1) == "B");
+        CHECK(reader.size() == 0);
+    }
+
+    SECTION("Lines continue past the end of the buffer")
+    {
+        fake.write("abc\rdefg");
+        CHECK(reader.readLine() == "abc");
+        CHECK(reader.size() == 5);
+
+        std::thread writer = writeLater(fake, "hi\r");
+        CHECK(reader.readLine() == "defghi");
+        writer.join();
+    }
+
+    SECTION("Unterminated lines longer than the buffer are errors")
+    {
+        fake.write("0123456789");
+        CHECK_THROWS_WITH(reader.readLine(), "buffered reader is full");
+    }
+
+    SECTION("Reads larger than the buffer are rejected")
+    {
+        CHECK_THROWS(reader.read(9));
+    }
+
+    SECTION("Reads into a caller buffer can exceed the capacity")
+    {
+        fake.write("0123");
+        CHECK(reader.read(2) == "01");
+        std::thread writer = writeLater(fake, "456789ABCDEF");
+        char out[14];
+        reader.read(out, sizeof(out));
+        writer.join();
+        CHECK(std::string(out, sizeof(out)) == "23456789ABCDEF");
+    }
+
+    SECTION("Timeouts are errors")
+    {
+        CHECK_THROWS(reader.read(1));
+    }
+}
+
+TEST_CASE("Line delimiters are found across refills")
+{
+    FakeSerial fake;
+    auto device = openDevice(fake);
+    serial::BufferedReader reader(*device, 64);
+
+    SECTION("The delimiter arrives in a later read")
+    {
+        fake.write("HELLO WO");
+        std::thread writer = writeLater(fake, "RLD\r");
+        CHECK(reader.readLine() == "HELLO WORLD");
+        writer.join();
+    }
+
+    SECTION("LF before CR ends the line")
+    {
+        fake.write("ABC");
+        std::thread writer = writeLater(fake, "D\nE\r");
+        CHECK(reader.readLine() == "ABCD");
+        writer.join();
+        CHECK(reader.readLine() == "E");
+    }
+
+    SECTION("Leading whitespace read before the data is skipped")
+    {
+        fake.write("\r\n\r");
+        std::thread writer = writeLater(fake, "XY\r");
+        CHECK(reader.readLine() == "XY");
+        writer.join();
+    }
+
+    SECTION("The stop sequence is returned at the start of a line")
+    {
+        fake.write("41 00\r\r");
+        std::thread writer = writeLater(fake, ">");
+        CHECK(reader.readLine(">") == "41 00");
+        CHECK(reader.readLine(">") == ">");
+        writer.join();
+        CHECK(reader.size() == 0);
+    }
+}
+#endif
@@ -0,0 +1,180 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/can/canlog.h>
+#include <lt/support/bytestream.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace lt;
+using namespace lt::network;
+
+namespace
+{
+CanLogEntry makeEntry(uint64_t sequence)
+{
+    uint8_t data[4] = {static_cast<uint8_t>(sequence), static_cast<uint8_t>(sequence >> 8), 0xAA, 0x55};
+    CanMessage message(0x700 + static_cast<uint32_t>(sequence % 16), data, 4);
+    message.setExtended(sequence % 5 == 0);
+    return CanLogEntry{sequence % 3 == 0 ? CanMessageDirection::Outbound : CanMessageDirection::Inbound, message,
+                       std::chrono::microseconds(sequence * 100)};
+}
+
+bool matches(const CanLogEntry & entry, uint64_t sequence)
+{
+    CanLogEntry expected = makeEntry(sequence);
+    return entry.direction == expected.direction && entry.message.id() == expected.message.id() &&
+           entry.message.extended() == expected.message.extended() &&
+           entry.message.length() == 4 && std::equal(entry.message.message(), entry.message.message() + 4,
+                                                     expected.message.message()) &&
+           entry.time == expected.time;
+}
+
+std::vector<uint8_t> readFile(const std::filesystem::path & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+} // namespace
+
+TEST_CASE("CAN log ring keeps the newest entries")
+{
+    CanLog log(8);
+    for (uint64_t i = 0; i < 20; ++i)
+        log.add(makeEntry(i));
+
+    CHECK(log.total() == 20);
+    CHECK(log.size() == 8);
+    CHECK(log.firstSequence() == 12);
+
+    CanLogEntry entry;
+    CHECK_FALSE(log.get(11, entry));
+    CHECK_FALSE(log.get(20, entry));
+    for (uint64_t i = 12; i < 20; ++i)
+    {
+        REQUIRE(log.get(i, entry));
+        CHECK(matches(entry, i));
+    }
+
+    // Reads that start before the ring are moved up to its first entry
+    std::vector<CanLogEntry> out;
+    CHECK(log.entries(3, 100, out) == 12);
+    REQUIRE(out.size() == 8);
+    CHECK(matches(out.front(), 12));
+    CHECK(matches(out.back(), 19));
+
+    log.clear();
+    CHECK(log.size() == 0);
+    CHECK(log.total() == 20);
+    log.add(makeEntry(20));
+    REQUIRE(log.snapshot().size() == 1);
+    CHECK(matches(log.snapshot()[0], 20));
+}
+
+TEST_CASE("CAN log spills dropped entries to disk")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_spill.ltcl";
+
+    {
+        CanLog log(4);
+        // Entries before the spill file is set are lost once dropped
+        log.add(makeEntry(0));
+        log.add(makeEntry(1));
+        log.setSpillFile(path);
+        for (uint64_t i = 2; i < 1000; ++i)
+            log.add(makeEntry(i));
+
+        CHECK(log.size() == 4);
+        CHECK(log.firstSequence() == 2);
+        CanLogEntry entry;
+        CHECK_FALSE(log.get(1, entry));
+
+        std::vector<CanLogEntry> all = log.snapshot();
+        REQUIRE(all.size() == 998);
+        std::size_t mismatches = 0;
+        for (uint64_t i = 0; i < all.size(); ++i)
+        {
+            if (!matches(all[i], i + 2))
+                ++mismatches;
+        }
+        CHECK(mismatches == 0);
+
+        // Reads that cross from the spill file into the ring
+        std::vector<CanLogEntry> out;
+        CHECK(log.entries(990, 10, out) == 990);
+        REQUIRE(out.size() == 10);
+        CHECK(matches(out[5], 995));
+        CHECK(matches(out[9], 999));
+    }
+
+    // The file stands alone after the log is gone
+    std::vector<uint8_t> file = readFile(path);
+    REQUIRE(file.size() >= canlogfile::HeaderSize + 998 * canlogfile::RecordSize);
+    CHECK(loadLittle<uint32_t>(file.data()) == canlogfile::Magic);
+    CHECK(loadLittle<uint16_t>(file.data() + 6) == canlogfile::RecordSize);
+    CHECK(loadLittle<uint64_t>(file.data() + 8) == 998);
+    const uint8_t * last = file.data() + canlogfile::HeaderSize + 997 * canlogfile::RecordSize;
+    CHECK(loadLittle<uint64_t>(last) == 99900);
+    CHECK(loadLittle<uint32_t>(last + 8) == ((0x700 + 999 % 16) | canlogfile::OutboundFlag));
+    CHECK(last[12] == 4);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Clearing a spilling CAN log restarts the file")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_spill_clear.ltcl";
+
+    {
+        CanLog log(2);
+        log.setSpillFile(path);
+        for (uint64_t i = 0; i < 50; ++i)
+            log.add(makeEntry(i));
+        log.clear();
+        CHECK(log.snapshot().empty());
+        CHECK(log.firstSequence() == 50);
+
+        for (uint64_t i = 50; i < 60; ++i)
+            log.add(makeEntry(i));
+        std::vector<CanLogEntry> all = log.snapshot();
+        REQUIRE(all.size() == 10);
+        CHECK(matches(all.front(), 50));
+        CHECK(matches(all.back(), 59));
+    }
+
+    std::vector<uint8_t> file = readFile(path);
+    CHECK(loadLittle<uint64_t>(file.data() + 8) == 10);
+    CHECK(loadLittle<uint64_t>(file.data() + canlogfile::HeaderSize) == 5000);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("CAN log listeners see every entry once")
+{
+    CanLog log(16, std::chrono::milliseconds(1));
+    std::mutex mutex;
+    uint64_t next = 0;
+    bool contiguous = true;
+    auto connection = log.onAdd([&](uint64_t first, std::size_t count) {
+        std::lock_guard lock(mutex);
+        contiguous = contiguous && first == next;
+        next = first + count;
+    });
+
+    for (uint64_t i = 0; i < 5000; ++i)
+        log.add(makeEntry(i));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        {
+            std::lock_guard lock(mutex);
+            if (next == 5000)
+                break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    std::lock_guard lock(mutex);
+    CHECK(contiguous);
+    CHECK(next == 5000);
+}
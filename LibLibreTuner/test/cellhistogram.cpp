@@ -0,0 +1,168 @@
+#include <catch2/catch.hpp>
+
+#include <lt/analysis/cellhistogram.h>
+
+#include <random>
+
+using namespace lt;
+
+namespace
+{
+// Columns at 1000, 2000, 3000 rpm and rows at 0.5, 1.0 load
+TableLookup makeLookup()
+{
+    return TableLookup(Breakpoints({1000.0, 2000.0, 3000.0}), Breakpoints({0.5, 1.0}));
+}
+} // namespace
+
+TEST_CASE("Cell statistics merge like sequential updates")
+{
+    std::vector<double> values{1.0, 4.0, -2.0, 8.5, 3.0, 3.0, 0.25};
+    CellStats all, left, right;
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        all.add(values[i]);
+        (i < 3 ? left : right).add(values[i]);
+    }
+    left.merge(right);
+
+    CHECK(left.count == all.count);
+    CHECK(left.mean == Approx(all.mean));
+    CHECK(left.variance() == Approx(all.variance()));
+    CHECK(left.min == -2.0);
+    CHECK(left.max == 8.5);
+
+    CellStats empty;
+    empty.merge(all);
+    CHECK(empty.mean == Approx(all.mean));
+}
+
+TEST_CASE("Cell histogram bins samples")
+{
+    CellHistogram histogram(makeLookup());
+    histogram.add(2000.0, 1.0, 0.10);
+    histogram.add(2000.0, 1.0, 0.20);
+    histogram.add(2100.0, 0.95, 0.30);
+    histogram.add(1000.0, 0.5, std::numeric_limits<double>::quiet_NaN());
+
+    CHECK(histogram.samples() == 3);
+    const CellStats & cell = histogram.cell(1, 1);
+    CHECK(cell.count == 3);
+    CHECK(cell.mean == Approx(0.2));
+    CHECK(cell.variance() == Approx(0.01));
+    CHECK(cell.min == 0.1);
+    CHECK(cell.max == 0.3);
+    CHECK(histogram.cell(0, 0).count == 0);
+
+    // The off-grid sample spreads some weight to its neighbours
+    CHECK(histogram.cell(0, 1).weight > 0.0);
+    CHECK(histogram.cell(1, 2).weight > 0.0);
+    double total = 0.0;
+    for (const CellStats & stats : histogram.cells())
+        total += stats.weight;
+    CHECK(total == Approx(3.0));
+
+    SECTION("Corrections apply to cells with enough weight")
+    {
+        std::vector<double> current(6, 10.0);
+        std::vector<double> suggested = histogram.suggest(current, CellHistogram::Correction::Multiplicative, 1.0);
+        CHECK(suggested[1 * 3 + 1] > 11.0);
+        CHECK(suggested[1 * 3 + 1] < 12.0);
+        CHECK(suggested[0] == 10.0);
+
+        suggested = histogram.suggest(current, CellHistogram::Correction::Additive, 1.0);
+        CHECK(suggested[1 * 3 + 1] == Approx(10.0 + histogram.cell(1, 1).weightedMean()));
+        CHECK_THROWS(histogram.suggest(std::vector<double>(5), CellHistogram::Correction::Additive));
+    }
+}
+
+TEST_CASE("Cell histogram gives the same result in parallel")
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> rpm(500.0, 3500.0), load(0.3, 1.2), error(-0.1, 0.1);
+    const std::size_t count = 200000;
+    std::vector<double> x(count), y(count), value(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        x[i] = rpm(rng);
+        y[i] = load(rng);
+        value[i] = error(rng);
+    }
+
+    CellHistogram serial(makeLookup());
+    serial.add(x.data(), y.data(), value.data(), count);
+
+    JobPool pool(4);
+    CellHistogram parallel(makeLookup());
+    parallel.addParallel(x.data(), y.data(), value.data(), count, pool);
+
+    CHECK(parallel.samples() == count);
+    for (int row = 0; row < 2; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            const CellStats & a = serial.cell(row, column);
+            const CellStats & b = parallel.cell(row, column);
+            CHECK(a.count == b.count);
+            CHECK(a.mean == Approx(b.mean));
+            CHECK(a.variance() == Approx(b.variance()));
+            CHECK(a.weight == Approx(b.weight));
+            CHECK(a.min == b.min);
+        }
+    }
+}
+
+TEST_CASE("Cell histograms follow a data log")
+{
+    DataLog log;
+    Pid rpm{1, "RPM", "", "", "rpm"};
+    Pid load{2, "Load", "", "", ""};
+    Pid afr{3, "AFR error", "", "", ""};
+
+    for (std::size_t t = 0; t < 10; ++t)
+    {
+        log.add(rpm, PidLogEntry{2000.0, t * 10});
+        log.add(load, PidLogEntry{1.0, t * 10});
+        log.add(afr, PidLogEntry{0.05, t * 10 + 5});
+    }
+
+    CellHistogram recorded = CellHistogram::fromLog(log, makeLookup(), rpm.code, load.code, afr.code);
+    // The last AFR entry is after the last operating point
+    CHECK(recorded.samples() == 9);
+    CHECK(recorded.cell(1, 1).mean == Approx(0.05));
+    CHECK_THROWS(CellHistogram::fromLog(log, makeLookup(), rpm.code, load.code, 99));
+
+    LiveCellHistogram live(log, makeLookup(), rpm.code, load.code, afr.code);
+    int updates = 0;
+    auto connection = live.onUpdate([&updates]() { ++updates; });
+    CHECK(live.snapshot().samples() == 9);
+
+    // The last AFR entry waits for both operating point PIDs
+    log.add(rpm, PidLogEntry{1000.0, 200});
+    CHECK(live.snapshot().samples() == 9);
+    log.add(load, PidLogEntry{0.5, 200});
+    CHECK(updates == 1);
+    CHECK(live.snapshot().samples() == 10);
+
+    log.add(afr, PidLogEntry{-0.1, 205});
+    log.add(afr, PidLogEntry{-0.2, 215});
+    CHECK(live.snapshot().samples() == 10);
+    log.add(rpm, PidLogEntry{1000.0, 220});
+    log.add(load, PidLogEntry{0.5, 220});
+
+    CellHistogram current = live.snapshot();
+    CHECK(updates == 2);
+    CHECK(current.samples() == 12);
+    CHECK(current.cell(0, 0).count == 2);
+    CHECK(current.cell(0, 0).mean == Approx(-0.15));
+
+    // Live samples are interpolated like the ones binned from the log
+    CellHistogram all = CellHistogram::fromLog(log, makeLookup(), rpm.code, load.code, afr.code);
+    CHECK(all.samples() == current.samples());
+    for (std::size_t i = 0; i < all.cells().size(); ++i)
+    {
+        CHECK(all.cells()[i].count == current.cells()[i].count);
+        CHECK(all.cells()[i].weight == Approx(current.cells()[i].weight));
+        CHECK(all.cells()[i].weightedSum == Approx(current.cells()[i].weightedSum));
+    }
+}
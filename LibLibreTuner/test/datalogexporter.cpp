@@ -0,0 +1,257 @@
+#include <catch2/catch.hpp>
+
+#include <lt/datalog/datalogexporter.h>
+#include <lt/support/bytestream.h>
+#include <lt/support/crc32.h>
+#include <lt/support/job.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+using namespace lt;
+
+namespace
+{
+const Pid rpm{1, "RPM", "", "", "rpm"};
+const Pid load{2, "Load, relative", "", "", ""};
+
+std::string readFile(const std::filesystem::path & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+std::vector<std::string> lines(const std::string & text)
+{
+    std::vector<std::string> out;
+    std::istringstream stream(text);
+    for (std::string line; std::getline(stream, line);)
+        out.push_back(line);
+    return out;
+}
+
+struct NpzMember
+{
+    std::string name;
+    std::vector<double> values;
+};
+
+// Reads the members of a stored zip through the central directory and
+// checks each against its CRC
+std::vector<NpzMember> readNpz(const std::string & file)
+{
+    auto data = reinterpret_cast<const uint8_t *>(file.data());
+    ByteReader end(data + file.size() - 22, data + file.size());
+    REQUIRE(end.read<uint32_t>() == 0x06054B50);
+    end.take(6);
+    auto count = end.read<uint16_t>();
+    end.take(4);
+    auto directory = end.read<uint32_t>();
+
+    std::vector<NpzMember> members;
+    ByteReader reader(data + directory, data + file.size());
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        REQUIRE(reader.read<uint32_t>() == 0x02014B50);
+        reader.take(6);
+        REQUIRE(reader.read<uint16_t>() == 0);
+        reader.take(4);
+        auto crc = reader.read<uint32_t>();
+        auto size = reader.read<uint32_t>();
+        REQUIRE(reader.read<uint32_t>() == size);
+        auto nameSize = reader.read<uint16_t>();
+        reader.take(12);
+        auto offset = reader.read<uint32_t>();
+        std::string name(reinterpret_cast<const char *>(reader.take(nameSize)), nameSize);
+
+        ByteReader local(data + offset, data + directory);
+        REQUIRE(local.read<uint32_t>() == 0x04034B50);
+        local.take(22);
+        auto localNameSize = local.read<uint16_t>();
+        local.take(2u + localNameSize);
+        const uint8_t * contents = local.take(size);
+        CHECK(crc32(contents, size) == crc);
+
+        // .npy header: magic, version, header length, dict
+        REQUIRE(std::string(reinterpret_cast<const char *>(contents), 6) == "\x93NUMPY");
+        std::size_t headerSize = 10 + (contents[8] | (contents[9] << 8));
+        CHECK(headerSize % 64 == 0);
+        std::string dict(reinterpret_cast<const char *>(contents) + 10, headerSize - 10);
+        CHECK(dict.find("'descr': '<f8'") != std::string::npos);
+
+        NpzMember member{name, std::vector<double>((size - headerSize) / sizeof(double))};
+        std::memcpy(member.values.data(), contents + headerSize, member.values.size() * sizeof(double));
+        CHECK(dict.find("'shape': (" + std::to_string(member.values.size()) + ",)") != std::string::npos);
+        members.push_back(std::move(member));
+    }
+    return members;
+}
+} // namespace
+
+TEST_CASE("Exporter resamples channels onto a common grid")
+{
+    DataLog log;
+    log.add(rpm, PidLogEntry{1000.0, 0});
+    log.add(rpm, PidLogEntry{2000.0, 100});
+    log.add(rpm, PidLogEntry{4000.0, 300});
+    log.add(load, PidLogEntry{0.5, 150});
+    log.add(load, PidLogEntry{1.0, 250});
+
+    SECTION("Hold last")
+    {
+        DataLogExporter exporter(log, ExportOptions{50});
+        REQUIRE(exporter.rows() == 7);
+        REQUIRE(exporter.columns() == 2);
+        CHECK(exporter.times() == std::vector<std::size_t>{0, 50, 100, 150, 200, 250, 300});
+        CHECK(exporter.column(0) == std::vector<double>{1000, 1000, 2000, 2000, 2000, 2000, 4000});
+        // Rows before the first sample are empty
+        CHECK(std::isnan(exporter.column(1)[2]));
+        CHECK(exporter.column(1)[3] == 0.5);
+        CHECK(exporter.column(1)[6] == 1.0);
+    }
+
+    SECTION("Linear")
+    {
+        DataLogExporter exporter(log, ExportOptions{50, Resampling::Linear});
+        CHECK(exporter.column(0) == std::vector<double>{1000, 1500, 2000, 2500, 3000, 3500, 4000});
+        CHECK(exporter.column(1)[4] == Approx(0.75));
+        // Past the last sample the value is held
+        CHECK(exporter.column(1)[6] == 1.0);
+    }
+
+    SECTION("Window and PID selection")
+    {
+        ExportOptions options{100};
+        options.begin = 90;
+        options.end = 250;
+        options.pids = {1, 2};
+        DataLogExporter exporter(log, options);
+        CHECK(exporter.times() == std::vector<std::size_t>{90, 190});
+        CHECK(exporter.column(0) == std::vector<double>{1000, 2000});
+        CHECK(std::isnan(exporter.column(1)[0]));
+        CHECK(exporter.column(1)[1] == 0.5);
+
+        // The grid starts at the first sample of the selected channels
+        options.pids = {2};
+        DataLogExporter single(log, options);
+        REQUIRE(single.columns() == 1);
+        CHECK(single.times() == std::vector<std::size_t>{150, 250});
+    }
+}
+
+TEST_CASE("Exporter writes CSV")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_export.csv";
+
+    SECTION("Header and empty cells")
+    {
+        DataLog log;
+        log.add(rpm, PidLogEntry{1000.0, 0});
+        log.add(load, PidLogEntry{0.25, 1000});
+        DataLogExporter(log, ExportOptions{500}).writeCsv(path);
+
+        CHECK(lines(readFile(path)) ==
+              std::vector<std::string>{"time,RPM (rpm),\"Load, relative\"", "0.000,1000,", "0.500,1000,",
+                                       "1.000,1000,0.25"});
+    }
+
+    SECTION("Rows formatted in parallel blocks stay in order")
+    {
+        // Several blocks per batch on any pool size
+        DataLog log;
+        for (std::size_t i = 0; i < 200000; ++i)
+            log.add(rpm, PidLogEntry{static_cast<double>(i % 10000), i * 10});
+        ExportOptions options{10};
+        options.threads = 3;
+        DataLogExporter(log, options).writeCsv(path);
+
+        std::vector<std::string> rows = lines(readFile(path));
+        REQUIRE(rows.size() == 200001);
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < 200000; ++i)
+        {
+            std::ostringstream expected;
+            expected << i / 100 << '.' << std::setw(3) << std::setfill('0') << (i % 100) * 10 << ',' << i % 10000;
+            if (rows[i + 1] != expected.str())
+                ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Exports report progress and stop when canceled")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_export_job.csv";
+    DataLog log;
+    for (std::size_t i = 0; i < 200000; ++i)
+        log.add(rpm, PidLogEntry{static_cast<double>(i), i * 10});
+    DataLogExporter exporter(log, ExportOptions{10});
+
+    SECTION("Progress increases to 1")
+    {
+        auto job = std::make_shared<Job>();
+        std::vector<double> progress;
+        auto connection = job->onProgress([&](double value) { progress.push_back(value); });
+        bool finished = false;
+        job->run([&](JobControl control) { finished = exporter.writeCsv(path, &control); });
+        job->wait();
+        CHECK(finished);
+        REQUIRE(progress.size() > 1);
+        CHECK(std::is_sorted(progress.begin(), progress.end()));
+        CHECK(progress.back() == 1.0);
+        CHECK(lines(readFile(path)).size() == 200001);
+    }
+
+    SECTION("Canceled exports remove the partial file")
+    {
+        for (bool npz : {false, true})
+        {
+            auto job = std::make_shared<Job>();
+            job->cancel();
+            bool finished = true;
+            job->run([&](JobControl control) {
+                finished = npz ? exporter.writeNpz(path, &control) : exporter.writeCsv(path, &control);
+            });
+            job->wait();
+            CHECK_FALSE(finished);
+            CHECK_FALSE(std::filesystem::exists(path));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Exporter writes NumPy archives")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_export.npz";
+    DataLog log;
+    log.add(rpm, PidLogEntry{1000.0, 0});
+    log.add(rpm, PidLogEntry{3000.0, 200});
+    log.add(load, PidLogEntry{0.5, 100});
+    // Same name as another PID and a character that is not allowed in names
+    log.add(Pid{3, "RPM", "", "", ""}, PidLogEntry{7.0, 0});
+    log.add(Pid{4, "", "", "", ""}, PidLogEntry{8.0, 0});
+    log.add(Pid{5, "A/B", "", "", ""}, PidLogEntry{9.0, 0});
+    DataLogExporter(log, ExportOptions{100, Resampling::Linear}).writeNpz(path);
+
+    std::vector<NpzMember> members = readNpz(readFile(path));
+    REQUIRE(members.size() == 6);
+    CHECK(members[0].name == "time.npy");
+    CHECK(members[0].values == std::vector<double>{0.0, 0.1, 0.2});
+    CHECK(members[1].name == "RPM.npy");
+    CHECK(members[1].values == std::vector<double>{1000, 2000, 3000});
+    CHECK(members[2].name == "Load, relative.npy");
+    CHECK(std::isnan(members[2].values[0]));
+    CHECK(members[2].values[2] == 0.5);
+    CHECK(members[3].name == "RPM_3.npy");
+    CHECK(members[4].name == "pid_4.npy");
+    CHECK(members[5].name == "A_B.npy");
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,202 @@
+#include <catch2/catch.hpp>
+
+#include <lt/datalog/datalogfile.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace lt;
+
+namespace
+{
+const Pid rpm{1, "RPM", "Engine speed", "", "rpm"};
+const Pid load{2, "Load", "", "", ""};
+
+// 500 entries of each PID, 10 ms apart
+void fillLog(DataLog & log)
+{
+    log.setName("Test drive");
+    for (std::size_t i = 0; i < 500; ++i)
+    {
+        log.add(rpm, PidLogEntry{1000.0 + static_cast<double>(i), i * 10});
+        log.add(load, PidLogEntry{static_cast<double>(i) / 500.0, i * 10 + 5});
+    }
+}
+
+std::size_t countEntries(const DataLog & log)
+{
+    std::size_t count = 0;
+    for (const auto & [code, pidLog] : log.logs())
+        count += pidLog.entries.size();
+    return count;
+}
+
+void corrupt(const std::filesystem::path & path, std::size_t offset)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekg(static_cast<std::streamoff>(offset));
+    char byte = 0;
+    file.read(&byte, 1);
+    byte = static_cast<char>(byte ^ 0x40);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(&byte, 1);
+}
+} // namespace
+
+TEST_CASE("Datalog files round trip")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_roundtrip.ltl";
+    DataLog log;
+    fillLog(log);
+    DataLogWriter::save(log, path, 64);
+
+    DataLogReader reader(path);
+    CHECK_FALSE(reader.recovered());
+    CHECK(reader.name() == "Test drive");
+    REQUIRE(reader.pids().size() == 2);
+    CHECK(reader.pid(1)->description == "Engine speed");
+    CHECK(reader.chunkCount() == (1000 + 63) / 64);
+    CHECK(reader.beginTime() == 0);
+    CHECK(reader.endTime() == 4995);
+
+    DataLog read;
+    reader.readInto(read);
+    REQUIRE(countEntries(read) == 1000);
+    const PidLog * readRpm = read.pidLog(rpm);
+    REQUIRE(readRpm != nullptr);
+    CHECK(readRpm->entries[123].time == 1230);
+    CHECK(readRpm->entries[123].value == 1123.0);
+
+    SECTION("Index lookup only visits overlapping chunks")
+    {
+        auto [first, last] = reader.chunksInRange(2000, 2100);
+        CHECK(last - first <= 2);
+        for (std::size_t i = first; i < last; ++i)
+        {
+            CHECK(reader.chunk(i).timeEnd >= 2000);
+            CHECK(reader.chunk(i).timeBegin <= 2100);
+        }
+
+        std::size_t count = 0;
+        reader.forEach(2000, 2100, [&](const Pid &, const PidLogEntry & entry) {
+            CHECK(entry.time >= 2000);
+            CHECK(entry.time <= 2100);
+            ++count;
+        });
+        // 2000..2100 holds 11 RPM and 10 load entries
+        CHECK(count == 21);
+
+        auto [none, end] = reader.chunksInRange(6000, 7000);
+        CHECK(none == end);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Datalogs whose writer died are recovered")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_recover.ltl";
+    DataLog log;
+    fillLog(log);
+    DataLogWriter::save(log, path, 100);
+    std::size_t chunks = DataLogReader(path).chunkCount();
+    std::size_t lastChunk = DataLogReader(path).chunk(chunks - 1).offset;
+
+    // Cut through the last chunk and drop the index
+    std::filesystem::resize_file(path, lastChunk + 40);
+
+    {
+        DataLogReader reader(path);
+        CHECK(reader.recovered());
+        CHECK(reader.chunkCount() == chunks - 1);
+        CHECK(reader.validSize() == lastChunk);
+    }
+
+    CHECK(DataLogReader::recover(path));
+    CHECK(std::filesystem::file_size(path) > lastChunk);
+    CHECK_FALSE(DataLogReader::recover(path));
+
+    DataLogReader reader(path);
+    CHECK_FALSE(reader.recovered());
+    DataLog read;
+    reader.readInto(read);
+    CHECK(countEntries(read) == 900);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Damaged datalog data is rejected")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_crc.ltl";
+    DataLog log;
+    fillLog(log);
+    DataLogWriter::save(log, path, 100);
+    std::size_t size = std::filesystem::file_size(path);
+    std::size_t secondChunk = DataLogReader(path).chunk(1).offset;
+
+    SECTION("A damaged index is rebuilt")
+    {
+        corrupt(path, size - datalogfile::TrailerSize - 3);
+        DataLogReader reader(path);
+        CHECK(reader.recovered());
+        CHECK(reader.chunkCount() == 10);
+    }
+
+    SECTION("Scanning stops at a chunk with a bad CRC")
+    {
+        corrupt(path, size - datalogfile::TrailerSize - 3);
+        corrupt(path, secondChunk + datalogfile::ChunkHeaderSize + 10);
+        DataLogReader reader(path);
+        CHECK(reader.recovered());
+        CHECK(reader.chunkCount() == 1);
+        CHECK(reader.validSize() == secondChunk);
+    }
+
+    SECTION("Trailer values that overflow are rejected")
+    {
+        // An index offset and count whose sum wraps around to the file size
+        std::vector<uint8_t> trailer;
+        ByteWriter writer(trailer);
+        writer.write(datalogfile::TrailerMagic);
+        writer.write(static_cast<uint32_t>(0x08000000));
+        writer.write(std::numeric_limits<uint64_t>::max() - 0x08000000ull * datalogfile::IndexEntrySize -
+                     datalogfile::TrailerSize + size + 1);
+        writer.write(static_cast<uint32_t>(0));
+        writer.write(static_cast<uint32_t>(0));
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(size - datalogfile::TrailerSize));
+            file.write(reinterpret_cast<const char *>(trailer.data()), trailer.size());
+        }
+
+        DataLogReader reader(path);
+        CHECK(reader.recovered());
+        CHECK(reader.chunkCount() == 10);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Datalog writers stream attached logs")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_stream.ltl";
+    DataLog log;
+    log.addPid(rpm);
+    {
+        DataLogWriter writer(path, "Stream", {rpm}, 16);
+        writer.attach(log);
+        for (std::size_t i = 0; i < 100; ++i)
+            log.add(rpm, PidLogEntry{static_cast<double>(i), i});
+        writer.close();
+        CHECK(writer.error().empty());
+
+        // Entries after closing are not written and do not throw
+        log.add(rpm, PidLogEntry{0.0, 200});
+    }
+
+    DataLog read;
+    DataLogReader(path).readInto(read);
+    CHECK(countEntries(read) == 100);
+
+    std::filesystem::remove(path);
+}
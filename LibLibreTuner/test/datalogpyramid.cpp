@@ -0,0 +1,140 @@
+#include <catch2/catch.hpp>
+
+#include <lt/datalog/datalog.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace lt;
+
+namespace
+{
+// Random walk with irregular sample spacing
+std::vector<PidLogEntry> randomEntries(std::size_t count, std::mt19937 & rng)
+{
+    std::uniform_real_distribution<double> step(-1.0, 1.0);
+    std::uniform_int_distribution<std::size_t> gap(1, 20);
+    std::vector<PidLogEntry> entries;
+    double value = 0.0;
+    std::size_t time = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        value += step(rng);
+        time += gap(rng);
+        entries.push_back(PidLogEntry{value, time});
+    }
+    return entries;
+}
+
+std::pair<double, double> bruteMinMax(const std::vector<PidLogEntry> & entries, std::size_t begin, std::size_t end)
+{
+    auto [min, max] = std::minmax_element(entries.begin() + begin, entries.begin() + end,
+                                          [](const auto & a, const auto & b) { return a.value < b.value; });
+    return {min->value, max->value};
+}
+} // namespace
+
+TEST_CASE("Pyramid buckets match the samples they cover")
+{
+    std::mt19937 rng(1234);
+    // Not a multiple of the bucket size, so every level has a partial bucket
+    std::vector<PidLogEntry> entries = randomEntries(5000, rng);
+    DataLogPyramid pyramid;
+    for (const PidLogEntry & entry : entries)
+        pyramid.add(entry);
+
+    REQUIRE(pyramid.levels() > 5);
+    for (std::size_t l = 0; l < pyramid.levels(); ++l)
+    {
+        std::size_t size = DataLogPyramid::BaseBucketSize << l;
+        const std::vector<DataLogBucket> & level = pyramid.level(l);
+        REQUIRE(level.size() == (entries.size() + size - 1) / size);
+        for (std::size_t b = 0; b < level.size(); ++b)
+        {
+            CAPTURE(l, b);
+            std::size_t begin = b * size;
+            std::size_t end = std::min(begin + size, entries.size());
+            auto [min, max] = bruteMinMax(entries, begin, end);
+            const DataLogBucket & bucket = level[b];
+            CHECK(bucket.min == min);
+            CHECK(bucket.max == max);
+            CHECK(bucket.first == entries[begin].value);
+            CHECK(bucket.last == entries[end - 1].value);
+            CHECK(bucket.timeBegin == entries[begin].time);
+            CHECK(bucket.timeEnd == entries[end - 1].time);
+        }
+    }
+}
+
+TEST_CASE("Pyramid queries keep the extremes of random windows")
+{
+    std::mt19937 rng(99);
+    std::vector<PidLogEntry> entries = randomEntries(20000, rng);
+    DataLogPyramid pyramid;
+    for (const PidLogEntry & entry : entries)
+        pyramid.add(entry);
+
+    std::size_t lastTime = entries.back().time;
+    std::uniform_int_distribution<std::size_t> time(0, lastTime);
+    std::uniform_int_distribution<std::size_t> buckets(1, 300);
+    auto byTime = [](const PidLogEntry & entry, std::size_t t) { return entry.time < t; };
+    for (int i = 0; i < 500; ++i)
+    {
+        std::size_t begin = time(rng);
+        std::size_t end = time(rng);
+        if (begin > end)
+            std::swap(begin, end);
+        std::size_t maxBuckets = buckets(rng);
+        CAPTURE(begin, end, maxBuckets);
+
+        std::vector<PidLogEntry> out;
+        pyramid.query(entries, begin, end, maxBuckets, out);
+
+        std::size_t first = std::lower_bound(entries.begin(), entries.end(), begin, byTime) - entries.begin();
+        std::size_t last = std::lower_bound(entries.begin(), entries.end(), end + 1, byTime) - entries.begin();
+        if (first == last)
+            continue;
+        REQUIRE_FALSE(out.empty());
+
+        // Every sample in the window is inside the range drawn for it
+        auto [min, max] = bruteMinMax(entries, first, last);
+        auto [outMin, outMax] = bruteMinMax(out, 0, out.size());
+        CHECK(outMin <= min);
+        CHECK(outMax >= max);
+
+        // Points are in time order and reach the window edges
+        CHECK(std::is_sorted(out.begin(), out.end(),
+                             [](const auto & a, const auto & b) { return a.time < b.time; }));
+        CHECK(out.front().time <= entries[first].time);
+        CHECK(out.back().time >= entries[last - 1].time);
+
+        // Summaries stay within the budget, plus a bucket at each edge
+        if (last - first > maxBuckets * 2 + 2)
+            CHECK(out.size() <= (maxBuckets + 2) * 4);
+    }
+}
+
+TEST_CASE("Datalogs accept new PIDs from several threads")
+{
+    DataLog log;
+    std::vector<std::thread> threads;
+    for (uint16_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&log, t]() {
+            // Every thread adds the same PIDs, so first entries race
+            for (std::size_t i = 0; i < 2000; ++i)
+                log.add(Pid{static_cast<uint16_t>(i % 50), "", "", "", ""}, PidLogEntry{1.0, i});
+        });
+    }
+    for (std::thread & thread : threads)
+        thread.join();
+
+    REQUIRE(log.logs().size() == 50);
+    for (const auto & [code, pidLog] : log.logs())
+    {
+        CHECK(pidLog.entries.size() == 4 * 40);
+        CHECK(pidLog.pyramid.level(0).size() == (4 * 40 + DataLogPyramid::BaseBucketSize - 1) /
+                                                      DataLogPyramid::BaseBucketSize);
+    }
+}
@@ -0,0 +1,166 @@
+#include <catch2/catch.hpp>
+
+#include <lt/buffer/memorybuffer.h>
+#include <lt/buffer/view.h>
+#include <lt/rom/edithistory.h>
+
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+MemoryBuffer makeBuffer(EditHistory & history, int size)
+{
+    MemoryBuffer buffer(std::vector<uint8_t>(static_cast<std::size_t>(size), 0));
+    buffer.setWriteObserver([&history](int offset, const uint8_t * before, const uint8_t * after, int size) {
+        history.record(offset, before, after, size);
+    });
+    return buffer;
+}
+} // namespace
+
+TEST_CASE("Edit history undoes and redoes single edits")
+{
+    EditHistory history;
+    MemoryBuffer buffer = makeBuffer(history, 64);
+    View view = buffer.view();
+
+    view.set<uint16_t, Endianness::Big>(0x1234, 4);
+    view.set<uint16_t, Endianness::Big>(0x5678, 4);
+    CHECK(history.size() == 2);
+    CHECK(history.canUndo());
+    CHECK_FALSE(history.canRedo());
+
+    REQUIRE(history.undo(buffer));
+    CHECK(view.get<uint16_t, Endianness::Big>(4) == 0x1234);
+    REQUIRE(history.undo(buffer));
+    CHECK(view.get<uint16_t, Endianness::Big>(4) == 0);
+    CHECK_FALSE(history.undo(buffer));
+
+    REQUIRE(history.redo(buffer));
+    CHECK(view.get<uint16_t, Endianness::Big>(4) == 0x1234);
+    // Undo and redo are not recorded
+    CHECK(history.size() == 2);
+
+    SECTION("A new edit forgets undone steps")
+    {
+        view.set<uint8_t, Endianness::Big>(9, 0);
+        CHECK(history.size() == 2);
+        CHECK_FALSE(history.canRedo());
+        REQUIRE(history.undo(buffer));
+        REQUIRE(history.undo(buffer));
+        CHECK(view.get<uint16_t, Endianness::Big>(4) == 0);
+        CHECK(view.get<uint8_t, Endianness::Big>(0) == 0);
+    }
+}
+
+TEST_CASE("Edit history coalesces bulk edits")
+{
+    EditHistory history;
+    MemoryBuffer buffer = makeBuffer(history, 32 * 32 * 4 + 16);
+    View view = buffer.view(16, 32 * 32 * 4);
+
+    {
+        EditHistory::Group group(history, "Scale");
+        {
+            // Nested groups join the outer step
+            EditHistory::Group inner(history, "Inner");
+            for (int i = 0; i < 32 * 32; ++i)
+                view.set<float, Endianness::Big>(static_cast<float>(i) * 1.5f, i * 4);
+        }
+        CHECK_FALSE(history.canUndo());
+    }
+
+    CHECK(history.size() == 1);
+    CHECK(history.undoLabel() == "Scale");
+    // Adjacent writes share one range, so the step costs as much as one
+    // write of the whole table
+    EditHistory single;
+    std::vector<uint8_t> table(32 * 32 * 4);
+    single.record(16, table.data(), table.data(), 32 * 32 * 4);
+    CHECK(history.memoryUsage() == single.memoryUsage());
+    CHECK(history.memoryUsage() >= 2 * 32 * 32 * 4);
+
+    REQUIRE(history.undo(buffer));
+    for (int i = 0; i < 32 * 32; ++i)
+        REQUIRE(view.get<float, Endianness::Big>(i * 4) == 0.0f);
+    CHECK(history.redoLabel() == "Scale");
+
+    REQUIRE(history.redo(buffer));
+    for (int i = 0; i < 32 * 32; ++i)
+        REQUIRE(view.get<float, Endianness::Big>(i * 4) == static_cast<float>(i) * 1.5f);
+
+    SECTION("Overlapping writes in a step are undone in order")
+    {
+        {
+            EditHistory::Group group(history, "Twice");
+            view.set<float, Endianness::Big>(1.0f, 0);
+            view.set<float, Endianness::Big>(2.0f, 8);
+            view.set<float, Endianness::Big>(3.0f, 0);
+        }
+        REQUIRE(history.undo(buffer));
+        CHECK(view.get<float, Endianness::Big>(0) == 0.0f);
+        CHECK(view.get<float, Endianness::Big>(8) == 3.0f);
+    }
+
+    SECTION("Empty groups add no step")
+    {
+        {
+            EditHistory::Group group(history, "Nothing");
+        }
+        CHECK(history.size() == 1);
+    }
+}
+
+TEST_CASE("Edit history keeps to its memory budget")
+{
+    EditHistory history(1024);
+    MemoryBuffer buffer = makeBuffer(history, 256);
+    View view = buffer.view();
+
+    for (int i = 0; i < 200; ++i)
+    {
+        EditHistory::Group group(history, std::to_string(i));
+        for (int j = 0; j < 8; ++j)
+            view.set<uint8_t, Endianness::Big>(static_cast<uint8_t>(i + 1), j);
+    }
+
+    CHECK(history.memoryUsage() <= history.budget());
+    CHECK(history.size() < 200);
+    CHECK(history.undoLabel() == "199");
+
+    // The remaining steps undo to the state before the oldest kept step
+    std::size_t steps = history.size();
+    while (history.undo(buffer))
+        ;
+    CHECK(view.get<uint8_t, Endianness::Big>(0) == static_cast<uint8_t>(200 - steps));
+
+    SECTION("Step and range records count toward the budget")
+    {
+        EditHistory tiny(4096);
+        MemoryBuffer data = makeBuffer(tiny, 256);
+        View bytes = data.view();
+        for (int i = 0; i < 10000; ++i)
+            bytes.set<uint8_t, Endianness::Big>(static_cast<uint8_t>(i), i % 256);
+
+        CHECK(tiny.memoryUsage() <= tiny.budget());
+        // Each step holds two bytes of contents, but far fewer than
+        // budget / 2 steps fit once their records are counted
+        CHECK(tiny.size() < tiny.budget() / 16);
+        CHECK(tiny.undoLabel().empty());
+        REQUIRE(tiny.undo(data));
+        CHECK(bytes.get<uint8_t, Endianness::Big>(9999 % 256) == static_cast<uint8_t>(9999 - 256));
+    }
+
+    SECTION("A step larger than the budget is kept")
+    {
+        EditHistory small(16);
+        MemoryBuffer data = makeBuffer(small, 64);
+        std::vector<uint8_t> ones(64, 1);
+        data.write(0, ones.data(), 64);
+        CHECK(small.size() == 1);
+        REQUIRE(small.undo(data));
+        CHECK(data[63] == 0);
+    }
+}
@@ -0,0 +1,221 @@
+#include <catch2/catch.hpp>
+
+#include <lt/support/event.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace lt;
+
+TEST_CASE("Events call connected listeners")
+{
+    Event<int> event;
+    int sum = 0;
+    auto a = event.connect([&sum](int value) { sum += value; });
+    auto b = event.connect([&sum](int value) { sum += value * 10; });
+    event(1);
+    CHECK(sum == 11);
+    CHECK(event.listeners() == 2);
+
+    a->disconnect();
+    event(1);
+    CHECK(sum == 21);
+
+    // Destroying the connection disconnects it
+    b.reset();
+    event(1);
+    CHECK(sum == 21);
+    CHECK(event.listeners() == 0);
+}
+
+TEST_CASE("Stale connections do not remove reused slots")
+{
+    Event<int> event;
+    int calls = 0;
+    auto first = event.connect([](int) {});
+    first->disconnect();
+    // Reuses the slot index of the first connection
+    auto second = event.connect([&calls](int) { ++calls; });
+    first->disconnect();
+    first.reset();
+    event(0);
+    CHECK(calls == 1);
+}
+
+TEST_CASE("Listeners can connect and disconnect during dispatch")
+{
+    Event<int> event;
+    int calls = 0;
+    Event<int>::ConnectionPtr self;
+    Event<int>::ConnectionPtr other;
+    Event<int>::ConnectionPtr added;
+
+    self = event.connect([&](int) {
+        ++calls;
+        // Disconnects itself and a listener that has not run yet
+        self->disconnect();
+        other.reset();
+        added = event.connect([&calls](int) { calls += 100; });
+    });
+    other = event.connect([&calls](int) { calls += 10; });
+
+    // The dispatch in progress keeps the list it started with
+    event(0);
+    CHECK(calls == 11);
+    CHECK(event.listeners() == 1);
+
+    event(0);
+    CHECK(calls == 111);
+}
+
+TEST_CASE("Listener lists replaced during dispatch are freed")
+{
+    Event<int> event;
+    auto token = std::make_shared<int>(0);
+    // Every list holds a copy of the listener and with it the token
+    auto holder = event.connect([token](int) {});
+    CHECK(token.use_count() == 2);
+
+    std::vector<Event<int>::ConnectionPtr> connections;
+    auto churn = event.connect([&](int) {
+        for (int i = 0; i < 20; ++i)
+            connections.push_back(event.connect([](int) {}));
+        connections.clear();
+    });
+
+    for (int i = 0; i < 50; ++i)
+        event(0);
+    // The lists replaced inside each dispatch are freed when it returns
+    CHECK(token.use_count() == 2);
+}
+
+TEST_CASE("Events dispatch from several threads")
+{
+    Event<int> event;
+    std::atomic<int> sum{0};
+    auto a = event.connect([&sum](int value) { sum += value; });
+    auto b = event.connect([&sum](int value) { sum += value; });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&event]() {
+            for (int i = 0; i < 10000; ++i)
+                event(1);
+        });
+    }
+    for (std::thread & thread : threads)
+        thread.join();
+    CHECK(sum == 4 * 10000 * 2);
+}
+
+TEST_CASE("Listener lists are freed while dispatches keep overlapping")
+{
+    // Two threads take turns dispatching, and each enters before the other
+    // leaves, so the event always has a reader
+    Event<int> event;
+    auto token = std::make_shared<int>(0);
+    auto holder = event.connect([token](int) {});
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool start[2]{}, inside[2]{}, release[2]{}, stop = false;
+    auto relay = event.connect([&](int who) {
+        if (who < 0)
+            return;
+        std::unique_lock lock(mutex);
+        inside[who] = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return release[who]; });
+        release[who] = false;
+    });
+
+    std::thread threads[2];
+    for (int who = 0; who < 2; ++who)
+    {
+        threads[who] = std::thread([&, who]() {
+            std::unique_lock lock(mutex);
+            while (true)
+            {
+                cv.wait(lock, [&]() { return start[who] || stop; });
+                if (stop)
+                    return;
+                start[who] = false;
+                lock.unlock();
+                event(who);
+                lock.lock();
+                inside[who] = false;
+                cv.notify_all();
+            }
+        });
+    }
+
+    auto enter = [&](int who) {
+        std::unique_lock lock(mutex);
+        start[who] = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return inside[who]; });
+    };
+    auto leave = [&](int who) {
+        std::unique_lock lock(mutex);
+        release[who] = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return !inside[who]; });
+    };
+
+    long maxLists = 0;
+    enter(0);
+    for (int i = 0; i < 500; ++i)
+    {
+        enter((i + 1) % 2);
+        leave(i % 2);
+        auto connection = event.connect([](int) {});
+        connection->disconnect();
+        maxLists = std::max<long>(maxLists, token.use_count() - 1);
+    }
+    leave(500 % 2);
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+        cv.notify_all();
+    }
+    for (std::thread & thread : threads)
+        thread.join();
+
+    // 1000 lists were replaced. Besides the current list, only those
+    // retired in the last two epochs are kept.
+    CHECK(maxLists <= 6);
+    event(-1);
+    CHECK(token.use_count() == 2);
+}
+
+TEST_CASE("Connecting while other threads dispatch frees replaced lists")
+{
+    Event<int> event;
+    auto token = std::make_shared<int>(0);
+    auto holder = event.connect([token](int) {});
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t)
+    {
+        threads.emplace_back([&]() {
+            while (!stop)
+                event(0);
+        });
+    }
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto connection = event.connect([](int) {});
+        connection->disconnect();
+    }
+    stop = true;
+    for (std::thread & thread : threads)
+        thread.join();
+
+    event(0);
+    CHECK(token.use_count() == 2);
+}
@@ -0,0 +1,255 @@
+// Fake J2534 (PassThru) library for tests. Emulates a device with an ECU
+// that answers every message:
+//  - CAN: echoes each frame back from ID + 8
+//  - ISO15765: answers with a positive response (SID + 0x40) carrying the
+//    rest of the request, from ID + 8
+// Test hooks at the bottom expose call counts and channel configuration.
+
+#include <j2534/j2534.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#ifdef WIN32
+#define FAKE_EXPORT extern "C" __declspec(dllexport)
+#else
+#define FAKE_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+using lt::j2534::PASSTHRU_MSG;
+using lt::j2534::SCONFIG_LIST;
+
+namespace
+{
+constexpr long ERR_INVALID_CHANNEL_ID = 0x02;
+constexpr long ERR_NOT_SUPPORTED = 0x01;
+
+struct Channel
+{
+    uint32_t protocol;
+    std::deque<PASSTHRU_MSG> rx;
+    std::map<uint32_t, uint32_t> config;
+};
+
+std::mutex mutex;
+std::condition_variable received;
+std::map<uint32_t, Channel> channels;
+uint32_t nextChannel = 1;
+uint32_t readCalls = 0;
+uint32_t writeCalls = 0;
+const char * lastError = "";
+
+uint32_t messageId(const PASSTHRU_MSG & msg)
+{
+    return (msg.Data[0] << 24U) | (msg.Data[1] << 16U) | (msg.Data[2] << 8U) | msg.Data[3];
+}
+
+void setMessageId(PASSTHRU_MSG & msg, uint32_t id)
+{
+    msg.Data[0] = static_cast<unsigned char>(id >> 24U);
+    msg.Data[1] = static_cast<unsigned char>(id >> 16U);
+    msg.Data[2] = static_cast<unsigned char>(id >> 8U);
+    msg.Data[3] = static_cast<unsigned char>(id);
+}
+
+// Queues the ECU's answer to `msg`. Requires mutex.
+void respond(Channel & channel, const PASSTHRU_MSG & msg)
+{
+    PASSTHRU_MSG response{};
+    response.ProtocolID = channel.protocol;
+    setMessageId(response, messageId(msg) + 8);
+
+    if (channel.protocol == static_cast<uint32_t>(lt::j2534::Protocol::ISO15765))
+    {
+        // Transmit confirmation
+        PASSTHRU_MSG done = msg;
+        done.RxStatus = TX_MSG_TYPE;
+        done.DataSize = 4;
+        channel.rx.push_back(done);
+
+        if (msg.DataSize <= 4)
+            return;
+        std::memcpy(response.Data + 4, msg.Data + 4, msg.DataSize - 4);
+        response.Data[4] = static_cast<unsigned char>(msg.Data[4] + 0x40);
+        response.DataSize = msg.DataSize;
+
+        if (response.DataSize - 4 > 7)
+        {
+            // Multi-frame responses are announced with their first frame
+            PASSTHRU_MSG first{};
+            first.ProtocolID = channel.protocol;
+            first.RxStatus = START_OF_MESSAGE;
+            setMessageId(first, messageId(response));
+            first.DataSize = 4;
+            channel.rx.push_back(first);
+        }
+    }
+    else
+    {
+        std::memcpy(response.Data + 4, msg.Data + 4, msg.DataSize - 4);
+        response.DataSize = msg.DataSize;
+    }
+    channel.rx.push_back(response);
+}
+} // namespace
+
+FAKE_EXPORT long PTAPI PassThruOpen(void *, uint32_t * pDeviceID)
+{
+    *pDeviceID = 1;
+    return STATUS_NOERROR;
+}
+
+FAKE_EXPORT long PTAPI PassThruClose(uint32_t) { return STATUS_NOERROR; }
+
+FAKE_EXPORT long PTAPI PassThruConnect(uint32_t, uint32_t protocolID, uint32_t, uint32_t, uint32_t * pChannelID)
+{
+    std::lock_guard lock(mutex);
+    uint32_t id = nextChannel++;
+    Channel & channel = channels[id];
+    channel.protocol = protocolID;
+    // J2534-1 defaults
+    channel.config[static_cast<uint32_t>(lt::j2534::Parameter::Iso15765BsTx)] = ISO15765_USE_ECU_VALUE;
+    channel.config[static_cast<uint32_t>(lt::j2534::Parameter::Iso15765StMinTx)] = ISO15765_USE_ECU_VALUE;
+    *pChannelID = id;
+    return STATUS_NOERROR;
+}
+
+FAKE_EXPORT long PTAPI PassThruDisconnect(uint32_t channelID)
+{
+    std::lock_guard lock(mutex);
+    return channels.erase(channelID) != 0 ? STATUS_NOERROR : ERR_INVALID_CHANNEL_ID;
+}
+
+FAKE_EXPORT long PTAPI PassThruReadMsgs(uint32_t channelID, PASSTHRU_MSG * pMsg, uint32_t * pNumMsgs,
+                                        uint32_t timeout)
+{
+    std::unique_lock lock(mutex);
+    ++readCalls;
+    auto it = channels.find(channelID);
+    if (it == channels.end())
+        return ERR_INVALID_CHANNEL_ID;
+    Channel & channel = it->second;
+
+    uint32_t wanted = *pNumMsgs;
+    if (timeout != 0)
+    {
+        received.wait_for(lock, std::chrono::milliseconds(timeout),
+                          [&]() { return channel.rx.size() >= wanted; });
+    }
+
+    uint32_t count = std::min<uint32_t>(wanted, static_cast<uint32_t>(channel.rx.size()));
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        pMsg[i] = channel.rx.front();
+        channel.rx.pop_front();
+    }
+    *pNumMsgs = count;
+    if (count == wanted)
+        return STATUS_NOERROR;
+    if (count == 0 && timeout == 0)
+        return ERR_BUFFER_EMPTY;
+    return ERR_TIMEOUT;
+}
+
+FAKE_EXPORT long PTAPI PassThruWriteMsgs(uint32_t channelID, PASSTHRU_MSG * pMsg, uint32_t * pNumMsgs, uint32_t)
+{
+    {
+        std::lock_guard lock(mutex);
+        ++writeCalls;
+        auto it = channels.find(channelID);
+        if (it == channels.end())
+            return ERR_INVALID_CHANNEL_ID;
+        for (uint32_t i = 0; i < *pNumMsgs; ++i)
+            respond(it->second, pMsg[i]);
+    }
+    received.notify_all();
+    return STATUS_NOERROR;
+}
+
+FAKE_EXPORT long PTAPI PassThruStartPeriodicMsg(uint32_t, const PASSTHRU_MSG *, uint32_t *, uint32_t)
+{
+    lastError = "periodic messages are not supported";
+    return ERR_NOT_SUPPORTED;
+}
+
+FAKE_EXPORT long PTAPI PassThruStopPeriodicMsg(uint32_t, uint32_t) { return ERR_NOT_SUPPORTED; }
+
+FAKE_EXPORT long PTAPI PassThruStartMsgFilter(uint32_t, uint32_t, const PASSTHRU_MSG *, const PASSTHRU_MSG *,
+                                              const PASSTHRU_MSG *, uint32_t * pMsgID)
+{
+    *pMsgID = 1;
+    return STATUS_NOERROR;
+}
+
+FAKE_EXPORT long PTAPI PassThruStopMsgFilter(uint32_t, uint32_t) { return STATUS_NOERROR; }
+
+FAKE_EXPORT long PTAPI PassThruSetProgrammingVoltage(uint32_t, uint32_t) { return ERR_NOT_SUPPORTED; }
+
+FAKE_EXPORT long PTAPI PassThruReadVersion(char * firmware, char * dll, char * api)
+{
+    std::strcpy(firmware, "1.0");
+    std::strcpy(dll, "1.0");
+    std::strcpy(api, "04.04");
+    return STATUS_NOERROR;
+}
+
+FAKE_EXPORT long PTAPI PassThruGetLastError(char * errorDescription)
+{
+    std::strcpy(errorDescription, lastError);
+    return STATUS_NOERROR;
+}
+
+FAKE_EXPORT long PTAPI PassThruIoctl(uint32_t channelID, uint32_t ioctlID, void * input, void *)
+{
+    std::lock_guard lock(mutex);
+    auto it = channels.find(channelID);
+    if (it == channels.end())
+    {
+        lastError = "invalid channel";
+        return ERR_INVALID_CHANNEL_ID;
+    }
+
+    auto * list = static_cast<SCONFIG_LIST *>(input);
+    switch (static_cast<lt::j2534::Ioctl>(ioctlID))
+    {
+    case lt::j2534::Ioctl::SetConfig:
+        for (uint32_t i = 0; i < list->NumOfParams; ++i)
+            it->second.config[list->ConfigPtr[i].Parameter] = list->ConfigPtr[i].Value;
+        return STATUS_NOERROR;
+    case lt::j2534::Ioctl::GetConfig:
+        for (uint32_t i = 0; i < list->NumOfParams; ++i)
+            list->ConfigPtr[i].Value = it->second.config[list->ConfigPtr[i].Parameter];
+        return STATUS_NOERROR;
+    default:
+        lastError = "ioctl is not supported";
+        return ERR_NOT_SUPPORTED;
+    }
+}
+
+// Test hooks
+
+FAKE_EXPORT uint32_t FakePassThruReadCalls()
+{
+    std::lock_guard lock(mutex);
+    return readCalls;
+}
+
+FAKE_EXPORT uint32_t FakePassThruWriteCalls()
+{
+    std::lock_guard lock(mutex);
+    return writeCalls;
+}
+
+// Returns a parameter of the most recently connected channel
+FAKE_EXPORT uint32_t FakePassThruConfig(uint32_t parameter)
+{
+    std::lock_guard lock(mutex);
+    if (channels.empty())
+        return 0;
+    return channels.rbegin()->second.config[parameter];
+}
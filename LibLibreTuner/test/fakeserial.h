@@ -0,0 +1,154 @@
+#ifndef LT_TEST_FAKESERIAL_H
+#define LT_TEST_FAKESERIAL_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Pseudo terminal standing in for a serial adapter. serial::Device opens
+// path() like a real port and the test talks to the other end.
+class FakeSerial
+{
+public:
+    FakeSerial()
+    {
+        master_ = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_ == -1 || grantpt(master_) != 0 || unlockpt(master_) != 0)
+            throw std::runtime_error("failed to open pseudo terminal");
+        path_ = ptsname(master_);
+    }
+
+    virtual ~FakeSerial()
+    {
+        stop();
+        close(master_);
+    }
+
+    FakeSerial(const FakeSerial &) = delete;
+    FakeSerial & operator=(const FakeSerial &) = delete;
+
+    inline const std::string & path() const noexcept { return path_; }
+
+    // Writes to the device end
+    void write(std::string_view data)
+    {
+        while (!data.empty())
+        {
+            ssize_t amount = ::write(master_, data.data(), data.size());
+            if (amount <= 0)
+                throw std::runtime_error("failed to write to pseudo terminal");
+            data.remove_prefix(static_cast<std::size_t>(amount));
+        }
+    }
+
+    // Calls `onLine` on a thread with each CR-terminated line the device
+    // writes, until the fake is destroyed
+    void serve(std::function<void(const std::string & line)> onLine)
+    {
+        thread_ = std::thread([this, onLine = std::move(onLine)]() {
+            std::string buffer;
+            char chunk[256];
+            while (!stop_)
+            {
+                pollfd pfd{master_, POLLIN, 0};
+                if (poll(&pfd, 1, 10) <= 0 || (pfd.revents & POLLIN) == 0)
+                    continue;
+                ssize_t amount = ::read(master_, chunk, sizeof(chunk));
+                if (amount <= 0)
+                    continue;
+                buffer.append(chunk, static_cast<std::size_t>(amount));
+                for (std::size_t end; (end = buffer.find('\r')) != std::string::npos;)
+                {
+                    onLine(buffer.substr(0, end));
+                    buffer.erase(0, end + 1);
+                }
+            }
+        });
+    }
+
+protected:
+    void stop()
+    {
+        stop_ = true;
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+private:
+    int master_{-1};
+    std::string path_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+// ELM327 or STN11xx adapter with echo off. AT and ST setup commands are
+// answered with OK; other commands get the scripted responses in order.
+class FakeElm : public FakeSerial
+{
+public:
+    explicit FakeElm(bool stn)
+    {
+        serve([this, stn](const std::string & command) {
+            std::string response;
+            {
+                std::lock_guard lock(mutex_);
+                if (command == "STI")
+                    response = stn ? "STN1110 v4.0.1" : "?";
+                else if (command == "AT I")
+                    response = "ELM327 v1.5";
+                else if (command.compare(0, 3, "AT ") == 0 || command.compare(0, 7, "STCSEGT") == 0)
+                    response = "OK";
+                else
+                {
+                    commands_.push_back(command);
+                    if (responses_.empty())
+                    {
+                        response = "?";
+                    }
+                    else
+                    {
+                        response = std::move(responses_.front());
+                        responses_.pop_front();
+                    }
+                }
+            }
+            write(response + "\r\r>");
+        });
+    }
+
+    ~FakeElm() override { stop(); }
+
+    // Queues the response to the next data command. Lines are separated by
+    // CR.
+    void respond(std::string response)
+    {
+        std::lock_guard lock(mutex_);
+        responses_.push_back(std::move(response));
+    }
+
+    // Data commands received so far
+    std::vector<std::string> commands()
+    {
+        std::lock_guard lock(mutex_);
+        return commands_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<std::string> responses_;
+    std::vector<std::string> commands_;
+};
+
+#endif // LT_TEST_FAKESERIAL_H
@@ -0,0 +1,371 @@
+#include <catch2/catch.hpp>
+
+#include <lt/os/iocontext.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace lt;
+using namespace std::chrono_literals;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+Task<std::chrono::milliseconds> sleepFor(os::IoContext & context, std::chrono::milliseconds duration)
+{
+    Clock::time_point start = Clock::now();
+    co_await context.sleep(duration);
+    co_return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+}
+
+Task<bool> onIoThread(os::IoContext & context)
+{
+    co_await context.sleep(1ms);
+    co_return context.isIoThread();
+}
+
+Task<int> failAfterSleep(os::IoContext & context)
+{
+    co_await context.sleep(1ms);
+    throw std::runtime_error("failed");
+}
+
+// Coroutine started eagerly whose frame the test destroys, so a coroutine
+// the context never resumes does not leak
+struct Eager
+{
+    struct promise_type
+    {
+        Eager get_return_object() noexcept { return Eager{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        inline std::suspend_never initial_suspend() const noexcept { return {}; }
+        inline std::suspend_always final_suspend() const noexcept { return {}; }
+        inline void return_void() const noexcept {}
+        inline void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+Eager sleepThenSet(os::IoContext & context, std::atomic<bool> & resumed)
+{
+    co_await context.sleep(10s);
+    resumed = true;
+}
+
+Task<bool> waitTrigger(os::IoContext::Trigger & trigger, std::chrono::microseconds timeout)
+{
+    co_return co_await trigger.wait(timeout);
+}
+
+// Waits on a trigger, then sleeps past the wait's timeout. Counts each
+// resumption so a stale timer that resumes twice is caught.
+Task<bool> waitThenSleep(os::IoContext & context, os::IoContext::Trigger & trigger, std::atomic<int> & resumes)
+{
+    bool fired = co_await trigger.wait(20ms);
+    ++resumes;
+    co_await context.sleep(60ms);
+    ++resumes;
+    co_return fired;
+}
+
+#ifdef __linux__
+Task<bool> waitReadable(os::IoContext & context, int fd, std::chrono::microseconds timeout)
+{
+    co_return co_await context.readable(fd, timeout);
+}
+#endif
+
+template <typename F> Task<std::pair<int, bool>> offloadValue(os::IoContext & context, F func)
+{
+    // Start on the I/O thread
+    co_await context.sleep(1ms);
+    int result = co_await os::offload(std::move(func));
+    co_return std::make_pair(result, context.isIoThread());
+}
+
+Task<std::thread::id> offloadFromCaller()
+{
+    co_await os::offload([]() { std::this_thread::sleep_for(1ms); });
+    co_return std::this_thread::get_id();
+}
+
+Task<bool> offloadFailure(os::IoContext & context)
+{
+    co_await context.sleep(1ms);
+    try
+    {
+        co_await os::offload([]() -> int { throw std::runtime_error("blocked"); });
+    }
+    catch (const std::runtime_error &)
+    {
+        co_return context.isIoThread();
+    }
+    co_return false;
+}
+} // namespace
+
+TEST_CASE("IoContext timers resume coroutines")
+{
+    os::IoContext context;
+
+    SECTION("Sleeping coroutines resume on the I/O thread after the duration")
+    {
+        CHECK(context.spawn(sleepFor(context, 20ms)).get() >= 20ms);
+        CHECK(context.spawn(onIoThread(context)).get());
+        CHECK_FALSE(context.isIoThread());
+    }
+
+    SECTION("Timers fire in deadline order")
+    {
+        auto slow = context.spawn(sleepFor(context, 60ms));
+        auto fast = context.spawn(sleepFor(context, 10ms));
+        CHECK(fast.wait_for(5s) == std::future_status::ready);
+        CHECK(slow.wait_for(0ms) == std::future_status::timeout);
+        CHECK(slow.get() >= 60ms);
+    }
+
+    SECTION("Zero durations do not suspend")
+    {
+        CHECK(context.spawn(sleepFor(context, 0ms)).get() < 20ms);
+    }
+
+    SECTION("Exceptions reach the spawned future")
+    {
+        CHECK_THROWS_WITH(context.spawn(failAfterSleep(context)).get(), "failed");
+    }
+
+    SECTION("syncWait can wait on a task resumed by the I/O thread")
+    {
+        CHECK(syncWait(sleepFor(context, 10ms)) >= 10ms);
+    }
+}
+
+TEST_CASE("Destroying an IoContext drops its waiting coroutines")
+{
+    std::atomic<bool> resumed{false};
+    Eager sleeper;
+    {
+        os::IoContext context;
+        sleeper = sleepThenSet(context, resumed);
+        std::this_thread::sleep_for(10ms);
+    }
+    CHECK_FALSE(resumed);
+    CHECK_FALSE(sleeper.handle.done());
+    sleeper.handle.destroy();
+}
+
+TEST_CASE("Triggers wake waiting coroutines")
+{
+    os::IoContext context;
+    os::IoContext::Trigger trigger(context);
+
+    SECTION("Firing wakes the waiter before its timeout")
+    {
+        Clock::time_point start = Clock::now();
+        auto fired = context.spawn(waitTrigger(trigger, 10s));
+        std::thread([&]() {
+            std::this_thread::sleep_for(10ms);
+            trigger.fire();
+        }).join();
+        CHECK(fired.get());
+        CHECK(Clock::now() - start < 5s);
+    }
+
+    SECTION("Waits time out without a fire")
+    {
+        Clock::time_point start = Clock::now();
+        CHECK_FALSE(context.spawn(waitTrigger(trigger, 20ms)).get());
+        CHECK(Clock::now() - start >= 20ms);
+    }
+
+    SECTION("A fire before the wait is kept")
+    {
+        trigger.fire();
+        CHECK(context.spawn(waitTrigger(trigger, 10s)).get());
+        // Consumed by the first wait
+        CHECK_FALSE(context.spawn(waitTrigger(trigger, 10ms)).get());
+    }
+
+    SECTION("Firing cancels the wait's timer")
+    {
+        std::atomic<int> resumes{0};
+        auto fired = context.spawn(waitThenSleep(context, trigger, resumes));
+        std::this_thread::sleep_for(5ms);
+        trigger.fire();
+        CHECK(fired.get());
+        CHECK(resumes == 2);
+    }
+}
+
+#ifdef __linux__
+TEST_CASE("Readable waits resume when data arrives")
+{
+    os::IoContext context;
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+
+    SECTION("Data wakes the waiter")
+    {
+        auto readable = context.spawn(waitReadable(context, fds[0], 10s));
+        std::this_thread::sleep_for(10ms);
+        REQUIRE(write(fds[1], "x", 1) == 1);
+        CHECK(readable.get());
+    }
+
+    SECTION("Waits time out and stop watching the descriptor")
+    {
+        Clock::time_point start = Clock::now();
+        CHECK_FALSE(context.spawn(waitReadable(context, fds[0], 20ms)).get());
+        CHECK(Clock::now() - start >= 20ms);
+
+        // The timed out wait is gone, so data only wakes the next one
+        REQUIRE(write(fds[1], "x", 1) == 1);
+        std::this_thread::sleep_for(10ms);
+        CHECK(context.spawn(waitReadable(context, fds[0], 10s)).get());
+    }
+
+    SECTION("A descriptor can be waited on again")
+    {
+        REQUIRE(write(fds[1], "x", 1) == 1);
+        CHECK(context.spawn(waitReadable(context, fds[0], 10s)).get());
+        char byte;
+        REQUIRE(read(fds[0], &byte, 1) == 1);
+        CHECK_FALSE(context.spawn(waitReadable(context, fds[0], 10ms)).get());
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE("Watches can be removed while their events are pending")
+{
+    os::IoContext context;
+    int a[2];
+    int b[2];
+    REQUIRE(pipe(a) == 0);
+    REQUIRE(pipe(b) == 0);
+
+    SECTION("A callback unwatches itself")
+    {
+        std::atomic<int> calls{0};
+        REQUIRE(write(a[1], "x", 1) == 1);
+        context.watch(a[0], [&]() {
+            ++calls;
+            context.unwatch(a[0]);
+        });
+        std::this_thread::sleep_for(20ms);
+        // Still readable, but no longer watched
+        CHECK(calls == 1);
+    }
+
+    SECTION("A callback unwatches a descriptor that is ready in the same batch")
+    {
+        // Both are readable before either is watched, so one epoll_wait
+        // returns both. Whichever runs first removes the other and watches
+        // its descriptor again with a new callback.
+        std::atomic<int> original{0};
+        std::atomic<int> replacement{0};
+        REQUIRE(write(a[1], "x", 1) == 1);
+        REQUIRE(write(b[1], "x", 1) == 1);
+        auto callback = [&](int self, int other) {
+            ++original;
+            context.unwatch(self);
+            context.unwatch(other);
+            context.watch(other, [&, other]() {
+                ++replacement;
+                context.unwatch(other);
+            });
+        };
+        context.post([&]() {
+            context.watch(a[0], [&]() { callback(a[0], b[0]); });
+            context.watch(b[0], [&]() { callback(b[0], a[0]); });
+        });
+        std::this_thread::sleep_for(20ms);
+        CHECK(original == 1);
+        CHECK(replacement == 1);
+    }
+
+    SECTION("unwatch() from another thread waits for a running callback")
+    {
+        std::atomic<bool> running{false};
+        std::atomic<int> calls{0};
+        REQUIRE(write(a[1], "x", 1) == 1);
+        // Never reads, so it is called until unwatched
+        context.watch(a[0], [&]() {
+            running = true;
+            ++calls;
+            std::this_thread::sleep_for(20ms);
+            running = false;
+        });
+        while (!running)
+            std::this_thread::yield();
+        context.unwatch(a[0]);
+        CHECK_FALSE(running);
+
+        int after = calls;
+        std::this_thread::sleep_for(30ms);
+        CHECK(calls == after);
+    }
+
+    SECTION("Watches removed from another thread are never called afterwards")
+    {
+        std::atomic<bool> removed{false};
+        std::atomic<bool> late{false};
+        REQUIRE(write(a[1], "x", 1) == 1);
+        for (int i = 0; i < 500; ++i)
+        {
+            removed = false;
+            context.watch(a[0], [&]() {
+                if (removed)
+                    late = true;
+            });
+            if (i % 2 == 0)
+                std::this_thread::yield();
+            context.unwatch(a[0]);
+            removed = true;
+        }
+        std::this_thread::sleep_for(10ms);
+        CHECK_FALSE(late);
+    }
+
+    for (int fd : {a[0], a[1], b[0], b[1]})
+        close(fd);
+}
+#endif
+
+TEST_CASE("offload runs blocking calls off the I/O thread")
+{
+    os::IoContext context;
+
+    SECTION("Results return to the I/O thread")
+    {
+        std::atomic<bool> calledOnIo{true};
+        auto [result, resumedOnIo] = context
+                                         .spawn(offloadValue(context,
+                                                             [&]() {
+                                                                 calledOnIo = context.isIoThread();
+                                                                 return 42;
+                                                             }))
+                                         .get();
+        CHECK(result == 42);
+        CHECK_FALSE(calledOnIo);
+        CHECK(resumedOnIo);
+    }
+
+    SECTION("Exceptions are rethrown on the I/O thread")
+    {
+        CHECK(context.spawn(offloadFailure(context)).get());
+    }
+
+    SECTION("Coroutines not on an I/O thread resume on the pool thread")
+    {
+        std::thread::id resumedOn = syncWait(offloadFromCaller());
+        CHECK(resumedOn != std::this_thread::get_id());
+    }
+}
@@ -0,0 +1,232 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/isotp/isotpdecoder.h>
+
+#include <numeric>
+
+using namespace lt::network;
+using namespace std::chrono_literals;
+
+namespace
+{
+class Capture
+{
+public:
+    void frame(uint32_t id, std::initializer_list<uint8_t> data, int64_t micros)
+    {
+        std::vector<uint8_t> bytes(data);
+        CanMessage message(id, bytes.data(), static_cast<uint8_t>(bytes.size()));
+        entries.push_back(CanLogEntry{CanMessageDirection::Inbound, message, std::chrono::microseconds(micros)});
+    }
+
+    std::vector<CanLogEntry> entries;
+};
+
+IsoTpDecoder decode(const Capture & capture, IsoTpDecoderOptions options = {})
+{
+    IsoTpDecoder decoder(std::move(options));
+    decoder.add(capture.entries.data(), capture.entries.size());
+    decoder.finish();
+    return decoder;
+}
+} // namespace
+
+TEST_CASE("Decoder pairs single frame requests and responses")
+{
+    Capture capture;
+    capture.frame(0x7E0, {0x02, 0x10, 0x03}, 1000);
+    capture.frame(0x7E8, {0x06, 0x50, 0x03, 0x00, 0x32, 0x01, 0xF4}, 1800);
+    // Traffic on other ids is ignored
+    capture.frame(0x201, {0x11, 0x22}, 1900);
+
+    IsoTpDecoder decoder = decode(capture);
+    CHECK(decoder.stats().frames == 3);
+    CHECK(decoder.stats().ignoredFrames == 1);
+    REQUIRE(decoder.transfers().size() == 2);
+    CHECK(decoder.transfers()[0].fromTester);
+    CHECK(decoder.transfers()[0].singleFrame());
+    CHECK(decoder.transfers()[1].size == 6);
+
+    REQUIRE(decoder.transactions().size() == 1);
+    const UdsTransaction & transaction = decoder.transactions()[0];
+    CHECK(transaction.sid == 0x10);
+    CHECK(transaction.status == UdsTransactionStatus::Positive);
+    CHECK(transaction.latency() == 800us);
+    CHECK(transaction.duration() == 800us);
+    CHECK(std::string(udsServiceName(transaction.sid)) == "DiagnosticSessionControl");
+}
+
+TEST_CASE("Decoder reassembles multi-frame transfers with flow control")
+{
+    // 21 byte TransferData request: first frame with 6 bytes, then 2 blocks
+    Capture capture;
+    capture.frame(0x7E0, {0x10, 0x15, 0x36, 0x01, 0x02, 0x03, 0x04, 0x05}, 0);
+    capture.frame(0x7E8, {0x30, 0x02, 0x05}, 1000);
+    capture.frame(0x7E0, {0x21, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C}, 6000);
+    // 3 ms after the previous frame, below the 5 ms STmin
+    capture.frame(0x7E0, {0x22, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13}, 9000);
+    capture.frame(0x7E8, {0x30, 0x00, 0x05}, 11000);
+    capture.frame(0x7E0, {0x23, 0x14}, 17000);
+    capture.frame(0x7E8, {0x02, 0x76, 0x01}, 20000);
+
+    IsoTpDecoder decoder = decode(capture);
+    REQUIRE(decoder.transfers().size() == 2);
+    const IsoTpTransfer & transfer = decoder.transfers()[0];
+    CHECK(transfer.status == IsoTpTransferStatus::Complete);
+    CHECK(transfer.size == 21);
+    CHECK(transfer.received == 21);
+    CHECK(transfer.frames == 4);
+    CHECK(transfer.flowControlFrames == 2);
+    CHECK(transfer.blockSize == 2);
+    CHECK(transfer.stMin == 5);
+    CHECK(transfer.flowControlDelay == 1000us);
+    // From the end of each block to the flow control frame releasing the next
+    CHECK(transfer.flowControlWait == 1000us + 2000us);
+    // Only the gap inside the first block is measured
+    CHECK(transfer.gaps == 1);
+    CHECK(transfer.minGap == 3000us);
+    CHECK(transfer.stMinViolations == 1);
+    CHECK(transfer.duration() == 17000us);
+
+    const uint8_t * payload = decoder.payload(transfer);
+    REQUIRE(payload != nullptr);
+    std::vector<uint8_t> expected(21);
+    expected[0] = 0x36;
+    std::iota(expected.begin() + 1, expected.end(), uint8_t{1});
+    CHECK(std::vector<uint8_t>(payload, payload + 21) == expected);
+
+    REQUIRE(decoder.transactions().size() == 1);
+    CHECK(decoder.transactions()[0].status == UdsTransactionStatus::Positive);
+    CHECK(decoder.transactions()[0].latency() == 3000us);
+
+    SECTION("STmin tolerance")
+    {
+        IsoTpDecoderOptions options;
+        options.stMinTolerance = 2ms;
+        CHECK(decode(capture, options).transfers()[0].stMinViolations == 0);
+    }
+
+    SECTION("Without payloads only the head is kept")
+    {
+        IsoTpDecoderOptions options;
+        options.keepPayload = false;
+        IsoTpDecoder light = decode(capture, options);
+        CHECK(light.payload(light.transfers()[0]) == nullptr);
+        CHECK(light.transfers()[0].head == std::array<uint8_t, 4>{0x36, 0x01, 0x02, 0x03});
+        CHECK(light.transfers()[0].received == 21);
+    }
+}
+
+TEST_CASE("Decoder follows pending, negative and suppressed responses")
+{
+    Capture capture;
+    // RoutineControl answered after two response pending replies
+    capture.frame(0x7E0, {0x04, 0x31, 0x01, 0xFF, 0x00}, 0);
+    capture.frame(0x7E8, {0x03, 0x7F, 0x31, 0x78}, 1000);
+    capture.frame(0x7E8, {0x03, 0x7F, 0x31, 0x78}, 50000);
+    capture.frame(0x7E8, {0x04, 0x71, 0x01, 0xFF, 0x00}, 90000);
+    // SecurityAccess with an invalid key
+    capture.frame(0x7E0, {0x06, 0x27, 0x02, 0x11, 0x22, 0x33, 0x44}, 100000);
+    capture.frame(0x7E8, {0x03, 0x7F, 0x27, 0x35}, 101000);
+    // TesterPresent with the positive response suppressed
+    capture.frame(0x7E0, {0x02, 0x3E, 0x80}, 110000);
+    // ReadDataByIdentifier that is never answered
+    capture.frame(0x7E0, {0x03, 0x22, 0xF1, 0x90}, 120000);
+    // Response with no open request
+    capture.frame(0x7E9, {0x02, 0x50, 0x01}, 130000);
+
+    IsoTpDecoder decoder = decode(capture);
+    const std::vector<UdsTransaction> & transactions = decoder.transactions();
+    REQUIRE(transactions.size() == 4);
+
+    CHECK(transactions[0].status == UdsTransactionStatus::Positive);
+    CHECK(transactions[0].pending == 2);
+    CHECK(transactions[0].latency() == 90000us);
+
+    CHECK(transactions[1].status == UdsTransactionStatus::Negative);
+    CHECK(transactions[1].negativeCode == 0x35);
+
+    CHECK(transactions[2].status == UdsTransactionStatus::Suppressed);
+    CHECK(transactions[2].response == UdsTransaction::npos);
+
+    CHECK(transactions[3].status == UdsTransactionStatus::NoResponse);
+    CHECK(decoder.stats().unmatchedResponses == 1);
+
+    std::vector<UdsServiceSummary> summary = decoder.summarize();
+    REQUIRE(summary.size() == 4);
+    // Sorted by total time, so the slow routine comes first
+    CHECK(summary[0].sid == 0x31);
+    CHECK(summary[0].pending == 2);
+    CHECK(summary[0].requestBytes == 4);
+    CHECK(summary[0].responseBytes == 4);
+    CHECK(summary[0].maxLatency == 90000us);
+    auto security = std::find_if(summary.begin(), summary.end(), [](const auto & s) { return s.sid == 0x27; });
+    REQUIRE(security != summary.end());
+    CHECK(security->negative == 1);
+    auto read = std::find_if(summary.begin(), summary.end(), [](const auto & s) { return s.sid == 0x22; });
+    REQUIRE(read != summary.end());
+    CHECK(read->noResponse == 1);
+}
+
+TEST_CASE("Decoder reports broken transfers")
+{
+    Capture capture;
+    capture.frame(0x7E8, {0x21, 0x00}, 0);
+    capture.frame(0x7E0, {0x10, 0x10, 0x36, 0x01, 0x02, 0x03, 0x04, 0x05}, 1000);
+    capture.frame(0x7E8, {0x30, 0x00, 0x00}, 2000);
+    // Sequence number 2 where 1 was expected
+    capture.frame(0x7E0, {0x22, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C}, 3000);
+    // A new first frame aborts the unfinished transfer
+    capture.frame(0x7E1, {0x10, 0x10, 0x36, 0x01, 0x02, 0x03, 0x04, 0x05}, 4000);
+    capture.frame(0x7E1, {0x10, 0x10, 0x36, 0x01, 0x02, 0x03, 0x04, 0x05}, 5000);
+    // Receiver overflow
+    capture.frame(0x7E2, {0x10, 0x10, 0x36, 0x01, 0x02, 0x03, 0x04, 0x05}, 6000);
+    capture.frame(0x7EA, {0x32, 0x00, 0x00}, 7000);
+
+    IsoTpDecoder decoder = decode(capture);
+    CHECK(decoder.stats().unexpectedFrames == 1);
+    REQUIRE(decoder.transfers().size() == 4);
+    CHECK(decoder.transfers()[0].status == IsoTpTransferStatus::SequenceError);
+    CHECK(decoder.transfers()[1].status == IsoTpTransferStatus::Aborted);
+    // The capture ends before the second first frame is continued
+    CHECK(decoder.transfers()[2].status == IsoTpTransferStatus::Incomplete);
+    CHECK(decoder.transfers()[3].status == IsoTpTransferStatus::Overflow);
+    CHECK(decoder.transactions().empty());
+}
+
+TEST_CASE("Decoder finds normal fixed addresses")
+{
+    Capture capture;
+    capture.frame(0x18DA10F1, {0x02, 0x3E, 0x00}, 0);
+    capture.frame(0x18DAF110, {0x02, 0x7E, 0x00}, 500);
+
+    IsoTpDecoder decoder = decode(capture);
+    REQUIRE(decoder.transactions().size() == 1);
+    CHECK(decoder.transactions()[0].status == UdsTransactionStatus::Positive);
+    CHECK(decoder.transfers()[0].fromTester);
+    CHECK_FALSE(decoder.transfers()[1].fromTester);
+
+    IsoTpDecoderOptions options;
+    options.normalFixed = false;
+    CHECK(decode(capture, options).stats().ignoredFrames == 2);
+}
+
+TEST_CASE("Decoder reads CAN logs")
+{
+    Capture capture;
+    for (int i = 0; i < 3000; ++i)
+    {
+        capture.frame(0x7E0, {0x02, 0x3E, 0x00}, i * 2000);
+        capture.frame(0x7E8, {0x02, 0x7E, 0x00}, i * 2000 + 300);
+    }
+    CanLog log(capture.entries.size());
+    for (const CanLogEntry & entry : capture.entries)
+        log.add(entry);
+
+    IsoTpDecoder decoder;
+    decoder.add(log);
+    decoder.finish();
+    CHECK(decoder.stats().frames == 6000);
+    CHECK(decoder.transactions().size() == 3000);
+    CHECK(decoder.summarize()[0].totalLatency == 3000 * 300us);
+}
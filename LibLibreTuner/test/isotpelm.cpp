@@ -0,0 +1,147 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/isotp/isotpelm.h>
+
+#ifdef __linux__
+#include "fakeserial.h"
+
+using namespace lt;
+using namespace lt::network;
+
+namespace
+{
+IsoTpPacket packet(std::initializer_list<uint8_t> bytes) { return IsoTpPacket(bytes.begin(), bytes.size()); }
+
+std::vector<uint8_t> bytes(const IsoTpPacket & packet) { return std::vector<uint8_t>(packet.begin(), packet.end()); }
+
+std::unique_ptr<IsoTpElm> connect(FakeElm & adapter)
+{
+    auto device = std::make_shared<Elm327>(adapter.path());
+    device->open();
+    return std::make_unique<IsoTpElm>(device);
+}
+} // namespace
+
+TEST_CASE("ELM responses are framed into packets")
+{
+    FakeElm adapter(false);
+    auto isotp = connect(adapter);
+    IsoTpPacket response;
+
+    SECTION("Single requests with one response ask for one response")
+    {
+        adapter.respond("62F19041");
+        isotp->request(packet({0x22, 0xF1, 0x90}), response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x62, 0xF1, 0x90, 0x41});
+        CHECK(adapter.commands() == std::vector<std::string>{"22F1901"});
+    }
+
+    SECTION("Multi-line responses are joined and padding is dropped")
+    {
+        adapter.respond("00A\r0:62F190313233\r1:34353637AAAAAA");
+        isotp->request(packet({0x22, 0xF1, 0x90}), response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x62, 0xF1, 0x90, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37});
+    }
+
+    SECTION("Several responses are returned in order")
+    {
+        adapter.respond("7101\r00A\r0:7101AABBCCDD\r1:EEFF0011");
+        isotp->request(packet({0x31, 0x01}), response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x71, 0x01});
+        isotp->recv(response);
+        CHECK(response.size() == 10);
+        CHECK(response[9] == 0x11);
+        CHECK_THROWS(isotp->recv(response));
+        // Requests without a known response count wait for the timeout
+        CHECK(adapter.commands() == std::vector<std::string>{"3101"});
+    }
+
+    SECTION("Short multi-line responses are errors")
+    {
+        adapter.respond("00A\r0:62F190313233");
+        CHECK_THROWS_WITH(isotp->request(packet({0x22, 0xF1, 0x90}), response),
+                          "message did not meet expected length");
+    }
+
+    SECTION("Status lines are reported")
+    {
+        adapter.respond("NO DATA");
+        CHECK_THROWS_WITH(isotp->request(packet({0x22, 0xF1, 0x90}), response), "received no data");
+    }
+
+    SECTION("ELM327 adapters cannot send long messages")
+    {
+        CHECK_THROWS(isotp->send(packet({0x2E, 0xF1, 0x90, 1, 2, 3, 4, 5})));
+        CHECK(adapter.commands().empty());
+    }
+}
+
+TEST_CASE("STN adapters send long messages with STPX")
+{
+    FakeElm adapter(true);
+    auto isotp = connect(adapter);
+    IsoTpPacket response;
+
+    adapter.respond("6EF190");
+    isotp->request(packet({0x2E, 0xF1, 0x90, 1, 2, 3, 4, 5}), response);
+    CHECK(bytes(response) == std::vector<uint8_t>{0x6E, 0xF1, 0x90});
+
+    // The response count follows the data
+    adapter.respond("63AABB");
+    isotp->request(packet({0x23, 0x14, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02}), response);
+    CHECK(bytes(response) == std::vector<uint8_t>{0x63, 0xAA, 0xBB});
+
+    // Short messages are sent as plain hex
+    adapter.respond("62F19041");
+    isotp->request(packet({0x22, 0xF1, 0x90}), response);
+
+    CHECK(adapter.commands() ==
+          std::vector<std::string>{"STPX D:2EF1900102030405", "STPX D:2314000100000002,R:1", "22F1901"});
+}
+
+TEST_CASE("Pending responses to hinted requests are waited for")
+{
+    FakeElm adapter(true);
+    auto isotp = connect(adapter);
+    IsoTpPacket response;
+
+    SECTION("Hinted requests are sent again without the count")
+    {
+        adapter.respond("7F2278");
+        adapter.respond("7F2278\r62F19041");
+        isotp->request(packet({0x22, 0xF1, 0x90}), response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x7F, 0x22, 0x78});
+        isotp->recv(response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x62, 0xF1, 0x90, 0x41});
+        CHECK(adapter.commands() == std::vector<std::string>{"22F1901", "22F190"});
+    }
+
+    SECTION("Long hinted requests drop the count from STPX")
+    {
+        adapter.respond("7F2378");
+        adapter.respond("7F2378\r63AABB");
+        isotp->request(packet({0x23, 0x14, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02}), response);
+        isotp->recv(response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x63, 0xAA, 0xBB});
+        CHECK(adapter.commands() ==
+              std::vector<std::string>{"STPX D:2314000100000002,R:1", "STPX D:2314000100000002"});
+    }
+
+    SECTION("Requests without a count are not repeated")
+    {
+        adapter.respond("7F3178\r7101");
+        isotp->request(packet({0x31, 0x01}), response);
+        isotp->recv(response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x71, 0x01});
+        CHECK(adapter.commands() == std::vector<std::string>{"3101"});
+    }
+
+    SECTION("Other negative responses are not repeated")
+    {
+        adapter.respond("7F2231");
+        isotp->request(packet({0x22, 0xF1, 0x90}), response);
+        CHECK(bytes(response) == std::vector<uint8_t>{0x7F, 0x22, 0x31});
+        CHECK(adapter.commands() == std::vector<std::string>{"22F1901"});
+    }
+}
+#endif
@@ -0,0 +1,130 @@
+#include <catch2/catch.hpp>
+
+#include <lt/j2534/j2534.h>
+#include <lt/network/can/j2534can.h>
+#include <lt/network/isotp/isotpj2534.h>
+
+#include <dlfcn.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+j2534::DevicePtr openFakeDevice(j2534::J2534Ptr & j2534)
+{
+    j2534::Info info;
+    info.name = "Fake PassThru";
+    info.functionLibrary = FAKE_PASSTHRU_LIBRARY;
+    info.protocols = j2534::Protocol::CAN | j2534::Protocol::ISO15765;
+
+    j2534 = j2534::J2534::create(std::move(info));
+    j2534->init();
+    return j2534->open();
+}
+
+// Resolves a test hook from the fake library, which is already loaded
+template <typename F> F fakeHook(const char * name)
+{
+    void * library = dlopen(FAKE_PASSTHRU_LIBRARY, RTLD_NOW | RTLD_NOLOAD);
+    REQUIRE(library != nullptr);
+    auto hook = reinterpret_cast<F>(dlsym(library, name));
+    dlclose(library);
+    REQUIRE(hook != nullptr);
+    return hook;
+}
+} // namespace
+
+TEST_CASE("J2534 channel configuration")
+{
+    j2534::J2534Ptr j2534;
+    j2534::DevicePtr device = openFakeDevice(j2534);
+    REQUIRE(device);
+
+    j2534::Channel channel = device->connect(j2534::Protocol::ISO15765);
+    channel.setConfig({
+        {static_cast<uint32_t>(j2534::Parameter::Iso15765Bs), 8},
+        {static_cast<uint32_t>(j2534::Parameter::Iso15765StMin), 2},
+    });
+    CHECK(channel.getConfig(j2534::Parameter::Iso15765Bs) == 8);
+    CHECK(channel.getConfig(j2534::Parameter::Iso15765StMin) == 2);
+    CHECK(channel.getConfig(j2534::Parameter::Iso15765BsTx) == ISO15765_USE_ECU_VALUE);
+}
+
+TEST_CASE("IsoTpJ2534 uses the device's ISO15765 channel")
+{
+    j2534::J2534Ptr j2534;
+    j2534::DevicePtr device = openFakeDevice(j2534);
+    REQUIRE(device);
+
+    network::IsoTpJ2534 isotp(device);
+
+    auto config = fakeHook<uint32_t (*)(uint32_t)>("FakePassThruConfig");
+    CHECK(config(static_cast<uint32_t>(j2534::Parameter::Iso15765Bs)) == 0);
+    CHECK(config(static_cast<uint32_t>(j2534::Parameter::Iso15765StMin)) == 0);
+    CHECK(config(static_cast<uint32_t>(j2534::Parameter::Iso15765StMinTx)) == ISO15765_USE_ECU_VALUE);
+
+    SECTION("Single frame")
+    {
+        const uint8_t request[] = {0x22, 0xF1, 0x90};
+        network::IsoTpPacket response;
+        isotp.request(network::IsoTpPacket(request, sizeof(request)), response);
+        REQUIRE(response.size() == 3);
+        CHECK(response[0] == 0x62);
+        CHECK(response[1] == 0xF1);
+        CHECK(response[2] == 0x90);
+    }
+
+    SECTION("Multi-frame")
+    {
+        std::vector<uint8_t> request(1000);
+        std::iota(request.begin(), request.end(), 0);
+        request[0] = 0x36;
+
+        network::IsoTpPacket response;
+        isotp.request(network::IsoTpPacket(request.data(), request.size()), response);
+        REQUIRE(response.size() == request.size());
+        CHECK(response[0] == 0x76);
+        CHECK(std::equal(response.begin() + 1, response.end(), request.begin() + 1));
+    }
+}
+
+TEST_CASE("J2534Can batches reads and writes")
+{
+    j2534::J2534Ptr j2534;
+    j2534::DevicePtr device = openFakeDevice(j2534);
+    REQUIRE(device);
+
+    network::J2534Can can(device);
+
+    constexpr std::size_t count = 200;
+    std::vector<network::CanMessage> messages(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        uint8_t data[2] = {static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)};
+        messages[i].setMessage(0x700, data, 2);
+    }
+
+    auto writeCalls = fakeHook<uint32_t (*)()>("FakePassThruWriteCalls");
+    auto readCalls = fakeHook<uint32_t (*)()>("FakePassThruReadCalls");
+    uint32_t writesBefore = writeCalls();
+    uint32_t readsBefore = readCalls();
+
+    can.sendBatch(messages.data(), messages.size());
+    CHECK(writeCalls() - writesBefore == (count + network::J2534Can::batchSize - 1) / network::J2534Can::batchSize);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        network::CanMessage message;
+        REQUIRE(can.recv(message, std::chrono::milliseconds(100)));
+        CHECK(message.id() == 0x708);
+        CHECK(message[0] == static_cast<uint8_t>(i));
+        CHECK(message[1] == static_cast<uint8_t>(i >> 8));
+    }
+    CHECK(readCalls() - readsBefore <= (count + network::J2534Can::batchSize - 1) / network::J2534Can::batchSize);
+
+    network::CanMessage message;
+    CHECK_FALSE(can.recv(message, std::chrono::milliseconds(10)));
+}
@@ -0,0 +1,170 @@
+#include <catch2/catch.hpp>
+
+#include <lt/support/job.h>
+
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+using namespace lt;
+
+TEST_CASE("Idle workers steal tasks posted by a busy worker")
+{
+    JobPool pool(2);
+
+    const std::size_t count = 20;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t done = 0;
+    std::set<std::thread::id> threads;
+    std::thread::id poster;
+
+    auto job = pool.submit([&](JobControl) {
+        poster = std::this_thread::get_id();
+        // Tasks posted from a worker go to its own deque. This worker
+        // blocks until they finish, so only the other worker can run them.
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            pool.post([&]() {
+                std::lock_guard lock(mutex);
+                threads.insert(std::this_thread::get_id());
+                ++done;
+                cv.notify_all();
+            });
+        }
+        std::unique_lock lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(10), [&]() { return done == count; });
+    });
+    job->wait();
+
+    std::lock_guard lock(mutex);
+    CHECK(done == count);
+    CHECK(threads.size() == 1);
+    CHECK(threads.count(poster) == 0);
+}
+
+TEST_CASE("parallelFor calls every index once")
+{
+    JobPool pool(3);
+
+    const std::size_t count = 1000;
+    std::vector<std::atomic<int>> calls(count);
+    pool.parallelFor(count, [&](std::size_t i) { ++calls[i]; });
+    CHECK(std::all_of(calls.begin(), calls.end(), [](const std::atomic<int> & c) { return c == 1; }));
+
+    SECTION("A single thread runs on the caller")
+    {
+        std::set<std::thread::id> threads;
+        pool.parallelFor(100, [&](std::size_t) { threads.insert(std::this_thread::get_id()); }, 1);
+        CHECK(threads == std::set<std::thread::id>{std::this_thread::get_id()});
+    }
+
+    SECTION("Empty ranges do nothing")
+    {
+        pool.parallelFor(0, [](std::size_t) { FAIL("called"); });
+    }
+}
+
+TEST_CASE("Nested parallelFor completes from pool threads")
+{
+    // Fewer workers than outer calls, so inner loops run while every
+    // worker is inside an outer call
+    JobPool pool(2);
+
+    const std::size_t outer = 8;
+    const std::size_t inner = 200;
+    std::vector<std::atomic<std::size_t>> sums(outer);
+
+    std::atomic<bool> onWorker{false};
+    auto job = pool.submit([&](JobControl) {
+        onWorker = pool.isWorkerThread();
+        pool.parallelFor(outer, [&](std::size_t i) {
+            pool.parallelFor(inner, [&](std::size_t j) { sums[i] += j; });
+        });
+    });
+    job->wait();
+
+    CHECK(onWorker);
+    for (std::size_t i = 0; i < outer; ++i)
+        CHECK(sums[i] == inner * (inner - 1) / 2);
+}
+
+TEST_CASE("Job exceptions propagate")
+{
+    JobPool pool(2);
+
+    SECTION("parallelFor rethrows the first exception and skips the rest")
+    {
+        std::atomic<std::size_t> calls{0};
+        CHECK_THROWS_WITH(pool.parallelFor(
+                              10000,
+                              [&](std::size_t i) {
+                                  ++calls;
+                                  if (i == 10)
+                                      throw std::runtime_error("index 10");
+                              },
+                              1),
+                          "index 10");
+        CHECK(calls == 11);
+    }
+
+    SECTION("wait() rethrows and error() holds the exception")
+    {
+        auto job = pool.submit([](JobControl) { throw std::runtime_error("failed"); });
+        CHECK_THROWS_WITH(job->wait(), "failed");
+        CHECK(job->error() != nullptr);
+        CHECK_FALSE(job->running());
+
+        // Continuations run after a failure
+        std::atomic<bool> ran{false};
+        auto next = job->then([&](JobControl) { ran = true; });
+        next->wait();
+        CHECK(ran);
+    }
+
+    SECTION("Exceptions from nested loops reach the job")
+    {
+        auto job = pool.submit([&](JobControl) {
+            pool.parallelFor(4, [&](std::size_t i) {
+                pool.parallelFor(4, [&](std::size_t j) {
+                    if (i == 2 && j == 3)
+                        throw std::runtime_error("nested");
+                });
+            });
+        });
+        CHECK_THROWS_WITH(job->wait(), "nested");
+    }
+}
+
+TEST_CASE("Jobs report progress and observe cancellation")
+{
+    JobPool pool(1);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool started = false;
+
+    auto job = std::make_shared<Job>();
+    std::vector<double> reported;
+    auto connection = job->onProgress([&](double progress) { reported.push_back(progress); });
+    job->runOn(pool, [&](JobControl control) {
+        control.setProgress(0.5);
+        {
+            std::lock_guard lock(mutex);
+            started = true;
+        }
+        cv.notify_all();
+        while (!control.canceled())
+            std::this_thread::yield();
+    });
+
+    {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&]() { return started; });
+    }
+    job->cancel();
+    job->wait();
+    CHECK(job->canceled());
+    CHECK(job->progress() == 0.5);
+    CHECK(reported == std::vector<double>{0.5});
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/can/loopbackcan.h>
+#include <lt/network/can/meteredcan.h>
+#include <lt/network/isotp/isotpcan.h>
+#include <lt/network/uds/isotpuds.h>
+#include <lt/sim/virtualecu.h>
+
+using namespace lt;
+
+TEST_CASE("Histogram buckets keep relative precision")
+{
+    for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 1000ull, 123456789ull})
+    {
+        std::size_t index = Histogram::index(value);
+        CHECK(Histogram::lowest(index) <= value);
+        CHECK(Histogram::lowest(index + 1) > value);
+    }
+
+    Histogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.record(i * 100);
+
+    CHECK(histogram.count() == 1000);
+    CHECK(histogram.min() == 100);
+    CHECK(histogram.max() == 100000);
+    CHECK(histogram.mean() == Approx(50050));
+    CHECK(histogram.percentile(50) == Approx(50000).epsilon(0.07));
+    CHECK(histogram.percentile(100) == 100000);
+
+    histogram.reset();
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.percentile(50) == 0);
+}
+
+TEST_CASE("Link metrics count frames, responses and latency")
+{
+    sim::VirtualEcuOptions options;
+    options.responsePending = true;
+    options.serviceLatency[0x22] = std::chrono::milliseconds(2);
+    options.didSource = [](uint16_t id, std::chrono::steady_clock::duration, std::vector<uint8_t> & value) {
+        if (id == 0x000C)
+            value = {0x12, 0x34};
+    };
+
+    auto [tester, ecuCan] = network::LoopbackCan::createPair();
+    sim::VirtualEcu ecu(std::move(ecuCan), std::move(options));
+    ecu.start();
+
+    auto metrics = std::make_shared<network::LinkMetrics>();
+    network::IsoTpOptions isotpOptions;
+    isotpOptions.metrics = metrics;
+    network::IsoTpUds uds(std::make_unique<network::IsoTpCan>(
+        std::make_unique<network::MeteredCan>(std::move(tester), metrics), isotpOptions));
+    uds.setMetrics(metrics);
+
+    uds.readDataByIdentifier(0x000C);
+    CHECK_THROWS(uds.readDataByIdentifier(0x000D));
+
+    CHECK(metrics->udsRequests.value() == 2);
+    // The ECU only sends response pending before positive responses
+    CHECK(metrics->udsResponsePending.value() == 1);
+    // requestOutOfRange
+    CHECK(metrics->udsNegativeResponses[0x31].value() == 1);
+    CHECK(metrics->udsLatency.count() == 2);
+    CHECK(metrics->udsLatency.min() >= 2000);
+
+    CHECK(metrics->framesSent.value() == 2);
+    CHECK(metrics->framesReceived.value() == 3);
+    CHECK(metrics->bytesSent.value() == 16);
+    CHECK(metrics->framesDroppedOnReceive.value() == 0);
+
+    metrics->reset();
+    CHECK(metrics->udsRequests.value() == 0);
+    CHECK(metrics->udsLatency.count() == 0);
+}
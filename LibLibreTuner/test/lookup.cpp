@@ -0,0 +1,134 @@
+#include <catch2/catch.hpp>
+
+#include <lt/analysis/lookup.h>
+
+#include <cmath>
+#include <random>
+
+using namespace lt;
+
+TEST_CASE("Breakpoints locate intervals")
+{
+    Breakpoints points({500.0, 1000.0, 2000.0, 3000.0, 4500.0});
+    CHECK(points.size() == 5);
+
+    Breakpoints::Position pos = points.locate(1500.0);
+    CHECK(pos.index == 1);
+    CHECK(pos.weight == Approx(0.5));
+
+    pos = points.locate(2000.0);
+    CHECK(pos.index == 2);
+    CHECK(pos.weight == 0.0);
+
+    // Clamped to the ends
+    pos = points.locate(100.0);
+    CHECK(pos.index == 0);
+    CHECK(pos.weight == 0.0);
+    pos = points.locate(9000.0);
+    CHECK(pos.index == 3);
+    CHECK(pos.weight == 1.0);
+    pos = points.locate(NAN);
+    CHECK(pos.index == 0);
+    CHECK(pos.weight == 0.0);
+
+    SECTION("Descending breakpoints")
+    {
+        Breakpoints down({100.0, 50.0, 0.0});
+        CHECK(down[0] == 100.0);
+        pos = down.locate(75.0);
+        CHECK(pos.index == 0);
+        CHECK(pos.weight == Approx(0.5));
+        pos = down.locate(-10.0);
+        CHECK(pos.index == 1);
+        CHECK(pos.weight == 1.0);
+    }
+
+    CHECK_THROWS(Breakpoints({1.0, 2.0, 2.0}));
+    CHECK_THROWS(Breakpoints(std::vector<double>{}));
+    CHECK(Breakpoints({7.0}).locate(3.0).index == 0);
+}
+
+TEST_CASE("Table lookup matches a linear scan")
+{
+    std::vector<double> xs, ys;
+    for (int i = 0; i < 20; ++i)
+        xs.push_back(600.0 + i * i * 20.0);
+    for (int i = 0; i < 17; ++i)
+        ys.push_back(0.1 * i);
+    TableLookup lookup{Breakpoints(xs), Breakpoints(ys)};
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> rpm(0.0, 9000.0), load(-0.2, 2.0);
+    const std::size_t count = 100000;
+    std::vector<double> x(count), y(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        x[i] = rpm(rng);
+        y[i] = load(rng);
+    }
+
+    std::vector<CellLookup> cells(count);
+    JobPool pool(4);
+    lookup.locateParallel(x.data(), y.data(), cells.data(), count, pool);
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int column = 0;
+        while (column + 2 < static_cast<int>(xs.size()) && xs[column + 1] <= x[i])
+            ++column;
+        int row = 0;
+        while (row + 2 < static_cast<int>(ys.size()) && ys[row + 1] <= y[i])
+            ++row;
+        if (cells[i].column != column || cells[i].row != row || cells[i].columnWeight < 0.0f ||
+            cells[i].columnWeight > 1.0f)
+            ++mismatches;
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("Table lookup interpolates bilinearly")
+{
+    TableLookup lookup(Breakpoints({0.0, 10.0, 20.0}), Breakpoints({0.0, 1.0}));
+    // value = x + 100 * y
+    std::vector<double> values{0.0, 10.0, 20.0, 100.0, 110.0, 120.0};
+
+    CellLookup cell = lookup.locate(15.0, 0.25);
+    CHECK(cell.column == 1);
+    CHECK(cell.row == 0);
+    CHECK(cell.nearestColumn() == 1);
+    CHECK(lookup.interpolate(cell, values.data()) == Approx(40.0));
+
+    cell = lookup.locate(25.0, 3.0);
+    CHECK(lookup.interpolate(cell, values.data()) == Approx(120.0));
+    CHECK(cell.nearestRow() == 1);
+    CHECK(cell.nearestColumn() == 2);
+}
+
+TEST_CASE("Samples are aligned to the first PID")
+{
+    DataLog log;
+    Pid rpm{1, "RPM", "", "", "rpm"};
+    Pid load{2, "Load", "", "", ""};
+    log.addPid(rpm);
+    log.addPid(load);
+
+    for (std::size_t t = 0; t <= 100; t += 10)
+        log.add(rpm, PidLogEntry{static_cast<double>(t) * 10.0, t});
+    for (std::size_t t = 25; t <= 85; t += 20)
+        log.add(load, PidLogEntry{static_cast<double>(t), t});
+
+    AlignedSamples samples = alignSamples({log.pidLog(rpm), log.pidLog(load)});
+    // Only 30 to 80 are covered by both
+    REQUIRE(samples.size() == 6);
+    CHECK(samples.time.front() == 30);
+    CHECK(samples.time.back() == 80);
+    CHECK(samples.channels[0][0] == 300.0);
+    CHECK(samples.channels[1][0] == Approx(30.0));
+    CHECK(samples.channels[1][2] == Approx(50.0));
+
+    // Incremental alignment resumes at an entry of the first PID
+    AlignedSamples tail = alignSamples({log.pidLog(rpm), log.pidLog(load)}, 6);
+    REQUIRE(tail.size() == 3);
+    CHECK(tail.time.front() == 60);
+}
@@ -0,0 +1,40 @@
+#include <catch2/catch.hpp>
+
+#include <lt/buffer/memorybuffer.h>
+#include <lt/buffer/view.h>
+
+using namespace lt;
+
+TEST_CASE("MemoryBuffer records modified pages")
+{
+    MemoryBuffer buffer(std::vector<uint8_t>(1000));
+    CHECK_FALSE(buffer.dirty());
+    CHECK_FALSE(buffer.dirty(0, 1000));
+
+    View view = buffer.view();
+    // Crosses the boundary of the first two pages
+    view.set<uint32_t, Endianness::Big>(5, 254);
+    // Last byte of the partial last page
+    view.set<uint8_t, Endianness::Big>(5, 999);
+
+    CHECK(buffer.dirty());
+    CHECK(buffer.dirty(600, 200));
+    CHECK_FALSE(buffer.dirty(512, 256));
+    CHECK(buffer.dirty(0, 1));
+    CHECK(buffer.dirty(511, 1));
+    CHECK(buffer.dirty(999, 1));
+
+    buffer.clearDirty();
+    CHECK_FALSE(buffer.dirty());
+
+    SECTION("Ranges spanning bitmap words mark every page")
+    {
+        MemoryBuffer large(std::vector<uint8_t>(1 << 20));
+        large.markDirty(64 * MemoryBuffer::pageSize - 10, 300);
+        CHECK(large.dirty(63 * 256, 1));
+        CHECK(large.dirty(64 * 256, 1));
+        CHECK(large.dirty(65 * 256 + 255, 1));
+        CHECK_FALSE(large.dirty(62 * 256, 256));
+        CHECK_FALSE(large.dirty(66 * 256, 256));
+    }
+}
@@ -0,0 +1,123 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/can/replaycan.h>
+
+#include <algorithm>
+#include <thread>
+
+using namespace lt::network;
+using namespace std::chrono_literals;
+
+namespace
+{
+CanLogEntry entry(CanMessageDirection direction, uint32_t id, uint8_t value, std::chrono::microseconds time)
+{
+    uint8_t data[2] = {0x01, value};
+    return CanLogEntry{direction, CanMessage(id, data, 2), time};
+}
+
+// Inbound frames every 20 ms with an outbound frame between each pair
+std::vector<CanLogEntry> recording(uint8_t count)
+{
+    std::vector<CanLogEntry> entries;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        entries.push_back(entry(CanMessageDirection::Outbound, 0x7E0, i, std::chrono::milliseconds(i * 20 + 5)));
+        entries.push_back(entry(CanMessageDirection::Inbound, 0x7E8, i, std::chrono::milliseconds(i * 20 + 10)));
+    }
+    return entries;
+}
+} // namespace
+
+TEST_CASE("Timed replay follows the recorded timeline")
+{
+    using Clock = std::chrono::steady_clock;
+    ReplayCan can(recording(5), ReplayMode::Timed, 2.0);
+
+    Clock::time_point start = Clock::now();
+    CanMessage message;
+    for (uint8_t i = 0; i < 5; ++i)
+    {
+        REQUIRE(can.recv(message, 1s));
+        CHECK(message.id() == 0x7E8);
+        CHECK(message.message()[1] == i);
+        // Twice as fast, relative to the first frame in the recording
+        CHECK(Clock::now() - start >= std::chrono::milliseconds(i * 10));
+    }
+    CHECK(can.finished());
+    CHECK_FALSE(can.recv(message, 10ms));
+}
+
+TEST_CASE("Timed replay keeps frames that were not due before the timeout")
+{
+    ReplayCan can(recording(3), ReplayMode::Timed, 0.5);
+    CanMessage message;
+    REQUIRE(can.recv(message, 1s));
+
+    // The next frame is due 40 ms after the first
+    CHECK_FALSE(can.recv(message, 5ms));
+    REQUIRE(can.recv(message, 1s));
+    CHECK(message.message()[1] == 1);
+    CHECK_FALSE(can.finished());
+}
+
+TEST_CASE("Timed replay without delays plays every frame at once")
+{
+    ReplayCan can(recording(50), ReplayMode::Timed, 0.0);
+    CanMessage message;
+    for (uint8_t i = 0; i < 50; ++i)
+    {
+        REQUIRE(can.recv(message, 0ms));
+        CHECK(message.message()[1] == i);
+    }
+    CHECK(can.finished());
+}
+
+TEST_CASE("Timed replay hands each frame to one receiver")
+{
+    ReplayCan can(recording(40), ReplayMode::Timed, 10.0);
+    std::vector<int> seen[2];
+    std::vector<std::thread> threads;
+    for (auto & out : seen)
+    {
+        threads.emplace_back([&can, &out]() {
+            CanMessage message;
+            while (can.recv(message, 200ms))
+                out.push_back(message.message()[1]);
+        });
+    }
+
+    // The receivers sleep without holding the lock
+    std::this_thread::sleep_for(5ms);
+    auto before = std::chrono::steady_clock::now();
+    can.clearBuffer();
+    CHECK(std::chrono::steady_clock::now() - before < 20ms);
+
+    for (std::thread & thread : threads)
+        thread.join();
+
+    std::vector<int> all = seen[0];
+    all.insert(all.end(), seen[1].begin(), seen[1].end());
+    std::sort(all.begin(), all.end());
+    REQUIRE(all.size() == 40);
+    for (int i = 0; i < 40; ++i)
+        CHECK(all[i] == i);
+}
+
+TEST_CASE("Respond replay answers matching requests")
+{
+    ReplayCan can(recording(3), ReplayMode::Respond, 0.0);
+    CanMessage message;
+    CHECK_FALSE(can.recv(message, 0ms));
+
+    uint8_t request[2] = {0x01, 2};
+    can.send(CanMessage(0x7E0, request, 2));
+    REQUIRE(can.recv(message, 0ms));
+    CHECK(message.id() == 0x7E8);
+    CHECK(message.message()[1] == 2);
+    CHECK_FALSE(can.recv(message, 0ms));
+
+    uint8_t unknown[2] = {0x3E, 0};
+    can.send(CanMessage(0x7E0, unknown, 2));
+    CHECK(can.unmatched() == 1);
+}
@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include <lt/buffer/memorybuffer.h>
+#include <lt/buffer/view.h>
+#include <lt/rom/table.h>
+
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+Table makeTable(MemoryBuffer & buffer, DataType type, int offset, int width, int height, double scale = 1.0)
+{
+    int size = width * height * static_cast<int>(dataTypeSize(type));
+    Table::Builder builder;
+    builder.setSize(width, height)
+        .setScale(scale)
+        .setBounds(0.0, 1000.0)
+        .setEntries(create_entries<double, Endianness::Big>(type, buffer.view(offset, size)));
+    return builder.build();
+}
+} // namespace
+
+TEST_CASE("Table regions read and write presented values")
+{
+    MemoryBuffer buffer(std::vector<uint8_t>(512, 0));
+    Table table = makeTable(buffer, DataType::Uint16, 0, 4, 4, 0.5);
+
+    std::vector<double> values{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    table.setRegion(Table::Region{1, 1, 2, 3}, values.data());
+    CHECK(table.getRegion(Table::Region{1, 1, 2, 3}) == values);
+    CHECK(table.get(2, 3) == 6.0);
+    CHECK(buffer[(1 * 4 + 1) * 2 + 1] == 2);
+    CHECK(table.dirty());
+
+    // Values are clamped to the table bounds
+    table.fill(Table::Region{0, 0, 1, 2}, 5000.0);
+    CHECK(table.get(0, 1) == 1000.0);
+    table.add(Table::Region{0, 0, 1, 2}, -2000.0);
+    CHECK(table.get(0, 0) == 0.0);
+
+    CHECK_THROWS(table.getRegion(Table::Region{3, 0, 2, 1}));
+    CHECK(table.clip(Table::Region{3, -1, 2, 3}) == Table::Region{3, 0, 1, 2});
+}
+
+TEST_CASE("Table region writes are batched")
+{
+    MemoryBuffer buffer(std::vector<uint8_t>(32 * 32 * 4, 0));
+    int writes = 0;
+    buffer.setWriteObserver([&](int, const uint8_t *, const uint8_t *, int) { ++writes; });
+    Table table = makeTable(buffer, DataType::Float, 0, 32, 32);
+
+    table.fill(table.region(), 2.0);
+    CHECK(writes == 1);
+
+    table.multiply(Table::Region{4, 4, 8, 8}, 1.5);
+    CHECK(writes == 9);
+    CHECK(table.get(4, 4) == 3.0);
+    CHECK(table.get(11, 11) == 3.0);
+    CHECK(table.get(12, 11) == 2.0);
+}
+
+TEST_CASE("Table interpolation and smoothing")
+{
+    MemoryBuffer buffer(std::vector<uint8_t>(256, 0));
+    Table table = makeTable(buffer, DataType::Float, 0, 5, 5);
+
+    table.set(0, 0, 0.0);
+    table.set(0, 4, 40.0);
+    table.set(4, 0, 80.0);
+    table.set(4, 4, 120.0);
+    table.interpolate(table.region());
+    CHECK(table.get(0, 2) == Approx(20.0));
+    CHECK(table.get(2, 0) == Approx(40.0));
+    CHECK(table.get(2, 2) == Approx(60.0));
+
+    SECTION("A single row is interpolated linearly")
+    {
+        table.set(1, 0, 10.0);
+        table.set(1, 4, 10.0);
+        table.interpolate(Table::Region{1, 0, 1, 5});
+        CHECK(table.get(1, 2) == Approx(10.0));
+    }
+
+    SECTION("Smoothing keeps a plane and flattens a spike")
+    {
+        table.smooth(table.region(), 0.5);
+        // Symmetric weights preserve linear data away from the edges
+        CHECK(table.get(2, 2) == Approx(60.0));
+
+        table.fill(table.region(), 0.0);
+        table.set(2, 2, 100.0);
+        table.smooth(table.region(), 1.0);
+        CHECK(table.get(2, 2) < 100.0);
+        CHECK(table.get(2, 3) > 0.0);
+        CHECK(table.get(2, 3) == Approx(table.get(3, 2)));
+    }
+}
+
+TEST_CASE("Tables copy between data types")
+{
+    MemoryBuffer buffer(std::vector<uint8_t>(256, 0));
+    Table source = makeTable(buffer, DataType::Float, 0, 3, 3);
+    Table dest = makeTable(buffer, DataType::Uint8, 64, 4, 4, 0.1);
+
+    std::vector<double> values{1.26, 2.5, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0};
+    source.setRegion(source.region(), values.data());
+
+    // The bottom right corner falls outside the destination
+    dest.copy(source, source.region(), 2, 2);
+    CHECK(dest.get(2, 2) == Approx(1.3));
+    CHECK(dest.get(2, 3) == Approx(2.5));
+    CHECK(dest.get(3, 3) == Approx(5.0));
+    CHECK(dest.get(1, 1) == 0.0);
+    CHECK(buffer[64 + 2 * 4 + 2] == 13);
+}
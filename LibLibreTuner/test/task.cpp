@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+#include <lt/support/task.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace lt;
+
+namespace
+{
+Task<int> value(int v, int & runs)
+{
+    ++runs;
+    co_return v;
+}
+
+Task<int> sum(int count, int & runs)
+{
+    int total = 0;
+    for (int i = 0; i < count; ++i)
+        total += co_await value(i, runs);
+    co_return total;
+}
+
+Task<std::string> fail(const char * message)
+{
+    throw std::runtime_error(message);
+    co_return "";
+}
+
+Task<int> failNested()
+{
+    std::string s = co_await fail("inner");
+    co_return static_cast<int>(s.size());
+}
+
+Task<> recover(std::string & caught)
+{
+    try
+    {
+        co_await fail("caught");
+    }
+    catch (const std::runtime_error & e)
+    {
+        caught = e.what();
+    }
+}
+
+// Suspends and resumes from another thread
+struct ResumeOnThread
+{
+    std::thread * thread;
+
+    inline bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        *thread = std::thread([handle]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            handle.resume();
+        });
+    }
+    inline void await_resume() const noexcept {}
+};
+
+Task<std::thread::id> resumeElsewhere(std::thread & thread)
+{
+    co_await ResumeOnThread{&thread};
+    co_return std::this_thread::get_id();
+}
+} // namespace
+
+TEST_CASE("Tasks run when awaited")
+{
+    int runs = 0;
+
+    SECTION("Results are returned through syncWait")
+    {
+        CHECK(syncWait(value(7, runs)) == 7);
+        CHECK(syncWait(sum(100, runs)) == 4950);
+        CHECK(runs == 101);
+    }
+
+    SECTION("Tasks that are never awaited never run")
+    {
+        {
+            Task<int> task = value(1, runs);
+            CHECK(task.valid());
+            Task<int> moved = std::move(task);
+            CHECK_FALSE(task.valid());
+        }
+        CHECK(runs == 0);
+    }
+}
+
+TEST_CASE("Task exceptions propagate to the awaiter")
+{
+    CHECK_THROWS_WITH(syncWait(fail("direct")), "direct");
+    CHECK_THROWS_WITH(syncWait(failNested()), "inner");
+
+    std::string caught;
+    syncWait(recover(caught));
+    CHECK(caught == "caught");
+}
+
+TEST_CASE("syncWait blocks until a task resumed elsewhere finishes")
+{
+    std::thread thread;
+    std::thread::id resumedOn = syncWait(resumeElsewhere(thread));
+    std::thread::id other = thread.get_id();
+    thread.join();
+    CHECK(resumedOn == other);
+    CHECK(resumedOn != std::this_thread::get_id());
+}
@@ -0,0 +1,84 @@
+#include <catch2/catch.hpp>
+
+#include <lt/support/trace.h>
+
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+using namespace lt;
+
+TEST_CASE("Trace events are exported as Chrome trace JSON")
+{
+    trace::clear();
+    {
+        trace::Span span("test.outer");
+        trace::counter("test.counter", 42);
+    }
+    std::thread([]() { trace::Span span("test.thread"); }).join();
+
+    trace::setEnabled(false);
+    {
+        trace::Span span("test.disabled");
+    }
+    trace::setEnabled(true);
+
+    std::stringstream ss;
+    trace::writeChromeTrace(ss);
+    std::string json = ss.str();
+
+    CHECK(json.find("\"traceEvents\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"test.outer\"") != std::string::npos);
+    CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"value\":42}") != std::string::npos);
+    CHECK(json.find("\"name\":\"test.thread\"") != std::string::npos);
+    CHECK(json.find("test.disabled") == std::string::npos);
+    CHECK(trace::dropped() == 0);
+}
+
+TEST_CASE("Async spans may end on another thread")
+{
+    trace::clear();
+    auto first = std::make_unique<trace::AsyncSpan>("test.async");
+    auto second = std::make_unique<trace::AsyncSpan>("test.async");
+    // Ended by the thread that resumes the coroutine
+    std::thread([&]() { first.reset(); }).join();
+    second.reset();
+
+    std::stringstream ss;
+    trace::writeChromeTrace(ss);
+
+    struct Found
+    {
+        std::string tid;
+        std::string phase;
+        std::string id;
+    };
+    std::vector<Found> events;
+    std::regex pattern(R"re("name":"test\.async","pid":1,"tid":(\d+),.*"ph":"([be])","cat":"async","id":(\d+))re");
+    for (std::string line; std::getline(ss, line);)
+    {
+        std::smatch match;
+        if (std::regex_search(line, match, pattern))
+            events.push_back(Found{match[1], match[2], match[3]});
+    }
+
+    REQUIRE(events.size() == 4);
+    auto find = [&](const std::string & phase, const std::string & id) {
+        return std::find_if(events.begin(), events.end(),
+                            [&](const Found & f) { return f.phase == phase && f.id == id; });
+    };
+    for (const Found & begin : events)
+    {
+        if (begin.phase != "b")
+            continue;
+        auto end = find("e", begin.id);
+        REQUIRE(end != events.end());
+        if (begin.id == events.front().id)
+            CHECK(end->tid != begin.tid);
+        else
+            CHECK(end->tid == begin.tid);
+    }
+    CHECK(events[0].id != events[1].id);
+}
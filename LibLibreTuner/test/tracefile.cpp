@@ -0,0 +1,136 @@
+#include <catch2/catch.hpp>
+
+#include <lt/network/can/asc.h>
+#include <lt/network/can/candump.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace lt::network;
+
+namespace
+{
+// A standard id, a short id in the extended format and a 29-bit id
+std::vector<CanLogEntry> sampleEntries()
+{
+    std::vector<CanLogEntry> entries;
+    const uint8_t data[8] = {0x02, 0x10, 0x03, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE};
+    for (uint32_t i = 0; i < 30; ++i)
+    {
+        CanLogEntry entry{i % 2 == 0 ? CanMessageDirection::Outbound : CanMessageDirection::Inbound,
+                          CanMessage(0, data, static_cast<uint8_t>(i % 9)), std::chrono::microseconds(i * 1500 + 7)};
+        switch (i % 3)
+        {
+        case 0:
+            entry.message.setId(0x7E0 + i % 2 * 8);
+            break;
+        case 1:
+            entry.message.setId(0x123);
+            entry.message.setExtended(true);
+            break;
+        default:
+            entry.message.setId(0x18DA10F1);
+            break;
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+template <typename Reader> std::vector<CanLogEntry> readAll(Reader && reader)
+{
+    std::vector<CanLogEntry> entries;
+    CanLogEntry entry;
+    while (reader.next(entry))
+        entries.push_back(entry);
+    return entries;
+}
+
+std::string readFile(const std::filesystem::path & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+void checkEqual(const std::vector<CanLogEntry> & read, const std::vector<CanLogEntry> & written,
+                bool checkDirection)
+{
+    REQUIRE(read.size() == written.size());
+    for (std::size_t i = 0; i < read.size(); ++i)
+    {
+        CAPTURE(i);
+        CHECK(read[i].message.id() == written[i].message.id());
+        CHECK(read[i].message.extended() == written[i].message.extended());
+        REQUIRE(read[i].message.length() == written[i].message.length());
+        CHECK(std::equal(read[i].message.message(), read[i].message.message() + read[i].message.length(),
+                         written[i].message.message()));
+        // Relative to the first frame
+        CHECK(read[i].time - read[0].time == written[i].time - written[0].time);
+        if (checkDirection)
+            CHECK(read[i].direction == written[i].direction);
+    }
+}
+} // namespace
+
+TEST_CASE("candump logs round trip")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_roundtrip.log";
+    std::vector<CanLogEntry> entries = sampleEntries();
+    {
+        CandumpWriter writer(path, "vcan0");
+        for (const CanLogEntry & entry : entries)
+            writer.write(entry);
+        writer.close();
+    }
+
+    std::string text = readFile(path);
+    CHECK(text.find("vcan0 7E0#") != std::string::npos);
+    CHECK(text.find("vcan0 00000123#") != std::string::npos);
+    CHECK(text.find("vcan0 18DA10F1#") != std::string::npos);
+
+    // candump has no direction, so it comes from the outbound id list
+    std::vector<CanLogEntry> read = readAll(CandumpReader(path, {0x7E0}));
+    checkEqual(read, entries, false);
+    for (const CanLogEntry & entry : read)
+        CHECK((entry.direction == CanMessageDirection::Outbound) == (entry.message.id() == 0x7E0));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("ASC logs round trip")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_roundtrip.asc";
+    std::vector<CanLogEntry> entries = sampleEntries();
+    {
+        AscWriter writer(path);
+        for (const CanLogEntry & entry : entries)
+            writer.write(entry);
+        writer.close();
+    }
+
+    std::string text = readFile(path);
+    CHECK(text.find(" 7E0  ") != std::string::npos);
+    CHECK(text.find(" 123x ") != std::string::npos);
+    CHECK(text.find(" 18DA10F1x ") != std::string::npos);
+
+    checkEqual(readAll(AscReader(path)), entries, true);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("ASC logs with decimal ids are read")
+{
+    std::string text = "date Mon Jan 01 00:00:00.000 2024\n"
+                       "base dec  timestamps absolute\n"
+                       "   0.001000 1  2016             Tx   d 2 1 255\n"
+                       "   0.002000 1  291x             Rx   d 1 16\n";
+    std::vector<CanLogEntry> read = readAll(AscReader(std::string_view(text)));
+    REQUIRE(read.size() == 2);
+    CHECK(read[0].message.id() == 0x7E0);
+    CHECK_FALSE(read[0].message.extended());
+    CHECK(read[0].message[1] == 0xFF);
+    CHECK(read[1].message.id() == 0x123);
+    CHECK(read[1].message.extended());
+    CHECK(read[1].direction == CanMessageDirection::Inbound);
+}
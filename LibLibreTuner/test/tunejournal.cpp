@@ -0,0 +1,89 @@
+#include <catch2/catch.hpp>
+
+#include <lt/rom/tunejournal.h>
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace lt;
+using namespace std::chrono_literals;
+
+TEST_CASE("Tune journal recovers synced edits")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test.ltt.journal";
+    std::filesystem::remove(path);
+
+    const uint8_t before[4] = {0, 0, 0, 0};
+    const uint8_t after[4] = {1, 2, 3, 4};
+    {
+        TuneJournal journal(path, 0x1234, 1024);
+        CHECK(journal.recovered().empty());
+        journal.append(16, before, after, 4);
+        journal.append(1020, before, after, 4);
+        journal.sync();
+        CHECK(journal.count() == 2);
+    }
+
+    // A record torn by a crash
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        const char torn[6] = {8, 0, 0, 0, 4, 0};
+        file.write(torn, sizeof(torn));
+    }
+
+    {
+        TuneJournal journal(path, 0x1234, 1024);
+        REQUIRE(journal.recovered().size() == 2);
+        CHECK(journal.recovered()[0].offset == 16);
+        CHECK(journal.recovered()[0].before == std::vector<uint8_t>(before, before + 4));
+        CHECK(journal.recovered()[1].after == std::vector<uint8_t>(after, after + 4));
+
+        // New edits follow the valid records
+        journal.append(0, before, after, 2);
+    }
+    {
+        TuneJournal journal(path, 0x1234, 1024);
+        CHECK(journal.recovered().size() == 3);
+    }
+
+    SECTION("Edits against other data are discarded")
+    {
+        TuneJournal journal(path, 0x5678, 1024);
+        CHECK(journal.recovered().empty());
+    }
+
+    SECTION("Reset journals are removed")
+    {
+        {
+            TuneJournal journal(path, 0x1234, 1024);
+            journal.reset(0x5678, 1024);
+            CHECK(journal.count() == 0);
+        }
+        CHECK_FALSE(std::filesystem::exists(path));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Tune journal syncs with nothing queued do not flush later edits early")
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lt_test_idle.ltt.journal";
+    std::filesystem::remove(path);
+
+    const uint8_t before[4] = {0, 0, 0, 0};
+    const uint8_t after[4] = {1, 2, 3, 4};
+    {
+        TuneJournal journal(path, 0x1234, 1024, 10s);
+        journal.sync();
+        journal.append(0, before, after, 4);
+        std::this_thread::sleep_for(50ms);
+        // Still waiting for the sync interval
+        CHECK(std::filesystem::file_size(path) == TuneJournal::headerSize);
+
+        journal.sync();
+        CHECK(std::filesystem::file_size(path) == TuneJournal::headerSize + 20);
+    }
+
+    std::filesystem::remove(path);
+}
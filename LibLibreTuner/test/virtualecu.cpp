@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include <lt/diagnostics/uds.h>
+#include <lt/download/rmadownloader.h>
+#include <lt/flash/mazdat1.h>
+#include <lt/network/can/loopbackcan.h>
+#include <lt/network/isotp/isotpcan.h>
+#include <lt/network/uds/isotpuds.h>
+#include <lt/sim/virtualecu.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+constexpr const char * key = "MazdA";
+
+// Starts an ECU on a loopback bus and returns a UDS interface for the tester
+network::UdsPtr connect(sim::VirtualEcuOptions options, std::unique_ptr<sim::VirtualEcu> & ecu)
+{
+    auto [tester, ecuCan] = network::LoopbackCan::createPair();
+    ecu = std::make_unique<sim::VirtualEcu>(std::move(ecuCan), std::move(options));
+    ecu->start();
+
+    network::IsoTpOptions isotpOptions;
+    isotpOptions.timeout = std::chrono::milliseconds(2000);
+    return std::make_unique<network::IsoTpUds>(std::make_unique<network::IsoTpCan>(std::move(tester), isotpOptions));
+}
+
+std::vector<uint8_t> pattern(std::size_t size)
+{
+    std::vector<uint8_t> data(size);
+    std::iota(data.begin(), data.end(), uint8_t{0});
+    return data;
+}
+} // namespace
+
+TEST_CASE("Virtual ECU serves downloads and flashes")
+{
+    sim::VirtualEcuOptions options;
+    options.auth.key = key;
+    options.image = pattern(20000);
+    options.responsePending = true;
+    options.serviceLatency[0xB1] = std::chrono::milliseconds(5);
+
+    std::unique_ptr<sim::VirtualEcu> ecu;
+
+    SECTION("RMADownloader reads the whole image")
+    {
+        download::Options downloadOptions{{key}, options.image.size()};
+        download::RMADownloader downloader(connect(options, ecu), std::move(downloadOptions));
+        REQUIRE(downloader.download());
+
+        auto [data, size] = downloader.data();
+        CHECK(std::vector<uint8_t>(data, data + size) == options.image);
+    }
+
+    SECTION("MazdaT1Flasher writes an image")
+    {
+        std::vector<uint8_t> flash(10000, 0x5A);
+        MazdaT1Flasher flasher(connect(options, ecu), FlashOptions{{key}});
+        REQUIRE(flasher.flash(FlashMap(flash, 0x1000)));
+
+        std::vector<uint8_t> image = ecu->image();
+        CHECK(std::equal(flash.begin(), flash.end(), image.begin() + 0x1000));
+        // The rest was erased
+        CHECK(image[0] == 0xFF);
+        CHECK(image.back() == 0xFF);
+    }
+
+    SECTION("Wrong keys are rejected")
+    {
+        download::Options downloadOptions{{"wrong"}, options.image.size()};
+        download::RMADownloader downloader(connect(options, ecu), std::move(downloadOptions));
+        CHECK_THROWS(downloader.download());
+    }
+}
+
+TEST_CASE("Virtual ECU serves live data and codes")
+{
+    sim::VirtualEcuOptions options;
+    options.dtcs = {0x0301, 0x0420};
+    options.pendingDtcs = {0x0171};
+    options.didSource = [](uint16_t id, std::chrono::steady_clock::duration, std::vector<uint8_t> & value) {
+        if (id == 0x000C)
+            value = {0x12, 0x34};
+    };
+
+    std::unique_ptr<sim::VirtualEcu> ecu;
+    network::UdsPtr uds = connect(options, ecu);
+
+    CHECK(uds->readDataByIdentifier(0x000C) == std::vector<uint8_t>{0x00, 0x0C, 0x12, 0x34});
+    CHECK_THROWS(uds->readDataByIdentifier(0x000D));
+
+    UdsDtcScanner scanner(std::move(uds));
+    DiagnosticCodes codes = scanner.scan();
+    REQUIRE(codes.size() == 2);
+    CHECK(codes[0].code == 0x0301);
+    CHECK(codes[1].code == 0x0420);
+    REQUIRE(scanner.scanPending().size() == 1);
+}
@@ -0,0 +1,119 @@
+// Runs a virtual ECU on a SocketCAN interface. A vcan interface lets the
+// downloader, flasher and loggers run against it on any Linux machine:
+//
+//   ip link add dev vcan0 type vcan && ip link set up vcan0
+//   lt_virtualecu vcan0 --key <key> --image rom.bin
+
+#include <lt/network/can/socketcan.h>
+#include <lt/sim/virtualecu.h>
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace
+{
+std::atomic<bool> interrupted{false};
+
+void usage()
+{
+    std::cerr << "Usage: lt_virtualecu <interface> [options]\n"
+                 "  --key <key>          security access key\n"
+                 "  --session <n>        session required for security access (default 0x87)\n"
+                 "  --image <file>       flash image\n"
+                 "  --size <bytes>       size of the blank image used without --image (default 1 MiB)\n"
+                 "  --base <address>     address of the image (default 0)\n"
+                 "  --latency <us>       delay before every response\n"
+                 "  --erase-latency <us> delay before erase responses\n"
+                 "  --pending            send response pending before delayed responses\n";
+}
+
+std::vector<uint8_t> readImage(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("failed to open " + path);
+    }
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    if (argc < 2)
+    {
+        usage();
+        return 1;
+    }
+
+    lt::sim::VirtualEcuOptions options;
+    std::size_t size = 1024 * 1024;
+    try
+    {
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--pending")
+            {
+                options.responsePending = true;
+                continue;
+            }
+            if (i + 1 == argc)
+            {
+                usage();
+                return 1;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--key")
+                options.auth.key = value;
+            else if (arg == "--session")
+                options.auth.session = static_cast<uint8_t>(std::stoul(value, nullptr, 0));
+            else if (arg == "--image")
+                options.image = readImage(value);
+            else if (arg == "--size")
+                size = std::stoul(value, nullptr, 0);
+            else if (arg == "--base")
+                options.baseAddress = static_cast<uint32_t>(std::stoul(value, nullptr, 0));
+            else if (arg == "--latency")
+                options.latency = std::chrono::microseconds(std::stol(value));
+            else if (arg == "--erase-latency")
+                options.serviceLatency[0xB1] = std::chrono::microseconds(std::stol(value));
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+
+        if (options.image.empty())
+        {
+            options.image.assign(size, 0xFF);
+        }
+
+        lt::sim::VirtualEcu ecu(std::make_unique<lt::network::SocketCan>(argv[1]), std::move(options));
+        std::signal(SIGINT, [](int) { interrupted = true; });
+        std::signal(SIGTERM, [](int) { interrupted = true; });
+
+        ecu.start();
+        std::cout << "Virtual ECU running on " << argv[1] << std::endl;
+        while (!interrupted)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        ecu.stop();
+        std::cout << "Answered " << ecu.requests() << " requests" << std::endl;
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
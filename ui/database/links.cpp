@@ -15,6 +15,7 @@
 
 #include <QString>
 #include <lt/link/elm.h>
+#include <lt/link/replay.h>
 
 struct LinkData
 {
@@ -24,6 +25,13 @@ struct LinkData
     int baudrate;
 };
 
+// Settings added after the original format. Saved as a second list after
+// the links so older files still load.
+struct LinkOptions
+{
+    double speed{1.0};
+};
+
 namespace serialize
 {
 template <typename D> void deserialize(D & d, LinkData & link)
@@ -41,6 +49,16 @@ template <typename S> void serialize(S & s, const LinkData & link)
     s.serialize(link.port);
     s.serialize(link.baudrate);
 }
+
+template <typename D> void deserialize(D & d, LinkOptions & options)
+{
+    d.deserialize(options.speed);
+}
+
+template <typename S> void serialize(S & s, const LinkOptions & options)
+{
+    s.serialize(options.speed);
+}
 } // namespace serialize
 
 void Links::load()
@@ -65,8 +83,16 @@ void Links::load()
         des(buffer);
     des.load(links);
 
-    for (const LinkData & link : links)
+    std::vector<LinkOptions> options;
+    if (!des.atEnd())
     {
+        des.load(options);
+    }
+    options.resize(links.size());
+
+    for (std::size_t i = 0; i < links.size(); ++i)
+    {
+        const LinkData & link = links[i];
         if (link.type == "socketcan")
         {
 #ifdef WITH_SOCKETCAN
@@ -82,6 +108,12 @@ void Links::load()
             manualLinks_.emplace_back(std::make_unique<lt::ElmDataLink>(
                 link.name, link.port, link.baudrate));
         }
+        else if (link.type == "replay")
+        {
+            manualLinks_.emplace_back(
+                std::make_unique<lt::ReplayDataLink>(link.name, link.port));
+            manualLinks_.back()->setSpeed(options[i].speed);
+        }
         else
         {
             throw std::runtime_error("Unknown datalink type: " + link.type);
@@ -98,6 +130,7 @@ void Links::save() const
 
     // Save manual links
     std::vector<LinkData> links;
+    std::vector<LinkOptions> options;
     for (const lt::DataLinkPtr & link : manualLinks_)
     {
         std::string type;
@@ -109,18 +142,24 @@ void Links::save() const
         {
             type = "elm";
         }
+        else if (link->type() == lt::DataLinkType::Replay)
+        {
+            type = "replay";
+        }
         LinkData data;
         data.type = type;
         data.name = link->name();
         data.port = link->port();
         data.baudrate = link->baudrate();
         links.emplace_back(std::move(data));
+        options.push_back(LinkOptions{link->speed()});
     }
 
     std::vector<char> buffer;
     serialize::Serializer<serialize::OutputBufferAdapter<std::vector<char>>>
         ser(buffer);
     ser.save(links);
+    ser.save(options);
 
     std::ofstream file(path_, std::ios::binary | std::ios::out);
     file.write(buffer.data(), buffer.size());
@@ -249,6 +288,8 @@ QString typeToString(lt::DataLinkType type)
         return "SocketCAN";
     case lt::DataLinkType::Elm:
         return "ELM327/ST";
+    case lt::DataLinkType::Replay:
+        return QObject::tr("Replay");
     default:
         return QObject::tr("Invalid");
     }
@@ -206,7 +206,9 @@ lt::PlatformLink LibreTuner::platformLink() const
     if (!currentPlatform_)
         throw std::runtime_error("no platform is selected");
 
-    return lt::PlatformLink(*currentDatalink_, *currentPlatform_);
+    lt::PlatformLink link(*currentDatalink_, *currentPlatform_);
+    link.setCanLog(canLog_);
+    return link;
 }
 
 lt::ProjectPtr LibreTuner::openProject(const std::filesystem::path & path)
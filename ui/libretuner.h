@@ -31,7 +31,9 @@
 #include "database/links.h"
 #include "database/projects.h"
 
+#include <lt/datalog/datalog.h>
 #include <lt/link/platformlink.h>
+#include <lt/network/can/canlog.h>
 #include <lt/project/project.h>
 
 #include <filesystem>
@@ -87,6 +89,13 @@ public:
 
     lt::PlatformLink platformLink() const;
 
+    /* Returns the log of CAN frames sent and received by platform links */
+    const lt::network::CanLogPtr & canLog() const noexcept { return canLog_; }
+
+    /* Returns the log open in the data logger or nullptr if there is none */
+    const lt::DataLogPtr & dataLog() const noexcept { return dataLog_; }
+    void setDataLog(lt::DataLogPtr log) { dataLog_ = std::move(log); }
+
 private:
     std::filesystem::path rootPath_;
     lt::Platforms platforms_;
@@ -97,11 +106,11 @@ private:
     lt::DataLink * currentDatalink_{nullptr};
     lt::PlatformPtr currentPlatform_;
 
+    lt::network::CanLogPtr canLog_{std::make_shared<lt::network::CanLog>()};
+    lt::DataLogPtr dataLog_;
+
     // Legacy stuff
 public:
-    /* Returns the CAN log. */
-    // CanLog *canLog() { return &canLog_; }
-
     /* Checks if the home directory exists and if it does not,
      * creates it. */
     // void checkHome();
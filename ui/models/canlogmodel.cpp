@@ -0,0 +1,244 @@
+#include "canlogmodel.h"
+
+#include "lt/support/hex.h"
+
+#include <algorithm>
+
+namespace
+{
+// Entries read from the log at a time when building the index
+constexpr std::size_t SliceSize = 4096;
+} // namespace
+
+CanLogModel::CanLogModel(QObject * parent) : QAbstractTableModel(parent)
+{
+    timer_.setInterval(UpdateInterval);
+    connect(&timer_, &QTimer::timeout, this, &CanLogModel::update);
+}
+
+void CanLogModel::setLog(lt::network::CanLogPtr log)
+{
+    beginResetModel();
+    log_ = std::move(log);
+    index_.clear();
+    cachedSequence_ = UINT64_MAX;
+    hasEpoch_ = false;
+    first_ = end_ = log_ ? log_->firstSequence() : 0;
+    endResetModel();
+
+    if (log_)
+    {
+        update();
+        timer_.start();
+    }
+    else
+    {
+        timer_.stop();
+    }
+}
+
+void CanLogModel::setFilter(CanLogFilter filter)
+{
+    filter_ = std::move(filter);
+    standardIds_.reset();
+    extendedIds_.clear();
+    for (uint32_t id : filter_.ids)
+    {
+        if (id < standardIds_.size())
+            standardIds_.set(id);
+        else
+            extendedIds_.push_back(id);
+    }
+    std::sort(extendedIds_.begin(), extendedIds_.end());
+
+    beginResetModel();
+    rebuildIndex();
+    endResetModel();
+}
+
+bool CanLogModel::matches(const lt::network::CanLogEntry & entry) const noexcept
+{
+    if (!(entry.direction == lt::network::CanMessageDirection::Inbound ? filter_.inbound : filter_.outbound))
+        return false;
+    if (filter_.ids.empty())
+        return true;
+
+    uint32_t id = entry.message.id();
+    if (id < standardIds_.size())
+        return standardIds_.test(id);
+    return std::binary_search(extendedIds_.begin(), extendedIds_.end(), id);
+}
+
+void CanLogModel::rebuildIndex()
+{
+    index_.clear();
+    if (!log_ || !filter_.active())
+        return;
+
+    scan(first_, end_, index_);
+}
+
+template <typename Container> void CanLogModel::scan(uint64_t begin, uint64_t end, Container & out)
+{
+    std::vector<lt::network::CanLogEntry> entries;
+    for (uint64_t sequence = begin; sequence < end; sequence += SliceSize)
+    {
+        uint64_t entrySequence = log_->entries(
+            sequence, static_cast<std::size_t>(std::min<uint64_t>(SliceSize, end - sequence)), entries);
+        for (const lt::network::CanLogEntry & entry : entries)
+        {
+            if (matches(entry))
+                out.push_back(entrySequence);
+            ++entrySequence;
+        }
+    }
+}
+
+void CanLogModel::update()
+{
+    if (!log_)
+        return;
+
+    uint64_t total = log_->total();
+    uint64_t firstAvailable = log_->firstSequence();
+    bool filtered = filter_.active();
+
+    // Remove rows whose entries were dropped from the log
+    if (firstAvailable > first_)
+    {
+        int removed = 0;
+        if (filtered)
+        {
+            removed = static_cast<int>(
+                std::lower_bound(index_.begin(), index_.end(), firstAvailable) - index_.begin());
+        }
+        else
+        {
+            removed = static_cast<int>(std::min(firstAvailable, end_) - first_);
+        }
+
+        if (removed > 0)
+            beginRemoveRows(QModelIndex(), 0, removed - 1);
+        if (filtered)
+            index_.erase(index_.begin(), index_.begin() + removed);
+        first_ = firstAvailable;
+        end_ = std::max(end_, first_);
+        if (removed > 0)
+            endRemoveRows();
+    }
+
+    if (total <= end_)
+        return;
+
+    if (!hasEpoch_ && log_->get(end_, cachedEntry_))
+    {
+        epoch_ = cachedEntry_.time;
+        hasEpoch_ = true;
+        cachedSequence_ = end_;
+    }
+
+    int rows = rowCount(QModelIndex());
+    if (!filtered)
+    {
+        beginInsertRows(QModelIndex(), rows, rows + static_cast<int>(total - end_) - 1);
+        end_ = total;
+        endInsertRows();
+        return;
+    }
+
+    std::vector<uint64_t> matched;
+    scan(end_, total, matched);
+    end_ = total;
+
+    if (matched.empty())
+        return;
+    beginInsertRows(QModelIndex(), rows, rows + static_cast<int>(matched.size()) - 1);
+    index_.insert(index_.end(), matched.begin(), matched.end());
+    endInsertRows();
+}
+
+uint64_t CanLogModel::sequence(int row) const
+{
+    if (filter_.active())
+        return index_[static_cast<std::size_t>(row)];
+    return first_ + static_cast<uint64_t>(row);
+}
+
+int CanLogModel::rowCount(const QModelIndex & parent) const
+{
+    if (parent.isValid())
+        return 0;
+    if (filter_.active())
+        return static_cast<int>(index_.size());
+    return static_cast<int>(end_ - first_);
+}
+
+int CanLogModel::columnCount(const QModelIndex & /*parent*/) const { return ColumnCount; }
+
+QVariant CanLogModel::data(const QModelIndex & index, int role) const
+{
+    if (role != Qt::DisplayRole || !log_ || !index.isValid() || index.row() >= rowCount(QModelIndex()))
+        return QVariant();
+
+    uint64_t seq = sequence(index.row());
+    if (seq != cachedSequence_)
+    {
+        if (!log_->get(seq, cachedEntry_))
+            return QVariant();
+        cachedSequence_ = seq;
+    }
+    const lt::network::CanLogEntry & entry = cachedEntry_;
+
+    switch (index.column())
+    {
+    case ColumnTime:
+        return QString::number(static_cast<double>((entry.time - epoch_).count()) / 1000000.0, 'f', 6);
+    case ColumnDirection:
+        return entry.direction == lt::network::CanMessageDirection::Inbound ? tr("Rx") : tr("Tx");
+    case ColumnId:
+    {
+        char buffer[8];
+        uint32_t id = entry.message.id();
+        char * end = lt::hex::writeNumber(buffer, id, id > 0x7FF ? 8 : 3);
+        return QString::fromLatin1(buffer, static_cast<int>(end - buffer));
+    }
+    case ColumnLength:
+        return static_cast<int>(entry.message.length());
+    case ColumnData:
+    {
+        char buffer[24];
+        char * out = buffer;
+        for (uint8_t i = 0; i < entry.message.length(); ++i)
+        {
+            if (i != 0)
+                *out++ = ' ';
+            out = lt::hex::write(out, entry.message[i]);
+        }
+        return QString::fromLatin1(buffer, static_cast<int>(out - buffer));
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QVariant CanLogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QVariant();
+
+    switch (section)
+    {
+    case ColumnTime:
+        return tr("Time");
+    case ColumnDirection:
+        return tr("Direction");
+    case ColumnId:
+        return tr("Id");
+    case ColumnLength:
+        return tr("Length");
+    case ColumnData:
+        return tr("Data");
+    default:
+        return QVariant();
+    }
+}
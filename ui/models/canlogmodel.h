@@ -0,0 +1,90 @@
+#ifndef LIBRETUNER_CANLOGMODEL_H
+#define LIBRETUNER_CANLOGMODEL_H
+
+#include "lt/network/can/canlog.h"
+
+#include <QAbstractTableModel>
+#include <QTimer>
+
+#include <bitset>
+#include <deque>
+#include <vector>
+
+struct CanLogFilter
+{
+    // Ids to show. All ids are shown if empty.
+    std::vector<uint32_t> ids;
+    bool inbound{true};
+    bool outbound{true};
+
+    inline bool active() const noexcept { return !ids.empty() || !inbound || !outbound; }
+};
+
+// Table model over a CanLog. Rows are added in batches on a timer instead of
+// once per frame, and cells are formatted from the log only when the view
+// asks for them. When a filter is set, the model keeps an index of the
+// matching sequence numbers that is extended as frames arrive.
+class CanLogModel : public QAbstractTableModel
+{
+public:
+    enum Column
+    {
+        ColumnTime,
+        ColumnDirection,
+        ColumnId,
+        ColumnLength,
+        ColumnData,
+        ColumnCount,
+    };
+
+    // Milliseconds between batches of inserted rows
+    static constexpr int UpdateInterval = 50;
+
+    explicit CanLogModel(QObject * parent = nullptr);
+
+    void setLog(lt::network::CanLogPtr log);
+    inline const lt::network::CanLogPtr & log() const noexcept { return log_; }
+
+    void setFilter(CanLogFilter filter);
+    inline const CanLogFilter & filter() const noexcept { return filter_; }
+
+    // Returns the log sequence number of a row
+    uint64_t sequence(int row) const;
+
+    int rowCount(const QModelIndex & parent) const override;
+    int columnCount(const QModelIndex & parent) const override;
+    QVariant data(const QModelIndex & index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+private:
+    lt::network::CanLogPtr log_;
+    CanLogFilter filter_;
+    // Fast lookup for standard ids. Extended ids are searched in the sorted
+    // filter list.
+    std::bitset<2048> standardIds_;
+    std::vector<uint32_t> extendedIds_;
+
+    QTimer timer_;
+    // Sequence numbers of the first row and one past the last entry that
+    // has been processed
+    uint64_t first_{0};
+    uint64_t end_{0};
+    // Sequence numbers of the rows when filtering
+    std::deque<uint64_t> index_;
+
+    // Time that the time column counts from
+    std::chrono::microseconds epoch_{0};
+    bool hasEpoch_{false};
+
+    // The view reads every column of a row in turn
+    mutable uint64_t cachedSequence_{UINT64_MAX};
+    mutable lt::network::CanLogEntry cachedEntry_{};
+
+    void update();
+    void rebuildIndex();
+    // Appends the sequence numbers of matching entries in [begin, end)
+    template <typename Container> void scan(uint64_t begin, uint64_t end, Container & out);
+    bool matches(const lt::network::CanLogEntry & entry) const noexcept;
+};
+
+#endif // LIBRETUNER_CANLOGMODEL_H
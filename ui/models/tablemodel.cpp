@@ -3,6 +3,7 @@
 #include <QColor>
 
 #include <cmath>
+#include <optional>
 
 void TableModel::setTable(lt::Table * table) noexcept
 {
@@ -11,6 +12,45 @@ void TableModel::setTable(lt::Table * table) noexcept
     endResetModel();
 }
 
+void TableModel::refresh()
+{
+    beginResetModel();
+    endResetModel();
+}
+
+bool TableModel::apply(const lt::Table::Region & region, const QString & label, const Operation & operation)
+{
+    if (table_ == nullptr)
+        return false;
+
+    lt::Table::Region clipped = table_->clip(region);
+    if (clipped.empty())
+        return false;
+
+    {
+        std::optional<lt::EditHistory::Group> group;
+        if (history_ != nullptr)
+            group.emplace(*history_, label.toStdString());
+        operation(*table_, clipped);
+    }
+
+    emit dataChanged(index(clipped.row, clipped.column),
+                     index(clipped.row + clipped.height - 1, clipped.column + clipped.width - 1));
+    return true;
+}
+
+void TableModel::setOverlay(std::shared_ptr<const lt::CellHistogram> overlay)
+{
+    if (overlay && table_ != nullptr && (overlay->width() != table_->width() || overlay->height() != table_->height()))
+        overlay.reset();
+    overlay_ = std::move(overlay);
+    if (table_ != nullptr && !table_->region().empty())
+    {
+        emit dataChanged(index(0, 0), index(table_->height() - 1, table_->width() - 1),
+                         {Qt::BackgroundRole, Qt::ToolTipRole});
+    }
+}
+
 int TableModel::rowCount(const QModelIndex & parent) const
 {
     if (table_ == nullptr || parent.isValid())
@@ -33,7 +73,7 @@ QVariant TableModel::data(const QModelIndex & index, int role) const
         return QVariant();
 
     if (role != Qt::UserRole && role != Qt::DisplayRole && role != Qt::BackgroundRole &&
-        role != Qt::ForegroundRole)
+        role != Qt::ForegroundRole && role != Qt::ToolTipRole)
         return QVariant();
 
     if (index.row() < 0 || index.row() >= table_->height() || index.column() < 0 || index.column() >= table_->width())
@@ -42,6 +82,22 @@ QVariant TableModel::data(const QModelIndex & index, int role) const
     if (role == Qt::DisplayRole)
         return table_->get(index.row(), index.column());
 
+    if (role == Qt::ToolTipRole)
+    {
+        if (!overlay_)
+            return QVariant();
+
+        const lt::CellStats & stats = overlay_->cell(index.row(), index.column());
+        if (stats.count == 0)
+            return tr("No samples");
+        return tr("Samples: %1\nMean: %2\nStd. dev.: %3\nMin: %4\nMax: %5")
+            .arg(stats.count)
+            .arg(stats.mean)
+            .arg(std::sqrt(stats.variance()))
+            .arg(stats.min)
+            .arg(stats.max);
+    }
+
     if (role == Qt::ForegroundRole)
     {
         if (table_->isScalar())
@@ -60,7 +116,9 @@ QVariant TableModel::data(const QModelIndex & index, int role) const
             return QColor::fromHsvF((1.0 / 3.0), 1.0, 1.0);
         double ratio = static_cast<double>(table_->get(index.row(), index.column()) - table_->minimum()) / diff;
         ratio = std::clamp(ratio, 0.0, 1.0);
-        return QColor::fromHsvF((1.0 - ratio) * (1.0 / 3.0), 1.0, 1.0);
+        // Dim cells the overlay has no samples for
+        double saturation = overlay_ && overlay_->cell(index.row(), index.column()).count == 0 ? 0.2 : 1.0;
+        return QColor::fromHsvF((1.0 - ratio) * (1.0 / 3.0), saturation, 1.0);
     }
 
     return QVariant();
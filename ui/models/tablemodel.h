@@ -1,9 +1,14 @@
 #ifndef TABLEMODEL_H
 #define TABLEMODEL_H
 
+#include "lt/analysis/cellhistogram.h"
+#include "lt/rom/edithistory.h"
 #include "lt/rom/table.h"
 #include <QAbstractTableModel>
 
+#include <functional>
+#include <memory>
+
 class TableModel : public QAbstractTableModel
 {
 public:
@@ -12,6 +17,27 @@ public:
     void setTable(lt::Table * table) noexcept;
     inline lt::Table * table() const noexcept { return table_; }
 
+    // Reloads the table after its data changed outside of the model,
+    // such as by undo
+    void refresh();
+
+    // Bulk edits become a single step of `history`, if set
+    inline void setHistory(lt::EditHistory * history) noexcept { history_ = history; }
+
+    using Operation = std::function<void(lt::Table & table, const lt::Table::Region & region)>;
+
+    // Applies `operation` to the part of `region` inside the table as one
+    // undo step named `label` and emits a single dataChanged for it.
+    // Returns false if the region is empty.
+    bool apply(const lt::Table::Region & region, const QString & label, const Operation & operation);
+
+    // Shows the statistics of logged samples over the cells. Cells without
+    // samples are dimmed and the statistics are shown as tool tips. The
+    // histogram must have the dimensions of the table. Pass nullptr to
+    // remove the overlay.
+    void setOverlay(std::shared_ptr<const lt::CellHistogram> overlay);
+    inline const std::shared_ptr<const lt::CellHistogram> & overlay() const noexcept { return overlay_; }
+
     virtual int rowCount(const QModelIndex & parent) const override;
     virtual int columnCount(const QModelIndex & parent) const override;
     virtual QVariant data(const QModelIndex & index, int role) const override;
@@ -23,6 +49,8 @@ public:
 
 private:
     lt::Table * table_{nullptr};
+    lt::EditHistory * history_{nullptr};
+    std::shared_ptr<const lt::CellHistogram> overlay_;
 };
 
 #endif
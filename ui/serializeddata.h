@@ -132,6 +132,8 @@ public:
         throw std::runtime_error("end of buffer");
     }
 
+    bool atEnd() const { return pointer_ == end_; }
+
 private:
     Iterator pointer_;
     Iterator end_;
@@ -269,6 +271,9 @@ public:
         read(t, size);
     }
 
+    // Returns true if all input has been read
+    bool atEnd() const { return input_.atEnd(); }
+
 private:
     InputAdapter input_;
 
@@ -20,6 +20,7 @@
 #include "lt/link/socketcan.h"
 #endif
 #include "lt/link/elm.h"
+#include "lt/link/replay.h"
 
 AddDatalinkDialog::AddDatalinkDialog(QWidget * parent) : QDialog(parent)
 {
@@ -29,6 +30,7 @@ AddDatalinkDialog::AddDatalinkDialog(QWidget * parent) : QDialog(parent)
     comboType_ = new QComboBox;
     comboType_->addItem("SocketCAN");
     comboType_->addItem("ELM327/ST");
+    comboType_->addItem(tr("Replay (candump/ASC/BLF log)"));
 
     // Settings
     settings_ = new DataLinkSettings;
@@ -93,6 +95,17 @@ void AddDatalinkDialog::addClicked()
         LT()->saveLinks();
         close();
         break;
+    case 2:
+    {
+        // Replay
+        auto link = std::make_unique<lt::ReplayDataLink>(
+            name, settings_->port().toStdString());
+        link->setSpeed(settings_->speed());
+        LT()->links().add(std::move(link));
+        LT()->saveLinks();
+        close();
+        break;
+    }
     default:
         QMessageBox::warning(
             this, tr("Unsupported type"),
@@ -114,6 +127,10 @@ void AddDatalinkDialog::typeIndexChanged(int index)
             settings_->setFlags(lt::DataLinkFlags::Port | lt::DataLinkFlags::Baudrate);
             settings_->setPortType(lt::DataLinkPortType::Serial);
             break;
+        case 2: // Replay
+            settings_->setFlags(lt::DataLinkFlags::Port | lt::DataLinkFlags::Speed);
+            settings_->setPortType(lt::DataLinkPortType::File);
+            break;
         default:
             settings_->setFlags(lt::DataLinkFlags::None);
         }
@@ -8,7 +8,8 @@
 #include <QApplication>
 
 /**
- * Runs a task in the background while updating Qt
+ * Runs a task on its own thread while updating Qt. Tasks are long, blocking
+ * link routines, so they are kept off the job pool.
  */
 template <typename T> class BackgroundTask;
 template <class R, class... Args> class BackgroundTask<R(Args...)>
@@ -27,6 +28,8 @@ public:
             [this, &complete](Args &&... args) {
                 task_(std::forward<Args>(args)...);
                 complete = true;
+                // Wake the event loop below
+                QMetaObject::invokeMethod(qApp, []() {}, Qt::QueuedConnection);
             },
             std::forward<Args>(args)...);
 
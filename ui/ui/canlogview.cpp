@@ -17,7 +17,13 @@
  */
 
 #include "canlogview.h"
-#include <QAbstractItemModel>
-#include <iostream>
 
-CanLogView::CanLogView(QWidget * parent) : QTableView(parent) {}
+#include <QHeaderView>
+
+CanLogView::CanLogView(QWidget * parent) : QTableView(parent)
+{
+    // Fixed row heights and no wrapping keep scrolling independent of the
+    // row count
+    setWordWrap(false);
+    verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+}
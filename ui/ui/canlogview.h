@@ -21,9 +21,7 @@
 
 #include <QTableView>
 
-/**
- * @todo write docs
- */
+// Table view for CanLogModel
 class CanLogView : public QTableView
 {
     Q_OBJECT
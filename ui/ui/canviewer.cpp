@@ -19,28 +19,70 @@
 #include "canviewer.h"
 #include "canlogview.h"
 #include "libretuner.h"
-#include "protocols/canlog.h"
+#include "models/canlogmodel.h"
 #include "ui_canviewer.h"
 
+#include "lt/support/hex.h"
+
 #include <QAbstractItemModel>
+#include <QRegularExpression>
 
 CanViewer::CanViewer(QWidget * parent) : QWidget(parent), ui(new Ui::CanViewer)
 {
-    // QWidget *main = new QWidget;
-    // mainLayout()->addWidget(main);
     ui->setupUi(this);
 
-    logModel_ = LibreTuner::get()->canLog();
+    logModel_ = new CanLogModel(this);
+    logModel_->setLog(LibreTuner::get()->canLog());
     ui->logView->setModel(logModel_);
     connect(logModel_, &QAbstractItemModel::rowsInserted, this,
             &CanViewer::rowsInserted);
+
+    ui->directionFilter->addItem(tr("All"));
+    ui->directionFilter->addItem(tr("Received"));
+    ui->directionFilter->addItem(tr("Sent"));
+    connect(ui->directionFilter,
+            QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &CanViewer::updateFilter);
+    connect(ui->idFilter, &QLineEdit::editingFinished, this,
+            &CanViewer::updateFilter);
 }
 
 CanViewer::~CanViewer() { delete ui; }
 
+void CanViewer::updateFilter()
+{
+    CanLogFilter filter;
+    // Ids are separated by spaces or commas
+    for (const QString & token :
+         ui->idFilter->text().split(QRegularExpression("[\\s,]+"), Qt::SkipEmptyParts))
+    {
+        uint32_t id;
+        if (lt::hex::parse(token.toStdString(), id))
+        {
+            filter.ids.push_back(id);
+        }
+    }
+
+    switch (ui->directionFilter->currentIndex())
+    {
+    case 1:
+        filter.outbound = false;
+        break;
+    case 2:
+        filter.inbound = false;
+        break;
+    default:
+        break;
+    }
+
+    logModel_->setFilter(std::move(filter));
+}
+
 void CanViewer::rowsInserted(const QModelIndex & /*parent*/, int /*first*/,
                              int /*last*/)
 {
+    // Rows are inserted in batches, so this runs at most once per model
+    // update
     if (ui->autoScroll->isChecked())
     {
         ui->logView->scrollToBottom();
@@ -26,8 +26,7 @@ namespace Ui
 class CanViewer;
 }
 
-class CanHandler;
-class QAbstractItemModel;
+class CanLogModel;
 
 class CanViewer : public QWidget
 {
@@ -39,7 +38,9 @@ public:
 
 private:
     Ui::CanViewer * ui;
-    QAbstractItemModel * logModel_ = nullptr;
+    CanLogModel * logModel_ = nullptr;
+
+    void updateFilter();
 
 public slots:
     void rowsInserted(const QModelIndex & parent, int first, int last);
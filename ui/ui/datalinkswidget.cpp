@@ -19,11 +19,12 @@
 #include "uiutil.h"
 #include "widget/customcombo.h"
 #include "widget/datalinksettings.h"
+#include "widget/linkmetricsview.h"
 
 DatalinksWidget::DatalinksWidget(QWidget * parent) : QWidget(parent)
 {
     setWindowTitle(tr("LibreTuner - Datalinks"));
-    resize(600, 400);
+    resize(600, 600);
 
     auto * buttonAdd = new QPushButton(tr("Add"));
     auto * buttonRemove = new QPushButton(tr("Remove"));
@@ -40,6 +41,8 @@ DatalinksWidget::DatalinksWidget(QWidget * parent) : QWidget(parent)
     settings_ = new DataLinkSettings;
     settings_->setEnabled(false);
 
+    metrics_ = new LinkMetricsView;
+
     // Layouts
     auto * buttonLayout = new QVBoxLayout;
     buttonLayout->setAlignment(Qt::AlignTop);
@@ -58,6 +61,7 @@ DatalinksWidget::DatalinksWidget(QWidget * parent) : QWidget(parent)
     auto * linksLayout = new QVBoxLayout;
     linksLayout->addWidget(linksView_);
     linksLayout->addLayout(layoutOpt);
+    linksLayout->addWidget(metrics_);
 
     auto * layout = new QHBoxLayout;
     layout->addLayout(linksLayout);
@@ -109,10 +113,13 @@ void DatalinksWidget::linkChanged(lt::DataLink * link)
     if (link == nullptr)
     {
         settings_->setEnabled(false);
+        metrics_->setMetrics(nullptr);
         setButtonsEnabled(false);
         return;
     }
 
+    metrics_->setMetrics(link->metrics());
+
     settings_->setEnabled(true);
     settings_->setFlags(link->flags());
     settings_->fill(link);
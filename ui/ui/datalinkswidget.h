@@ -7,6 +7,7 @@
 class QPushButton;
 class QTreeView;
 class DataLinkSettings;
+class LinkMetricsView;
 
 namespace lt
 {
@@ -28,6 +29,7 @@ private:
     QPushButton * buttonReset_;
     QTreeView * linksView_;
     DataLinkSettings * settings_;
+    LinkMetricsView * metrics_;
 };
 
 #endif // LIBRETUNER_INTERFACESDIALOG_H
@@ -23,14 +23,23 @@
 #include <QLabel>
 #include <QListWidget>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QShowEvent>
 #include <QSplitter>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QDesktopWidget>
+#include <QFileDialog>
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
 
 #include "backgroundtask.h"
 #include "libretuner.h"
+#include "lt/datalog/datalogexporter.h"
+#include "lt/datalog/datalogfile.h"
 #include "lt/datalog/datalogger.h"
 #include "lt/definition/platform.h"
 #include "lt/link/datalink.h"
@@ -57,9 +66,12 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
     dataLogLiveView_->setSizePolicy(QSizePolicy::Expanding,
                                     QSizePolicy::Preferred);
     dataLogLiveView_->setDataLog(log_);
+    LT()->setDataLog(log_);
 
     buttonLog_ = new QPushButton(tr("Start logging"));
     auto * buttonSave = new QPushButton(tr("Save log"));
+    auto * buttonOpen = new QPushButton(tr("Open log"));
+    auto * buttonExport = new QPushButton(tr("Export log"));
 
     auto * buttonSimulate = new QPushButton(tr("Simulate"));
 
@@ -71,6 +83,9 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
     auto * logLayout = new QVBoxLayout;
     logLayout->addWidget(splitter);
     logLayout->addWidget(buttonLog_);
+    logLayout->addWidget(buttonSave);
+    logLayout->addWidget(buttonOpen);
+    logLayout->addWidget(buttonExport);
     logLayout->addWidget(buttonSimulate);
 
     // PIDs layout
@@ -90,6 +105,10 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
             &DataLoggerWindow::toggleLogger);
     connect(buttonSave, &QPushButton::clicked, this,
             &DataLoggerWindow::saveLog);
+    connect(buttonOpen, &QPushButton::clicked, this,
+            &DataLoggerWindow::openLog);
+    connect(buttonExport, &QPushButton::clicked, this,
+            &DataLoggerWindow::exportLog);
     connect(buttonSimulate, &QPushButton::clicked, [this]() { simulate(); });
     reset();
 }
@@ -130,7 +149,152 @@ void DataLoggerWindow::closeEvent(QCloseEvent * event)
     }
 }
 
-void DataLoggerWindow::saveLog() {}
+void DataLoggerWindow::saveLog()
+{
+    if (logger_)
+    {
+        QMessageBox::warning(this, tr("Save log"),
+                             tr("Stop the data logger before saving"));
+        return;
+    }
+
+    QString path = QFileDialog::getSaveFileName(
+        this, tr("Save log"),
+        QString::fromStdString((LT()->rootPath() / "logs").string()),
+        tr("LibreTuner log (*.ltl)"));
+    if (path.isNull())
+    {
+        return;
+    }
+
+    try
+    {
+        lt::DataLogWriter::save(*log_, path.toStdString());
+    }
+    catch (const std::runtime_error & error)
+    {
+        QMessageBox::critical(this, tr("Save error"), error.what());
+    }
+}
+
+void DataLoggerWindow::openLog()
+{
+    if (logger_)
+    {
+        return;
+    }
+
+    QString path = QFileDialog::getOpenFileName(
+        this, tr("Open log"),
+        QString::fromStdString((LT()->rootPath() / "logs").string()),
+        tr("LibreTuner log (*.ltl)"));
+    if (path.isNull())
+    {
+        return;
+    }
+
+    try
+    {
+        // Repair the file first so the damaged tail is not read again
+        if (lt::DataLogReader::recover(path.toStdString()))
+        {
+            Logger::warning("Log '" + path.toStdString() +
+                            "' was not closed properly and has been "
+                            "recovered");
+        }
+        lt::DataLogReader reader(path.toStdString());
+
+        resetLog();
+        log_->setName(reader.name());
+        reader.readInto(*log_);
+    }
+    catch (const std::runtime_error & error)
+    {
+        QMessageBox::critical(this, tr("Open error"), error.what());
+    }
+}
+
+void DataLoggerWindow::exportLog()
+{
+    if (logger_)
+    {
+        QMessageBox::warning(this, tr("Export log"),
+                             tr("Stop the data logger before exporting"));
+        return;
+    }
+
+    QString filter;
+    QString path = QFileDialog::getSaveFileName(
+        this, tr("Export log"),
+        QString::fromStdString((LT()->rootPath() / "logs").string()),
+        tr("CSV (*.csv);;NumPy archive (*.npz)"), &filter);
+    if (path.isNull())
+    {
+        return;
+    }
+
+    if (exportJob_ && exportJob_->running())
+    {
+        QMessageBox::warning(this, tr("Export log"),
+                             tr("An export is already running"));
+        return;
+    }
+
+    bool npz = path.endsWith(".npz", Qt::CaseInsensitive) ||
+               filter.contains("npz");
+
+    // Resampling and writing a long log takes a while, so export on the job
+    // pool and poll its progress
+    exportJob_ = std::make_shared<lt::Job>();
+    exportJob_->run(
+        [log = log_, npz](lt::JobControl control, std::string file) {
+            lt::DataLogExporter exporter(*log);
+            if (npz)
+            {
+                exporter.writeNpz(file, &control);
+            }
+            else
+            {
+                exporter.writeCsv(file, &control);
+            }
+        },
+        path.toStdString());
+
+    auto * progress = new QProgressDialog(tr("Exporting log..."),
+                                          tr("Cancel"), 0, 100, this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setWindowTitle(tr("LibreTuner - Export"));
+    progress->setValue(0);
+    progress->show();
+
+    lt::JobPtr job = exportJob_;
+    connect(progress, &QProgressDialog::canceled, [job]() { job->cancel(); });
+
+    auto * timer = new QTimer(progress);
+    connect(timer, &QTimer::timeout, [this, job, progress, timer]() {
+        if (job->running())
+        {
+            progress->setValue(static_cast<int>(job->progress() * 100));
+            return;
+        }
+        timer->stop();
+        progress->close();
+
+        if (std::exception_ptr error = job->error())
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception & e)
+            {
+                QMessageBox::critical(this, tr("Export error"), e.what());
+            }
+        }
+    });
+    timer->start(50);
+}
 
 void DataLoggerWindow::simulate()
 {
@@ -191,6 +355,24 @@ void DataLoggerWindow::toggleLogger()
             }
         }
 
+        // Stream to the logs directory so the session survives a crash
+        std::filesystem::path logsDir = LT()->rootPath() / "logs";
+        std::filesystem::create_directories(logsDir);
+        std::time_t now = std::chrono::system_clock::to_time_t(
+            std::chrono::system_clock::now());
+        std::ostringstream fileName;
+        fileName << std::put_time(std::localtime(&now), "%Y%m%d-%H%M%S")
+                 << ".ltl";
+
+        std::vector<lt::Pid> pids;
+        for (const auto & [code, pidLog] : log_->logs())
+        {
+            pids.push_back(pidLog.pid);
+        }
+        logWriter_ = std::make_unique<lt::DataLogWriter>(
+            logsDir / fileName.str(), log_->name(), pids);
+        logWriter_->attach(*log_);
+
         BackgroundTask<void()> task([&]() { logger_->run(); });
 
         buttonLog_->setText(tr("Stop logging"));
@@ -200,10 +382,24 @@ void DataLoggerWindow::toggleLogger()
         task.future().get();
 
         logger_.reset();
+        std::string writeError = logWriter_->error();
+        logWriter_->close();
+        logWriter_.reset();
         buttonLog_->setText(tr("Start logging"));
+
+        if (!writeError.empty())
+        {
+            QMessageBox::warning(
+                this, tr("Datalog error"),
+                tr("The log stopped being saved to disk: %1")
+                    .arg(QString::fromStdString(writeError)));
+        }
     }
     catch (const std::runtime_error & error)
     {
+        logger_.reset();
+        logWriter_.reset();
+        buttonLog_->setText(tr("Start logging"));
         QMessageBox::critical(this, "Datalog error", error.what());
     }
 }
@@ -242,4 +438,5 @@ void DataLoggerWindow::resetLog()
 
     dataLogView_->setDataLog(log_);
     dataLogLiveView_->setDataLog(log_);
+    LT()->setDataLog(log_);
 }
\ No newline at end of file
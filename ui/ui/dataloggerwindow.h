@@ -27,11 +27,13 @@
 #include <unordered_map>
 
 #include "lt/datalog/datalog.h"
+#include "lt/support/job.h"
 
 namespace lt
 {
 class DataLogger;
 using DataLoggerPtr = std::unique_ptr<DataLogger>;
+class DataLogWriter;
 } // namespace lt
 
 class QListWidget;
@@ -63,10 +65,16 @@ public slots:
     /* Callback for the start/stop button */
     void toggleLogger();
     void saveLog();
+    void openLog();
+    void exportLog();
 
 private:
     lt::DataLogPtr log_;
     lt::DataLoggerPtr logger_;
+    // Streams the running log to disk
+    std::unique_ptr<lt::DataLogWriter> logWriter_;
+    // Export running in the background
+    lt::JobPtr exportJob_;
 
     QListWidget * pidList_;
     QPushButton * buttonLog_;
@@ -34,6 +34,7 @@
 
 #include "windows/definitionswindow.h"
 
+#include "canviewer.h"
 #include "datalinkswidget.h"
 #include "dataloggerwindow.h"
 #include "flasherwindow.h"
@@ -184,6 +185,7 @@ bool MainWindow::checkSave()
             tr("Error while saving tune"));
         return false;
     case QMessageBox::Discard:
+        tune_->discardJournal();
         return true;
     case QMessageBox::Cancel:
     default:
@@ -191,6 +193,26 @@ bool MainWindow::checkSave()
     }
 }
 
+void MainWindow::applyHistory(bool redo)
+{
+    if (!tune_)
+        return;
+
+    bool applied = false;
+    catchWarning([&]() { applied = redo ? tune_->redo() : tune_->undo(); },
+                 redo ? tr("Error redoing edit") : tr("Error undoing edit"));
+    if (!applied)
+        return;
+
+    for (auto & [id, view] : views_)
+    {
+        if (auto * tableView = dynamic_cast<TableView *>(view.data()))
+            tableView->refresh();
+        else if (auto * scalarView = dynamic_cast<ScalarView *>(view.data()))
+            scalarView->refresh();
+    }
+}
+
 void MainWindow::setTune(const lt::TunePtr & tune)
 {
     if (tune_ == tune)
@@ -210,6 +232,8 @@ void MainWindow::setTune(const lt::TunePtr & tune)
 
     flashCurrentAction_->setEnabled(!!tune);
     saveCurrentAction_->setEnabled(!!tune);
+    undoAction_->setEnabled(!!tune);
+    redoAction_->setEnabled(!!tune);
 
     if (tune)
         setWindowTitle(tr("LibreTuner") + " - " + QString::fromStdString(tune->name()));
@@ -322,6 +346,7 @@ void MainWindow::setTable(const lt::TableDefinition * table)
                 auto * view = new TableView;
                 view->resize(QGuiApplication::primaryScreen()->size() * 0.5);
                 view->setTable(tab);
+                view->setHistory(&tune_->history());
                 view->setAttribute(Qt::WA_DeleteOnClose);
                 view->setWindowFlag(Qt::WindowStaysOnTopHint);
                 view->show();
@@ -382,7 +407,7 @@ void MainWindow::setupMenu()
 {
     auto * menuBar = new QMenuBar;
     QMenu * fileMenu = menuBar->addMenu(tr("&File"));
-    /*QMenu * editMenu =*/ menuBar->addMenu(tr("&Edit"));
+    QMenu * editMenu = menuBar->addMenu(tr("&Edit"));
     /*QMenu * helpMenu =*/ menuBar->addMenu(tr("&Help"));
     QMenu * viewMenu = menuBar->addMenu(tr("&View"));
     QMenu * toolsMenu = menuBar->addMenu(tr("&Tools"));
@@ -407,6 +432,18 @@ void MainWindow::setupMenu()
     flashCurrentAction_->setShortcut(QKeySequence(+Qt::CTRL + Qt::Key_F));
     flashCurrentAction_->setEnabled(false);
 
+    // Edit menu
+    // Tables open in their own windows, so the shortcuts apply to every window
+    undoAction_ = editMenu->addAction(tr("&Undo"));
+    undoAction_->setShortcut(QKeySequence::Undo);
+    undoAction_->setShortcutContext(Qt::ApplicationShortcut);
+    undoAction_->setEnabled(false);
+
+    redoAction_ = editMenu->addAction(tr("&Redo"));
+    redoAction_->setShortcuts({QKeySequence::Redo, QKeySequence(+Qt::CTRL + Qt::Key_Y)});
+    redoAction_->setShortcutContext(Qt::ApplicationShortcut);
+    redoAction_->setEnabled(false);
+
     // View menu
     auto * openPlatformsAction = viewMenu->addAction(tr("Platforms"));
     connect(openPlatformsAction, &QAction::triggered, [this]() {
@@ -446,6 +483,9 @@ void MainWindow::setupMenu()
 
     connect(createTuneAction, &QAction::triggered, this, &MainWindow::openCreateTune);
 
+    connect(undoAction_, &QAction::triggered, [this]() { applyHistory(false); });
+    connect(redoAction_, &QAction::triggered, [this]() { applyHistory(true); });
+
     connect(saveCurrentAction_, &QAction::triggered,
             [this]() { catchCritical([this]() { saveTune(); }, tr("Error saving tune")); });
 
@@ -477,8 +517,15 @@ void MainWindow::setupMenu()
 
     // Tools menu
 
-    /*QAction * logAction =*/ toolsMenu->addAction(tr("&CAN Log"));
-    // connect(logAct, &QAction::triggered, [this] { canViewer_.show(); });
+    QAction * logAction = toolsMenu->addAction(tr("&CAN Log"));
+    connect(logAction, &QAction::triggered, [this]() {
+        if (canViewer_ == nullptr)
+        {
+            canViewer_ = new CanViewer(this);
+            canViewer_->setWindowFlag(Qt::Window);
+        }
+        canViewer_->show();
+    });
     QAction * infoAction = toolsMenu->addAction(tr("Vehicle Information"));
     connect(infoAction, &QAction::triggered, [this]() {
         if (infoWidget_ == nullptr)
@@ -43,6 +43,7 @@ class GraphWidget;
 class DefinitionsWindow;
 class ExplorerWidget;
 class VehicleInformationWidget;
+class CanViewer;
 
 namespace lt
 {
@@ -83,6 +84,10 @@ signals:
 private:
     bool checkSave();
 
+    // Applies undo or redo to the tune and reloads the open tables
+    void applyHistory(bool redo);
+
+
     void addToRecentMenu(const QString & path);
 
     QComboBox * comboLogVehicles_;
@@ -96,6 +101,8 @@ private:
 
     QAction * flashCurrentAction_;
     QAction * saveCurrentAction_;
+    QAction * undoAction_;
+    QAction * redoAction_;
 
     // Docks
     QDockWidget * logDock_;
@@ -136,6 +143,7 @@ private:
 
     QPointer<DefinitionsWindow> definitionsWindow_;
     VehicleInformationWidget * infoWidget_{nullptr};
+    CanViewer * canViewer_{nullptr};
 
     QStringList recentProjects_;
 
@@ -1,6 +1,7 @@
 #include "datalinksettings.h"
 
 #include <QCheckBox>
+#include <QDoubleSpinBox>
 #include <QFormLayout>
 #include <QLabel>
 #include <QLineEdit>
@@ -47,6 +48,16 @@ DataLinkSettings::DataLinkSettings(lt::DataLinkFlags flags, QWidget * parent)
     baudrateLayout_->addWidget(spinBaudrate_);
     baudrateLayout_->addWidget(checkBaudrate_);
 
+    // Replay speed
+    spinSpeed_ = new QDoubleSpinBox;
+    spinSpeed_->setRange(0.0, 100.0);
+    spinSpeed_->setDecimals(2);
+    spinSpeed_->setSingleStep(0.25);
+    spinSpeed_->setValue(1.0);
+    spinSpeed_->setSuffix("x");
+    spinSpeed_->setSpecialValueText(tr("No delays"));
+    labelSpeed_ = new QLabel(tr("Speed"));
+
     // Form
     auto * form = new QFormLayout;
     form->setContentsMargins(0, 0, 0, 0);
@@ -54,6 +65,7 @@ DataLinkSettings::DataLinkSettings(lt::DataLinkFlags flags, QWidget * parent)
     form->addRow(tr("Name"), lineName_);
     form->addRow(labelPort_, comboPort_);
     form->addRow(labelBaudrate_, baudrateLayout_);
+    form->addRow(labelSpeed_, spinSpeed_);
 
     setFlags(flags);
 
@@ -74,6 +86,9 @@ DataLinkSettings::DataLinkSettings(lt::DataLinkFlags flags, QWidget * parent)
 
     connect(checkBaudrate_, &QCheckBox::stateChanged,
             [this](int /*state*/) { emit settingChanged(); });
+
+    connect(spinSpeed_, &QDoubleSpinBox::editingFinished,
+            [this]() { emit settingChanged(); });
 }
 
 void DataLinkSettings::setFlags(lt::DataLinkFlags flags)
@@ -81,12 +96,15 @@ void DataLinkSettings::setFlags(lt::DataLinkFlags flags)
     bool baudrate =
         (flags & lt::DataLinkFlags::Baudrate) != lt::DataLinkFlags::None;
     bool port = (flags & lt::DataLinkFlags::Port) != lt::DataLinkFlags::None;
+    bool speed = (flags & lt::DataLinkFlags::Speed) != lt::DataLinkFlags::None;
 
     labelPort_->setVisible(port);
     comboPort_->setVisible(port);
     labelBaudrate_->setVisible(baudrate);
     spinBaudrate_->setVisible(baudrate);
     checkBaudrate_->setVisible(baudrate);
+    labelSpeed_->setVisible(speed);
+    spinSpeed_->setVisible(speed);
 }
 
 void DataLinkSettings::apply(lt::DataLink & link)
@@ -94,6 +112,7 @@ void DataLinkSettings::apply(lt::DataLink & link)
     link.setName(lineName_->text().toStdString());
     link.setPort(comboPort_->value().toStdString());
     link.setBaudrate(checkBaudrate_->isChecked() ? 0 : spinBaudrate_->value());
+    link.setSpeed(spinSpeed_->value());
 }
 
 void DataLinkSettings::fill(lt::DataLink * link)
@@ -117,6 +136,7 @@ void DataLinkSettings::fill(lt::DataLink * link)
     comboPort_->setValue(QString::fromStdString(link->port()));
     spinBaudrate_->setValue(link->baudrate());
     checkBaudrate_->setChecked(link->baudrate() == 0);
+    spinSpeed_->setValue(link->speed());
 }
 
 void DataLinkSettings::reset()
@@ -125,6 +145,7 @@ void DataLinkSettings::reset()
     comboPort_->setValue("");
     spinBaudrate_->setValue(0);
     checkBaudrate_->setChecked(true);
+    spinSpeed_->setValue(1.0);
 }
 
 QString DataLinkSettings::name() const { return lineName_->text(); }
@@ -136,6 +157,8 @@ int DataLinkSettings::baudrate() const
     return (checkBaudrate_->isChecked() ? 0 : spinBaudrate_->value());
 }
 
+double DataLinkSettings::speed() const { return spinSpeed_->value(); }
+
 void DataLinkSettings::setPortType(lt::DataLinkPortType type)
 {
     std::vector<std::string> ports;
@@ -149,6 +172,9 @@ void DataLinkSettings::setPortType(lt::DataLinkPortType type)
         ports = lt::enumerateNetworkInterfaces(/*AF_CAN*/);
 #endif
         break;
+    case lt::DataLinkPortType::File:
+        // The path is typed in
+        break;
     }
 
     catchWarning(
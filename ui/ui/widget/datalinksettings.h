@@ -7,6 +7,7 @@
 
 class QLineEdit;
 class QSpinBox;
+class QDoubleSpinBox;
 class CustomCombo;
 class QCheckBox;
 class QLabel;
@@ -38,6 +39,7 @@ public:
     void setPort(const QString & port);
     QString port() const;
     int baudrate() const;
+    double speed() const;
 
 signals:
     void settingChanged();
@@ -47,9 +49,11 @@ private:
     CustomCombo * comboPort_{nullptr};
     QSpinBox * spinBaudrate_{nullptr};
     QCheckBox * checkBaudrate_{nullptr};
+    QDoubleSpinBox * spinSpeed_{nullptr};
 
     QLabel * labelPort_;
     QLabel * labelBaudrate_;
+    QLabel * labelSpeed_;
     QHBoxLayout * baudrateLayout_;
 
     SerialPortModel * portModel_;
@@ -6,6 +6,8 @@
 #include <QListWidget>
 #include <QVBoxLayout>
 
+#include <iterator>
+
 DataLogView::DataLogView(QWidget * parent) : QWidget(parent)
 {
     plot_ = new QCustomPlot;
@@ -22,6 +24,7 @@ DataLogView::DataLogView(QWidget * parent) : QWidget(parent)
                 {
                     plot_->xAxis->setRange(
                         newRange.bounded(0, dataLog_->maxTime() / 1000.0));
+                    scheduleRefresh();
                 }
             });
 
@@ -58,7 +61,7 @@ QCPGraph * DataLogView::getOrCreateGraph(const lt::Pid & pid) noexcept
     {
         QCPGraph * graph = plot_->addGraph();
         graph->setName(QString::fromStdString(pid.name));
-        graph->setPen(QPen(plotColors[graphs_.size() % sizeof(plotColors)]));
+        graph->setPen(QPen(plotColors[graphs_.size() % std::size(plotColors)]));
         graphs_.emplace(pid.code, graph);
         return graph;
     }
@@ -68,22 +71,64 @@ QCPGraph * DataLogView::getOrCreateGraph(const lt::Pid & pid) noexcept
 void DataLogView::onAdded(const lt::PidLog & log,
                           const lt::PidLogEntry & entry) noexcept
 {
-    QMetaObject::invokeMethod(
-        this,
-        [this, log, entry] {
-            QCPGraph * graph = getOrCreateGraph(log.pid);
-            graph->addData(static_cast<double>(entry.time) / 1000.0,
-                           entry.value);
-
-            if (checkLive_->isChecked())
-            {
-                plot_->xAxis->setRange(dataLog_->maxTime() / 1000.0, 8,
-                                       Qt::AlignRight);
-            }
-
-            plot_->replot(QCustomPlot::rpQueuedReplot);
-        },
-        Qt::QueuedConnection);
+    Q_UNUSED(log)
+    Q_UNUSED(entry)
+    scheduleRefresh();
+}
+
+void DataLogView::scheduleRefresh() noexcept
+{
+    if (refreshQueued_.exchange(true))
+    {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this] { refresh(); },
+                              Qt::QueuedConnection);
+}
+
+void DataLogView::refresh()
+{
+    refreshQueued_ = false;
+    if (!dataLog_)
+    {
+        return;
+    }
+
+    if (checkLive_->isChecked())
+    {
+        // Block signals so this does not queue another refresh
+        QSignalBlocker blocker(plot_->xAxis);
+        plot_->xAxis->setRange(dataLog_->maxTime() / 1000.0, 8,
+                               Qt::AlignRight);
+    }
+
+    const QCPRange range = plot_->xAxis->range();
+    const auto begin =
+        static_cast<std::size_t>(std::max(range.lower, 0.0) * 1000.0);
+    const auto end =
+        static_cast<std::size_t>(std::max(range.upper, 0.0) * 1000.0);
+    const auto width =
+        static_cast<std::size_t>(std::max(plot_->axisRect()->width(), 1));
+
+    QVector<double> keys;
+    QVector<double> values;
+    for (const lt::Pid & pid : dataLog_->pids())
+    {
+        points_.clear();
+        dataLog_->query(pid.code, begin, end, width, points_);
+
+        keys.resize(static_cast<int>(points_.size()));
+        values.resize(static_cast<int>(points_.size()));
+        for (std::size_t i = 0; i < points_.size(); ++i)
+        {
+            keys[static_cast<int>(i)] =
+                static_cast<double>(points_[i].time) / 1000.0;
+            values[static_cast<int>(i)] = points_[i].value;
+        }
+        getOrCreateGraph(pid)->setData(keys, values, true);
+    }
+
+    plot_->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void DataLogView::setDataLog(lt::DataLogPtr dataLog)
@@ -102,4 +147,7 @@ void DataLogView::setDataLog(lt::DataLogPtr dataLog)
         [this](const lt::PidLog & log, const lt::PidLogEntry & entry) {
             onAdded(log, entry);
         });
+
+    // Draw entries that are already in the log
+    scheduleRefresh();
 }
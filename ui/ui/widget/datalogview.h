@@ -2,7 +2,9 @@
 #define DATALOGVIEW_H
 
 #include <QWidget>
+#include <atomic>
 #include <unordered_map>
+#include <vector>
 
 #include "lt/datalog/datalog.h"
 
@@ -32,6 +34,14 @@ private:
 
     QCPGraph * getOrCreateGraph(const lt::Pid & pid) noexcept;
 
+    // Queues a refresh. Multiple requests before the refresh runs are
+    // merged into one.
+    void scheduleRefresh() noexcept;
+
+    // Rebuilds graph data for the visible range from the log's pyramid.
+    // The number of points depends on the plot width, not the log length.
+    void refresh();
+
     QCustomPlot * plot_;
     QCheckBox * checkLive_;
 
@@ -40,6 +50,10 @@ private:
 
     // Map PIDs to graphs
     std::unordered_map<std::size_t, QCPGraph *> graphs_;
+
+    std::atomic<bool> refreshQueued_{false};
+    // Reused between refreshes
+    std::vector<lt::PidLogEntry> points_;
 };
 
 #endif // DATALOGVIEW_H
@@ -0,0 +1,132 @@
+#include "linkmetricsview.h"
+
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace
+{
+QTreeWidgetItem * addItem(QTreeWidgetItem * parent, const QString & name,
+                          const QString & value)
+{
+    auto * item = new QTreeWidgetItem(parent);
+    item->setText(0, name);
+    item->setText(1, value);
+    return item;
+}
+
+QTreeWidgetItem * addItem(QTreeWidgetItem * parent, const QString & name,
+                          uint64_t value)
+{
+    return addItem(parent, name, QString::number(value));
+}
+
+QString microseconds(uint64_t value)
+{
+    if (value >= 10000)
+        return QString::number(static_cast<double>(value) / 1000.0, 'f', 1) +
+               QStringLiteral(" ms");
+    return QString::number(value) + QStringLiteral(" us");
+}
+} // namespace
+
+LinkMetricsView::LinkMetricsView(QWidget * parent) : QWidget(parent)
+{
+    tree_ = new QTreeWidget;
+    tree_->setColumnCount(2);
+    tree_->setHeaderLabels({tr("Statistic"), tr("Value")});
+    tree_->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    auto * buttonReset = new QPushButton(tr("Reset Statistics"));
+
+    auto * layout = new QVBoxLayout;
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(tree_);
+    layout->addWidget(buttonReset, 0, Qt::AlignRight);
+    setLayout(layout);
+
+    timer_ = new QTimer(this);
+    timer_->setInterval(1000);
+    connect(timer_, &QTimer::timeout, this, &LinkMetricsView::refresh);
+
+    connect(buttonReset, &QPushButton::clicked, [this]() {
+        if (metrics_)
+        {
+            metrics_->reset();
+            refresh();
+        }
+    });
+}
+
+void LinkMetricsView::setMetrics(lt::network::LinkMetricsPtr metrics)
+{
+    metrics_ = std::move(metrics);
+    refresh();
+}
+
+void LinkMetricsView::showEvent(QShowEvent * event)
+{
+    timer_->start();
+    refresh();
+    QWidget::showEvent(event);
+}
+
+void LinkMetricsView::hideEvent(QHideEvent * event)
+{
+    timer_->stop();
+    QWidget::hideEvent(event);
+}
+
+void LinkMetricsView::refresh()
+{
+    tree_->clear();
+    if (!metrics_)
+        return;
+
+    const lt::network::LinkMetrics & m = *metrics_;
+
+    auto * can = new QTreeWidgetItem(tree_, {tr("CAN")});
+    addItem(can, tr("Frames sent"), m.framesSent.value());
+    addItem(can, tr("Frames received"), m.framesReceived.value());
+    addItem(can, tr("Bytes sent"), m.bytesSent.value());
+    addItem(can, tr("Bytes received"), m.bytesReceived.value());
+    addItem(can, tr("Frames dropped on receive"), m.framesDroppedOnReceive.value());
+
+    auto * isotp = new QTreeWidgetItem(tree_, {tr("ISO-TP")});
+    addItem(isotp, tr("Timeouts"), m.isoTpTimeouts.value());
+    addItem(isotp, tr("Flow control waits"), m.isoTpWaits.value());
+    addItem(isotp, tr("Aborted transfers"), m.isoTpAborts.value());
+
+    auto * uds = new QTreeWidgetItem(tree_, {tr("UDS")});
+    addItem(uds, tr("Requests"), m.udsRequests.value());
+    addItem(uds, tr("Response pending"), m.udsResponsePending.value());
+
+    auto * negative = addItem(uds, tr("Negative responses"), QString());
+    uint64_t negativeTotal = 0;
+    for (std::size_t code = 0; code < m.udsNegativeResponses.size(); ++code)
+    {
+        uint64_t count = m.udsNegativeResponses[code].value();
+        if (count == 0)
+            continue;
+        negativeTotal += count;
+        addItem(negative,
+                QStringLiteral("0x") + QString::number(code, 16).rightJustified(2, QLatin1Char('0')).toUpper(),
+                count);
+    }
+    negative->setText(1, QString::number(negativeTotal));
+
+    const lt::Histogram & latency = m.udsLatency;
+    auto * latencyItem = addItem(uds, tr("Round-trip time"), QString());
+    if (latency.count() != 0)
+    {
+        addItem(latencyItem, tr("Minimum"), microseconds(latency.min()));
+        addItem(latencyItem, tr("Median"), microseconds(latency.percentile(50)));
+        addItem(latencyItem, tr("99th percentile"), microseconds(latency.percentile(99)));
+        addItem(latencyItem, tr("Maximum"), microseconds(latency.max()));
+        latencyItem->setText(1, microseconds(static_cast<uint64_t>(latency.mean())) + tr(" mean"));
+    }
+
+    tree_->expandAll();
+}
@@ -0,0 +1,33 @@
+#ifndef LIBRETUNER_LINKMETRICSVIEW_H
+#define LIBRETUNER_LINKMETRICSVIEW_H
+
+#include <QWidget>
+
+#include <lt/network/linkmetrics.h>
+
+class QTimer;
+class QTreeWidget;
+
+// Shows the traffic and error statistics of a data link. Refreshes while
+// visible.
+class LinkMetricsView : public QWidget
+{
+public:
+    explicit LinkMetricsView(QWidget * parent = nullptr);
+
+    // Clears the view if `metrics` is null
+    void setMetrics(lt::network::LinkMetricsPtr metrics);
+
+protected:
+    void showEvent(QShowEvent * event) override;
+    void hideEvent(QHideEvent * event) override;
+
+private:
+    void refresh();
+
+    lt::network::LinkMetricsPtr metrics_;
+    QTreeWidget * tree_;
+    QTimer * timer_;
+};
+
+#endif // LIBRETUNER_LINKMETRICSVIEW_H
@@ -24,6 +24,14 @@ void ScalarView::setTable(lt::Table * table)
     setValue(table_->get(0, 0));
 }
 
+void ScalarView::refresh()
+{
+    if (table_ == nullptr)
+        return;
+    setValue(table_->get(0, 0));
+    setDirty(false);
+}
+
 ScalarView::ScalarView(QWidget * parent) : QWidget(parent)
 {
     lineValue_ = new QLineEdit;
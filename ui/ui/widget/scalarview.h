@@ -22,6 +22,9 @@ public:
 
     void setTable(lt::Table * table);
 
+    // Shows the current value of the table, dropping unsaved input
+    void refresh();
+
 protected:
     void closeEvent(QCloseEvent * event) override;
 
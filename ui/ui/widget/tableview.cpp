@@ -1,15 +1,26 @@
 #include "tableview.h"
 
 #include <QAbstractItemView>
+#include <QAction>
+#include <QClipboard>
+#include <QGuiApplication>
 #include <QHBoxLayout>
 #include <QHeaderView>
+#include <QInputDialog>
 #include <QLabel>
+#include <QMessageBox>
 #include <QPainter>
 #include <QStyledItemDelegate>
 #include <QTableView>
+#include <QTimer>
 #include <QVBoxLayout>
 
 #include "../docks/graphwidget.h"
+#include "libretuner.h"
+#include "uiutil.h"
+
+#include <algorithm>
+#include <limits>
 
 class TableDelegate : public QStyledItemDelegate
 {
@@ -78,6 +89,255 @@ TableView::TableView(QWidget * /*parent*/)
 
     connect(&model_, &TableModel::modelReset, this, &TableView::axesChanged);
     connect(buttonGraph, &QPushButton::clicked, graph_, &GraphWidget::show);
+
+    // Bulk editing
+    auto * copyAction = new QAction(tr("Copy"), view_);
+    copyAction->setShortcut(QKeySequence::Copy);
+    auto * pasteAction = new QAction(tr("Paste"), view_);
+    pasteAction->setShortcut(QKeySequence::Paste);
+    auto * multiplyAction = new QAction(tr("Multiply..."), view_);
+    auto * addAction = new QAction(tr("Add..."), view_);
+    auto * fillAction = new QAction(tr("Fill..."), view_);
+    auto * interpolateAction = new QAction(tr("Interpolate"), view_);
+    auto * smoothAction = new QAction(tr("Smooth"), view_);
+
+    for (QAction * action : {copyAction, pasteAction, multiplyAction, addAction, fillAction, interpolateAction,
+                             smoothAction})
+    {
+        action->setShortcutContext(Qt::WidgetShortcut);
+        view_->addAction(action);
+    }
+    auto * separator = new QAction(view_);
+    separator->setSeparator(true);
+    view_->insertAction(multiplyAction, separator);
+
+    // Log overlay
+    auto * overlaySeparator = new QAction(view_);
+    overlaySeparator->setSeparator(true);
+    auto * showOverlayAction = new QAction(tr("Show Log Overlay..."), view_);
+    auto * hideOverlayAction = new QAction(tr("Hide Log Overlay"), view_);
+    auto * correctAction = new QAction(tr("Apply Log Corrections"), view_);
+    view_->addActions({overlaySeparator, showOverlayAction, hideOverlayAction, correctAction});
+    view_->setContextMenuPolicy(Qt::ActionsContextMenu);
+
+    overlayTimer_ = new QTimer(this);
+    overlayTimer_->setInterval(1000);
+    connect(overlayTimer_, &QTimer::timeout, [this]() {
+        if (overlay_)
+            model_.setOverlay(std::make_shared<lt::CellHistogram>(overlay_->snapshot()));
+    });
+    connect(showOverlayAction, &QAction::triggered, this, &TableView::showOverlay);
+    connect(hideOverlayAction, &QAction::triggered, this, &TableView::hideOverlay);
+    connect(correctAction, &QAction::triggered, this, &TableView::applyCorrections);
+
+    connect(copyAction, &QAction::triggered, this, &TableView::copy);
+    connect(pasteAction, &QAction::triggered, this, &TableView::paste);
+    connect(multiplyAction, &QAction::triggered,
+            [this]() { applyWithValue(tr("Multiply"), tr("Multiply by:"), 1.0, &lt::Table::multiply); });
+    connect(addAction, &QAction::triggered,
+            [this]() { applyWithValue(tr("Add"), tr("Add:"), 0.0, &lt::Table::add); });
+    connect(fillAction, &QAction::triggered,
+            [this]() { applyWithValue(tr("Fill"), tr("Fill with:"), 0.0, &lt::Table::fill); });
+    connect(interpolateAction, &QAction::triggered, [this]() {
+        catchWarning(
+            [this]() {
+                model_.apply(selection(), tr("Interpolate"),
+                             [](lt::Table & table, const lt::Table::Region & region) { table.interpolate(region); });
+            },
+            tr("Error interpolating cells"));
+    });
+    connect(smoothAction, &QAction::triggered, [this]() {
+        catchWarning(
+            [this]() {
+                model_.apply(selection(), tr("Smooth"),
+                             [](lt::Table & table, const lt::Table::Region & region) { table.smooth(region); });
+            },
+            tr("Error smoothing cells"));
+    });
+}
+
+lt::Table::Region TableView::selection() const
+{
+    const QModelIndexList indexes = view_->selectionModel()->selectedIndexes();
+    if (indexes.isEmpty())
+        return lt::Table::Region{0, 0, 0, 0};
+
+    int top = std::numeric_limits<int>::max(), left = std::numeric_limits<int>::max();
+    int bottom = 0, right = 0;
+    for (const QModelIndex & index : indexes)
+    {
+        top = std::min(top, index.row());
+        left = std::min(left, index.column());
+        bottom = std::max(bottom, index.row());
+        right = std::max(right, index.column());
+    }
+    return lt::Table::Region{top, left, bottom - top + 1, right - left + 1};
+}
+
+void TableView::copy()
+{
+    lt::Table * table = model_.table();
+    lt::Table::Region region = selection();
+    if (table == nullptr || region.empty())
+        return;
+
+    // Tab separated, like other spreadsheets
+    std::vector<double> values = table->getRegion(region);
+    QString text;
+    for (int row = 0; row < region.height; ++row)
+    {
+        for (int column = 0; column < region.width; ++column)
+        {
+            if (column != 0)
+                text += '\t';
+            text += QString::number(values[row * region.width + column]);
+        }
+        text += '\n';
+    }
+    QGuiApplication::clipboard()->setText(text);
+}
+
+void TableView::paste()
+{
+    lt::Table::Region target = selection();
+    if (target.empty())
+        return;
+
+    QStringList lines = QGuiApplication::clipboard()->text().split('\n');
+    while (!lines.isEmpty() && lines.back().trimmed().isEmpty())
+        lines.removeLast();
+    if (lines.isEmpty())
+        return;
+
+    std::vector<QStringList> cells;
+    int width = 0;
+    for (const QString & line : lines)
+    {
+        cells.push_back(line.split('\t'));
+        width = std::max(width, static_cast<int>(cells.back().size()));
+    }
+
+    target.height = static_cast<int>(cells.size());
+    target.width = width;
+    catchWarning(
+        [&]() {
+            model_.apply(target, tr("Paste"), [&](lt::Table & table, const lt::Table::Region & region) {
+                // Cells that are missing or not numbers keep their value
+                std::vector<double> values = table.getRegion(region);
+                for (int row = 0; row < region.height; ++row)
+                {
+                    const QStringList & line = cells[row];
+                    for (int column = 0; column < region.width && column < line.size(); ++column)
+                    {
+                        bool ok;
+                        double value = line[column].trimmed().toDouble(&ok);
+                        if (ok)
+                            values[row * region.width + column] = value;
+                    }
+                }
+                table.setRegion(region, values.data());
+            });
+        },
+        tr("Error pasting cells"));
+}
+
+void TableView::showOverlay()
+{
+    lt::Table * table = model_.table();
+    const lt::DataLogPtr & log = LT()->dataLog();
+    if (table == nullptr)
+        return;
+    if (!log || log->empty())
+    {
+        QMessageBox::information(this, tr("Log Overlay"), tr("Record or open a log in the data logger first."));
+        return;
+    }
+
+    std::vector<lt::Pid> pids = log->pids();
+    QStringList names;
+    for (const lt::Pid & pid : pids)
+        names.append(QString::fromStdString(pid.name));
+
+    // Preselects the PID named like the axis
+    auto choose = [&](const QString & prompt, const lt::Table::AxisTypePtr & axis, int & index) {
+        int current = 0;
+        if (axis)
+            current = std::max(names.indexOf(QString::fromStdString(axis->name())), 0);
+        bool ok;
+        QString name = QInputDialog::getItem(this, tr("Log Overlay"), prompt, names, current, false, &ok);
+        index = names.indexOf(name);
+        return ok && index != -1;
+    };
+
+    int x, y, value;
+    if (!choose(tr("PID of the columns:"), table->xAxis(), x) || !choose(tr("PID of the rows:"), table->yAxis(), y) ||
+        !choose(tr("PID to overlay:"), nullptr, value))
+        return;
+
+    catchWarning(
+        [&]() {
+            overlay_.reset();
+            overlay_ = std::make_unique<lt::LiveCellHistogram>(*log, lt::TableLookup::fromTable(*table), pids[x].code,
+                                                               pids[y].code, pids[value].code);
+            model_.setOverlay(std::make_shared<lt::CellHistogram>(overlay_->snapshot()));
+            overlayTimer_->start();
+        },
+        tr("Error creating log overlay"));
+}
+
+void TableView::hideOverlay()
+{
+    overlayTimer_->stop();
+    overlay_.reset();
+    model_.setOverlay(nullptr);
+}
+
+void TableView::applyCorrections()
+{
+    std::shared_ptr<const lt::CellHistogram> overlay = model_.overlay();
+    if (!overlay || model_.table() == nullptr)
+        return;
+
+    const QStringList modes{tr("Scale by the mean (fractional error)"), tr("Add the mean (absolute error)")};
+    bool ok;
+    QString mode = QInputDialog::getItem(this, tr("Apply Log Corrections"), tr("The overlaid PID is:"), modes, 0,
+                                         false, &ok);
+    if (!ok)
+        return;
+    const auto correction = mode == modes[0] ? lt::CellHistogram::Correction::Multiplicative
+                                             : lt::CellHistogram::Correction::Additive;
+
+    catchWarning(
+        [&]() {
+            model_.apply(model_.table()->region(), tr("Apply Log Corrections"),
+                         [&](lt::Table & table, const lt::Table::Region & region) {
+                             std::vector<double> values = overlay->suggest(table.getRegion(region), correction);
+                             table.setRegion(region, values.data());
+                         });
+        },
+        tr("Error applying corrections"));
+}
+
+void TableView::applyWithValue(const QString & label, const QString & prompt, double initial,
+                               void (lt::Table::*operation)(const lt::Table::Region &, double))
+{
+    lt::Table::Region region = selection();
+    if (model_.table() == nullptr || region.empty())
+        return;
+
+    bool ok;
+    double value = QInputDialog::getDouble(this, label, prompt, initial, std::numeric_limits<double>::lowest(),
+                                           std::numeric_limits<double>::max(), 4, &ok);
+    if (!ok)
+        return;
+
+    catchWarning(
+        [&]() {
+            model_.apply(region, label, [&](lt::Table & table, const lt::Table::Region & clipped) {
+                (table.*operation)(clipped, value);
+            });
+        },
+        tr("Error editing cells"));
 }
 
 void TableView::axesChanged()
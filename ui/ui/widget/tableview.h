@@ -6,10 +6,13 @@
 #include "../verticallabel.h"
 #include "models/tablemodel.h"
 
+#include <memory>
+
 class QTableView;
 class QLabel;
 class GraphWidget;
 class QBoxLayout;
+class QTimer;
 
 class TableView : public QWidget
 {
@@ -19,10 +22,31 @@ public:
 
     void setTable(lt::Table * table);
 
+    inline void refresh() { model_.refresh(); }
+
+    // Bulk edits become single steps of `history`
+    inline void setHistory(lt::EditHistory * history) noexcept { model_.setHistory(history); }
+
 private slots:
     void axesChanged();
 
 private:
+    // Bounding box of the selected cells
+    lt::Table::Region selection() const;
+
+    void copy();
+    void paste();
+    // Asks for an operand and applies `operation` to the selection
+    void applyWithValue(const QString & label, const QString & prompt, double initial,
+                        void (lt::Table::*operation)(const lt::Table::Region &, double));
+
+    // Asks for the PIDs of the axes and the overlaid channel, then bins the
+    // current data log into the cells
+    void showOverlay();
+    void hideOverlay();
+    // Applies the corrections suggested by the overlay
+    void applyCorrections();
+
     QTableView * view_;
     QLabel * labelX_;
     VerticalLabel * labelY_;
@@ -30,6 +54,10 @@ private:
     QBoxLayout * layout_;
 
     TableModel model_;
+
+    std::unique_ptr<lt::LiveCellHistogram> overlay_;
+    // Refreshes the overlay while logging
+    QTimer * overlayTimer_;
 };
 
 #endif // LIBRETUNER_TABLEVIEW_H